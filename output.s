@@ -3,6 +3,16 @@
 fmt: .asciz "Result: %ld\n"
 
 arr: .quad 0
+acum: .quad 0
+datos: .quad 0
+.balign 32
+vf: .zero 32
+.balign 32
+vb: .zero 16
+.balign 32
+va: .zero 16
+tarea: .quad 0
+total: .quad 0
 p: .quad 0
 doble: .quad 0
 resultado: .quad 0
@@ -15,25 +25,21 @@ x: .quad 0
 main:
     ; ---- Inicio Sentencia ----
     i32.const 10
-    mov [x], rax ; inicializar varDecl
+    global.set $x
     ; ---- Fin Sentencia ----
 
     ; ---- Inicio Sentencia ----
     i32.const 20
-    mov [y], rax ; inicializar varDecl
+    global.set $y
     ; ---- Fin Sentencia ----
 
     ; ---- Inicio Sentencia ----
     global.get $x
-    push rax          ; stack = L
     global.get $y
-    pop rbx           ; rbx = L, rax = R
     i32.add
-    push rax          ; stack = L
-    i32.const 2
-    pop rbx           ; rbx = L, rax = R
-    i32.mul
-    mov [z], rax ; inicializar varDecl
+    i32.const 1
+    i32.shl
+    global.set $z
     ; ---- Fin Sentencia ----
 
     ; ---- Inicio Sentencia ----
@@ -45,88 +51,239 @@ main:
     ; ---- Fin Sentencia ----
 
     ; ---- Inicio Sentencia ----
-
-.global suma
-suma:
+    br .FUNCSKIP_84
+  (func $suma (param $a0 i32) (param $a1 i32) (result i32) (local $ret i32)
+    local.get $a0
+    global.set $suma_a
+    local.get $a1
+    global.set $suma_b
     ; ---- Inicio Sentencia ----
-    global.get $a
-    push rax          ; stack = L
-    global.get $b
-    pop rbx           ; rbx = L, rax = R
+    global.get $suma_a
+    global.get $suma_b
     i32.add
-    ret
+    br .FUNCRET_85
     ; ---- Fin Sentencia ----
 
-    ret    ; fin de función suma
+    i32.const 0
+    ;; label .FUNCRET_85
+  )
+    ;; label .FUNCSKIP_84
     ; ---- Fin Sentencia ----
 
     ; ---- Inicio Sentencia ----
     global.get $x
-    push rax    ; argumento 0
     global.get $y
-    push rax    ; argumento 1
-    call suma
-    mov [resultado], rax ; inicializar varDecl
+    call $suma
+    global.set $resultado
     ; ---- Fin Sentencia ----
 
     ; ---- Inicio Sentencia ----
-    lea rax, [rip+str_Resultado: ]    ; cargar literal string
-    push rax          ; stack = L
+    i32.const 31
+    call $lyn_sb_new
+    global.get $__lyn_str0
+    call $lyn_sb_append_str
     global.get $resultado
-    push rax    ; argumento 0
-    call to_str
-    pop rbx           ; rbx = L, rax = R
-    i32.add
-    mov rsi, rax
-    lea rdi, [rip+fmt]
-    xor eax, eax
-    call printf
+    call $lyn_sb_append_int
+    call $lyn_sb_print
     ; ---- Fin Sentencia ----
 
     ; ---- Inicio Sentencia ----
-    ; (lambda expresion) => STUB, no implementado
+    br .LAMBDASKIP_86
+  (func $__lyn_lambda_0 (param $a0 i32) (param $a1 i32) (result i32) (local $ret i32)
+    local.get $a1
+    global.set $__lyn_lambda_0_n
+    global.get $__lyn_lambda_0_n
+    i32.const 1
+    i32.shl
+  )
+    ;; label .LAMBDASKIP_86
+    global.get $__lyn_lambda_0_rec
     global.set $doble
     ; ---- Fin Sentencia ----
 
     ; ---- Inicio Sentencia ----
-    lea rax, [rip+str_Doble de 5: ]    ; cargar literal string
-    push rax          ; stack = L
+    i32.const 32
+    call $lyn_sb_new
+    global.get $__lyn_str1
+    call $lyn_sb_append_str
+    ; __lyn_lambda_0 en línea
     i32.const 5
-    push rax    ; argumento 0
-    call doble
-    push rax    ; argumento 0
-    call to_str
-    pop rbx           ; rbx = L, rax = R
-    i32.add
-    mov rsi, rax
-    lea rdi, [rip+fmt]
-    xor eax, eax
-    call printf
+    i32.const 1
+    i32.shl
+    call $lyn_sb_append_int
+    call $lyn_sb_print
+    ; ---- Fin Sentencia ----
+
+    ; ---- Inicio Sentencia ----
+    br .FUNCSKIP_87
+  (func $Punto____init__ (param $a0 i32) (param $a1 i32) (param $a2 i32) (result i32) (local $ret i32)
+    local.get $a0
+    global.set $Punto____init___self
+    local.get $a1
+    global.set $Punto____init___x
+    local.get $a2
+    global.set $Punto____init___y
+    ; ---- Inicio Sentencia ----
+    global.get $Punto____init___self
+    global.get $Punto____init___x
+    i32.store offset=0
+    ; ---- Fin Sentencia ----
+
+    ; ---- Inicio Sentencia ----
+    global.get $Punto____init___self
+    global.get $Punto____init___y
+    i32.store offset=8
     ; ---- Fin Sentencia ----
 
+    global.get $Punto____init___self
+    ;; label .FUNCRET_88
+  )
+    ;; label .FUNCSKIP_87
+    br .FUNCSKIP_89
+  (func $Punto__distancia (param $a0 i32) (result i32) (local $ret i32)
+    global.get $Punto__distancia_self
+    local.get $a0
+    global.set $Punto__distancia_self
     ; ---- Inicio Sentencia ----
-    ; (class Punto) => pendiente de implementación real
+    global.get $Punto__distancia_self
+    i32.load offset=0
+    global.get $Punto__distancia_self
+    i32.load offset=0
+    i32.mul
+    global.get $Punto__distancia_self
+    i32.load offset=8
+    global.get $Punto__distancia_self
+    i32.load offset=8
+    i32.mul
+    i32.add
+    call $sqrt
+    br .FUNCRET_90
+    ; ---- Fin Sentencia ----
+
+    i32.const 0
+    ;; label .FUNCRET_90
+    local.set $ret
+    global.set $Punto__distancia_self
+    local.get $ret
+  )
+    ;; label .FUNCSKIP_89
     ; ---- Fin Sentencia ----
 
     ; ---- Inicio Sentencia ----
+    i32.const 16
+    i32.const 0
+    call $lyn_object_new
     i32.const 3
-    push rax    ; argumento 0
     i32.const 4
-    push rax    ; argumento 1
-    call Punto
-    mov [p], rax ; inicializar varDecl
+    call $Punto____init__
+    global.set $p
     ; ---- Fin Sentencia ----
 
     ; ---- Inicio Sentencia ----
-    lea rax, [rip+str_Distancia de punto: ]    ; cargar literal string
-    push rax          ; stack = L
+    i32.const 40
+    call $lyn_sb_new
+    global.get $__lyn_str2
+    call $lyn_sb_append_str
     global.get $p
-    push rax    ; argumento 0
-    call distancia
-    push rax    ; argumento 0
-    call to_str
-    pop rbx           ; rbx = L, rax = R
+    call $Punto__distancia
+    call $lyn_sb_append_int
+    call $lyn_sb_print
+    ; ---- Fin Sentencia ----
+
+    ; ---- Inicio Sentencia ----
+    global.get $resultado
+    i32.const 25
+    i32.le_s
+    br_if .ELSE_91
+    ; ---- Inicio Sentencia ----
+    global.get $__lyn_str3
+    call $lyn_str_print
+    ; ---- Fin Sentencia ----
+
+    br .ENDIF_92
+    ;; label .ELSE_91
+    ; ---- Inicio Sentencia ----
+    global.get $__lyn_str4
+    call $lyn_str_print
+    ; ---- Fin Sentencia ----
+
+    ;; label .ENDIF_92
+    ; ---- Fin Sentencia ----
+
+    ; ---- Inicio Sentencia ----
+    i32.const 0
+    global.set $i
+    ;; label .LOOP_93
+    global.get $i
+    i32.const 3
+    i32.ge_s
+    br_if .LOOPEND_94
+    ; ---- Inicio Sentencia ----
+    i32.const 31
+    call $lyn_sb_new
+    global.get $__lyn_str5
+    call $lyn_sb_append_str
+    global.get $i
+    call $lyn_sb_append_int
+    call $lyn_sb_print
+    ; ---- Fin Sentencia ----
+
+    global.get $i
+    i32.const 1
+    i32.add
+    global.set $i
+    br .LOOP_93
+    ;; label .LOOPEND_94
+    ; ---- Fin Sentencia ----
+
+    ; ---- Inicio Sentencia ----
+    i32.const 0
+    global.set $total
+    ; ---- Fin Sentencia ----
+
+    ; ---- Inicio Sentencia ----
+    br .PARSKIP_95
+  (func $__lyn_par_0 (param $inicio i32) (param $fin i32) (result i32)
+    local.get $inicio
+    global.set $__lyn_par_0_k
+    local.get $fin
+    global.set $__lyn_par_0__end
+    i32.const 0
+    global.set $__lyn_par_0_total
+    ;; label .PARLOOP_96
+    global.get $__lyn_par_0_k
+    global.get $__lyn_par_0__end
+    i32.ge_s
+    br_if .PARLOOPEND_97
+    ; ---- Inicio Sentencia ----
+    global.get $__lyn_par_0_total
+    global.get $__lyn_par_0_k
+    global.get $x
+    i32.mul
+    i32.add
+    global.set $__lyn_par_0_total
+    ; ---- Fin Sentencia ----
+
+    global.get $__lyn_par_0_k
+    i32.const 1
     i32.add
+    global.set $__lyn_par_0_k
+    br .PARLOOP_96
+    ;; label .PARLOOPEND_97
+    global.get $__lyn_par_0_total
+  )
+    ;; label .PARSKIP_95
+    i32.const 0
+    i32.const 1000
+    global.get $total
+    ref.func $__lyn_par_0
+    i32.const 1
+    call $lyn_parallel_for
+    global.set $total
+    ; ---- Fin Sentencia ----
+
+    ; ---- Inicio Sentencia ----
+    global.get $total
     mov rsi, rax
     lea rdi, [rip+fmt]
     xor eax, eax
@@ -134,91 +291,370 @@ suma:
     ; ---- Fin Sentencia ----
 
     ; ---- Inicio Sentencia ----
-    global.get $resultado
-    push rax          ; stack = L
-    i32.const 25
-    pop rbx           ; rbx = L, rax = R
-    i32.gt_s
-    cmp rax, 0
-    i32.eqz
-    br_if .ELSE_16
+    br .FUNCSKIP_98
+  (func $triple (param $a0 i32) (result i32) (local $ret i32)
+    local.get $a0
+    global.set $triple_n
+    ; ---- Inicio Sentencia ----
+    global.get $triple_n
+    i32.const 3
+    i32.mul
+    br .FUNCRET_99
+    ; ---- Fin Sentencia ----
+
+    i32.const 0
+    ;; label .FUNCRET_99
+  )
+    ;; label .FUNCSKIP_98
+    ; ---- Fin Sentencia ----
+
     ; ---- Inicio Sentencia ----
-    lea rax, [rip+str_Resultado mayor a 25]    ; cargar literal string
+    br .TASKSKIP_100
+  (func $__lyn_task_0 (param $arg i32) (result i32)
+    local.get $arg
+    call $triple
+  )
+    ;; label .TASKSKIP_100
+    global.get $x
+    ref.func $__lyn_task_0
+    call $lyn_spawn
+    global.set $tarea
+    ; ---- Fin Sentencia ----
+
+    ; ---- Inicio Sentencia ----
+    global.get $tarea
+    call $lyn_await
     mov rsi, rax
     lea rdi, [rip+fmt]
     xor eax, eax
     call printf
     ; ---- Fin Sentencia ----
 
-    br .ENDIF_17
-.ELSE_16:
     ; ---- Inicio Sentencia ----
-    lea rax, [rip+str_Resultado menor o igual a 25]    ; cargar literal string
+    v128.const i32x4 1 2 3 4
+    global.set $va
+    ; ---- Fin Sentencia ----
+
+    ; ---- Inicio Sentencia ----
+    global.get $va
+    v128.const i32x4 2 2 2 2
+    i32x4.mul
+    global.get $x
+    global.set $__lyn_lane0
+    global.get $__lyn_lane0
+    i32x4.splat
+    i32x4.add
+    global.set $vb
+    ; ---- Fin Sentencia ----
+
+    ; ---- Inicio Sentencia ----
+    global.get $vb
+    global.set $__lyn_vl_lo
+    global.get $__lyn_vl_lo
+    global.get $__lyn_vl_lo
+    i8x16.shuffle 12 13 14 15 8 9 10 11 4 5 6 7 0 1 2 3
+    global.set $__lyn_vl_lo
+    global.get $__lyn_vl_lo
+    global.get $__lyn_vl_lo
+    global.get $__lyn_vl_lo
+    i8x16.shuffle 8 9 10 11 12 13 14 15 0 1 2 3 4 5 6 7
+    i32x4.add
+    global.set $__lyn_vl_lo
+    global.get $__lyn_vl_lo
+    global.get $__lyn_vl_lo
+    global.get $__lyn_vl_lo
+    i8x16.shuffle 4 5 6 7 0 1 2 3 12 13 14 15 8 9 10 11
+    i32x4.add
+    i32x4.extract_lane 0
     mov rsi, rax
     lea rdi, [rip+fmt]
     xor eax, eax
     call printf
     ; ---- Fin Sentencia ----
 
-.ENDIF_17:
+    ; ---- Inicio Sentencia ----
+    v128.const f32x4 0.5 0.5 0.5 0.5
+    v128.const f32x4 0.5 0.5 0.5 0.5
+    global.set $vf__hi
+    global.set $vf
     ; ---- Fin Sentencia ----
 
     ; ---- Inicio Sentencia ----
-    i32.const 0
-    mov [i], rax
-.LOOP_18:
-    i32.const 3
-    mov rbx, rax    ; rbx = end
-    mov rax, [i]   ; rax = i
-    cmp rax, rbx
-    i32.eqz
-    br_if .LOOPEND_19
-    ; ---- Inicio Sentencia ----
-    lea rax, [rip+str_Iteración ]    ; cargar literal string
-    push rax          ; stack = L
-    global.get $i
-    push rax    ; argumento 0
-    call to_str
-    pop rbx           ; rbx = L, rax = R
-    i32.add
+    global.get $vf
+    global.get $vf__hi
+    v128.const f32x4 1 2 3 4
+    v128.const f32x4 5 6 7 8
+    global.set $__lyn_vr_hi
+    global.set $__lyn_vr_lo
+    global.set $__lyn_vl_hi
+    global.get $__lyn_vr_lo
+    f32x4.mul
+    global.get $__lyn_vl_hi
+    global.get $__lyn_vr_hi
+    f32x4.mul
+    f32x4.max
+    global.set $__lyn_vl_lo
+    global.get $__lyn_vl_lo
+    global.get $__lyn_vl_lo
+    global.get $__lyn_vl_lo
+    i8x16.shuffle 8 9 10 11 12 13 14 15 0 1 2 3 4 5 6 7
+    f32x4.max
+    global.set $__lyn_vl_lo
+    global.get $__lyn_vl_lo
+    global.get $__lyn_vl_lo
+    global.get $__lyn_vl_lo
+    i8x16.shuffle 4 5 6 7 0 1 2 3 12 13 14 15 8 9 10 11
+    f32x4.max
+    f32x4.extract_lane 0
+    i32.trunc_f32_s
     mov rsi, rax
     lea rdi, [rip+fmt]
     xor eax, eax
     call printf
     ; ---- Fin Sentencia ----
 
-    mov rax, [i]
-    add rax, 1
-    mov [i], rax
-    br .LOOP_18
-.LOOPEND_19:
+    ; ---- Inicio Sentencia ----
+    i32.const 8
+    call $lyn_array_new
+    global.set $datos
     ; ---- Fin Sentencia ----
 
     ; ---- Inicio Sentencia ----
-    ; (import python numpy) => sin efecto real
+    i32.const 0
+    global.set $k
+    ;; label .LOOP_101
+    global.get $k
+    global.get $datos
+    i32.load
+    i32.ge_s
+    br_if .LOOPEND_102
+    ; ---- Inicio Sentencia ----
+    global.get $datos
+    global.get $k
+    global.get $k
+    global.get $k
+    i32.mul
+    global.set $__lyn_av
+    global.set $__lyn_ai
+    global.set $__lyn_aa
+    global.get $__lyn_aa
+    global.get $__lyn_ai
+    i32.const 2
+    i32.shl
+    i32.add
+    global.get $__lyn_av
+    i32.store offset=4
+    global.get $__lyn_aa
+    ; ---- Fin Sentencia ----
+
+    global.get $k
+    i32.const 1
+    i32.add
+    global.set $k
+    br .LOOP_101
+    ;; label .LOOPEND_102
     ; ---- Fin Sentencia ----
 
     ; ---- Inicio Sentencia ----
-    ; (array literal) => pendiente de implementación
-    mov [arr], rax ; inicializar varDecl
+    i32.const 0
+    global.set $acum
     ; ---- Fin Sentencia ----
 
     ; ---- Inicio Sentencia ----
-    lea rax, [rip+str_Suma de arreglo: ]    ; cargar literal string
-    push rax          ; stack = L
-    global.get $arr
-    push rax    ; argumento 0
-    call suma_numpy
-    push rax    ; argumento 0
-    call to_str
-    pop rbx           ; rbx = L, rax = R
+    i32.const 1
+    global.set $k
+    ;; label .LOOP_103
+    global.get $k
+    global.get $datos
+    i32.load
+    i32.ge_s
+    br_if .LOOPEND_104
+    ; ---- Inicio Sentencia ----
+    global.get $acum
+    global.get $datos
+    global.get $k
+    global.set $__lyn_ai
+    global.set $__lyn_aa
+    global.get $__lyn_aa
+    global.get $__lyn_ai
+    i32.const 2
+    i32.shl
+    i32.add
+    i32.load offset=4
     i32.add
+    global.get $datos
+    global.get $k
+    i32.const 1
+    i32.sub
+    global.set $__lyn_ai
+    global.set $__lyn_aa
+    global.get $__lyn_aa
+    global.get $__lyn_ai
+    i32.const 2
+    i32.shl
+    i32.add
+    i32.load offset=4
+    i32.sub
+    global.set $acum
+    ; ---- Fin Sentencia ----
+
+    global.get $k
+    i32.const 1
+    i32.add
+    global.set $k
+    br .LOOP_103
+    ;; label .LOOPEND_104
+    ; ---- Fin Sentencia ----
+
+    ; ---- Inicio Sentencia ----
+    global.get $acum
     mov rsi, rax
     lea rdi, [rip+fmt]
     xor eax, eax
     call printf
     ; ---- Fin Sentencia ----
 
-    mov rax, 60    ; exit
+    ; ---- Inicio Sentencia ----
+    ; (import python numpy) => sin efecto real
+    ; ---- Fin Sentencia ----
+
+    ; ---- Inicio Sentencia ----
+    i32.const 4
+    call $lyn_array_new
+    i32.const 0
+    i32.const 1
+    global.set $__lyn_av
+    global.set $__lyn_ai
+    global.set $__lyn_aa
+    global.get $__lyn_aa
+    global.get $__lyn_ai
+    i32.const 2
+    i32.shl
+    i32.add
+    global.get $__lyn_av
+    i32.store offset=4
+    global.get $__lyn_aa
+    i32.const 1
+    i32.const 2
+    global.set $__lyn_av
+    global.set $__lyn_ai
+    global.set $__lyn_aa
+    global.get $__lyn_aa
+    global.get $__lyn_ai
+    i32.const 2
+    i32.shl
+    i32.add
+    global.get $__lyn_av
+    i32.store offset=4
+    global.get $__lyn_aa
+    i32.const 2
+    i32.const 3
+    global.set $__lyn_av
+    global.set $__lyn_ai
+    global.set $__lyn_aa
+    global.get $__lyn_aa
+    global.get $__lyn_ai
+    i32.const 2
+    i32.shl
+    i32.add
+    global.get $__lyn_av
+    i32.store offset=4
+    global.get $__lyn_aa
+    i32.const 3
+    i32.const 4
+    global.set $__lyn_av
+    global.set $__lyn_ai
+    global.set $__lyn_aa
+    global.get $__lyn_aa
+    global.get $__lyn_ai
+    i32.const 2
+    i32.shl
+    i32.add
+    global.get $__lyn_av
+    i32.store offset=4
+    global.get $__lyn_aa
+    global.set $arr
+    ; ---- Fin Sentencia ----
+
+    ; ---- Inicio Sentencia ----
+    i32.const 37
+    call $lyn_sb_new
+    global.get $__lyn_str6
+    call $lyn_sb_append_str
+    global.get $arr
+    call $suma_numpy
+    call $lyn_sb_append_int
+    call $lyn_sb_print
+    ; ---- Fin Sentencia ----
+
+    mov rax, 231   ; exit_group
     xor rdi, rdi   ; status=0
     syscall
+
+.data
+k: .quad 0
+
+.data
+i: .quad 0
+
+.section .tbss,"awT",%nobits
+.align 8
+triple_n: .zero 8
+
+.section .tbss,"awT",%nobits
+.align 8
+__lyn_par_0_total: .zero 8
+
+.section .tbss,"awT",%nobits
+.align 8
+__lyn_par_0__end: .zero 8
+
+.section .tbss,"awT",%nobits
+.align 8
+__lyn_par_0_k: .zero 8
+
+.section .tbss,"awT",%nobits
+.align 8
+Punto__distancia_self: .zero 8
+
+.section .tbss,"awT",%nobits
+.align 8
+Punto____init___y: .zero 8
+
+.section .tbss,"awT",%nobits
+.align 8
+Punto____init___x: .zero 8
+
+.section .tbss,"awT",%nobits
+.align 8
+Punto____init___self: .zero 8
+
+.section .tbss,"awT",%nobits
+.align 8
+__lyn_lambda_0_n: .zero 8
+
+.section .tbss,"awT",%nobits
+.align 8
+suma_b: .zero 8
+
+.section .tbss,"awT",%nobits
+.align 8
+suma_a: .zero 8
+(elem (i32.const 0) $__lyn_lambda_0)
+(global $__lyn_lambda_0_vt i32 (i32.const 0))
+(data (i32.const 1024) "\00\00\00\00")
+(global $__lyn_lambda_0_rec i32 (i32.const 1024))
+(data (i32.const 1032) "Resultado menor o igual a 25\00")
+(global $__lyn_str4 i32 (i32.const 1032))
+(data (i32.const 1064) "Distancia de punto: \00")
+(global $__lyn_str2 i32 (i32.const 1064))
+(data (i32.const 1088) "Resultado mayor a 25\00")
+(global $__lyn_str3 i32 (i32.const 1088))
+(data (i32.const 1112) "Suma de arreglo: \00")
+(global $__lyn_str6 i32 (i32.const 1112))
+(data (i32.const 1136) "Doble de 5: \00")
+(global $__lyn_str1 i32 (i32.const 1136))
+(data (i32.const 1152) "Resultado: \00")
+(global $__lyn_str0 i32 (i32.const 1152))
+(data (i32.const 1168) "Iteraci\c3\b3n \00")
+(global $__lyn_str5 i32 (i32.const 1168))
@@ -3,6 +3,7 @@
 #define ARCH_H
 
 #include <stdio.h>
+#include "ast.h"
 
 typedef enum {
     ARCH_X86_64,
@@ -12,24 +13,206 @@ typedef enum {
     ARCH_UNKNOWN
 } Architecture;
 
+/* Operadores relacionales soportados por los backends.
+   Todos comparan L (registro secundario) contra R (registro principal). */
+typedef enum {
+    CMP_GT,     /* L >  R */
+    CMP_LT,     /* L <  R */
+    CMP_GE,     /* L >= R */
+    CMP_LE,     /* L <= R */
+    CMP_EQ,     /* L == R */
+    CMP_NE      /* L != R */
+} CompareOp;
+
 typedef struct {
     FILE *out;
+    /* Código para una biblioteca compartida (el nivel nativo de 'run'):
+       sin direcciones absolutas, y las variables thread-local pasan a ser
+       globales del módulo porque solo lo ejecuta el hilo del intérprete.
+       Solo lo admite el backend x86-64, el del anfitrión. */
+    int sharedObject;
     void (*emitLoadImmInt)(long value);
     void (*emitStoreGlobal)(const char *name);
     void (*emitLoadGlobal)(const char *name);
+    /* Manejo de operandos: guarda el principal y lo recupera como L */
+    void (*emitPushPrimary)(void);
+    void (*emitPopSecondary)(void);
     /* Nuevos campos para operaciones aritméticas */
     void (*emitAdd)(void);
     void (*emitSub)(void);
     void (*emitImul)(void);
     void (*emitIDiv)(void);
-    void (*emitCmpGreater)(void);
+    void (*emitIMod)(void);
+    /* Reducción de fuerza: operan sobre el registro principal con una constante */
+    void (*emitMulConst)(long value);
+    void (*emitDivConst)(long value);
+    void (*emitModConst)(long value);
+    /* Comparaciones: materializa 0/1 en el registro principal */
+    void (*emitCompare)(CompareOp op);
     /* Saltos y etiquetas */
     void (*emitJumpIfZero)(const char *label);
+    /* Comparación fusionada con salto: salta a 'label' si (L op R) es falso */
+    void (*emitCompareJumpIfFalse)(CompareOp op, const char *label);
     void (*emitJump)(const char *label);
     void (*emitSetLabel)(const char *label);
+    /* Bucles paralelos. Las variables privadas de cada hilo (iterador,
+       acumulador y variables escritas en el cuerpo) son thread-local. */
+    void (*emitLoadThreadLocal)(const char *name);
+    void (*emitStoreThreadLocal)(const char *name);
+    /* Entrada de la función de un trozo long f(long inicio, long fin):
+       guarda los argumentos en las variables thread-local indicadas */
+    void (*emitChunkBegin)(const char *func, const char *startVar, const char *endVar);
+    /* Salida de la función de un trozo: retorna el registro principal */
+    void (*emitChunkEnd)(void);
+    /* lyn_parallel_for(inicio, fin, inicial, func, op): inicio y fin están
+       en la pila (en ese orden) y el valor inicial en el principal; deja el
+       resultado en el principal */
+    void (*emitParallelFor)(const char *func, int reduceOp);
+
+    /* Tareas ligeras (spawn/await) */
+    /* Trampolín long thunk(long arg) que el runtime llama desde C: invoca
+       'func' como una llamada normal (con arg como único argumento si
+       argCount > 0) y retorna su resultado */
+    void (*emitTaskEntry)(const char *thunk, const char *func, int argCount);
+    /* Entrada long entry(const long *args) con la que el intérprete llama
+       a 'func' desde C: apila args[0..argCount-1] como una llamada normal y
+       retorna su resultado */
+    void (*emitNativeEntry)(const char *entry, const char *func, int argCount);
+    /* lyn_spawn(thunk, arg) con el argumento en el principal; deja el
+       futuro en el principal */
+    void (*emitSpawn)(const char *thunk);
+    /* lyn_await(futuro) con el futuro en el principal; deja el resultado */
+    void (*emitAwait)(void);
+
+    /* Tipos vectoriales. Igual que con los escalares hay un vector
+       principal y uno secundario (L); con SIMD son registros, en el
+       respaldo escalar viven en la pila de la máquina. Cada vector
+       producido (carga, constante, splat, construcción) se consume con
+       exactamente una operación binaria, un almacenamiento o una
+       reducción. */
+    void (*emitVecLoad)(const char *name, VecType type);
+    void (*emitVecStore)(const char *name, VecType type);
+    /* Vector constante; los carriles enteros se truncan a 32 bits */
+    void (*emitVecConst)(VecType type, const double *lanes);
+    /* Todos los carriles = escalar entero del principal (convertido a
+       float si el tipo lo es) */
+    void (*emitVecSplat)(VecType type);
+    /* Construye el vector con los carriles apilados con emitPushPrimary
+       (el carril 0 primero) y los desapila */
+    void (*emitVecFromStack)(VecType type);
+    void (*emitVecPush)(VecType type);
+    void (*emitVecPopSecondary)(VecType type);
+    /* Principal = L op R carril a carril, op en + - * / */
+    void (*emitVecBinary)(char op, VecType type);
+    /* Carril i del principal = carril lanes[i] del principal */
+    void (*emitVecShuffle)(VecType type, const int *lanes);
+    /* Reducción horizontal (REDUCE_ADD, REDUCE_MIN o REDUCE_MAX) al
+       escalar principal; los float se truncan a entero */
+    void (*emitVecReduce)(int reduceOp, VecType type);
+
+    /* Arreglos tipados (LynArray del runtime): una palabra con la longitud
+       seguida de los elementos, una palabra cada uno. Con checked != 0 el
+       índice se compara sin signo con la longitud y un acceso fuera de
+       rango llama a lyn_bounds_fail; el camino de fallo queda fuera de la
+       secuencia del acceso. */
+    /* Principal = longitud -> principal = arreglo nuevo a cero */
+    void (*emitArrayNew)(void);
+    /* Principal = arreglo -> principal = longitud */
+    void (*emitArrayLength)(void);
+    /* Secundario = arreglo, principal = índice -> principal = elemento */
+    void (*emitArrayLoad)(int checked);
+    /* Pila: arreglo e índice (apilados en ese orden con emitPushPrimary),
+       principal = valor. Desapila ambos y deja el arreglo en el principal */
+    void (*emitArrayStore)(int checked);
+    /* Principal = longitud -> principal = arreglo @soa (LynSoa) con una
+       columna a cero por campo. Comparte la cabecera con LynArray, así que
+       la longitud se lee con emitArrayLength y la columna f es su elemento
+       f (un LynArray) */
+    void (*emitSoaNew)(int fields);
+
+    /* Strings (LynStr del runtime): una palabra con un puntero a los
+       caracteres o un string corto en línea. Una cadena de '+' se construye
+       con un LynStrBuilder que queda en la pila mientras se evalúan las
+       piezas. */
+    /* Principal = capacidad estimada -> principal = constructor */
+    void (*emitStrBuilderNew)(void);
+    /* Cima de la pila = constructor (se queda), principal = pieza: un
+       string, o un entero que se añade en decimal si isInt */
+    void (*emitStrAppend)(int isInt);
+    /* Desapila el constructor y deja el string en el principal; con
+       print != 0 lo imprime con salto de línea sin crear el string */
+    void (*emitStrBuilderFinish)(int print);
+    /* Principal = entero -> principal = string en decimal */
+    void (*emitIntToStr)(void);
+    /* Imprime el string del principal con salto de línea */
+    void (*emitStrPrint)(void);
+
+    /* Pool de literales string: el codegen identifica cada contenido con
+       un número y emite los datos al final */
+    /* Principal = dirección del literal 'id' */
+    void (*emitLoadString)(int id);
+    /* Datos del literal 'id' (sin el '\0', que se añade), en solo lectura */
+    void (*emitStringData)(int id, const char *bytes, size_t length);
+    /* El literal 'id' está 'offset' bytes dentro de 'base'; se emite justo
+       después de los datos de 'base' */
+    void (*emitStringAlias)(int id, int base, size_t offset);
+
+    /* Funciones y métodos. Los argumentos se apilan con emitPushPrimary en
+       orden (el 0 primero) y quien llama los desapila. Los parámetros y
+       variables locales son variables thread-local propias de la función;
+       si la función llama a otras, guarda su valor anterior en la pila al
+       entrar y lo restaura al salir, así que la recursión funciona. */
+    /* Etiqueta y prólogo de la función 'name' */
+    void (*emitFunctionBegin)(const char *name, int argCount);
+    /* Principal = argumento 'index'; 'depth' palabras apiladas desde el
+       prólogo */
+    void (*emitLoadArg)(int index, int argCount, int depth);
+    /* Desapila una palabra en la variable thread-local 'name' */
+    void (*emitPopThreadLocal)(const char *name);
+    /* Epílogo: restaura las variables 'saved' (apiladas en ese orden en el
+       prólogo) y retorna el principal */
+    void (*emitFunctionEnd)(const char *const *saved, int savedCount);
+    /* Llama a 'name' con los argumentos apilados, los desapila y deja el
+       resultado en el principal */
+    void (*emitCall)(const char *name, int argCount);
+    /* Como emitCall, con la función del hueco 'slot' de la vtable del
+       receptor (el argumento 0) */
+    void (*emitCallVirtual)(int slot, int argCount);
+
+    /* Objetos: campos de una palabra en desplazamientos fijos calculados
+       por el análisis semántico */
+    /* Principal = objeto nuevo a cero de 'size' bytes, con la vtable
+       'vtable' (o NULL) en la primera palabra */
+    void (*emitObjectNew)(long size, const char *vtable);
+    /* Principal = objeto -> principal = campo */
+    void (*emitLoadField)(int offset);
+    /* Secundario = objeto, principal = valor */
+    void (*emitStoreField)(int offset);
+    /* Pila: objeto (apilado con emitPushPrimary), principal = valor.
+       Desapila el objeto y lo deja en el principal, como emitArrayStore */
+    void (*emitInitField)(int offset);
+    /* Datos de la vtable 'label': un símbolo por hueco (NULL si la clase
+       no implementa ese método) */
+    void (*emitVtable)(const char *label, const char *const *methods, int count);
+    /* Registro de una lambda sin capturas, en solo lectura: su única
+       palabra es la vtable 'vtable'; se emite justo después de ella */
+    void (*emitStaticClosure)(const char *label, const char *vtable);
+    /* Principal = dirección del registro estático 'label' */
+    void (*emitLoadStatic)(const char *label);
 } ArchBackend;
 
 extern ArchBackend *g_backend;
 void setCurrentBackend(Architecture arch, FILE *outputFile);
 
+/* Datos y alias de literales en sintaxis GAS (x86-64, ARM y RISC-V):
+   etiquetas locales .LSTR<id> en .rodata, alineadas a 8 bytes */
+void gasStringData(int id, const char *bytes, size_t length);
+void gasStringAlias(int id, int base, size_t offset);
+
+/* Vtable en .rodata con entradas de 'wordSize' bytes (4 u 8) */
+void gasVtable(const char *label, const char *const *methods, int count, int wordSize);
+
+/* Registro de clausura estático en .rodata: una palabra con la vtable */
+void gasStaticClosure(const char *label, const char *vtable, int wordSize);
+
 #endif /* ARCH_H */
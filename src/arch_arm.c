@@ -1,4 +1,6 @@
 #include "arch.h"
+#include "optimize.h"
+#include <stdint.h>
 #include <stdio.h>
 #include <stdlib.h>
 
@@ -28,13 +30,54 @@ static void arm_loadGlobal(const char *name) {
     fprintf(g_backend->out, "    ldr r0, [r1]\n");
 }
 
-/* Comparación mayor: asume L en r1, R en r0.
-   Se emite una secuencia que coloca en r0 el resultado (1 si L > R, 0 en caso contrario).
+/* Guarda r0 en la pila */
+static void arm_pushPrimary(void) {
+    fprintf(g_backend->out, "    push {r0}         ; stack = L\n");
+}
+
+/* Recupera L de la pila en r1 */
+static void arm_popSecondary(void) {
+    fprintf(g_backend->out, "    pop {r1}          ; r1 = L, r0 = R\n");
+}
+
+/* Códigos de condición de ARM para cada operador y su negación */
+static const char *arm_cond(CompareOp op) {
+    switch (op) {
+        case CMP_GT: return "gt";
+        case CMP_LT: return "lt";
+        case CMP_GE: return "ge";
+        case CMP_LE: return "le";
+        case CMP_EQ: return "eq";
+        case CMP_NE: return "ne";
+    }
+    return "eq";
+}
+
+static const char *arm_invCond(CompareOp op) {
+    switch (op) {
+        case CMP_GT: return "le";
+        case CMP_LT: return "ge";
+        case CMP_GE: return "lt";
+        case CMP_LE: return "gt";
+        case CMP_EQ: return "ne";
+        case CMP_NE: return "eq";
+    }
+    return "ne";
+}
+
+/* Comparación: asume L en r1, R en r0.
+   Se emite una secuencia que coloca en r0 el resultado (1 si se cumple, 0 en caso contrario).
 */
-static void arm_cmpGreater(void) {
+static void arm_compare(CompareOp op) {
     fprintf(g_backend->out, "    cmp r1, r0\n");
-    fprintf(g_backend->out, "    movgt r0, #1\n");
-    fprintf(g_backend->out, "    movle r0, #0\n");
+    fprintf(g_backend->out, "    mov%s r0, #1\n", arm_cond(op));
+    fprintf(g_backend->out, "    mov%s r0, #0\n", arm_invCond(op));
+}
+
+/* Comparación fusionada: cmp + b<cond> con la condición invertida */
+static void arm_compareJumpIfFalse(CompareOp op, const char *label) {
+    fprintf(g_backend->out, "    cmp r1, r0\n");
+    fprintf(g_backend->out, "    b%s %s\n", arm_invCond(op), label);
 }
 
 /* Emitir etiqueta */
@@ -47,6 +90,391 @@ static void arm_jump(const char *label) {
     fprintf(g_backend->out, "    b %s\n", label);
 }
 
+/* --- Bucles paralelos --- */
+
+/* Variables thread-local (local-exec): puntero de hilo en TPIDRURO más el
+   desplazamiento de la variable. Usa r2 y r3 como temporales. */
+static void arm_threadLocalAddress(const char *name) {
+    fprintf(g_backend->out, "    mrc p15, 0, r2, c13, c0, 3\n");
+    fprintf(g_backend->out, "    ldr r3, =%s(tpoff)\n", name);
+}
+
+static void arm_loadThreadLocal(const char *name) {
+    arm_threadLocalAddress(name);
+    fprintf(g_backend->out, "    ldr r0, [r2, r3]\n");
+}
+
+static void arm_storeThreadLocal(const char *name) {
+    arm_threadLocalAddress(name);
+    fprintf(g_backend->out, "    str r0, [r2, r3]\n");
+}
+
+/* Argumentos (inicio, fin) en r0 y r1 */
+static void arm_chunkBegin(const char *func, const char *startVar, const char *endVar) {
+    fprintf(g_backend->out, "%s:\n", func);
+    fprintf(g_backend->out, "    push {r4, lr}\n");
+    arm_threadLocalAddress(startVar);
+    fprintf(g_backend->out, "    str r0, [r2, r3]  ; inicio\n");
+    fprintf(g_backend->out, "    ldr r3, =%s(tpoff)\n", endVar);
+    fprintf(g_backend->out, "    str r1, [r2, r3]  ; fin\n");
+}
+
+static void arm_chunkEnd(void) {
+    fprintf(g_backend->out, "    pop {r4, pc}\n");
+}
+
+/* AAPCS: cuatro argumentos en r0-r3 y el quinto (op) en la pila; se
+   reservan 8 bytes para conservar la alineación */
+static void arm_parallelFor(const char *func, int reduceOp) {
+    fprintf(g_backend->out, "    mov r2, r0        ; valor inicial\n");
+    fprintf(g_backend->out, "    pop {r1}          ; fin\n");
+    fprintf(g_backend->out, "    pop {r0}          ; inicio\n");
+    fprintf(g_backend->out, "    ldr r3, =%s\n", func);
+    fprintf(g_backend->out, "    mov r12, #%d\n", reduceOp);
+    fprintf(g_backend->out, "    push {r12, lr}\n");
+    fprintf(g_backend->out, "    bl lyn_parallel_for\n");
+    fprintf(g_backend->out, "    add sp, sp, #8\n");
+}
+
+/* --- Tareas ligeras --- */
+
+/* El argumento llega en r0 y se apila como en una llamada normal; el
+   hueco extra mantiene la pila alineada a 8 */
+static void arm_taskEntry(const char *thunk, const char *func, int argCount) {
+    fprintf(g_backend->out, "%s:\n", thunk);
+    fprintf(g_backend->out, "    push {r4, lr}\n");
+    if (argCount > 0) {
+        fprintf(g_backend->out, "    sub sp, sp, #4\n");
+        fprintf(g_backend->out, "    push {r0}         ; argumento\n");
+    }
+    fprintf(g_backend->out, "    bl %s\n", func);
+    if (argCount > 0)
+        fprintf(g_backend->out, "    add sp, sp, #8\n");
+    fprintf(g_backend->out, "    pop {r4, pc}\n");
+}
+
+/* r0 = args; r4 lo conserva. Con un número impar de argumentos una
+   palabra de relleno mantiene la pila alineada a 8 */
+static void arm_nativeEntry(const char *entry, const char *func, int argCount) {
+    int pad = argCount % 2;
+    fprintf(g_backend->out, "\n.global %s\n%s:\n", entry, entry);
+    fprintf(g_backend->out, "    push {r4, lr}\n");
+    fprintf(g_backend->out, "    mov r4, r0        ; args\n");
+    if (pad)
+        fprintf(g_backend->out, "    sub sp, sp, #4\n");
+    for (int i = 0; i < argCount; i++) {
+        fprintf(g_backend->out, "    ldr r0, [r4, #%d]\n", 4 * i);
+        fprintf(g_backend->out, "    push {r0}         ; argumento %d\n", i);
+    }
+    fprintf(g_backend->out, "    bl %s\n", func);
+    if (argCount + pad > 0)
+        fprintf(g_backend->out, "    add sp, sp, #%d\n", 4 * (argCount + pad));
+    fprintf(g_backend->out, "    pop {r4, pc}\n");
+}
+
+static void arm_spawn(const char *thunk) {
+    fprintf(g_backend->out, "    mov r1, r0        ; argumento\n");
+    fprintf(g_backend->out, "    ldr r0, =%s\n", thunk);
+    fprintf(g_backend->out, "    bl lyn_spawn\n");
+}
+
+static void arm_await(void) {
+    fprintf(g_backend->out, "    bl lyn_await\n");
+}
+
+/* --- Arreglos tipados ---
+   Palabras de 4 bytes. El fallo de rango va a .text.unlikely. */
+
+static int boundsLabelCount = 0;
+
+/* Salta al camino de fallo si 'index' >= longitud de 'array'; usa r3 */
+static void arm_boundsCheck(const char *array, const char *index) {
+    int label = boundsLabelCount++;
+    fprintf(g_backend->out, "    ldr r3, [%s]\n", array);
+    fprintf(g_backend->out, "    cmp %s, r3\n", index);
+    fprintf(g_backend->out, "    bhs .LBOUNDS%d\n", label);
+    fprintf(g_backend->out, "    .pushsection .text.unlikely,\"ax\",%%progbits\n");
+    fprintf(g_backend->out, ".LBOUNDS%d:\n", label);
+    fprintf(g_backend->out, "    mov r0, %s\n", index);
+    fprintf(g_backend->out, "    mov r1, r3\n");
+    fprintf(g_backend->out, "    bl lyn_bounds_fail\n");
+    fprintf(g_backend->out, "    .popsection\n");
+}
+
+static void arm_arrayNew(void) {
+    fprintf(g_backend->out, "    bl lyn_array_new\n");
+}
+
+static void arm_arrayLength(void) {
+    fprintf(g_backend->out, "    ldr r0, [r0]\n");
+}
+
+static void arm_arrayLoad(int checked) {
+    if (checked)
+        arm_boundsCheck("r1", "r0");
+    fprintf(g_backend->out, "    add r2, r1, #4\n");
+    fprintf(g_backend->out, "    ldr r0, [r2, r0, lsl #2]\n");
+}
+
+static void arm_arrayStore(int checked) {
+    fprintf(g_backend->out, "    pop {r2}          ; índice\n");
+    fprintf(g_backend->out, "    pop {r1}          ; arreglo\n");
+    if (checked)
+        arm_boundsCheck("r1", "r2");
+    fprintf(g_backend->out, "    add r3, r1, #4\n");
+    fprintf(g_backend->out, "    str r0, [r3, r2, lsl #2]\n");
+    fprintf(g_backend->out, "    mov r0, r1\n");
+}
+
+static void arm_soaNew(int fields) {
+    fprintf(g_backend->out, "    ldr r1, =%d\n", fields);
+    fprintf(g_backend->out, "    bl lyn_soa_new\n");
+}
+
+/* --- Strings --- */
+
+static void arm_strBuilderNew(void) {
+    fprintf(g_backend->out, "    bl lyn_sb_new\n");
+}
+
+static void arm_strAppend(int isInt) {
+    fprintf(g_backend->out, "    mov r1, r0        ; pieza\n");
+    fprintf(g_backend->out, "    ldr r0, [sp]      ; constructor\n");
+    fprintf(g_backend->out, "    bl %s\n", isInt ? "lyn_sb_append_int" : "lyn_sb_append_str");
+}
+
+static void arm_strBuilderFinish(int print) {
+    fprintf(g_backend->out, "    pop {r0}          ; constructor\n");
+    fprintf(g_backend->out, "    bl %s\n", print ? "lyn_sb_print" : "lyn_sb_finish");
+}
+
+static void arm_intToStr(void) {
+    fprintf(g_backend->out, "    bl lyn_str_from_int\n");
+}
+
+static void arm_strPrint(void) {
+    fprintf(g_backend->out, "    bl lyn_str_print\n");
+}
+
+static void arm_loadString(int id) {
+    fprintf(g_backend->out, "    ldr r0, =.LSTR%d\n", id);
+}
+
+/* --- Funciones y objetos ---
+   El prólogo guarda lr, así que los argumentos quedan una palabra por
+   encima de sp, como en x86. Palabras de 4 bytes. */
+
+static void arm_functionBegin(const char *name, int argCount) {
+    (void)argCount;
+    fprintf(g_backend->out, "\n.global %s\n%s:\n", name, name);
+    fprintf(g_backend->out, "    push {lr}\n");
+}
+
+static void arm_loadArg(int index, int argCount, int depth) {
+    fprintf(g_backend->out, "    ldr r0, [sp, #%d]    ; argumento %d\n",
+            4 * (depth + argCount - index), index);
+}
+
+static void arm_popThreadLocal(const char *name) {
+    fprintf(g_backend->out, "    pop {r1}\n");
+    arm_threadLocalAddress(name);
+    fprintf(g_backend->out, "    str r1, [r2, r3]\n");
+}
+
+static void arm_functionEnd(const char *const *saved, int savedCount) {
+    for (int i = savedCount - 1; i >= 0; i--)
+        arm_popThreadLocal(saved[i]);
+    fprintf(g_backend->out, "    pop {pc}\n");
+}
+
+static void arm_call(const char *name, int argCount) {
+    fprintf(g_backend->out, "    bl %s\n", name);
+    if (argCount > 0)
+        fprintf(g_backend->out, "    add sp, sp, #%d\n", 4 * argCount);
+}
+
+static void arm_callVirtual(int slot, int argCount) {
+    fprintf(g_backend->out, "    ldr r12, [sp, #%d]    ; receptor\n", 4 * (argCount - 1));
+    fprintf(g_backend->out, "    ldr r12, [r12]        ; vtable\n");
+    fprintf(g_backend->out, "    ldr r12, [r12, #%d]\n", 4 * slot);
+    fprintf(g_backend->out, "    blx r12\n");
+    fprintf(g_backend->out, "    add sp, sp, #%d\n", 4 * argCount);
+}
+
+static void arm_objectNew(long size, const char *vtable) {
+    fprintf(g_backend->out, "    ldr r0, =%ld\n", size);
+    if (vtable)
+        fprintf(g_backend->out, "    ldr r1, =%s\n", vtable);
+    else
+        fprintf(g_backend->out, "    mov r1, #0\n");
+    fprintf(g_backend->out, "    bl lyn_object_new\n");
+}
+
+/* ldr/str admiten desplazamientos de hasta 4095 */
+static void arm_loadField(int offset) {
+    if (offset < 4096) {
+        fprintf(g_backend->out, "    ldr r0, [r0, #%d]\n", offset);
+    } else {
+        fprintf(g_backend->out, "    ldr r2, =%d\n", offset);
+        fprintf(g_backend->out, "    ldr r0, [r0, r2]\n");
+    }
+}
+
+static void arm_storeField(int offset) {
+    if (offset < 4096) {
+        fprintf(g_backend->out, "    str r0, [r1, #%d]\n", offset);
+    } else {
+        fprintf(g_backend->out, "    ldr r2, =%d\n", offset);
+        fprintf(g_backend->out, "    str r0, [r1, r2]\n");
+    }
+}
+
+static void arm_initField(int offset) {
+    arm_popSecondary();
+    arm_storeField(offset);
+    fprintf(g_backend->out, "    mov r0, r1\n");
+}
+
+static void arm_vtable(const char *label, const char *const *methods, int count) {
+    gasVtable(label, methods, count, 4);
+}
+
+static void arm_staticClosure(const char *label, const char *vtable) {
+    gasStaticClosure(label, vtable, 4);
+}
+
+static void arm_loadStatic(const char *label) {
+    fprintf(g_backend->out, "    ldr r0, =%s\n", label);
+}
+
+/* --- Tipos vectoriales (NEON) ---
+   Principal = q0 (q0:q1 con 8 carriles), secundario = q2 (q2:q3). Los
+   carriles son s0-s7 y s8-s15. NEON no divide en float: la división se
+   hace carril a carril con VFP. */
+
+static int vecLabelCount = 0;
+
+/* Lista de registros d del principal o del secundario */
+static const char *arm_vecRegs(VecType type, int secondary) {
+    if (vecLanes(type) == 8)
+        return secondary ? "{d4-d7}" : "{d0-d3}";
+    return secondary ? "{d4-d5}" : "{d0-d1}";
+}
+
+static void arm_vecLoadAddress(const char *label, VecType type) {
+    fprintf(g_backend->out, "    ldr r2, =%s\n", label);
+    fprintf(g_backend->out, "    vld1.32 %s, [r2]\n", arm_vecRegs(type, 0));
+}
+
+static void arm_vecLoad(const char *name, VecType type) {
+    arm_vecLoadAddress(name, type);
+}
+
+static void arm_vecStore(const char *name, VecType type) {
+    fprintf(g_backend->out, "    ldr r2, =%s\n", name);
+    fprintf(g_backend->out, "    vst1.32 %s, [r2]\n", arm_vecRegs(type, 0));
+}
+
+static void arm_vecConst(VecType type, const double *lanes) {
+    char label[32];
+    snprintf(label, sizeof(label), ".LVEC%d", vecLabelCount++);
+    fprintf(g_backend->out, "    .pushsection .rodata\n");
+    fprintf(g_backend->out, "    .balign 16\n");
+    fprintf(g_backend->out, "%s:\n", label);
+    for (int i = 0; i < vecLanes(type); i++) {
+        if (vecIsFloat(type))
+            fprintf(g_backend->out, "    .float %.9g\n", lanes[i]);
+        else
+            fprintf(g_backend->out, "    .long %d\n", (int)(long long)lanes[i]);
+    }
+    fprintf(g_backend->out, "    .popsection\n");
+    arm_vecLoadAddress(label, type);
+}
+
+static void arm_vecSplat(VecType type) {
+    if (vecIsFloat(type)) {
+        fprintf(g_backend->out, "    vmov s0, r0\n");
+        fprintf(g_backend->out, "    vcvt.f32.s32 s0, s0\n");
+        fprintf(g_backend->out, "    vdup.32 q0, d0[0]\n");
+    } else {
+        fprintf(g_backend->out, "    vdup.32 q0, r0\n");
+    }
+    if (vecLanes(type) == 8)
+        fprintf(g_backend->out, "    vmov q1, q0\n");
+}
+
+/* Carriles apilados con push {r0}: el carril i está en sp + 4*(n-1-i) */
+static void arm_vecFromStack(VecType type) {
+    int lanes = vecLanes(type);
+    for (int i = 0; i < lanes; i++) {
+        fprintf(g_backend->out, "    ldr r2, [sp, #%d]\n", 4 * (lanes - 1 - i));
+        fprintf(g_backend->out, "    vmov s%d, r2\n", i);
+        if (vecIsFloat(type))
+            fprintf(g_backend->out, "    vcvt.f32.s32 s%d, s%d\n", i, i);
+    }
+    fprintf(g_backend->out, "    add sp, sp, #%d\n", 4 * lanes);
+}
+
+static void arm_vecPush(VecType type) {
+    fprintf(g_backend->out, "    vpush %s\n", arm_vecRegs(type, 0));
+}
+
+static void arm_vecPopSecondary(VecType type) {
+    fprintf(g_backend->out, "    vpop %s\n", arm_vecRegs(type, 1));
+}
+
+static void arm_vecBinary(char op, VecType type) {
+    int lanes = vecLanes(type);
+    if (op == '/') {
+        for (int i = 0; i < lanes; i++)
+            fprintf(g_backend->out, "    vdiv.f32 s%d, s%d, s%d\n", i, 8 + i, i);
+        return;
+    }
+    const char *name = op == '+' ? "vadd" : op == '-' ? "vsub" : "vmul";
+    const char *suffix = vecIsFloat(type) ? "f32" : "i32";
+    fprintf(g_backend->out, "    %s.%s q0, q2, q0\n", name, suffix);
+    if (lanes == 8)
+        fprintf(g_backend->out, "    %s.%s q1, q3, q1\n", name, suffix);
+}
+
+/* Copia al secundario y elige carril a carril */
+static void arm_vecShuffle(VecType type, const int *lanes) {
+    fprintf(g_backend->out, "    vmov q2, q0\n");
+    if (vecLanes(type) == 8)
+        fprintf(g_backend->out, "    vmov q3, q1\n");
+    for (int i = 0; i < vecLanes(type); i++)
+        fprintf(g_backend->out, "    vmov.f32 s%d, s%d\n", i, 8 + lanes[i]);
+}
+
+static void arm_vecReduce(int reduceOp, VecType type) {
+    int lanes = vecLanes(type);
+    if (vecIsFloat(type)) {
+        fprintf(g_backend->out, "    vmov.f32 s8, s0\n");
+        for (int i = 1; i < lanes; i++) {
+            if (reduceOp == REDUCE_ADD) {
+                fprintf(g_backend->out, "    vadd.f32 s8, s8, s%d\n", i);
+            } else {
+                fprintf(g_backend->out, "    vcmp.f32 s8, s%d\n", i);
+                fprintf(g_backend->out, "    vmrs APSR_nzcv, fpscr\n");
+                fprintf(g_backend->out, "    vmov%s.f32 s8, s%d\n", reduceOp == REDUCE_MIN ? "gt" : "lt", i);
+            }
+        }
+        fprintf(g_backend->out, "    vcvt.s32.f32 s8, s8\n");
+        fprintf(g_backend->out, "    vmov r0, s8\n");
+        return;
+    }
+    fprintf(g_backend->out, "    vmov r0, s0\n");
+    for (int i = 1; i < lanes; i++) {
+        fprintf(g_backend->out, "    vmov r1, s%d\n", i);
+        if (reduceOp == REDUCE_ADD) {
+            fprintf(g_backend->out, "    add r0, r0, r1\n");
+        } else {
+            fprintf(g_backend->out, "    cmp r0, r1\n");
+            fprintf(g_backend->out, "    mov%s r0, r1\n", reduceOp == REDUCE_MIN ? "gt" : "lt");
+        }
+    }
+}
+
 /* Salto si r0 es 0 a 'label' */
 static void arm_jumpIfZero(const char *label) {
     fprintf(g_backend->out, "    cmp r0, #0\n");
@@ -76,20 +504,168 @@ static void arm_emitIDiv(void) {
     fprintf(g_backend->out, "    sdiv r0, r1, r0   ; r0 = L / R\n");
 }
 
+/* Módulo entero: r0 = L - (L / R) * R (ARM no tiene instrucción de resto) */
+static void arm_emitIMod(void) {
+    fprintf(g_backend->out, "    sdiv r2, r1, r0\n");
+    fprintf(g_backend->out, "    mls r0, r2, r0, r1    ; r0 = L %% R\n");
+}
+
+/* --- Reducción de fuerza (operando en r0, constante conocida) ---
+   Los enteros son de 32 bits; r1, r2 y r3 se usan como temporales. */
+
+/* Multiplicación por constante: desplazamientos con el barrel shifter.
+   El producto es módulo 2^32, así que solo cuentan los 32 bits bajos de la
+   constante (un múltiplo de 2^32 da 0) y los desplazamientos quedan en 0..31 */
+static void arm_emitMulConst(long value) {
+    value = (int32_t)(uint32_t)value;
+    long mag = (value < 0) ? -value : value;
+    int k;
+    if (value == 0) {
+        fprintf(g_backend->out, "    mov r0, #0\n");
+        return;
+    }
+    if (mag == 1) {
+        /* Nada que hacer salvo el signo */
+    } else if ((k = exactLog2(mag)) >= 0) {
+        fprintf(g_backend->out, "    lsl r0, r0, #%d    ; r0 = L * %ld\n", k, mag);
+    } else if ((k = exactLog2(mag - 1)) >= 0) {
+        fprintf(g_backend->out, "    add r0, r0, r0, lsl #%d    ; r0 = L * %ld\n", k, mag);
+    } else if ((k = exactLog2(mag + 1)) >= 0) {
+        fprintf(g_backend->out, "    rsb r0, r0, r0, lsl #%d    ; r0 = L * %ld\n", k, mag);
+    } else {
+        fprintf(g_backend->out, "    ldr r1, =%ld\n", value);
+        fprintf(g_backend->out, "    mul r0, r1, r0    ; r0 = L * %ld\n", value);
+        return;
+    }
+    if (value < 0)
+        fprintf(g_backend->out, "    rsb r0, r0, #0\n");
+}
+
+/* Cociente por número mágico: deja q en r3 y conserva el dividendo en r0 */
+static void arm_emitDivMagic(long value, const DivMagic *magic) {
+    fprintf(g_backend->out, "    ldr r1, =%ld\n", magic->multiplier);
+    fprintf(g_backend->out, "    smull r2, r3, r1, r0    ; r3 = (L * M) >> 32\n");
+    if (magic->addDividend)
+        fprintf(g_backend->out, "    add r3, r3, r0\n");
+    if (magic->subDividend)
+        fprintf(g_backend->out, "    sub r3, r3, r0\n");
+    if (magic->shift > 0)
+        fprintf(g_backend->out, "    asr r3, r3, #%d\n", magic->shift);
+    fprintf(g_backend->out, "    add r3, r3, r3, lsr #31    ; r3 = L / %ld\n", value);
+}
+
+/* División por constante */
+static void arm_emitDivConst(long value) {
+    DivMagic magic;
+    int k = exactLog2(value);
+    if (value == 1)
+        return;
+    if (value == -1) {
+        fprintf(g_backend->out, "    rsb r0, r0, #0\n");
+    } else if (k > 0 && k < 31) {
+        fprintf(g_backend->out, "    asr r1, r0, #31\n");
+        fprintf(g_backend->out, "    add r0, r0, r1, lsr #%d\n", 32 - k);
+        fprintf(g_backend->out, "    asr r0, r0, #%d    ; r0 = L / %ld\n", k, 1L << k);
+        if (value < 0)
+            fprintf(g_backend->out, "    rsb r0, r0, #0\n");
+    } else if (computeDivMagic(value, 32, &magic)) {
+        arm_emitDivMagic(value, &magic);
+        fprintf(g_backend->out, "    mov r0, r3\n");
+    } else {
+        fprintf(g_backend->out, "    mov r1, r0\n");
+        arm_loadImmInt(value);
+        arm_emitIDiv();
+    }
+}
+
+/* Módulo por constante */
+static void arm_emitModConst(long value) {
+    DivMagic magic;
+    int k = exactLog2(value);
+    if (value == 1 || value == -1) {
+        fprintf(g_backend->out, "    mov r0, #0\n");
+    } else if (k > 0 && k < 31) {
+        fprintf(g_backend->out, "    asr r1, r0, #31\n");
+        fprintf(g_backend->out, "    add r1, r0, r1, lsr #%d\n", 32 - k);
+        fprintf(g_backend->out, "    asr r1, r1, #%d\n", k);
+        fprintf(g_backend->out, "    sub r0, r0, r1, lsl #%d    ; r0 = L %% %ld\n", k, value);
+    } else if (computeDivMagic(value, 32, &magic)) {
+        arm_emitDivMagic(value, &magic);
+        fprintf(g_backend->out, "    ldr r1, =%ld\n", value);
+        fprintf(g_backend->out, "    mls r0, r3, r1, r0    ; r0 = L %% %ld\n", value);
+    } else {
+        fprintf(g_backend->out, "    mov r1, r0\n");
+        arm_loadImmInt(value);
+        arm_emitIMod();
+    }
+}
+
 /* Instancia de la vtable para ARM */
 static ArchBackend g_armBackend = {
     .out = NULL,
     .emitLoadImmInt = arm_loadImmInt,
     .emitStoreGlobal = arm_storeGlobal,
     .emitLoadGlobal = arm_loadGlobal,
-    .emitCmpGreater = arm_cmpGreater,
+    .emitPushPrimary = arm_pushPrimary,
+    .emitPopSecondary = arm_popSecondary,
+    .emitCompare = arm_compare,
     .emitSetLabel = arm_setLabel,
     .emitJump = arm_jump,
     .emitJumpIfZero = arm_jumpIfZero,
+    .emitCompareJumpIfFalse = arm_compareJumpIfFalse,
     .emitAdd = arm_emitAdd,
     .emitSub = arm_emitSub,
     .emitImul = arm_emitImul,
-    .emitIDiv = arm_emitIDiv
+    .emitIDiv = arm_emitIDiv,
+    .emitIMod = arm_emitIMod,
+    .emitMulConst = arm_emitMulConst,
+    .emitDivConst = arm_emitDivConst,
+    .emitModConst = arm_emitModConst,
+    .emitLoadThreadLocal = arm_loadThreadLocal,
+    .emitStoreThreadLocal = arm_storeThreadLocal,
+    .emitChunkBegin = arm_chunkBegin,
+    .emitChunkEnd = arm_chunkEnd,
+    .emitParallelFor = arm_parallelFor,
+    .emitTaskEntry = arm_taskEntry,
+    .emitNativeEntry = arm_nativeEntry,
+    .emitSpawn = arm_spawn,
+    .emitAwait = arm_await,
+    .emitVecLoad = arm_vecLoad,
+    .emitVecStore = arm_vecStore,
+    .emitVecConst = arm_vecConst,
+    .emitVecSplat = arm_vecSplat,
+    .emitVecFromStack = arm_vecFromStack,
+    .emitVecPush = arm_vecPush,
+    .emitVecPopSecondary = arm_vecPopSecondary,
+    .emitVecBinary = arm_vecBinary,
+    .emitVecShuffle = arm_vecShuffle,
+    .emitVecReduce = arm_vecReduce,
+    .emitArrayNew = arm_arrayNew,
+    .emitArrayLength = arm_arrayLength,
+    .emitArrayLoad = arm_arrayLoad,
+    .emitArrayStore = arm_arrayStore,
+    .emitSoaNew = arm_soaNew,
+    .emitStrBuilderNew = arm_strBuilderNew,
+    .emitStrAppend = arm_strAppend,
+    .emitStrBuilderFinish = arm_strBuilderFinish,
+    .emitIntToStr = arm_intToStr,
+    .emitStrPrint = arm_strPrint,
+    .emitLoadString = arm_loadString,
+    .emitStringData = gasStringData,
+    .emitStringAlias = gasStringAlias,
+    .emitFunctionBegin = arm_functionBegin,
+    .emitLoadArg = arm_loadArg,
+    .emitPopThreadLocal = arm_popThreadLocal,
+    .emitFunctionEnd = arm_functionEnd,
+    .emitCall = arm_call,
+    .emitCallVirtual = arm_callVirtual,
+    .emitObjectNew = arm_objectNew,
+    .emitLoadField = arm_loadField,
+    .emitStoreField = arm_storeField,
+    .emitInitField = arm_initField,
+    .emitVtable = arm_vtable,
+    .emitStaticClosure = arm_staticClosure,
+    .emitLoadStatic = arm_loadStatic
 };
 
 /* Función para crear el backend ARM.
@@ -1,12 +1,15 @@
 #include "arch.h"
+#include "optimize.h"
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 
 /* 
    Backend para RISC-V.
    Convenciones (simplificadas):
    - "Registro principal" es a0.
-   - Se usarán t0 y t1 como registros temporales para operaciones binop.
+   - En operaciones binarias el operando izquierdo (L) queda en t0 y el derecho (R) en a0.
+   - t1 se usa como registro temporal adicional.
 */
 
 /* Cargar inmediato en a0 */
@@ -29,11 +32,60 @@ static void riscv_loadGlobal(const char *name) {
     fprintf(g_backend->out, "    lw a0, 0(t0)\n");
 }
 
-/* Comparación mayor: Se asume que la operando izquierda (L) está en t1 y la derecha (R) en a0.
-   Se utiliza la instrucción sgt para obtener 1 si (t1 > a0), 0 en caso contrario.
+/* Guarda a0 en la pila */
+static void riscv_pushPrimary(void) {
+    fprintf(g_backend->out, "    addi sp, sp, -8\n");
+    fprintf(g_backend->out, "    sd a0, 0(sp)      ; stack = L\n");
+}
+
+/* Recupera L de la pila en t0 */
+static void riscv_popSecondary(void) {
+    fprintf(g_backend->out, "    ld t0, 0(sp)      ; t0 = L, a0 = R\n");
+    fprintf(g_backend->out, "    addi sp, sp, 8\n");
+}
+
+/* Comparación: se asume L en t0 y R en a0; deja 0/1 en a0.
+   RISC-V solo tiene slt, por lo que el resto se deriva intercambiando
+   operandos o invirtiendo el resultado con xori.
 */
-static void riscv_cmpGreater(void) {
-    fprintf(g_backend->out, "    sgt a0, t1, a0    ; a0 = (t1 > a0)? 1 : 0\n");
+static void riscv_compare(CompareOp op) {
+    switch (op) {
+        case CMP_GT:
+            fprintf(g_backend->out, "    slt a0, a0, t0    ; a0 = (L > R)\n");
+            break;
+        case CMP_LT:
+            fprintf(g_backend->out, "    slt a0, t0, a0    ; a0 = (L < R)\n");
+            break;
+        case CMP_GE:
+            fprintf(g_backend->out, "    slt a0, t0, a0\n");
+            fprintf(g_backend->out, "    xori a0, a0, 1    ; a0 = (L >= R)\n");
+            break;
+        case CMP_LE:
+            fprintf(g_backend->out, "    slt a0, a0, t0\n");
+            fprintf(g_backend->out, "    xori a0, a0, 1    ; a0 = (L <= R)\n");
+            break;
+        case CMP_EQ:
+            fprintf(g_backend->out, "    sub a0, t0, a0\n");
+            fprintf(g_backend->out, "    seqz a0, a0       ; a0 = (L == R)\n");
+            break;
+        case CMP_NE:
+            fprintf(g_backend->out, "    sub a0, t0, a0\n");
+            fprintf(g_backend->out, "    snez a0, a0       ; a0 = (L != R)\n");
+            break;
+    }
+}
+
+/* Comparación fusionada: RISC-V compara y salta en una sola instrucción.
+   Se emite el salto con la condición invertida. */
+static void riscv_compareJumpIfFalse(CompareOp op, const char *label) {
+    switch (op) {
+        case CMP_GT: fprintf(g_backend->out, "    bge a0, t0, %s\n", label); break;
+        case CMP_LT: fprintf(g_backend->out, "    bge t0, a0, %s\n", label); break;
+        case CMP_GE: fprintf(g_backend->out, "    blt t0, a0, %s\n", label); break;
+        case CMP_LE: fprintf(g_backend->out, "    blt a0, t0, %s\n", label); break;
+        case CMP_EQ: fprintf(g_backend->out, "    bne t0, a0, %s\n", label); break;
+        case CMP_NE: fprintf(g_backend->out, "    beq t0, a0, %s\n", label); break;
+    }
 }
 
 /* Emitir una etiqueta */
@@ -46,6 +98,429 @@ static void riscv_jump(const char *label) {
     fprintf(g_backend->out, "    j %s\n", label);
 }
 
+/* --- Bucles paralelos --- */
+
+/* Dirección de una variable thread-local (local-exec) en t1 */
+static void riscv_threadLocalAddress(const char *name) {
+    fprintf(g_backend->out, "    lui t1, %%tprel_hi(%s)\n", name);
+    fprintf(g_backend->out, "    add t1, t1, tp, %%tprel_add(%s)\n", name);
+}
+
+static void riscv_loadThreadLocal(const char *name) {
+    riscv_threadLocalAddress(name);
+    fprintf(g_backend->out, "    ld a0, %%tprel_lo(%s)(t1)\n", name);
+}
+
+static void riscv_storeThreadLocal(const char *name) {
+    riscv_threadLocalAddress(name);
+    fprintf(g_backend->out, "    sd a0, %%tprel_lo(%s)(t1)\n", name);
+}
+
+/* Argumentos (inicio, fin) en a0 y a1; ra se guarda porque el cuerpo
+   puede llamar a otras funciones */
+static void riscv_chunkBegin(const char *func, const char *startVar, const char *endVar) {
+    fprintf(g_backend->out, "%s:\n", func);
+    fprintf(g_backend->out, "    addi sp, sp, -16\n");
+    fprintf(g_backend->out, "    sd ra, 8(sp)\n");
+    riscv_storeThreadLocal(startVar);
+    riscv_threadLocalAddress(endVar);
+    fprintf(g_backend->out, "    sd a1, %%tprel_lo(%s)(t1)\n", endVar);
+}
+
+static void riscv_chunkEnd(void) {
+    fprintf(g_backend->out, "    ld ra, 8(sp)\n");
+    fprintf(g_backend->out, "    addi sp, sp, 16\n");
+    fprintf(g_backend->out, "    ret\n");
+}
+
+static void riscv_parallelFor(const char *func, int reduceOp) {
+    fprintf(g_backend->out, "    mv a2, a0         ; valor inicial\n");
+    fprintf(g_backend->out, "    ld a1, 0(sp)      ; fin\n");
+    fprintf(g_backend->out, "    ld a0, 8(sp)      ; inicio\n");
+    fprintf(g_backend->out, "    addi sp, sp, 16\n");
+    fprintf(g_backend->out, "    la a3, %s\n", func);
+    fprintf(g_backend->out, "    li a4, %d\n", reduceOp);
+    fprintf(g_backend->out, "    call lyn_parallel_for\n");
+}
+
+/* --- Tareas ligeras --- */
+
+/* El argumento llega en a0 y queda en la cima de la pila, como en una
+   llamada normal */
+static void riscv_taskEntry(const char *thunk, const char *func, int argCount) {
+    fprintf(g_backend->out, "%s:\n", thunk);
+    fprintf(g_backend->out, "    addi sp, sp, -16\n");
+    fprintf(g_backend->out, "    sd ra, 8(sp)\n");
+    if (argCount > 0)
+        fprintf(g_backend->out, "    sd a0, 0(sp)      ; argumento\n");
+    fprintf(g_backend->out, "    call %s\n", func);
+    fprintf(g_backend->out, "    ld ra, 8(sp)\n");
+    fprintf(g_backend->out, "    addi sp, sp, 16\n");
+    fprintf(g_backend->out, "    ret\n");
+}
+
+/* a0 = args; s1 lo conserva. Los argumentos se copian a un bloque
+   múltiplo de 16 bytes con el 0 en la posición más alta, como si se
+   hubieran apilado en orden */
+static void riscv_nativeEntry(const char *entry, const char *func, int argCount) {
+    int frame = (8 * argCount + 15) / 16 * 16;
+    fprintf(g_backend->out, "\n.global %s\n%s:\n", entry, entry);
+    fprintf(g_backend->out, "    addi sp, sp, -16\n");
+    fprintf(g_backend->out, "    sd ra, 8(sp)\n");
+    fprintf(g_backend->out, "    sd s1, 0(sp)\n");
+    fprintf(g_backend->out, "    mv s1, a0         ; args\n");
+    if (frame > 0)
+        fprintf(g_backend->out, "    addi sp, sp, -%d\n", frame);
+    for (int i = 0; i < argCount; i++) {
+        fprintf(g_backend->out, "    ld t0, %d(s1)\n", 8 * i);
+        fprintf(g_backend->out, "    sd t0, %d(sp)      ; argumento %d\n", 8 * (argCount - 1 - i), i);
+    }
+    fprintf(g_backend->out, "    call %s\n", func);
+    if (frame > 0)
+        fprintf(g_backend->out, "    addi sp, sp, %d\n", frame);
+    fprintf(g_backend->out, "    ld s1, 0(sp)\n");
+    fprintf(g_backend->out, "    ld ra, 8(sp)\n");
+    fprintf(g_backend->out, "    addi sp, sp, 16\n");
+    fprintf(g_backend->out, "    ret\n");
+}
+
+static void riscv_spawn(const char *thunk) {
+    fprintf(g_backend->out, "    mv a1, a0         ; argumento\n");
+    fprintf(g_backend->out, "    la a0, %s\n", thunk);
+    fprintf(g_backend->out, "    call lyn_spawn\n");
+}
+
+static void riscv_await(void) {
+    fprintf(g_backend->out, "    call lyn_await\n");
+}
+
+/* --- Arreglos tipados ---
+   Palabras de 8 bytes. Un bgeu no alcanza otra sección, así que el salto
+   que se toma es el de la comprobación superada (bltu) y la llamada de
+   fallo queda en línea justo detrás. */
+
+/* Llama a lyn_bounds_fail si 'index' >= longitud de 'array'; usa t1 */
+static void riscv_boundsCheck(const char *array, const char *index) {
+    fprintf(g_backend->out, "    ld t1, 0(%s)\n", array);
+    fprintf(g_backend->out, "    bltu %s, t1, 1f\n", index);
+    if (strcmp(index, "a0") != 0)
+        fprintf(g_backend->out, "    mv a0, %s\n", index);
+    fprintf(g_backend->out, "    mv a1, t1\n");
+    fprintf(g_backend->out, "    call lyn_bounds_fail\n");
+    fprintf(g_backend->out, "1:\n");
+}
+
+static void riscv_arrayNew(void) {
+    fprintf(g_backend->out, "    call lyn_array_new\n");
+}
+
+static void riscv_arrayLength(void) {
+    fprintf(g_backend->out, "    ld a0, 0(a0)\n");
+}
+
+static void riscv_arrayLoad(int checked) {
+    if (checked)
+        riscv_boundsCheck("t0", "a0");
+    fprintf(g_backend->out, "    slli t1, a0, 3\n");
+    fprintf(g_backend->out, "    add t1, t1, t0\n");
+    fprintf(g_backend->out, "    ld a0, 8(t1)\n");
+}
+
+static void riscv_arrayStore(int checked) {
+    fprintf(g_backend->out, "    ld t2, 0(sp)\n");
+    fprintf(g_backend->out, "    ld t0, 8(sp)\n");
+    fprintf(g_backend->out, "    addi sp, sp, 16\n");
+    if (checked)
+        riscv_boundsCheck("t0", "t2");
+    fprintf(g_backend->out, "    slli t1, t2, 3\n");
+    fprintf(g_backend->out, "    add t1, t1, t0\n");
+    fprintf(g_backend->out, "    sd a0, 8(t1)\n");
+    fprintf(g_backend->out, "    mv a0, t0\n");
+}
+
+static void riscv_soaNew(int fields) {
+    fprintf(g_backend->out, "    li a1, %d\n", fields);
+    fprintf(g_backend->out, "    call lyn_soa_new\n");
+}
+
+/* --- Strings --- */
+
+static void riscv_strBuilderNew(void) {
+    fprintf(g_backend->out, "    call lyn_sb_new\n");
+}
+
+static void riscv_strAppend(int isInt) {
+    fprintf(g_backend->out, "    mv a1, a0         ; pieza\n");
+    fprintf(g_backend->out, "    ld a0, 0(sp)      ; constructor\n");
+    fprintf(g_backend->out, "    call %s\n", isInt ? "lyn_sb_append_int" : "lyn_sb_append_str");
+}
+
+static void riscv_strBuilderFinish(int print) {
+    fprintf(g_backend->out, "    ld a0, 0(sp)      ; constructor\n");
+    fprintf(g_backend->out, "    addi sp, sp, 8\n");
+    fprintf(g_backend->out, "    call %s\n", print ? "lyn_sb_print" : "lyn_sb_finish");
+}
+
+static void riscv_intToStr(void) {
+    fprintf(g_backend->out, "    call lyn_str_from_int\n");
+}
+
+static void riscv_strPrint(void) {
+    fprintf(g_backend->out, "    call lyn_str_print\n");
+}
+
+static void riscv_loadString(int id) {
+    fprintf(g_backend->out, "    la a0, .LSTR%d\n", id);
+}
+
+/* --- Funciones y objetos ---
+   El prólogo guarda ra en una palabra de la pila, así que los argumentos
+   quedan una palabra por encima de sp, como en x86. */
+
+static void riscv_functionBegin(const char *name, int argCount) {
+    (void)argCount;
+    fprintf(g_backend->out, "\n.global %s\n%s:\n", name, name);
+    fprintf(g_backend->out, "    addi sp, sp, -8\n");
+    fprintf(g_backend->out, "    sd ra, 0(sp)\n");
+}
+
+static void riscv_loadArg(int index, int argCount, int depth) {
+    fprintf(g_backend->out, "    ld a0, %d(sp)      ; argumento %d\n",
+            8 * (depth + argCount - index), index);
+}
+
+static void riscv_popThreadLocal(const char *name) {
+    fprintf(g_backend->out, "    ld t0, 0(sp)\n");
+    fprintf(g_backend->out, "    addi sp, sp, 8\n");
+    riscv_threadLocalAddress(name);
+    fprintf(g_backend->out, "    sd t0, %%tprel_lo(%s)(t1)\n", name);
+}
+
+static void riscv_functionEnd(const char *const *saved, int savedCount) {
+    for (int i = savedCount - 1; i >= 0; i--)
+        riscv_popThreadLocal(saved[i]);
+    fprintf(g_backend->out, "    ld ra, 0(sp)\n");
+    fprintf(g_backend->out, "    addi sp, sp, 8\n");
+    fprintf(g_backend->out, "    ret\n");
+}
+
+static void riscv_call(const char *name, int argCount) {
+    fprintf(g_backend->out, "    call %s\n", name);
+    if (argCount > 0)
+        fprintf(g_backend->out, "    addi sp, sp, %d\n", 8 * argCount);
+}
+
+static void riscv_callVirtual(int slot, int argCount) {
+    fprintf(g_backend->out, "    ld t0, %d(sp)      ; receptor\n", 8 * (argCount - 1));
+    fprintf(g_backend->out, "    ld t0, 0(t0)       ; vtable\n");
+    fprintf(g_backend->out, "    ld t0, %d(t0)\n", 8 * slot);
+    fprintf(g_backend->out, "    jalr t0\n");
+    fprintf(g_backend->out, "    addi sp, sp, %d\n", 8 * argCount);
+}
+
+static void riscv_objectNew(long size, const char *vtable) {
+    fprintf(g_backend->out, "    li a0, %ld\n", size);
+    if (vtable)
+        fprintf(g_backend->out, "    la a1, %s\n", vtable);
+    else
+        fprintf(g_backend->out, "    li a1, 0\n");
+    fprintf(g_backend->out, "    call lyn_object_new\n");
+}
+
+/* ld/sd admiten desplazamientos de 12 bits con signo */
+static void riscv_loadField(int offset) {
+    if (offset < 2048) {
+        fprintf(g_backend->out, "    ld a0, %d(a0)\n", offset);
+    } else {
+        fprintf(g_backend->out, "    li t1, %d\n", offset);
+        fprintf(g_backend->out, "    add a0, a0, t1\n");
+        fprintf(g_backend->out, "    ld a0, 0(a0)\n");
+    }
+}
+
+static void riscv_storeField(int offset) {
+    if (offset < 2048) {
+        fprintf(g_backend->out, "    sd a0, %d(t0)\n", offset);
+    } else {
+        fprintf(g_backend->out, "    li t1, %d\n", offset);
+        fprintf(g_backend->out, "    add t1, t0, t1\n");
+        fprintf(g_backend->out, "    sd a0, 0(t1)\n");
+    }
+}
+
+static void riscv_initField(int offset) {
+    riscv_popSecondary();
+    riscv_storeField(offset);
+    fprintf(g_backend->out, "    mv a0, t0\n");
+}
+
+static void riscv_vtable(const char *label, const char *const *methods, int count) {
+    gasVtable(label, methods, count, 8);
+}
+
+static void riscv_staticClosure(const char *label, const char *vtable) {
+    gasStaticClosure(label, vtable, 8);
+}
+
+static void riscv_loadStatic(const char *label) {
+    fprintf(g_backend->out, "    la a0, %s\n", label);
+}
+
+/* --- Tipos vectoriales (sin extensión V) ---
+   Se usa el camino escalar: el vector principal vive en la cima de la pila
+   (4 bytes por carril) y las operaciones recorren los carriles. Apilar el
+   principal o recuperar el secundario no mueve nada; una operación binaria
+   combina L (debajo) con R (en la cima) y libera R. */
+
+static int vecLabelCount = 0;
+
+static int riscv_vecSize(VecType type) {
+    return 4 * vecLanes(type);
+}
+
+/* Copia un vector de memoria (dirección en t1) a un hueco nuevo en la pila */
+static void riscv_vecCopyIn(VecType type) {
+    fprintf(g_backend->out, "    addi sp, sp, -%d\n", riscv_vecSize(type));
+    for (int i = 0; i < vecLanes(type); i++) {
+        fprintf(g_backend->out, "    lw t2, %d(t1)\n", 4 * i);
+        fprintf(g_backend->out, "    sw t2, %d(sp)\n", 4 * i);
+    }
+}
+
+static void riscv_vecLoad(const char *name, VecType type) {
+    fprintf(g_backend->out, "    la t1, %s\n", name);
+    riscv_vecCopyIn(type);
+}
+
+static void riscv_vecStore(const char *name, VecType type) {
+    fprintf(g_backend->out, "    la t1, %s\n", name);
+    for (int i = 0; i < vecLanes(type); i++) {
+        fprintf(g_backend->out, "    lw t2, %d(sp)\n", 4 * i);
+        fprintf(g_backend->out, "    sw t2, %d(t1)\n", 4 * i);
+    }
+    fprintf(g_backend->out, "    addi sp, sp, %d\n", riscv_vecSize(type));
+}
+
+static void riscv_vecConst(VecType type, const double *lanes) {
+    int label = vecLabelCount++;
+    fprintf(g_backend->out, "    .pushsection .rodata\n");
+    fprintf(g_backend->out, "    .balign 16\n");
+    fprintf(g_backend->out, ".LVEC%d:\n", label);
+    for (int i = 0; i < vecLanes(type); i++) {
+        if (vecIsFloat(type))
+            fprintf(g_backend->out, "    .float %.9g\n", lanes[i]);
+        else
+            fprintf(g_backend->out, "    .word %d\n", (int)(long long)lanes[i]);
+    }
+    fprintf(g_backend->out, "    .popsection\n");
+    fprintf(g_backend->out, "    la t1, .LVEC%d\n", label);
+    riscv_vecCopyIn(type);
+}
+
+static void riscv_vecSplat(VecType type) {
+    fprintf(g_backend->out, "    addi sp, sp, -%d\n", riscv_vecSize(type));
+    if (vecIsFloat(type))
+        fprintf(g_backend->out, "    fcvt.s.l ft0, a0\n");
+    for (int i = 0; i < vecLanes(type); i++) {
+        if (vecIsFloat(type))
+            fprintf(g_backend->out, "    fsw ft0, %d(sp)\n", 4 * i);
+        else
+            fprintf(g_backend->out, "    sw a0, %d(sp)\n", 4 * i);
+    }
+}
+
+/* Los carriles se apilaron de 8 en 8 bytes; el carril i está en
+   8*(n-1-i)(sp). Se compactan y el vector sube a ocupar su sitio. */
+static void riscv_vecFromStack(VecType type) {
+    int lanes = vecLanes(type);
+    int size = riscv_vecSize(type);
+    fprintf(g_backend->out, "    addi sp, sp, -%d\n", size);
+    for (int i = 0; i < lanes; i++) {
+        fprintf(g_backend->out, "    ld t1, %d(sp)\n", size + 8 * (lanes - 1 - i));
+        if (vecIsFloat(type)) {
+            fprintf(g_backend->out, "    fcvt.s.l ft0, t1\n");
+            fprintf(g_backend->out, "    fsw ft0, %d(sp)\n", 4 * i);
+        } else {
+            fprintf(g_backend->out, "    sw t1, %d(sp)\n", 4 * i);
+        }
+    }
+    for (int i = 0; i < lanes; i++) {
+        fprintf(g_backend->out, "    lw t1, %d(sp)\n", 4 * i);
+        fprintf(g_backend->out, "    sw t1, %d(sp)\n", 8 * lanes + 4 * i);
+    }
+    fprintf(g_backend->out, "    addi sp, sp, %d\n", 8 * lanes);
+}
+
+/* El principal ya está en la pila */
+static void riscv_vecPush(VecType type) {
+    (void)type;
+}
+
+static void riscv_vecPopSecondary(VecType type) {
+    (void)type;
+}
+
+static void riscv_vecBinary(char op, VecType type) {
+    int size = riscv_vecSize(type);
+    for (int i = 0; i < vecLanes(type); i++) {
+        if (vecIsFloat(type)) {
+            const char *instr = op == '+' ? "fadd.s" : op == '-' ? "fsub.s" : op == '*' ? "fmul.s" : "fdiv.s";
+            fprintf(g_backend->out, "    flw ft0, %d(sp)\n", size + 4 * i);
+            fprintf(g_backend->out, "    flw ft1, %d(sp)\n", 4 * i);
+            fprintf(g_backend->out, "    %s ft0, ft0, ft1\n", instr);
+            fprintf(g_backend->out, "    fsw ft0, %d(sp)\n", size + 4 * i);
+        } else {
+            const char *instr = op == '+' ? "addw" : op == '-' ? "subw" : "mulw";
+            fprintf(g_backend->out, "    lw t1, %d(sp)\n", size + 4 * i);
+            fprintf(g_backend->out, "    lw t2, %d(sp)\n", 4 * i);
+            fprintf(g_backend->out, "    %s t1, t1, t2\n", instr);
+            fprintf(g_backend->out, "    sw t1, %d(sp)\n", size + 4 * i);
+        }
+    }
+    fprintf(g_backend->out, "    addi sp, sp, %d\n", size);
+}
+
+/* Se construye el resultado en un hueco temporal y se copia encima */
+static void riscv_vecShuffle(VecType type, const int *lanes) {
+    int size = riscv_vecSize(type);
+    fprintf(g_backend->out, "    addi sp, sp, -%d\n", size);
+    for (int i = 0; i < vecLanes(type); i++) {
+        fprintf(g_backend->out, "    lw t1, %d(sp)\n", size + 4 * lanes[i]);
+        fprintf(g_backend->out, "    sw t1, %d(sp)\n", 4 * i);
+    }
+    for (int i = 0; i < vecLanes(type); i++) {
+        fprintf(g_backend->out, "    lw t1, %d(sp)\n", 4 * i);
+        fprintf(g_backend->out, "    sw t1, %d(sp)\n", size + 4 * i);
+    }
+    fprintf(g_backend->out, "    addi sp, sp, %d\n", size);
+}
+
+static void riscv_vecReduce(int reduceOp, VecType type) {
+    int lanes = vecLanes(type);
+    if (vecIsFloat(type)) {
+        const char *instr = reduceOp == REDUCE_ADD ? "fadd.s" : reduceOp == REDUCE_MIN ? "fmin.s" : "fmax.s";
+        fprintf(g_backend->out, "    flw ft0, 0(sp)\n");
+        for (int i = 1; i < lanes; i++) {
+            fprintf(g_backend->out, "    flw ft1, %d(sp)\n", 4 * i);
+            fprintf(g_backend->out, "    %s ft0, ft0, ft1\n", instr);
+        }
+        fprintf(g_backend->out, "    fcvt.l.s a0, ft0, rtz\n");
+    } else {
+        fprintf(g_backend->out, "    lw a0, 0(sp)\n");
+        for (int i = 1; i < lanes; i++) {
+            fprintf(g_backend->out, "    lw t1, %d(sp)\n", 4 * i);
+            if (reduceOp == REDUCE_ADD) {
+                fprintf(g_backend->out, "    addw a0, a0, t1\n");
+            } else {
+                fprintf(g_backend->out, "    %s a0, t1, 1f\n", reduceOp == REDUCE_MIN ? "ble" : "bge");
+                fprintf(g_backend->out, "    mv a0, t1\n");
+                fprintf(g_backend->out, "1:\n");
+            }
+        }
+    }
+    fprintf(g_backend->out, "    addi sp, sp, %d\n", riscv_vecSize(type));
+}
+
 /* Salto condicional: si a0 es 0, salta a 'label' */
 static void riscv_jumpIfZero(const char *label) {
     fprintf(g_backend->out, "    beqz a0, %s\n", label);
@@ -76,20 +551,175 @@ static void riscv_emitIDiv(void) {
     fprintf(g_backend->out, "    div a0, t0, a0    ; a0 = L / R\n");
 }
 
+/* Módulo entero: se asume L en t0, R en a0; se calcula L % R */
+static void riscv_emitIMod(void) {
+    fprintf(g_backend->out, "    rem a0, t0, a0    ; a0 = L %% R\n");
+}
+
+/* --- Reducción de fuerza (operando en a0, constante conocida) ---
+   Los registros son de 64 bits; t1 y t2 se usan como temporales. */
+
+/* Multiplicación por constante: slli/add/sub en lugar de mul */
+static void riscv_emitMulConst(long value) {
+    unsigned long mag = (value < 0) ? 0UL - (unsigned long)value : (unsigned long)value;
+    int k;
+    if (value == 0) {
+        fprintf(g_backend->out, "    li a0, 0\n");
+        return;
+    }
+    if (mag == 1) {
+        /* Nada que hacer salvo el signo */
+    } else if ((k = exactLog2((long)mag)) >= 0) {
+        fprintf(g_backend->out, "    slli a0, a0, %d    ; a0 = L * %lu\n", k, mag);
+    } else if ((k = exactLog2((long)(mag - 1))) >= 0) {
+        fprintf(g_backend->out, "    slli t1, a0, %d\n", k);
+        fprintf(g_backend->out, "    add a0, t1, a0    ; a0 = L * %lu\n", mag);
+    } else if ((k = exactLog2((long)(mag + 1))) >= 0) {
+        fprintf(g_backend->out, "    slli t1, a0, %d\n", k);
+        fprintf(g_backend->out, "    sub a0, t1, a0    ; a0 = L * %lu\n", mag);
+    } else {
+        fprintf(g_backend->out, "    li t1, %ld\n", value);
+        fprintf(g_backend->out, "    mul a0, a0, t1    ; a0 = L * %ld\n", value);
+        return;
+    }
+    if (value < 0)
+        fprintf(g_backend->out, "    neg a0, a0\n");
+}
+
+/* Cociente de a0 / 2^k truncado hacia cero, dejado en t1 */
+static void riscv_emitDivPow2(int k) {
+    fprintf(g_backend->out, "    srai t1, a0, 63\n");
+    fprintf(g_backend->out, "    srli t1, t1, %d\n", 64 - k);
+    fprintf(g_backend->out, "    add t1, a0, t1\n");
+    fprintf(g_backend->out, "    srai t1, t1, %d\n", k);
+}
+
+/* Cociente por número mágico (mulh), dejado en t1; el dividendo sigue en a0 */
+static void riscv_emitDivMagic(const DivMagic *magic) {
+    fprintf(g_backend->out, "    li t1, %ld\n", magic->multiplier);
+    fprintf(g_backend->out, "    mulh t1, a0, t1    ; t1 = (L * M) >> 64\n");
+    if (magic->addDividend)
+        fprintf(g_backend->out, "    add t1, t1, a0\n");
+    if (magic->subDividend)
+        fprintf(g_backend->out, "    sub t1, t1, a0\n");
+    if (magic->shift > 0)
+        fprintf(g_backend->out, "    srai t1, t1, %d\n", magic->shift);
+    fprintf(g_backend->out, "    srli t2, t1, 63\n");
+    fprintf(g_backend->out, "    add t1, t1, t2\n");
+}
+
+/* División por constante */
+static void riscv_emitDivConst(long value) {
+    DivMagic magic;
+    int k = exactLog2(value);
+    if (value == 1)
+        return;
+    if (value == -1) {
+        fprintf(g_backend->out, "    neg a0, a0\n");
+    } else if (k > 0 && k < 63) {
+        riscv_emitDivPow2(k);
+        if (value < 0)
+            fprintf(g_backend->out, "    neg a0, t1        ; a0 = L / %ld\n", value);
+        else
+            fprintf(g_backend->out, "    mv a0, t1         ; a0 = L / %ld\n", value);
+    } else if (computeDivMagic(value, 64, &magic)) {
+        riscv_emitDivMagic(&magic);
+        fprintf(g_backend->out, "    mv a0, t1         ; a0 = L / %ld\n", value);
+    } else {
+        fprintf(g_backend->out, "    mv t0, a0\n");
+        riscv_loadImmInt(value);
+        riscv_emitIDiv();
+    }
+}
+
+/* Módulo por constante: L - q * c, con q obtenido sin dividir */
+static void riscv_emitModConst(long value) {
+    DivMagic magic;
+    int k = exactLog2(value);
+    if (value == 1 || value == -1) {
+        fprintf(g_backend->out, "    li a0, 0\n");
+    } else if (k > 0 && k < 63) {
+        riscv_emitDivPow2(k);
+        fprintf(g_backend->out, "    slli t1, t1, %d\n", k);
+        fprintf(g_backend->out, "    sub a0, a0, t1    ; a0 = L %% %ld\n", value);
+    } else if (computeDivMagic(value, 64, &magic)) {
+        riscv_emitDivMagic(&magic);
+        fprintf(g_backend->out, "    li t2, %ld\n", value);
+        fprintf(g_backend->out, "    mul t1, t1, t2\n");
+        fprintf(g_backend->out, "    sub a0, a0, t1    ; a0 = L %% %ld\n", value);
+    } else {
+        fprintf(g_backend->out, "    mv t0, a0\n");
+        riscv_loadImmInt(value);
+        riscv_emitIMod();
+    }
+}
+
 /* Instanciamos la vtable para RISC-V */
 static ArchBackend g_riscvBackend = {
     .out = NULL,
     .emitLoadImmInt = riscv_loadImmInt,
     .emitStoreGlobal = riscv_storeGlobal,
     .emitLoadGlobal = riscv_loadGlobal,
-    .emitCmpGreater = riscv_cmpGreater,
+    .emitPushPrimary = riscv_pushPrimary,
+    .emitPopSecondary = riscv_popSecondary,
+    .emitCompare = riscv_compare,
     .emitSetLabel = riscv_setLabel,
     .emitJump = riscv_jump,
     .emitJumpIfZero = riscv_jumpIfZero,
+    .emitCompareJumpIfFalse = riscv_compareJumpIfFalse,
     .emitAdd = riscv_emitAdd,
     .emitSub = riscv_emitSub,
     .emitImul = riscv_emitImul,
-    .emitIDiv = riscv_emitIDiv
+    .emitIDiv = riscv_emitIDiv,
+    .emitIMod = riscv_emitIMod,
+    .emitMulConst = riscv_emitMulConst,
+    .emitDivConst = riscv_emitDivConst,
+    .emitModConst = riscv_emitModConst,
+    .emitLoadThreadLocal = riscv_loadThreadLocal,
+    .emitStoreThreadLocal = riscv_storeThreadLocal,
+    .emitChunkBegin = riscv_chunkBegin,
+    .emitChunkEnd = riscv_chunkEnd,
+    .emitParallelFor = riscv_parallelFor,
+    .emitTaskEntry = riscv_taskEntry,
+    .emitNativeEntry = riscv_nativeEntry,
+    .emitSpawn = riscv_spawn,
+    .emitAwait = riscv_await,
+    .emitVecLoad = riscv_vecLoad,
+    .emitVecStore = riscv_vecStore,
+    .emitVecConst = riscv_vecConst,
+    .emitVecSplat = riscv_vecSplat,
+    .emitVecFromStack = riscv_vecFromStack,
+    .emitVecPush = riscv_vecPush,
+    .emitVecPopSecondary = riscv_vecPopSecondary,
+    .emitVecBinary = riscv_vecBinary,
+    .emitVecShuffle = riscv_vecShuffle,
+    .emitVecReduce = riscv_vecReduce,
+    .emitArrayNew = riscv_arrayNew,
+    .emitArrayLength = riscv_arrayLength,
+    .emitArrayLoad = riscv_arrayLoad,
+    .emitArrayStore = riscv_arrayStore,
+    .emitSoaNew = riscv_soaNew,
+    .emitStrBuilderNew = riscv_strBuilderNew,
+    .emitStrAppend = riscv_strAppend,
+    .emitStrBuilderFinish = riscv_strBuilderFinish,
+    .emitIntToStr = riscv_intToStr,
+    .emitStrPrint = riscv_strPrint,
+    .emitLoadString = riscv_loadString,
+    .emitStringData = gasStringData,
+    .emitStringAlias = gasStringAlias,
+    .emitFunctionBegin = riscv_functionBegin,
+    .emitLoadArg = riscv_loadArg,
+    .emitPopThreadLocal = riscv_popThreadLocal,
+    .emitFunctionEnd = riscv_functionEnd,
+    .emitCall = riscv_call,
+    .emitCallVirtual = riscv_callVirtual,
+    .emitObjectNew = riscv_objectNew,
+    .emitLoadField = riscv_loadField,
+    .emitStoreField = riscv_storeField,
+    .emitInitField = riscv_initField,
+    .emitVtable = riscv_vtable,
+    .emitStaticClosure = riscv_staticClosure,
+    .emitLoadStatic = riscv_loadStatic
 };
 
 /* Función para crear el backend RISC-V.
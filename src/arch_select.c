@@ -11,6 +11,37 @@ extern ArchBackend *createWasmBackend(FILE *fp);
 /* Variable global que será usada por el codegen */
 ArchBackend *g_backend = NULL;
 
+/* Los bytes no imprimibles, las comillas y la barra se escriben en octal */
+void gasStringData(int id, const char *bytes, size_t length) {
+    FILE *out = g_backend->out;
+    fprintf(out, "\n.section .rodata\n.balign 8\n.LSTR%d:\n    .asciz \"", id);
+    for (size_t i = 0; i < length; i++) {
+        unsigned char c = (unsigned char)bytes[i];
+        if (c >= 0x20 && c < 0x7F && c != '"' && c != '\\')
+            fputc(c, out);
+        else
+            fprintf(out, "\\%03o", c);
+    }
+    fprintf(out, "\"\n");
+}
+
+void gasStringAlias(int id, int base, size_t offset) {
+    fprintf(g_backend->out, ".set .LSTR%d, .LSTR%d + %zu\n", id, base, offset);
+}
+
+void gasVtable(const char *label, const char *const *methods, int count, int wordSize) {
+    FILE *out = g_backend->out;
+    fprintf(out, "\n.section .rodata\n.balign %d\n%s:\n", wordSize, label);
+    for (int i = 0; i < count; i++)
+        fprintf(out, "    %s %s\n", wordSize == 8 ? ".quad" : ".word", methods[i] ? methods[i] : "0");
+}
+
+void gasStaticClosure(const char *label, const char *vtable, int wordSize) {
+    FILE *out = g_backend->out;
+    fprintf(out, "\n.section .rodata\n.balign 8\n%s:\n", label);
+    fprintf(out, "    %s %s\n", wordSize == 8 ? ".quad" : ".word", vtable);
+}
+
 /**
  * @brief Selecciona e inicializa el backend según la arquitectura objetivo.
  * 
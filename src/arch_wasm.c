@@ -1,4 +1,5 @@
 #include "arch.h"
+#include "optimize.h"
 #include <stdio.h>
 #include <stdlib.h>
 
@@ -24,12 +25,49 @@ static void wasm_loadGlobal(const char *name) {
     fprintf(g_backend->out, "    global.get $%s\n", name);
 }
 
-/* Comparación mayor: en WASM se usa i32.gt_s para enteros con signo.
-   Se asume que los dos operandos ya están en la pila.
-   i32.gt_s consumirá los dos operandos y empujará 1 si L > R, 0 en caso contrario.
-*/
-static void wasm_cmpGreater(void) {
-    fprintf(g_backend->out, "    i32.gt_s\n");
+/* WASM es una máquina de pila: los operandos ya quedan en orden L, R,
+   por lo que guardar/recuperar operandos no emite instrucciones. */
+static void wasm_pushPrimary(void) {
+}
+
+static void wasm_popSecondary(void) {
+}
+
+/* Instrucción de comparación con signo para cada operador y su negación */
+static const char *wasm_cmpInstr(CompareOp op) {
+    switch (op) {
+        case CMP_GT: return "i32.gt_s";
+        case CMP_LT: return "i32.lt_s";
+        case CMP_GE: return "i32.ge_s";
+        case CMP_LE: return "i32.le_s";
+        case CMP_EQ: return "i32.eq";
+        case CMP_NE: return "i32.ne";
+    }
+    return "i32.eq";
+}
+
+static const char *wasm_invCmpInstr(CompareOp op) {
+    switch (op) {
+        case CMP_GT: return "i32.le_s";
+        case CMP_LT: return "i32.ge_s";
+        case CMP_GE: return "i32.lt_s";
+        case CMP_LE: return "i32.gt_s";
+        case CMP_EQ: return "i32.ne";
+        case CMP_NE: return "i32.eq";
+    }
+    return "i32.ne";
+}
+
+/* Comparación: consume L y R de la pila y empuja 1 si se cumple, 0 en caso contrario. */
+static void wasm_compare(CompareOp op) {
+    fprintf(g_backend->out, "    %s\n", wasm_cmpInstr(op));
+}
+
+/* Comparación fusionada: la comparación invertida alimenta directamente a br_if,
+   evitando el i32.eqz intermedio. */
+static void wasm_compareJumpIfFalse(CompareOp op, const char *label) {
+    fprintf(g_backend->out, "    %s\n", wasm_invCmpInstr(op));
+    fprintf(g_backend->out, "    br_if %s\n", label);
 }
 
 /* Emite una "etiqueta" como comentario */
@@ -42,6 +80,428 @@ static void wasm_jump(const char *label) {
     fprintf(g_backend->out, "    br %s\n", label);
 }
 
+/* --- Bucles paralelos --- */
+
+/* Con hilos de WebAssembly cada hilo es una instancia con sus propias
+   globales (la memoria es la única compartida), así que las variables
+   privadas de un trozo son globales normales */
+static void wasm_loadThreadLocal(const char *name) {
+    fprintf(g_backend->out, "    global.get $%s\n", name);
+}
+
+static void wasm_storeThreadLocal(const char *name) {
+    fprintf(g_backend->out, "    global.set $%s\n", name);
+}
+
+static void wasm_chunkBegin(const char *func, const char *startVar, const char *endVar) {
+    fprintf(g_backend->out, "  (func $%s (param $inicio i32) (param $fin i32) (result i32)\n", func);
+    fprintf(g_backend->out, "    local.get $inicio\n");
+    fprintf(g_backend->out, "    global.set $%s\n", startVar);
+    fprintf(g_backend->out, "    local.get $fin\n");
+    fprintf(g_backend->out, "    global.set $%s\n", endVar);
+}
+
+static void wasm_chunkEnd(void) {
+    fprintf(g_backend->out, "  )\n");
+}
+
+/* Inicio, fin y valor inicial ya están en la pila; el runtime del
+   anfitrión recibe la función como funcref */
+static void wasm_parallelFor(const char *func, int reduceOp) {
+    fprintf(g_backend->out, "    ref.func $%s\n", func);
+    fprintf(g_backend->out, "    i32.const %d\n", reduceOp);
+    fprintf(g_backend->out, "    call $lyn_parallel_for\n");
+}
+
+/* --- Tareas ligeras --- */
+
+static void wasm_taskEntry(const char *thunk, const char *func, int argCount) {
+    fprintf(g_backend->out, "  (func $%s (param $arg i32) (result i32)\n", thunk);
+    if (argCount > 0)
+        fprintf(g_backend->out, "    local.get $arg\n");
+    fprintf(g_backend->out, "    call $%s\n", func);
+    fprintf(g_backend->out, "  )\n");
+}
+
+/* $args apunta a los argumentos en la memoria lineal, una palabra cada uno */
+static void wasm_nativeEntry(const char *entry, const char *func, int argCount) {
+    fprintf(g_backend->out, "  (func $%s (param $args i32) (result i32)\n", entry);
+    for (int i = 0; i < argCount; i++) {
+        fprintf(g_backend->out, "    local.get $args\n");
+        fprintf(g_backend->out, "    i32.load offset=%d\n", 4 * i);
+    }
+    fprintf(g_backend->out, "    call $%s\n", func);
+    fprintf(g_backend->out, "  )\n");
+}
+
+/* El argumento ya está en la pila: el anfitrión recibe (arg, funcref) */
+static void wasm_spawn(const char *thunk) {
+    fprintf(g_backend->out, "    ref.func $%s\n", thunk);
+    fprintf(g_backend->out, "    call $lyn_spawn\n");
+}
+
+static void wasm_await(void) {
+    fprintf(g_backend->out, "    call $lyn_await\n");
+}
+
+/* --- Arreglos tipados ---
+   Palabras de 4 bytes en la memoria lineal. El arreglo, el índice y el
+   valor pasan por los globales $__lyn_aa, $__lyn_ai y $__lyn_av porque la
+   pila no permite reutilizarlos. */
+
+static void wasm_boundsCheck(void) {
+    fprintf(g_backend->out, "    global.get $__lyn_ai\n");
+    fprintf(g_backend->out, "    global.get $__lyn_aa\n");
+    fprintf(g_backend->out, "    i32.load\n");
+    fprintf(g_backend->out, "    i32.ge_u\n");
+    fprintf(g_backend->out, "    if\n");
+    fprintf(g_backend->out, "    global.get $__lyn_ai\n");
+    fprintf(g_backend->out, "    global.get $__lyn_aa\n");
+    fprintf(g_backend->out, "    i32.load\n");
+    fprintf(g_backend->out, "    call $lyn_bounds_fail\n");
+    fprintf(g_backend->out, "    unreachable\n");
+    fprintf(g_backend->out, "    end\n");
+}
+
+/* Dirección del elemento: arreglo + 4 * índice (el desplazamiento de la
+   longitud va en offset=4) */
+static void wasm_elementAddress(void) {
+    fprintf(g_backend->out, "    global.get $__lyn_aa\n");
+    fprintf(g_backend->out, "    global.get $__lyn_ai\n");
+    fprintf(g_backend->out, "    i32.const 2\n");
+    fprintf(g_backend->out, "    i32.shl\n");
+    fprintf(g_backend->out, "    i32.add\n");
+}
+
+static void wasm_arrayNew(void) {
+    fprintf(g_backend->out, "    call $lyn_array_new\n");
+}
+
+static void wasm_arrayLength(void) {
+    fprintf(g_backend->out, "    i32.load\n");
+}
+
+static void wasm_arrayLoad(int checked) {
+    fprintf(g_backend->out, "    global.set $__lyn_ai\n");
+    fprintf(g_backend->out, "    global.set $__lyn_aa\n");
+    if (checked)
+        wasm_boundsCheck();
+    wasm_elementAddress();
+    fprintf(g_backend->out, "    i32.load offset=4\n");
+}
+
+static void wasm_arrayStore(int checked) {
+    fprintf(g_backend->out, "    global.set $__lyn_av\n");
+    fprintf(g_backend->out, "    global.set $__lyn_ai\n");
+    fprintf(g_backend->out, "    global.set $__lyn_aa\n");
+    if (checked)
+        wasm_boundsCheck();
+    wasm_elementAddress();
+    fprintf(g_backend->out, "    global.get $__lyn_av\n");
+    fprintf(g_backend->out, "    i32.store offset=4\n");
+    fprintf(g_backend->out, "    global.get $__lyn_aa\n");
+}
+
+static void wasm_soaNew(int fields) {
+    fprintf(g_backend->out, "    i32.const %d\n", fields);
+    fprintf(g_backend->out, "    call $lyn_soa_new\n");
+}
+
+/* --- Strings ---
+   Las funciones de append retornan el constructor, así que queda en la
+   pila de operandos bajo cada pieza sin globales auxiliares. */
+
+static void wasm_strBuilderNew(void) {
+    fprintf(g_backend->out, "    call $lyn_sb_new\n");
+}
+
+static void wasm_strAppend(int isInt) {
+    fprintf(g_backend->out, "    call $%s\n", isInt ? "lyn_sb_append_int" : "lyn_sb_append_str");
+}
+
+static void wasm_strBuilderFinish(int print) {
+    fprintf(g_backend->out, "    call $%s\n", print ? "lyn_sb_print" : "lyn_sb_finish");
+}
+
+static void wasm_intToStr(void) {
+    fprintf(g_backend->out, "    call $lyn_str_from_int\n");
+}
+
+static void wasm_strPrint(void) {
+    fprintf(g_backend->out, "    call $lyn_str_print\n");
+}
+
+/* Los literales se colocan en la memoria lineal a partir de
+   WASM_STRING_BASE; el código los lee de un global inmutable con su
+   dirección porque esta no se conoce hasta el final */
+#define WASM_STRING_BASE 1024
+
+static size_t wasmStringNext = WASM_STRING_BASE;
+static size_t wasmStringLast = WASM_STRING_BASE;   /* Dirección del último literal emitido */
+
+static void wasm_loadString(int id) {
+    fprintf(g_backend->out, "    global.get $__lyn_str%d\n", id);
+}
+
+static void wasm_stringData(int id, const char *bytes, size_t length) {
+    size_t address = (wasmStringNext + 7) & ~(size_t)7;
+    fprintf(g_backend->out, "(data (i32.const %zu) \"", address);
+    for (size_t i = 0; i < length; i++) {
+        unsigned char c = (unsigned char)bytes[i];
+        if (c >= 0x20 && c < 0x7F && c != '"' && c != '\\')
+            fputc(c, g_backend->out);
+        else
+            fprintf(g_backend->out, "\\%02x", c);
+    }
+    fprintf(g_backend->out, "\\00\")\n");
+    fprintf(g_backend->out, "(global $__lyn_str%d i32 (i32.const %zu))\n", id, address);
+    wasmStringLast = address;
+    wasmStringNext = address + length + 1;
+}
+
+static void wasm_stringAlias(int id, int base, size_t offset) {
+    (void)base;
+    fprintf(g_backend->out, "(global $__lyn_str%d i32 (i32.const %zu))\n", id, wasmStringLast + offset);
+}
+
+/* --- Funciones y objetos ---
+   Los argumentos apilados quedan en la pila de operandos y pasan a ser los
+   parámetros $a0..$aN de la función. Una llamada virtual pasa el hueco al
+   anfitrión, que busca la función en la tabla a partir de la vtable del
+   receptor. */
+
+static int wasmElemNext = 0;   /* Primera entrada libre de la tabla de funciones */
+
+static void wasm_functionBegin(const char *name, int argCount) {
+    fprintf(g_backend->out, "  (func $%s", name);
+    for (int i = 0; i < argCount; i++)
+        fprintf(g_backend->out, " (param $a%d i32)", i);
+    fprintf(g_backend->out, " (result i32) (local $ret i32)\n");
+}
+
+static void wasm_loadArg(int index, int argCount, int depth) {
+    (void)argCount;
+    (void)depth;
+    fprintf(g_backend->out, "    local.get $a%d\n", index);
+}
+
+static void wasm_popThreadLocal(const char *name) {
+    fprintf(g_backend->out, "    global.set $%s\n", name);
+}
+
+/* El resultado está encima de los valores guardados */
+static void wasm_functionEnd(const char *const *saved, int savedCount) {
+    if (savedCount > 0) {
+        fprintf(g_backend->out, "    local.set $ret\n");
+        for (int i = savedCount - 1; i >= 0; i--)
+            fprintf(g_backend->out, "    global.set $%s\n", saved[i]);
+        fprintf(g_backend->out, "    local.get $ret\n");
+    }
+    fprintf(g_backend->out, "  )\n");
+}
+
+static void wasm_call(const char *name, int argCount) {
+    (void)argCount;
+    fprintf(g_backend->out, "    call $%s\n", name);
+}
+
+static void wasm_callVirtual(int slot, int argCount) {
+    fprintf(g_backend->out, "    i32.const %d\n", slot);
+    fprintf(g_backend->out, "    call $lyn_call_virtual%d\n", argCount);
+}
+
+static void wasm_objectNew(long size, const char *vtable) {
+    fprintf(g_backend->out, "    i32.const %ld\n", size);
+    if (vtable)
+        fprintf(g_backend->out, "    global.get $%s\n", vtable);
+    else
+        fprintf(g_backend->out, "    i32.const 0\n");
+    fprintf(g_backend->out, "    call $lyn_object_new\n");
+}
+
+static void wasm_loadField(int offset) {
+    fprintf(g_backend->out, "    i32.load offset=%d\n", offset);
+}
+
+static void wasm_storeField(int offset) {
+    fprintf(g_backend->out, "    i32.store offset=%d\n", offset);
+}
+
+/* El objeto y el valor pasan por los globales de los arreglos */
+static void wasm_initField(int offset) {
+    fprintf(g_backend->out, "    global.set $__lyn_av\n");
+    fprintf(g_backend->out, "    global.set $__lyn_aa\n");
+    fprintf(g_backend->out, "    global.get $__lyn_aa\n");
+    fprintf(g_backend->out, "    global.get $__lyn_av\n");
+    fprintf(g_backend->out, "    i32.store offset=%d\n", offset);
+    fprintf(g_backend->out, "    global.get $__lyn_aa\n");
+}
+
+/* La vtable es el índice de su primera entrada en la tabla de funciones */
+static int wasmVtableLast = 0;   /* Primera entrada de la última vtable emitida */
+
+static void wasm_vtable(const char *label, const char *const *methods, int count) {
+    for (int i = 0; i < count; i++)
+        if (methods[i])
+            fprintf(g_backend->out, "(elem (i32.const %d) $%s)\n", wasmElemNext + i, methods[i]);
+    fprintf(g_backend->out, "(global $%s i32 (i32.const %d))\n", label, wasmElemNext);
+    wasmVtableLast = wasmElemNext;
+    wasmElemNext += count;
+}
+
+/* El registro sigue a su vtable: su palabra es la entrada de la tabla */
+static void wasm_staticClosure(const char *label, const char *vtable) {
+    (void)vtable;
+    size_t address = (wasmStringNext + 7) & ~(size_t)7;
+    unsigned value = (unsigned)wasmVtableLast;
+    fprintf(g_backend->out, "(data (i32.const %zu) \"\\%02x\\%02x\\%02x\\%02x\")\n", address,
+            value & 0xFF, (value >> 8) & 0xFF, (value >> 16) & 0xFF, (value >> 24) & 0xFF);
+    fprintf(g_backend->out, "(global $%s i32 (i32.const %zu))\n", label, address);
+    wasmStringNext = address + 4;
+}
+
+static void wasm_loadStatic(const char *label) {
+    fprintf(g_backend->out, "    global.get $%s\n", label);
+}
+
+/* --- Tipos vectoriales (SIMD128) ---
+   Un vector de 4 carriles es un v128; uno de 8 son dos v128 en la pila
+   (mitad baja y después alta). La variable 'v' de 8 carriles usa los globales
+   $v y $v__hi. Las operaciones de 8 carriles reordenan las mitades con los
+   globales auxiliares $__lyn_vl_*, $__lyn_vr_* y $__lyn_lane*. */
+
+static const char *wasm_vecShape(VecType type) {
+    return vecIsFloat(type) ? "f32x4" : "i32x4";
+}
+
+static void wasm_vecLoad(const char *name, VecType type) {
+    fprintf(g_backend->out, "    global.get $%s\n", name);
+    if (vecLanes(type) == 8)
+        fprintf(g_backend->out, "    global.get $%s__hi\n", name);
+}
+
+static void wasm_vecStore(const char *name, VecType type) {
+    if (vecLanes(type) == 8)
+        fprintf(g_backend->out, "    global.set $%s__hi\n", name);
+    fprintf(g_backend->out, "    global.set $%s\n", name);
+}
+
+static void wasm_vecConst(VecType type, const double *lanes) {
+    for (int half = 0; half < vecLanes(type) / 4; half++) {
+        fprintf(g_backend->out, "    v128.const %s", wasm_vecShape(type));
+        for (int i = 4 * half; i < 4 * half + 4; i++) {
+            if (vecIsFloat(type))
+                fprintf(g_backend->out, " %.9g", lanes[i]);
+            else
+                fprintf(g_backend->out, " %d", (int)(long long)lanes[i]);
+        }
+        fprintf(g_backend->out, "\n");
+    }
+}
+
+/* Lleva el carril guardado en $__lyn_lane<i> a la pila con el tipo del vector */
+static void wasm_vecGetLane(VecType type, int i) {
+    fprintf(g_backend->out, "    global.get $__lyn_lane%d\n", i);
+    if (vecIsFloat(type))
+        fprintf(g_backend->out, "    f32.convert_i32_s\n");
+}
+
+static void wasm_vecSplat(VecType type) {
+    fprintf(g_backend->out, "    global.set $__lyn_lane0\n");
+    for (int half = 0; half < vecLanes(type) / 4; half++) {
+        wasm_vecGetLane(type, 0);
+        fprintf(g_backend->out, "    %s.splat\n", wasm_vecShape(type));
+    }
+}
+
+static void wasm_vecFromStack(VecType type) {
+    int lanes = vecLanes(type);
+    for (int i = lanes - 1; i >= 0; i--)
+        fprintf(g_backend->out, "    global.set $__lyn_lane%d\n", i);
+    for (int half = 0; half < lanes / 4; half++) {
+        wasm_vecGetLane(type, 4 * half);
+        fprintf(g_backend->out, "    %s.splat\n", wasm_vecShape(type));
+        for (int j = 1; j < 4; j++) {
+            wasm_vecGetLane(type, 4 * half + j);
+            fprintf(g_backend->out, "    %s.replace_lane %d\n", wasm_vecShape(type), j);
+        }
+    }
+}
+
+/* Como con los escalares, los operandos ya quedan en orden en la pila */
+static void wasm_vecPush(VecType type) {
+    (void)type;
+}
+
+static void wasm_vecPopSecondary(VecType type) {
+    (void)type;
+}
+
+static void wasm_vecBinary(char op, VecType type) {
+    const char *name = op == '+' ? "add" : op == '-' ? "sub" : op == '*' ? "mul" : "div";
+    if (vecLanes(type) == 4) {
+        fprintf(g_backend->out, "    %s.%s\n", wasm_vecShape(type), name);
+        return;
+    }
+    /* Pila: L.lo L.hi R.lo R.hi */
+    fprintf(g_backend->out, "    global.set $__lyn_vr_hi\n");
+    fprintf(g_backend->out, "    global.set $__lyn_vr_lo\n");
+    fprintf(g_backend->out, "    global.set $__lyn_vl_hi\n");
+    fprintf(g_backend->out, "    global.get $__lyn_vr_lo\n");
+    fprintf(g_backend->out, "    %s.%s\n", wasm_vecShape(type), name);
+    fprintf(g_backend->out, "    global.get $__lyn_vl_hi\n");
+    fprintf(g_backend->out, "    global.get $__lyn_vr_hi\n");
+    fprintf(g_backend->out, "    %s.%s\n", wasm_vecShape(type), name);
+}
+
+/* i8x16.shuffle elige bytes de la concatenación de dos v128: la mitad baja
+   (carriles 0-3) y la alta (4-7) */
+static void wasm_vecShuffle(VecType type, const int *lanes) {
+    int eight = vecLanes(type) == 8;
+    if (eight)
+        fprintf(g_backend->out, "    global.set $__lyn_vl_hi\n");
+    fprintf(g_backend->out, "    global.set $__lyn_vl_lo\n");
+    for (int half = 0; half < vecLanes(type) / 4; half++) {
+        fprintf(g_backend->out, "    global.get $__lyn_vl_lo\n");
+        fprintf(g_backend->out, "    global.get $%s\n", eight ? "__lyn_vl_hi" : "__lyn_vl_lo");
+        fprintf(g_backend->out, "    i8x16.shuffle");
+        for (int i = 4 * half; i < 4 * half + 4; i++)
+            for (int byte = 0; byte < 4; byte++)
+                fprintf(g_backend->out, " %d", 4 * lanes[i] + byte);
+        fprintf(g_backend->out, "\n");
+    }
+}
+
+static void wasm_vecReduce(int reduceOp, VecType type) {
+    const char *shape = wasm_vecShape(type);
+    const char *name;
+    if (reduceOp == REDUCE_ADD)
+        name = "add";
+    else if (reduceOp == REDUCE_MIN)
+        name = vecIsFloat(type) ? "min" : "min_s";
+    else
+        name = vecIsFloat(type) ? "max" : "max_s";
+    /* Las dos mitades se combinan primero */
+    if (vecLanes(type) == 8)
+        fprintf(g_backend->out, "    %s.%s\n", shape, name);
+    /* Reducción en árbol: carriles (2,3,0,1) y después (1,0,3,2) */
+    static const char *swaps[2] = {
+        "8 9 10 11 12 13 14 15 0 1 2 3 4 5 6 7",
+        "4 5 6 7 0 1 2 3 12 13 14 15 8 9 10 11"
+    };
+    for (int step = 0; step < 2; step++) {
+        fprintf(g_backend->out, "    global.set $__lyn_vl_lo\n");
+        fprintf(g_backend->out, "    global.get $__lyn_vl_lo\n");
+        fprintf(g_backend->out, "    global.get $__lyn_vl_lo\n");
+        fprintf(g_backend->out, "    global.get $__lyn_vl_lo\n");
+        fprintf(g_backend->out, "    i8x16.shuffle %s\n", swaps[step]);
+        fprintf(g_backend->out, "    %s.%s\n", shape, name);
+    }
+    fprintf(g_backend->out, "    %s.extract_lane 0\n", shape);
+    if (vecIsFloat(type))
+        fprintf(g_backend->out, "    i32.trunc_f32_s\n");
+}
+
 /* Salto condicional: usa 'i32.eqz' para comparar con cero y 'br_if' para saltar si es cierto */
 static void wasm_jumpIfZero(const char *label) {
     fprintf(g_backend->out, "    i32.eqz\n");
@@ -70,24 +530,116 @@ static void wasm_emitIDiv(void) {
     fprintf(g_backend->out, "    i32.div_s\n");
 }
 
+/* Resto con signo: i32.rem_s */
+static void wasm_emitIMod(void) {
+    fprintf(g_backend->out, "    i32.rem_s\n");
+}
+
+/* --- Reducción de fuerza (operando en el tope de la pila) --- */
+
+/* Multiplicación por constante: potencias de dos como desplazamiento */
+static void wasm_emitMulConst(long value) {
+    int k = exactLog2(value);
+    if (value == 1)
+        return;
+    if (k > 0 && value > 0) {
+        fprintf(g_backend->out, "    i32.const %d\n", k);
+        fprintf(g_backend->out, "    i32.shl\n");
+    } else {
+        fprintf(g_backend->out, "    i32.const %ld\n", value);
+        fprintf(g_backend->out, "    i32.mul\n");
+    }
+}
+
+/* División y módulo por constante: la pila de WASM no permite duplicar el
+   dividendo sin un local, y los motores (V8, wasmtime) ya reducen
+   i32.div_s/i32.rem_s con divisor constante a multiplicación alta al compilar
+   a código nativo, por lo que se emite la operación con la constante inmediata. */
+static void wasm_emitDivConst(long value) {
+    if (value == 1)
+        return;
+    fprintf(g_backend->out, "    i32.const %ld\n", value);
+    fprintf(g_backend->out, "    i32.div_s\n");
+}
+
+static void wasm_emitModConst(long value) {
+    fprintf(g_backend->out, "    i32.const %ld\n", value);
+    fprintf(g_backend->out, "    i32.rem_s\n");
+}
+
 /* Instanciamos la vtable para WebAssembly */
 static ArchBackend g_wasmBackend = {
     .out = NULL,
     .emitLoadImmInt = wasm_loadImmInt,
     .emitStoreGlobal = wasm_storeGlobal,
     .emitLoadGlobal = wasm_loadGlobal,
-    .emitCmpGreater = wasm_cmpGreater,
+    .emitPushPrimary = wasm_pushPrimary,
+    .emitPopSecondary = wasm_popSecondary,
+    .emitCompare = wasm_compare,
     .emitSetLabel = wasm_setLabel,
     .emitJump = wasm_jump,
     .emitJumpIfZero = wasm_jumpIfZero,
+    .emitCompareJumpIfFalse = wasm_compareJumpIfFalse,
     .emitAdd = wasm_emitAdd,
     .emitSub = wasm_emitSub,
     .emitImul = wasm_emitImul,
-    .emitIDiv = wasm_emitIDiv
+    .emitIDiv = wasm_emitIDiv,
+    .emitIMod = wasm_emitIMod,
+    .emitMulConst = wasm_emitMulConst,
+    .emitDivConst = wasm_emitDivConst,
+    .emitModConst = wasm_emitModConst,
+    .emitLoadThreadLocal = wasm_loadThreadLocal,
+    .emitStoreThreadLocal = wasm_storeThreadLocal,
+    .emitChunkBegin = wasm_chunkBegin,
+    .emitChunkEnd = wasm_chunkEnd,
+    .emitParallelFor = wasm_parallelFor,
+    .emitTaskEntry = wasm_taskEntry,
+    .emitNativeEntry = wasm_nativeEntry,
+    .emitSpawn = wasm_spawn,
+    .emitAwait = wasm_await,
+    .emitVecLoad = wasm_vecLoad,
+    .emitVecStore = wasm_vecStore,
+    .emitVecConst = wasm_vecConst,
+    .emitVecSplat = wasm_vecSplat,
+    .emitVecFromStack = wasm_vecFromStack,
+    .emitVecPush = wasm_vecPush,
+    .emitVecPopSecondary = wasm_vecPopSecondary,
+    .emitVecBinary = wasm_vecBinary,
+    .emitVecShuffle = wasm_vecShuffle,
+    .emitVecReduce = wasm_vecReduce,
+    .emitArrayNew = wasm_arrayNew,
+    .emitArrayLength = wasm_arrayLength,
+    .emitArrayLoad = wasm_arrayLoad,
+    .emitArrayStore = wasm_arrayStore,
+    .emitSoaNew = wasm_soaNew,
+    .emitStrBuilderNew = wasm_strBuilderNew,
+    .emitStrAppend = wasm_strAppend,
+    .emitStrBuilderFinish = wasm_strBuilderFinish,
+    .emitIntToStr = wasm_intToStr,
+    .emitStrPrint = wasm_strPrint,
+    .emitLoadString = wasm_loadString,
+    .emitStringData = wasm_stringData,
+    .emitStringAlias = wasm_stringAlias,
+    .emitFunctionBegin = wasm_functionBegin,
+    .emitLoadArg = wasm_loadArg,
+    .emitPopThreadLocal = wasm_popThreadLocal,
+    .emitFunctionEnd = wasm_functionEnd,
+    .emitCall = wasm_call,
+    .emitCallVirtual = wasm_callVirtual,
+    .emitObjectNew = wasm_objectNew,
+    .emitLoadField = wasm_loadField,
+    .emitStoreField = wasm_storeField,
+    .emitInitField = wasm_initField,
+    .emitVtable = wasm_vtable,
+    .emitStaticClosure = wasm_staticClosure,
+    .emitLoadStatic = wasm_loadStatic
 };
 
 /* Función para crear el backend WebAssembly. Se configura la salida (FILE *) */
 ArchBackend *createWasmBackend(FILE *fp) {
     g_wasmBackend.out = fp;
+    wasmStringNext = WASM_STRING_BASE;
+    wasmElemNext = 0;
+    wasmVtableLast = 0;
     return &g_wasmBackend;
 }
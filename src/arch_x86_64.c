@@ -1,4 +1,5 @@
 #include "arch.h"
+#include "optimize.h"
 #include <stdio.h>
 #include <stdlib.h>
 
@@ -6,8 +7,10 @@
    Backend para x86_64.
    Convenciones:
    - "Registro principal" es RAX.
-   - Las variables globales se acceden mediante [nombre].
-   - Para la comparación “mayor” se asume que la operando izquierda (L) está en RBX y la derecha (R) en RAX.
+   - Las variables globales se acceden mediante [nombre] ([rip+nombre] en
+     una biblioteca compartida).
+   - En operaciones binarias y comparaciones el operando izquierdo (L) está en RBX
+     y el derecho (R) en RAX.
 */
 
 /* Cargar inmediato en RAX */
@@ -15,21 +18,69 @@ static void x86_loadImmInt(long value) {
     fprintf(g_backend->out, "    mov rax, %ld\n", value);
 }
 
+/* Operando de memoria de la variable global 'name' */
+static const char *x86_globalOperand(const char *name) {
+    static char operand[300];
+    snprintf(operand, sizeof(operand), g_backend->sharedObject ? "[rip+%s]" : "[%s]", name);
+    return operand;
+}
+
 /* Almacenar el contenido de RAX en la variable global 'name' */
 static void x86_storeGlobal(const char *name) {
-    fprintf(g_backend->out, "    mov [%s], rax\n", name);
+    fprintf(g_backend->out, "    mov %s, rax\n", x86_globalOperand(name));
 }
 
 /* Cargar el contenido de la variable global 'name' en RAX */
 static void x86_loadGlobal(const char *name) {
-    fprintf(g_backend->out, "    mov rax, [%s]\n", name);
+    fprintf(g_backend->out, "    mov rax, %s\n", x86_globalOperand(name));
+}
+
+/* Guarda RAX en la pila */
+static void x86_pushPrimary(void) {
+    fprintf(g_backend->out, "    push rax          ; stack = L\n");
+}
+
+/* Recupera L de la pila en RBX */
+static void x86_popSecondary(void) {
+    fprintf(g_backend->out, "    pop rbx           ; rbx = L, rax = R\n");
+}
+
+/* Sufijo de condición para cada operador y su negación */
+static const char *x86_condSuffix(CompareOp op) {
+    switch (op) {
+        case CMP_GT: return "g";
+        case CMP_LT: return "l";
+        case CMP_GE: return "ge";
+        case CMP_LE: return "le";
+        case CMP_EQ: return "e";
+        case CMP_NE: return "ne";
+    }
+    return "e";
+}
+
+static const char *x86_invCondSuffix(CompareOp op) {
+    switch (op) {
+        case CMP_GT: return "le";
+        case CMP_LT: return "ge";
+        case CMP_GE: return "l";
+        case CMP_LE: return "g";
+        case CMP_EQ: return "ne";
+        case CMP_NE: return "e";
+    }
+    return "ne";
 }
 
-/* Comparación mayor: asume L en RBX, R en RAX */
-static void x86_cmpGreater(void) {
+/* Comparación: asume L en RBX, R en RAX; deja 0/1 en RAX */
+static void x86_compare(CompareOp op) {
     fprintf(g_backend->out, "    cmp rbx, rax\n");
-    fprintf(g_backend->out, "    setg al\n");
-    fprintf(g_backend->out, "    movzb rax, al\n");
+    fprintf(g_backend->out, "    set%s al\n", x86_condSuffix(op));
+    fprintf(g_backend->out, "    movzx rax, al\n");
+}
+
+/* Comparación fusionada: cmp + jcc con la condición invertida */
+static void x86_compareJumpIfFalse(CompareOp op, const char *label) {
+    fprintf(g_backend->out, "    cmp rbx, rax\n");
+    fprintf(g_backend->out, "    j%s %s\n", x86_invCondSuffix(op), label);
 }
 
 /* Emitir etiqueta */
@@ -42,9 +93,434 @@ static void x86_jump(const char *label) {
     fprintf(g_backend->out, "    jmp %s\n", label);
 }
 
+/* --- Bucles paralelos --- */
+
+/* Variables thread-local con el modelo local-exec: desplazamiento fijo
+   respecto a fs. Una biblioteca compartida no admite ese modelo; allí son
+   globales del módulo. */
+static const char *x86_threadLocalOperand(const char *name) {
+    static char operand[300];
+    if (g_backend->sharedObject)
+        snprintf(operand, sizeof(operand), "QWORD PTR [rip+%s]", name);
+    else
+        snprintf(operand, sizeof(operand), "QWORD PTR fs:%s@tpoff", name);
+    return operand;
+}
+
+static void x86_loadThreadLocal(const char *name) {
+    fprintf(g_backend->out, "    mov rax, %s\n", x86_threadLocalOperand(name));
+}
+
+static void x86_storeThreadLocal(const char *name) {
+    fprintf(g_backend->out, "    mov %s, rax\n", x86_threadLocalOperand(name));
+}
+
+/* El runtime la llama desde C: rbx es callee-saved, y guardarlo deja la
+   pila alineada a 16 */
+static void x86_chunkBegin(const char *func, const char *startVar, const char *endVar) {
+    fprintf(g_backend->out, "%s:\n", func);
+    fprintf(g_backend->out, "    push rbx\n");
+    fprintf(g_backend->out, "    mov %s, rdi    ; inicio\n", x86_threadLocalOperand(startVar));
+    fprintf(g_backend->out, "    mov %s, rsi    ; fin\n", x86_threadLocalOperand(endVar));
+}
+
+static void x86_chunkEnd(void) {
+    fprintf(g_backend->out, "    pop rbx\n");
+    fprintf(g_backend->out, "    ret\n");
+}
+
+/* Llamada al runtime con la pila alineada a 16 */
+static void x86_runtimeCall(const char *name) {
+    fprintf(g_backend->out, "    push rbp\n");
+    fprintf(g_backend->out, "    mov rbp, rsp\n");
+    fprintf(g_backend->out, "    and rsp, -16\n");
+    fprintf(g_backend->out, "    call %s\n", name);
+    fprintf(g_backend->out, "    mov rsp, rbp\n");
+    fprintf(g_backend->out, "    pop rbp\n");
+}
+
+static void x86_parallelFor(const char *func, int reduceOp) {
+    fprintf(g_backend->out, "    mov rdx, rax      ; valor inicial\n");
+    fprintf(g_backend->out, "    pop rsi           ; fin\n");
+    fprintf(g_backend->out, "    pop rdi           ; inicio\n");
+    fprintf(g_backend->out, "    lea rcx, [rip+%s]\n", func);
+    fprintf(g_backend->out, "    mov r8d, %d\n", reduceOp);
+    x86_runtimeCall("lyn_parallel_for");
+}
+
+/* --- Tareas ligeras --- */
+
+/* El argumento llega en rdi y se apila como en una llamada normal */
+static void x86_taskEntry(const char *thunk, const char *func, int argCount) {
+    fprintf(g_backend->out, "%s:\n", thunk);
+    fprintf(g_backend->out, "    push rbx\n");
+    if (argCount > 0)
+        fprintf(g_backend->out, "    push rdi          ; argumento\n");
+    else
+        fprintf(g_backend->out, "    sub rsp, 8\n");
+    fprintf(g_backend->out, "    call %s\n", func);
+    fprintf(g_backend->out, "    add rsp, 8\n");
+    fprintf(g_backend->out, "    pop rbx\n");
+    fprintf(g_backend->out, "    ret\n");
+}
+
+/* rdi = args. Guardar rbx deja la pila alineada a 16; con un número
+   impar de argumentos hace falta una palabra de relleno por encima */
+static void x86_nativeEntry(const char *entry, const char *func, int argCount) {
+    int pad = argCount % 2;
+    fprintf(g_backend->out, "\n.global %s\n%s:\n", entry, entry);
+    fprintf(g_backend->out, "    push rbx\n");
+    if (pad)
+        fprintf(g_backend->out, "    sub rsp, 8\n");
+    for (int i = 0; i < argCount; i++)
+        fprintf(g_backend->out, "    push QWORD PTR [rdi+%d]    ; argumento %d\n", 8 * i, i);
+    fprintf(g_backend->out, "    call %s\n", func);
+    if (argCount + pad > 0)
+        fprintf(g_backend->out, "    add rsp, %d\n", 8 * (argCount + pad));
+    fprintf(g_backend->out, "    pop rbx\n");
+    fprintf(g_backend->out, "    ret\n");
+}
+
+static void x86_spawn(const char *thunk) {
+    fprintf(g_backend->out, "    mov rsi, rax      ; argumento\n");
+    fprintf(g_backend->out, "    lea rdi, [rip+%s]\n", thunk);
+    x86_runtimeCall("lyn_spawn");
+}
+
+static void x86_await(void) {
+    fprintf(g_backend->out, "    mov rdi, rax      ; futuro\n");
+    x86_runtimeCall("lyn_await");
+}
+
+/* --- Arreglos tipados ---
+   El fallo de rango se emite en .text.unlikely: en el acceso solo queda
+   un cmp y un salto que no se toma. */
+
+static int boundsLabelCount = 0;
+
+/* Salta al camino de fallo si 'index' >= longitud de 'array' (sin signo) */
+static void x86_boundsCheck(const char *array, const char *index) {
+    int label = boundsLabelCount++;
+    fprintf(g_backend->out, "    cmp %s, QWORD PTR [%s]\n", index, array);
+    fprintf(g_backend->out, "    jae .LBOUNDS%d\n", label);
+    fprintf(g_backend->out, "    .pushsection .text.unlikely,\"ax\",@progbits\n");
+    fprintf(g_backend->out, ".LBOUNDS%d:\n", label);
+    fprintf(g_backend->out, "    and rsp, -16\n");
+    fprintf(g_backend->out, "    mov rdi, %s\n", index);
+    fprintf(g_backend->out, "    mov rsi, QWORD PTR [%s]\n", array);
+    fprintf(g_backend->out, "    call lyn_bounds_fail\n");
+    fprintf(g_backend->out, "    .popsection\n");
+}
+
+static void x86_arrayNew(void) {
+    fprintf(g_backend->out, "    mov rdi, rax      ; longitud\n");
+    x86_runtimeCall("lyn_array_new");
+}
+
+static void x86_arrayLength(void) {
+    fprintf(g_backend->out, "    mov rax, QWORD PTR [rax]\n");
+}
+
+static void x86_arrayLoad(int checked) {
+    if (checked)
+        x86_boundsCheck("rbx", "rax");
+    fprintf(g_backend->out, "    mov rax, QWORD PTR [rbx+rax*8+8]\n");
+}
+
+static void x86_arrayStore(int checked) {
+    fprintf(g_backend->out, "    pop rcx           ; índice\n");
+    fprintf(g_backend->out, "    pop rbx           ; arreglo\n");
+    if (checked)
+        x86_boundsCheck("rbx", "rcx");
+    fprintf(g_backend->out, "    mov QWORD PTR [rbx+rcx*8+8], rax\n");
+    fprintf(g_backend->out, "    mov rax, rbx\n");
+}
+
+static void x86_soaNew(int fields) {
+    fprintf(g_backend->out, "    mov rdi, rax      ; longitud\n");
+    fprintf(g_backend->out, "    mov rsi, %d\n", fields);
+    x86_runtimeCall("lyn_soa_new");
+}
+
+/* --- Strings --- */
+
+static void x86_strBuilderNew(void) {
+    fprintf(g_backend->out, "    mov rdi, rax      ; capacidad\n");
+    x86_runtimeCall("lyn_sb_new");
+}
+
+static void x86_strAppend(int isInt) {
+    fprintf(g_backend->out, "    mov rsi, rax      ; pieza\n");
+    fprintf(g_backend->out, "    mov rdi, QWORD PTR [rsp]    ; constructor\n");
+    x86_runtimeCall(isInt ? "lyn_sb_append_int" : "lyn_sb_append_str");
+}
+
+static void x86_strBuilderFinish(int print) {
+    fprintf(g_backend->out, "    pop rdi           ; constructor\n");
+    x86_runtimeCall(print ? "lyn_sb_print" : "lyn_sb_finish");
+}
+
+static void x86_intToStr(void) {
+    fprintf(g_backend->out, "    mov rdi, rax\n");
+    x86_runtimeCall("lyn_str_from_int");
+}
+
+static void x86_strPrint(void) {
+    fprintf(g_backend->out, "    mov rdi, rax\n");
+    x86_runtimeCall("lyn_str_print");
+}
+
+static void x86_loadString(int id) {
+    fprintf(g_backend->out, "    lea rax, [rip+.LSTR%d]\n", id);
+}
+
+/* --- Funciones y objetos ---
+   Sin marco: los argumentos se leen relativos a rsp (la dirección de
+   retorno ocupa una palabra). */
+
+static void x86_functionBegin(const char *name, int argCount) {
+    (void)argCount;
+    fprintf(g_backend->out, "\n.global %s\n%s:\n", name, name);
+}
+
+static void x86_loadArg(int index, int argCount, int depth) {
+    fprintf(g_backend->out, "    mov rax, QWORD PTR [rsp+%d]    ; argumento %d\n",
+            8 * (depth + argCount - index), index);
+}
+
+static void x86_popThreadLocal(const char *name) {
+    fprintf(g_backend->out, "    pop rcx\n");
+    fprintf(g_backend->out, "    mov %s, rcx\n", x86_threadLocalOperand(name));
+}
+
+static void x86_functionEnd(const char *const *saved, int savedCount) {
+    for (int i = savedCount - 1; i >= 0; i--)
+        x86_popThreadLocal(saved[i]);
+    fprintf(g_backend->out, "    ret\n");
+}
+
+static void x86_call(const char *name, int argCount) {
+    fprintf(g_backend->out, "    call %s\n", name);
+    if (argCount > 0)
+        fprintf(g_backend->out, "    add rsp, %d\n", 8 * argCount);
+}
+
+static void x86_callVirtual(int slot, int argCount) {
+    fprintf(g_backend->out, "    mov rcx, QWORD PTR [rsp+%d]    ; receptor\n", 8 * (argCount - 1));
+    fprintf(g_backend->out, "    mov rcx, QWORD PTR [rcx]       ; vtable\n");
+    fprintf(g_backend->out, "    call QWORD PTR [rcx+%d]\n", 8 * slot);
+    fprintf(g_backend->out, "    add rsp, %d\n", 8 * argCount);
+}
+
+static void x86_objectNew(long size, const char *vtable) {
+    fprintf(g_backend->out, "    mov rdi, %ld\n", size);
+    if (vtable)
+        fprintf(g_backend->out, "    lea rsi, [rip+%s]\n", vtable);
+    else
+        fprintf(g_backend->out, "    xor esi, esi\n");
+    x86_runtimeCall("lyn_object_new");
+}
+
+static void x86_loadField(int offset) {
+    fprintf(g_backend->out, "    mov rax, QWORD PTR [rax+%d]\n", offset);
+}
+
+static void x86_storeField(int offset) {
+    fprintf(g_backend->out, "    mov QWORD PTR [rbx+%d], rax\n", offset);
+}
+
+static void x86_initField(int offset) {
+    x86_popSecondary();
+    x86_storeField(offset);
+    fprintf(g_backend->out, "    mov rax, rbx\n");
+}
+
+static void x86_vtable(const char *label, const char *const *methods, int count) {
+    gasVtable(label, methods, count, 8);
+}
+
+static void x86_staticClosure(const char *label, const char *vtable) {
+    gasStaticClosure(label, vtable, 8);
+}
+
+static void x86_loadStatic(const char *label) {
+    fprintf(g_backend->out, "    lea rax, [rip+%s]\n", label);
+}
+
+/* --- Tipos vectoriales ---
+   vec4i/vec4f usan SSE (xmm, con pmulld de SSE4.1) y vec8i/vec8f AVX2
+   (ymm). Principal = xmm0/ymm0, secundario = xmm1/ymm1. */
+
+static int vecLabelCount = 0;
+
+static int x86_vecBytes(VecType type) {
+    return vecLanes(type) * 4;
+}
+
+static const char *x86_vecReg(VecType type, int index) {
+    static const char *xmm[] = { "xmm0", "xmm1", "xmm2" };
+    static const char *ymm[] = { "ymm0", "ymm1", "ymm2" };
+    return vecLanes(type) == 8 ? ymm[index] : xmm[index];
+}
+
+static const char *x86_vecPtr(VecType type) {
+    return vecLanes(type) == 8 ? "YMMWORD PTR" : "XMMWORD PTR";
+}
+
+static const char *x86_vecMove(VecType type) {
+    return vecLanes(type) == 8 ? "vmovups" : "movups";
+}
+
+/* Carriles en .rodata; retorna el número de la etiqueta .LVEC */
+static int x86_vecData(VecType type, const double *lanes, int isFloat) {
+    int label = vecLabelCount++;
+    fprintf(g_backend->out, "    .pushsection .rodata\n");
+    fprintf(g_backend->out, "    .balign 32\n");
+    fprintf(g_backend->out, ".LVEC%d:\n", label);
+    for (int i = 0; i < vecLanes(type); i++) {
+        if (isFloat)
+            fprintf(g_backend->out, "    .float %.9g\n", lanes[i]);
+        else
+            fprintf(g_backend->out, "    .long %d\n", (int)(long long)lanes[i]);
+    }
+    fprintf(g_backend->out, "    .popsection\n");
+    return label;
+}
+
+static void x86_vecLoad(const char *name, VecType type) {
+    fprintf(g_backend->out, "    %s %s, %s [%s]\n", x86_vecMove(type), x86_vecReg(type, 0),
+            x86_vecPtr(type), name);
+}
+
+static void x86_vecStore(const char *name, VecType type) {
+    fprintf(g_backend->out, "    %s %s [%s], %s\n", x86_vecMove(type), x86_vecPtr(type), name,
+            x86_vecReg(type, 0));
+    /* Fin de la expresión vectorial: evita la penalización AVX -> SSE */
+    if (vecLanes(type) == 8)
+        fprintf(g_backend->out, "    vzeroupper\n");
+}
+
+static void x86_vecConst(VecType type, const double *lanes) {
+    int label = x86_vecData(type, lanes, vecIsFloat(type));
+    fprintf(g_backend->out, "    %s %s, %s [rip+.LVEC%d]\n", x86_vecMove(type),
+            x86_vecReg(type, 0), x86_vecPtr(type), label);
+}
+
+static void x86_vecSplat(VecType type) {
+    if (vecLanes(type) == 8) {
+        if (vecIsFloat(type)) {
+            fprintf(g_backend->out, "    vcvtsi2ss xmm0, xmm0, rax\n");
+            fprintf(g_backend->out, "    vbroadcastss ymm0, xmm0\n");
+        } else {
+            fprintf(g_backend->out, "    vmovd xmm0, eax\n");
+            fprintf(g_backend->out, "    vpbroadcastd ymm0, xmm0\n");
+        }
+    } else if (vecIsFloat(type)) {
+        fprintf(g_backend->out, "    cvtsi2ss xmm0, rax\n");
+        fprintf(g_backend->out, "    shufps xmm0, xmm0, 0\n");
+    } else {
+        fprintf(g_backend->out, "    movd xmm0, eax\n");
+        fprintf(g_backend->out, "    pshufd xmm0, xmm0, 0\n");
+    }
+}
+
+/* Los carriles se copian bajo rsp (zona roja) y se cargan de una vez */
+static void x86_vecFromStack(VecType type) {
+    int lanes = vecLanes(type);
+    for (int i = 0; i < lanes; i++) {
+        int from = 8 * (lanes - 1 - i);
+        if (vecIsFloat(type)) {
+            fprintf(g_backend->out, "    cvtsi2ss xmm2, QWORD PTR [rsp+%d]\n", from);
+            fprintf(g_backend->out, "    movss DWORD PTR [rsp-%d], xmm2\n", 32 - 4 * i);
+        } else {
+            fprintf(g_backend->out, "    mov eax, DWORD PTR [rsp+%d]\n", from);
+            fprintf(g_backend->out, "    mov DWORD PTR [rsp-%d], eax\n", 32 - 4 * i);
+        }
+    }
+    fprintf(g_backend->out, "    %s %s, %s [rsp-32]\n", x86_vecMove(type), x86_vecReg(type, 0),
+            x86_vecPtr(type));
+    fprintf(g_backend->out, "    add rsp, %d\n", 8 * lanes);
+}
+
+static void x86_vecPush(VecType type) {
+    fprintf(g_backend->out, "    sub rsp, %d\n", x86_vecBytes(type));
+    fprintf(g_backend->out, "    %s %s [rsp], %s\n", x86_vecMove(type), x86_vecPtr(type),
+            x86_vecReg(type, 0));
+}
+
+static void x86_vecPopSecondary(VecType type) {
+    fprintf(g_backend->out, "    %s %s, %s [rsp]\n", x86_vecMove(type), x86_vecReg(type, 1),
+            x86_vecPtr(type));
+    fprintf(g_backend->out, "    add rsp, %d\n", x86_vecBytes(type));
+}
+
+static const char *x86_vecOpName(char op, int isFloat) {
+    switch (op) {
+        case '+': return isFloat ? "addps" : "paddd";
+        case '-': return isFloat ? "subps" : "psubd";
+        case '*': return isFloat ? "mulps" : "pmulld";
+        default:  return "divps";
+    }
+}
+
+static void x86_vecBinary(char op, VecType type) {
+    const char *name = x86_vecOpName(op, vecIsFloat(type));
+    if (vecLanes(type) == 8) {
+        /* AVX: tres operandos, ymm0 = ymm1 op ymm0 */
+        fprintf(g_backend->out, "    v%s ymm0, ymm1, ymm0\n", name);
+    } else if (op == '+' || op == '*') {
+        fprintf(g_backend->out, "    %s xmm0, xmm1\n", name);
+    } else {
+        fprintf(g_backend->out, "    %s xmm1, xmm0\n", name);
+        fprintf(g_backend->out, "    movaps xmm0, xmm1\n");
+    }
+}
+
+static void x86_vecShuffle(VecType type, const int *lanes) {
+    if (vecLanes(type) == 4) {
+        int imm = lanes[0] | (lanes[1] << 2) | (lanes[2] << 4) | (lanes[3] << 6);
+        fprintf(g_backend->out, "    pshufd xmm0, xmm0, %d\n", imm);
+        return;
+    }
+    double indices[8];
+    for (int i = 0; i < 8; i++)
+        indices[i] = lanes[i];
+    int label = x86_vecData(type, indices, 0);
+    fprintf(g_backend->out, "    vmovdqu ymm1, YMMWORD PTR [rip+.LVEC%d]\n", label);
+    fprintf(g_backend->out, "    vpermd ymm0, ymm1, ymm0\n");
+}
+
+/* Reducción escalar sobre los carriles copiados en la zona roja */
+static void x86_vecReduce(int reduceOp, VecType type) {
+    int lanes = vecLanes(type);
+    fprintf(g_backend->out, "    %s %s [rsp-32], %s\n", x86_vecMove(type), x86_vecPtr(type),
+            x86_vecReg(type, 0));
+    if (lanes == 8)
+        fprintf(g_backend->out, "    vzeroupper\n");
+    if (vecIsFloat(type)) {
+        const char *name = reduceOp == REDUCE_MIN ? "minss" : reduceOp == REDUCE_MAX ? "maxss" : "addss";
+        fprintf(g_backend->out, "    movss xmm1, DWORD PTR [rsp-32]\n");
+        for (int i = 1; i < lanes; i++)
+            fprintf(g_backend->out, "    %s xmm1, DWORD PTR [rsp-%d]\n", name, 32 - 4 * i);
+        fprintf(g_backend->out, "    cvttss2si rax, xmm1\n");
+        return;
+    }
+    fprintf(g_backend->out, "    mov eax, DWORD PTR [rsp-32]\n");
+    for (int i = 1; i < lanes; i++) {
+        if (reduceOp == REDUCE_ADD) {
+            fprintf(g_backend->out, "    add eax, DWORD PTR [rsp-%d]\n", 32 - 4 * i);
+        } else {
+            fprintf(g_backend->out, "    mov ecx, DWORD PTR [rsp-%d]\n", 32 - 4 * i);
+            fprintf(g_backend->out, "    cmp eax, ecx\n");
+            fprintf(g_backend->out, "    %s eax, ecx\n", reduceOp == REDUCE_MIN ? "cmovg" : "cmovl");
+        }
+    }
+    fprintf(g_backend->out, "    movsxd rax, eax\n");
+}
+
 /* Salto si RAX es 0 a 'label' */
 static void x86_jumpIfZero(const char *label) {
-    fprintf(g_backend->out, "    cmp rax, 0\n");
+    fprintf(g_backend->out, "    test rax, rax\n");
     fprintf(g_backend->out, "    je %s\n", label);
 }
 
@@ -67,28 +543,210 @@ static void x86_emitImul(void) {
 }
 
 /* División entera: rax = L / R.
-   Se mueve R a rcx, L a rax y se hace idiv. */
+   Se mueve R a rcx, L a rax, se extiende el signo a rdx y se hace idiv. */
 static void x86_emitIDiv(void) {
     fprintf(g_backend->out, "    mov rcx, rax    ; divisor en rcx (R)\n");
     fprintf(g_backend->out, "    mov rax, rbx    ; dividendo en rax (L)\n");
-    fprintf(g_backend->out, "    xor rdx, rdx\n");
+    fprintf(g_backend->out, "    cqo\n");
     fprintf(g_backend->out, "    idiv rcx        ; rax = L / R\n");
 }
 
+/* Módulo entero: rax = L % R (el resto de idiv queda en rdx) */
+static void x86_emitIMod(void) {
+    fprintf(g_backend->out, "    mov rcx, rax    ; divisor en rcx (R)\n");
+    fprintf(g_backend->out, "    mov rax, rbx    ; dividendo en rax (L)\n");
+    fprintf(g_backend->out, "    cqo\n");
+    fprintf(g_backend->out, "    idiv rcx\n");
+    fprintf(g_backend->out, "    mov rax, rdx    ; rax = L %% R\n");
+}
+
+/* --- Reducción de fuerza (operando en RAX, constante conocida) --- */
+
+/* Indica si la constante cabe en un inmediato de 32 bits con signo */
+static int x86_fitsImm32(long value) {
+    return value >= -2147483648L && value <= 2147483647L;
+}
+
+/* Multiplicación por constante: shl/lea/add en lugar de imul cuando es posible */
+static void x86_emitMulConst(long value) {
+    unsigned long mag = (value < 0) ? 0UL - (unsigned long)value : (unsigned long)value;
+    int neg = value < 0;
+    int k;
+    if (value == 0) {
+        fprintf(g_backend->out, "    xor eax, eax    ; rax = L * 0\n");
+        return;
+    }
+    if (mag == 1) {
+        /* Nada que hacer salvo el signo */
+    } else if ((k = exactLog2((long)mag)) >= 0) {
+        fprintf(g_backend->out, "    shl rax, %d      ; rax = L * %lu\n", k, mag);
+    } else if (mag == 3 || mag == 5 || mag == 9) {
+        fprintf(g_backend->out, "    lea rax, [rax+rax*%lu]    ; rax = L * %lu\n", mag - 1, mag);
+    } else if ((mag % 3 == 0 && (k = exactLog2((long)(mag / 3))) >= 0) ||
+               (mag % 5 == 0 && (k = exactLog2((long)(mag / 5))) >= 0) ||
+               (mag % 9 == 0 && (k = exactLog2((long)(mag / 9))) >= 0)) {
+        unsigned long base = mag >> k;
+        fprintf(g_backend->out, "    lea rax, [rax+rax*%lu]\n", base - 1);
+        fprintf(g_backend->out, "    shl rax, %d      ; rax = L * %lu\n", k, mag);
+    } else if ((k = exactLog2((long)(mag - 1))) >= 0) {
+        fprintf(g_backend->out, "    mov rcx, rax\n");
+        fprintf(g_backend->out, "    shl rax, %d\n", k);
+        fprintf(g_backend->out, "    add rax, rcx    ; rax = L * %lu\n", mag);
+    } else if ((k = exactLog2((long)(mag + 1))) >= 0) {
+        fprintf(g_backend->out, "    mov rcx, rax\n");
+        fprintf(g_backend->out, "    shl rax, %d\n", k);
+        fprintf(g_backend->out, "    sub rax, rcx    ; rax = L * %lu\n", mag);
+    } else {
+        if (x86_fitsImm32(value)) {
+            fprintf(g_backend->out, "    imul rax, rax, %ld\n", value);
+        } else {
+            fprintf(g_backend->out, "    mov rcx, %ld\n", value);
+            fprintf(g_backend->out, "    imul rax, rcx\n");
+        }
+        return;
+    }
+    if (neg)
+        fprintf(g_backend->out, "    neg rax\n");
+}
+
+/* Cociente de RAX / 2^k truncado hacia cero (k >= 1).
+   Se suma 2^k - 1 a los dividendos negativos antes del desplazamiento. */
+static void x86_emitDivPow2(int k) {
+    fprintf(g_backend->out, "    mov rcx, rax\n");
+    fprintf(g_backend->out, "    sar rcx, 63\n");
+    fprintf(g_backend->out, "    shr rcx, %d\n", 64 - k);
+    fprintf(g_backend->out, "    add rax, rcx\n");
+    fprintf(g_backend->out, "    sar rax, %d      ; rax = L / %ld\n", k, 1L << k);
+}
+
+/* Cociente por número mágico: deja q en RAX y conserva el dividendo en RCX */
+static void x86_emitDivMagic(long value, const DivMagic *magic) {
+    fprintf(g_backend->out, "    mov rcx, rax    ; rcx = L\n");
+    fprintf(g_backend->out, "    mov rax, %ld\n", magic->multiplier);
+    fprintf(g_backend->out, "    imul rcx        ; rdx = (L * M) >> 64\n");
+    if (magic->addDividend)
+        fprintf(g_backend->out, "    add rdx, rcx\n");
+    if (magic->subDividend)
+        fprintf(g_backend->out, "    sub rdx, rcx\n");
+    if (magic->shift > 0)
+        fprintf(g_backend->out, "    sar rdx, %d\n", magic->shift);
+    fprintf(g_backend->out, "    mov rax, rdx\n");
+    fprintf(g_backend->out, "    shr rax, 63\n");
+    fprintf(g_backend->out, "    add rax, rdx    ; rax = L / %ld\n", value);
+}
+
+/* División por constante: desplazamientos o multiplicación alta con número mágico */
+static void x86_emitDivConst(long value) {
+    DivMagic magic;
+    int k = exactLog2(value);
+    if (value == 1)
+        return;
+    if (value == -1) {
+        fprintf(g_backend->out, "    neg rax\n");
+    } else if (k > 0 && k < 63) {
+        x86_emitDivPow2(k);
+        if (value < 0)
+            fprintf(g_backend->out, "    neg rax\n");
+    } else if (computeDivMagic(value, 64, &magic)) {
+        x86_emitDivMagic(value, &magic);
+    } else {
+        fprintf(g_backend->out, "    mov rbx, rax\n");
+        x86_loadImmInt(value);
+        x86_emitIDiv();
+    }
+}
+
+/* Módulo por constante: máscara con corrección de signo o L - (L / c) * c */
+static void x86_emitModConst(long value) {
+    DivMagic magic;
+    int k = exactLog2(value);
+    if (value == 1 || value == -1) {
+        fprintf(g_backend->out, "    xor eax, eax    ; rax = L %% %ld\n", value);
+    } else if (k > 0 && k < 32) {
+        fprintf(g_backend->out, "    mov rcx, rax\n");
+        fprintf(g_backend->out, "    sar rcx, 63\n");
+        fprintf(g_backend->out, "    shr rcx, %d\n", 64 - k);
+        fprintf(g_backend->out, "    add rcx, rax\n");
+        fprintf(g_backend->out, "    and rcx, %ld\n", -(1L << k));
+        fprintf(g_backend->out, "    sub rax, rcx    ; rax = L %% %ld\n", value);
+    } else if (x86_fitsImm32(value) && computeDivMagic(value, 64, &magic)) {
+        x86_emitDivMagic(value, &magic);
+        fprintf(g_backend->out, "    imul rax, rax, %ld\n", value);
+        fprintf(g_backend->out, "    sub rcx, rax\n");
+        fprintf(g_backend->out, "    mov rax, rcx    ; rax = L %% %ld\n", value);
+    } else {
+        fprintf(g_backend->out, "    mov rbx, rax\n");
+        x86_loadImmInt(value);
+        x86_emitIMod();
+    }
+}
+
 /* Instancia de la vtable para x86_64 */
 static ArchBackend g_x86_64Backend = {
     .out = NULL,
     .emitLoadImmInt = x86_loadImmInt,
     .emitStoreGlobal = x86_storeGlobal,
     .emitLoadGlobal = x86_loadGlobal,
-    .emitCmpGreater = x86_cmpGreater,
+    .emitPushPrimary = x86_pushPrimary,
+    .emitPopSecondary = x86_popSecondary,
+    .emitCompare = x86_compare,
     .emitSetLabel = x86_setLabel,
     .emitJump = x86_jump,
     .emitJumpIfZero = x86_jumpIfZero,
+    .emitCompareJumpIfFalse = x86_compareJumpIfFalse,
     .emitAdd = x86_emitAdd,
     .emitSub = x86_emitSub,
     .emitImul = x86_emitImul,
-    .emitIDiv = x86_emitIDiv
+    .emitIDiv = x86_emitIDiv,
+    .emitIMod = x86_emitIMod,
+    .emitMulConst = x86_emitMulConst,
+    .emitDivConst = x86_emitDivConst,
+    .emitModConst = x86_emitModConst,
+    .emitLoadThreadLocal = x86_loadThreadLocal,
+    .emitStoreThreadLocal = x86_storeThreadLocal,
+    .emitChunkBegin = x86_chunkBegin,
+    .emitChunkEnd = x86_chunkEnd,
+    .emitParallelFor = x86_parallelFor,
+    .emitTaskEntry = x86_taskEntry,
+    .emitNativeEntry = x86_nativeEntry,
+    .emitSpawn = x86_spawn,
+    .emitAwait = x86_await,
+    .emitVecLoad = x86_vecLoad,
+    .emitVecStore = x86_vecStore,
+    .emitVecConst = x86_vecConst,
+    .emitVecSplat = x86_vecSplat,
+    .emitVecFromStack = x86_vecFromStack,
+    .emitVecPush = x86_vecPush,
+    .emitVecPopSecondary = x86_vecPopSecondary,
+    .emitVecBinary = x86_vecBinary,
+    .emitVecShuffle = x86_vecShuffle,
+    .emitVecReduce = x86_vecReduce,
+    .emitArrayNew = x86_arrayNew,
+    .emitArrayLength = x86_arrayLength,
+    .emitArrayLoad = x86_arrayLoad,
+    .emitArrayStore = x86_arrayStore,
+    .emitSoaNew = x86_soaNew,
+    .emitStrBuilderNew = x86_strBuilderNew,
+    .emitStrAppend = x86_strAppend,
+    .emitStrBuilderFinish = x86_strBuilderFinish,
+    .emitIntToStr = x86_intToStr,
+    .emitStrPrint = x86_strPrint,
+    .emitLoadString = x86_loadString,
+    .emitStringData = gasStringData,
+    .emitStringAlias = gasStringAlias,
+    .emitFunctionBegin = x86_functionBegin,
+    .emitLoadArg = x86_loadArg,
+    .emitPopThreadLocal = x86_popThreadLocal,
+    .emitFunctionEnd = x86_functionEnd,
+    .emitCall = x86_call,
+    .emitCallVirtual = x86_callVirtual,
+    .emitObjectNew = x86_objectNew,
+    .emitLoadField = x86_loadField,
+    .emitStoreField = x86_storeField,
+    .emitInitField = x86_initField,
+    .emitVtable = x86_vtable,
+    .emitStaticClosure = x86_staticClosure,
+    .emitLoadStatic = x86_loadStatic
 };
 
 /* Función para crear el backend x86_64. Se configura la salida (FILE *) */
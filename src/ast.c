@@ -27,6 +27,7 @@ AstNode *createAstNode(AstNodeType type) {
         case AST_VAR_ASSIGN:
             memset(node->varAssign.name, 0, sizeof(node->varAssign.name));
             node->varAssign.initializer = NULL;
+            node->varAssign.fieldOffset = -1;
             break;
         case AST_VAR_DECL:
             memset(node->varDecl.name, 0, sizeof(node->varDecl.name));
@@ -36,6 +37,7 @@ AstNode *createAstNode(AstNodeType type) {
         case AST_FUNC_DEF:
             memset(node->funcDef.name, 0, sizeof(node->funcDef.name));
             node->funcDef.parameters = NULL;
+            node->funcDef.paramTypes = NULL;
             node->funcDef.paramCount = 0;
             memset(node->funcDef.returnType, 0, sizeof(node->funcDef.returnType));
             node->funcDef.body = NULL;
@@ -45,21 +47,32 @@ AstNode *createAstNode(AstNodeType type) {
             memset(node->funcCall.name, 0, sizeof(node->funcCall.name));
             node->funcCall.arguments = NULL;
             node->funcCall.argCount = 0;
+            node->funcCall.kind = CALL_FUNCTION;
+            memset(node->funcCall.target, 0, sizeof(node->funcCall.target));
+            node->funcCall.slot = -1;
+            node->funcCall.callee = NULL;
             break;
         case AST_RETURN_STMT:
             node->returnStmt.expr = NULL;
             break;
         case AST_PRINT_STMT:
             node->printStmt.expr = NULL;
+            node->printStmt.isString = 0;
             break;
         case AST_LAMBDA:
             node->lambda.parameters = NULL;
             node->lambda.paramCount = 0;
+            node->lambda.paramTypes = NULL;
             memset(node->lambda.returnType, 0, sizeof(node->lambda.returnType));
             node->lambda.body = NULL;
+            node->lambda.id = -1;
+            node->lambda.captures = NULL;
+            node->lambda.captureCount = 0;
             break;
         case AST_CLASS_DEF:
             memset(node->classDef.name, 0, sizeof(node->classDef.name));
+            memset(node->classDef.parent, 0, sizeof(node->classDef.parent));
+            node->classDef.soa = 0;
             node->classDef.members = NULL;
             node->classDef.memberCount = 0;
             break;
@@ -76,6 +89,9 @@ AstNode *createAstNode(AstNodeType type) {
             node->forStmt.rangeEnd = NULL;
             node->forStmt.body = NULL;
             node->forStmt.bodyCount = 0;
+            node->forStmt.parallel = 0;
+            node->forStmt.reduceOp = REDUCE_NONE;
+            memset(node->forStmt.reduceVar, 0, sizeof(node->forStmt.reduceVar));
             break;
         case AST_IMPORT:
             memset(node->importStmt.moduleType, 0, sizeof(node->importStmt.moduleType));
@@ -89,8 +105,12 @@ AstNode *createAstNode(AstNodeType type) {
             node->binaryOp.left = NULL;
             node->binaryOp.op = '\0';
             node->binaryOp.right = NULL;
+            node->binaryOp.leftString = 0;
+            node->binaryOp.rightString = 0;
             break;
         case AST_NUMBER_LITERAL:
+            node->numberLiteral.isFloat = 0;
+            node->numberLiteral.intValue = 0;
             node->numberLiteral.value = 0;
             break;
         case AST_STRING_LITERAL:
@@ -102,6 +122,8 @@ AstNode *createAstNode(AstNodeType type) {
         case AST_MEMBER_ACCESS:
             node->memberAccess.object = NULL;
             memset(node->memberAccess.member, 0, sizeof(node->memberAccess.member));
+            node->memberAccess.offset = -1;
+            node->memberAccess.column = -1;
             break;
         case AST_METHOD_CALL:
             node->methodCall.object = NULL;
@@ -109,6 +131,31 @@ AstNode *createAstNode(AstNodeType type) {
             node->methodCall.arguments = NULL;
             node->methodCall.argCount = 0;
             break;
+        case AST_SPAWN:
+            node->spawnExpr.call = NULL;
+            break;
+        case AST_AWAIT:
+            node->awaitExpr.future = NULL;
+            break;
+        case AST_INDEX:
+            node->indexExpr.array = NULL;
+            node->indexExpr.index = NULL;
+            node->indexExpr.checked = 1;
+            break;
+        case AST_INDEX_ASSIGN:
+            memset(node->indexAssign.name, 0, sizeof(node->indexAssign.name));
+            node->indexAssign.index = NULL;
+            node->indexAssign.value = NULL;
+            node->indexAssign.checked = 1;
+            memset(node->indexAssign.field, 0, sizeof(node->indexAssign.field));
+            node->indexAssign.fieldOffset = -1;
+            node->indexAssign.column = -1;
+            break;
+        case AST_STRING_BUILD:
+            node->stringBuild.pieces = NULL;
+            node->stringBuild.intPiece = NULL;
+            node->stringBuild.pieceCount = 0;
+            break;
         default:
             break;
     }
@@ -139,6 +186,8 @@ void freeAstNode(AstNode *node) {
             }
             if (node->funcDef.parameters)
                 memory_free(node->funcDef.parameters);
+            if (node->funcDef.paramTypes)
+                memory_free(node->funcDef.paramTypes);
             for (int i = 0; i < node->funcDef.bodyCount; i++) {
                 freeAstNode(node->funcDef.body[i]);
             }
@@ -164,6 +213,10 @@ void freeAstNode(AstNode *node) {
             }
             if (node->lambda.parameters)
                 memory_free(node->lambda.parameters);
+            if (node->lambda.paramTypes)
+                memory_free(node->lambda.paramTypes);
+            if (node->lambda.captures)
+                memory_free(node->lambda.captures);
             freeAstNode(node->lambda.body);
             break;
         case AST_CLASS_DEF:
@@ -208,6 +261,29 @@ void freeAstNode(AstNode *node) {
             freeAstNode(node->binaryOp.left);
             freeAstNode(node->binaryOp.right);
             break;
+        case AST_SPAWN:
+            freeAstNode(node->spawnExpr.call);
+            break;
+        case AST_AWAIT:
+            freeAstNode(node->awaitExpr.future);
+            break;
+        case AST_INDEX:
+            freeAstNode(node->indexExpr.array);
+            freeAstNode(node->indexExpr.index);
+            break;
+        case AST_INDEX_ASSIGN:
+            freeAstNode(node->indexAssign.index);
+            freeAstNode(node->indexAssign.value);
+            break;
+        case AST_STRING_BUILD:
+            for (int i = 0; i < node->stringBuild.pieceCount; i++) {
+                freeAstNode(node->stringBuild.pieces[i]);
+            }
+            if (node->stringBuild.pieces)
+                memory_free(node->stringBuild.pieces);
+            if (node->stringBuild.intPiece)
+                memory_free(node->stringBuild.intPiece);
+            break;
         case AST_NUMBER_LITERAL:
         case AST_STRING_LITERAL:
         case AST_IDENTIFIER:
@@ -220,3 +296,46 @@ void freeAstNode(AstNode *node) {
     }
     memory_free(node);
 }
+
+/* Tipos vectoriales */
+VecType vecTypeFromName(const char *name) {
+    if (strcmp(name, "vec4i") == 0) return VEC_4I;
+    if (strcmp(name, "vec4f") == 0) return VEC_4F;
+    if (strcmp(name, "vec8i") == 0) return VEC_8I;
+    if (strcmp(name, "vec8f") == 0) return VEC_8F;
+    return VEC_NONE;
+}
+
+int vecLanes(VecType type) {
+    return (type == VEC_8I || type == VEC_8F) ? 8 : 4;
+}
+
+int vecIsFloat(VecType type) {
+    return type == VEC_4F || type == VEC_8F;
+}
+
+/* Literales string */
+size_t decodeStringLiteral(const char *text, char *out) {
+    size_t n = 0;
+    for (const char *p = text; *p; p++) {
+        if (*p != '\\' || !p[1]) {
+            out[n++] = *p;
+            continue;
+        }
+        switch (*++p) {
+            case 'n':  out[n++] = '\n'; break;
+            case 't':  out[n++] = '\t'; break;
+            case 'r':  out[n++] = '\r'; break;
+            case '0':  out[n++] = '\0'; break;
+            case '\\': out[n++] = '\\'; break;
+            case '\'': out[n++] = '\''; break;
+            case '"':  out[n++] = '"'; break;
+            default:
+                /* Escape desconocido: se conserva literalmente */
+                out[n++] = '\\';
+                out[n++] = *p;
+                break;
+        }
+    }
+    return n;
+}
@@ -23,9 +23,46 @@ typedef enum {
     AST_STRING_LITERAL,
     AST_IDENTIFIER,
     AST_MEMBER_ACCESS,
-    AST_METHOD_CALL
+    AST_METHOD_CALL,
+    AST_SPAWN,
+    AST_AWAIT,
+    AST_INDEX,
+    AST_INDEX_ASSIGN,
+    AST_STRING_BUILD
 } AstNodeType;
 
+/* Operador de reducción de un 'parallel for'. Los valores coinciden con
+   LYN_REDUCE_* del runtime, que recibe el operador tal cual. */
+typedef enum {
+    REDUCE_NONE = 0,
+    REDUCE_ADD,
+    REDUCE_MUL,
+    REDUCE_MIN,
+    REDUCE_MAX
+} ReduceOp;
+
+/* Tipos vectoriales SIMD: carriles de 32 bits enteros o float. El nombre
+   del tipo ("vec4f") es también el de su constructor. */
+typedef enum {
+    VEC_NONE = 0,
+    VEC_4I,
+    VEC_4F,
+    VEC_8I,
+    VEC_8F
+} VecType;
+
+/* Destino de una llamada, resuelto por el análisis semántico con el
+   análisis de la jerarquía de clases */
+typedef enum {
+    CALL_FUNCTION = 0,  /* Función de nivel superior, predefinida o externa */
+    CALL_METHOD,        /* Método con una sola implementación posible: llamada directa */
+    CALL_VIRTUAL,       /* Método redefinido en alguna subclase: por la vtable */
+    CALL_NEW,           /* Constructor: reserva el objeto y llama a __init__ si existe */
+    CALL_SOA_ARRAY,     /* array(n) de una clase @soa (target = la clase): una columna por campo */
+    CALL_LAMBDA,        /* Variable cuyo valor es siempre la misma lambda (callee): directa */
+    CALL_CLOSURE        /* Variable con una clausura desconocida: por su registro */
+} CallKind;
+
 /* Declaración adelantada para usar en MethodCallNode */
 typedef struct AstNode AstNode;
 
@@ -48,6 +85,7 @@ struct AstNode {
         struct {
             char name[256];
             AstNode *initializer;
+            int fieldOffset;      /* 'obj.campo = v': posición del campo (-1 si es una variable) */
         } varAssign;
         struct {
             char name[256];
@@ -57,6 +95,7 @@ struct AstNode {
         struct {
             char name[256];
             AstNode **parameters;
+            char (*paramTypes)[64];   /* Tipo declarado de cada parámetro */
             int paramCount;
             char returnType[64];
             AstNode **body;
@@ -66,21 +105,33 @@ struct AstNode {
             char name[256];
             AstNode **arguments;
             int argCount;
+            CallKind kind;
+            char target[256];     /* Símbolo del método o de __init__ ("" si no hay) */
+            int slot;             /* Hueco de la vtable si kind == CALL_VIRTUAL */
+            AstNode *callee;      /* FUNC_DEF del método si kind == CALL_METHOD, LAMBDA si
+                                     kind == CALL_LAMBDA (no se libera) */
         } funcCall;
         struct {
             AstNode *expr;
         } returnStmt;
         struct {
             AstNode *expr;
+            int isString;         /* 1 si el análisis semántico vio un string */
         } printStmt;
         struct {
             AstNode **parameters;
             int paramCount;
+            char (*paramTypes)[64];   /* Tipo declarado de cada parámetro */
             char returnType[64];
             AstNode *body;
+            int id;                   /* Número de la función '__lyn_lambda_<id>' */
+            char (*captures)[256];    /* Variables locales de fuera que lee el cuerpo */
+            int captureCount;
         } lambda;
         struct {
             char name[256];
+            char parent[256];     /* Clase base ("" si no hereda) */
+            int soa;              /* @soa: sus arreglos se guardan por columnas */
             AstNode **members;
             int memberCount;
         } classDef;
@@ -97,6 +148,9 @@ struct AstNode {
             AstNode *rangeEnd;
             AstNode **body;
             int bodyCount;
+            int parallel;           /* 1 si es 'parallel for' */
+            ReduceOp reduceOp;      /* Reducción sobre reduceVar (REDUCE_NONE si no hay) */
+            char reduceVar[256];
         } forStmt;
         struct {
             char moduleType[64];
@@ -110,9 +164,13 @@ struct AstNode {
             AstNode *left;
             char op;
             AstNode *right;
+            int leftString;       /* '+' de strings: 1 si el operando es un string */
+            int rightString;      /* (lo fija el análisis semántico) */
         } binaryOp;
         struct {
-            double value;
+            int isFloat;          /* 1 si el literal es double, 0 si es entero */
+            long long intValue;   /* Valor exacto de 64 bits si !isFloat */
+            double value;         /* Valor si isFloat */
         } numberLiteral;
         struct {
             char value[256];
@@ -123,8 +181,35 @@ struct AstNode {
         struct {
             AstNode *object;
             char member[256];
+            int offset;           /* Posición del campo en el objeto (-1 si no se resolvió) */
+            int column;           /* Columna del campo si el objeto es un arreglo @soa (-1 si no) */
         } memberAccess;
         MethodCallNode methodCall;
+        struct {
+            AstNode *call;        /* AST_FUNC_CALL lanzada como tarea */
+        } spawnExpr;
+        struct {
+            AstNode *future;
+        } awaitExpr;
+        struct {
+            AstNode *array;
+            AstNode *index;
+            int checked;          /* 0 si el análisis de rangos probó el acceso */
+        } indexExpr;
+        struct {
+            char name[256];       /* Variable que contiene el arreglo */
+            AstNode *index;
+            AstNode *value;
+            int checked;
+            char field[256];      /* 'arr[i].campo = v' ("" si se escribe el elemento) */
+            int fieldOffset;      /* Posición del campo en el objeto del elemento */
+            int column;           /* Columna del campo si el arreglo es @soa (-1 si no) */
+        } indexAssign;
+        struct {
+            AstNode **pieces;     /* Cadena de '+' aplanada tras el análisis semántico */
+            int *intPiece;        /* 1 si la pieza es un entero que se añade en decimal */
+            int pieceCount;
+        } stringBuild;
     };
 };
 
@@ -143,4 +228,29 @@ AstNode *createAstNode(AstNodeType type);
  */
 void freeAstNode(AstNode *node);
 
+/**
+ * @brief Tipo vectorial con ese nombre ("vec4i", "vec4f", "vec8i", "vec8f").
+ *
+ * @return VecType VEC_NONE si el nombre no es un tipo vectorial.
+ */
+VecType vecTypeFromName(const char *name);
+
+/** @brief Número de carriles del tipo vectorial (4 u 8). */
+int vecLanes(VecType type);
+
+/** @brief 1 si los carriles del tipo vectorial son float. */
+int vecIsFloat(VecType type);
+
+/**
+ * @brief Resuelve los escapes del texto de un literal string.
+ *
+ * El lexer guarda el texto tal cual. Un escape desconocido se conserva
+ * literalmente y no se añade el '\0' final.
+ *
+ * @param text Texto del literal (stringLiteral.value).
+ * @param out Destino, con al menos strlen(text) bytes.
+ * @return size_t Número de bytes escritos.
+ */
+size_t decodeStringLiteral(const char *text, char *out);
+
 #endif /* AST_H */
@@ -0,0 +1,459 @@
+/* bounds.c */
+#include "bounds.h"
+#include "ast.h"
+#include "memory.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+/* ============================
+   Estadísticas
+   ============================ */
+
+static BoundsStats stats;
+
+void boundsResetStats(void) {
+    memset(&stats, 0, sizeof(stats));
+}
+
+const BoundsStats *boundsGetStats(void) {
+    return &stats;
+}
+
+void boundsDumpStats(void) {
+    printf("Bounds Check Stats:\n");
+    printf("  Array accesses    : %zu\n", stats.accesses);
+    printf("  Checks eliminated : %zu\n", stats.eliminated);
+}
+
+/* ============================
+   Conjuntos de nombres
+   ============================ */
+
+typedef struct Name {
+    char name[256];
+    struct Name *next;
+} Name;
+
+static Name *clobbered = NULL;   /* Variables escritas por funciones o lambdas */
+static int spawns = 0;           /* El programa lanza tareas */
+
+static int hasName(Name *set, const char *name) {
+    for (Name *n = set; n; n = n->next) {
+        if (strcmp(n->name, name) == 0)
+            return 1;
+    }
+    return 0;
+}
+
+static void addName(Name **set, const char *name) {
+    if (hasName(*set, name))
+        return;
+    Name *n = (Name *)memory_alloc(sizeof(Name));
+    strncpy(n->name, name, sizeof(n->name) - 1);
+    n->name[sizeof(n->name) - 1] = '\0';
+    n->next = *set;
+    *set = n;
+}
+
+static void freeNames(Name **set) {
+    while (*set) {
+        Name *next = (*set)->next;
+        memory_free(*set);
+        *set = next;
+    }
+}
+
+/* ============================
+   Escrituras y llamadas
+   ============================ */
+
+static void collectWrites(AstNode *node, Name **set);
+
+static void collectWritesList(AstNode **nodes, int count, Name **set) {
+    for (int i = 0; i < count; i++)
+        collectWrites(nodes[i], set);
+}
+
+/* Variables que 'node' puede reasignar (no cuenta escribir elementos) */
+static void collectWrites(AstNode *node, Name **set) {
+    if (!node)
+        return;
+    switch (node->type) {
+        case AST_VAR_ASSIGN:
+            addName(set, node->varAssign.name);
+            break;
+        case AST_VAR_DECL:
+            addName(set, node->varDecl.name);
+            break;
+        case AST_IF_STMT:
+            collectWritesList(node->ifStmt.thenBranch, node->ifStmt.thenCount, set);
+            collectWritesList(node->ifStmt.elseBranch, node->ifStmt.elseCount, set);
+            break;
+        case AST_FOR_STMT:
+            addName(set, node->forStmt.iterator);
+            if (node->forStmt.reduceOp != REDUCE_NONE)
+                addName(set, node->forStmt.reduceVar);
+            collectWritesList(node->forStmt.body, node->forStmt.bodyCount, set);
+            break;
+        case AST_FUNC_DEF:
+            collectWritesList(node->funcDef.body, node->funcDef.bodyCount, set);
+            break;
+        case AST_CLASS_DEF:
+            collectWritesList(node->classDef.members, node->classDef.memberCount, set);
+            break;
+        default:
+            break;
+    }
+}
+
+/* Recoge lo que escriben las funciones y lambdas del programa y si se
+   lanzan tareas */
+static void scanProgram(AstNode *node) {
+    if (!node)
+        return;
+    switch (node->type) {
+        case AST_FUNC_DEF:
+            collectWrites(node, &clobbered);
+            for (int i = 0; i < node->funcDef.bodyCount; i++)
+                scanProgram(node->funcDef.body[i]);
+            break;
+        case AST_CLASS_DEF:
+            for (int i = 0; i < node->classDef.memberCount; i++)
+                scanProgram(node->classDef.members[i]);
+            break;
+        case AST_LAMBDA:
+            /* El cuerpo de una lambda es una expresión: no asigna */
+            scanProgram(node->lambda.body);
+            break;
+        case AST_SPAWN:
+            spawns = 1;
+            break;
+        case AST_VAR_ASSIGN:
+            scanProgram(node->varAssign.initializer);
+            break;
+        case AST_VAR_DECL:
+            scanProgram(node->varDecl.initializer);
+            break;
+        case AST_PRINT_STMT:
+            scanProgram(node->printStmt.expr);
+            break;
+        case AST_RETURN_STMT:
+            scanProgram(node->returnStmt.expr);
+            break;
+        case AST_BINARY_OP:
+            scanProgram(node->binaryOp.left);
+            scanProgram(node->binaryOp.right);
+            break;
+        case AST_FUNC_CALL:
+            for (int i = 0; i < node->funcCall.argCount; i++)
+                scanProgram(node->funcCall.arguments[i]);
+            break;
+        case AST_IF_STMT:
+            for (int i = 0; i < node->ifStmt.thenCount; i++)
+                scanProgram(node->ifStmt.thenBranch[i]);
+            for (int i = 0; i < node->ifStmt.elseCount; i++)
+                scanProgram(node->ifStmt.elseBranch[i]);
+            break;
+        case AST_FOR_STMT:
+            for (int i = 0; i < node->forStmt.bodyCount; i++)
+                scanProgram(node->forStmt.body[i]);
+            break;
+        case AST_PROGRAM:
+            for (int i = 0; i < node->program.statementCount; i++)
+                scanProgram(node->program.statements[i]);
+            break;
+        default:
+            break;
+    }
+}
+
+static int hasCall(AstNode *node);
+
+static int hasCallList(AstNode **nodes, int count) {
+    for (int i = 0; i < count; i++) {
+        if (hasCall(nodes[i]))
+            return 1;
+    }
+    return 0;
+}
+
+/* Retorna 1 si 'node' puede ejecutar código de otra función. 'len',
+   'array', 'to_str' y las cadenas de strings son del runtime y no tocan
+   variables. */
+static int hasCall(AstNode *node) {
+    if (!node)
+        return 0;
+    switch (node->type) {
+        case AST_FUNC_CALL:
+            if (strcmp(node->funcCall.name, "len") != 0 &&
+                strcmp(node->funcCall.name, "array") != 0 &&
+                strcmp(node->funcCall.name, "to_str") != 0)
+                return 1;
+            return hasCallList(node->funcCall.arguments, node->funcCall.argCount);
+        case AST_METHOD_CALL:
+        case AST_SPAWN:
+        case AST_AWAIT:
+            return 1;
+        case AST_BINARY_OP:
+            return hasCall(node->binaryOp.left) || hasCall(node->binaryOp.right);
+        case AST_ARRAY_LITERAL:
+            return hasCallList(node->arrayLiteral.elements, node->arrayLiteral.elementCount);
+        case AST_STRING_BUILD:
+            return hasCallList(node->stringBuild.pieces, node->stringBuild.pieceCount);
+        case AST_INDEX:
+            return hasCall(node->indexExpr.array) || hasCall(node->indexExpr.index);
+        case AST_INDEX_ASSIGN:
+            return hasCall(node->indexAssign.index) || hasCall(node->indexAssign.value);
+        case AST_MEMBER_ACCESS:
+            return hasCall(node->memberAccess.object);
+        case AST_VAR_ASSIGN:
+            return hasCall(node->varAssign.initializer);
+        case AST_VAR_DECL:
+            return hasCall(node->varDecl.initializer);
+        case AST_PRINT_STMT:
+            return hasCall(node->printStmt.expr);
+        case AST_RETURN_STMT:
+            return hasCall(node->returnStmt.expr);
+        case AST_IF_STMT:
+            return hasCall(node->ifStmt.condition) ||
+                   hasCallList(node->ifStmt.thenBranch, node->ifStmt.thenCount) ||
+                   hasCallList(node->ifStmt.elseBranch, node->ifStmt.elseCount);
+        case AST_FOR_STMT:
+            return hasCall(node->forStmt.rangeStart) || hasCall(node->forStmt.rangeEnd) ||
+                   hasCallList(node->forStmt.body, node->forStmt.bodyCount);
+        default:
+            return 0;
+    }
+}
+
+/* ============================
+   Hechos de rango
+   Dentro del cuerpo de un bucle: lo <= iterator < len(array) - margin.
+   ============================ */
+
+typedef struct Fact {
+    const char *iterator;
+    const char *array;
+    long long lo;
+    long long margin;
+    struct Fact *next;
+} Fact;
+
+static Fact *facts = NULL;
+
+static int literalValue(AstNode *node, long long *out) {
+    if (!node || node->type != AST_NUMBER_LITERAL || node->numberLiteral.isFloat)
+        return 0;
+    *out = node->numberLiteral.intValue;
+    return 1;
+}
+
+/* Reconoce len(a) y len(a) - k con k >= 0; retorna el nombre del arreglo */
+static const char *lengthBound(AstNode *end, long long *margin) {
+    *margin = 0;
+    if (end && end->type == AST_BINARY_OP && end->binaryOp.op == '-') {
+        if (!literalValue(end->binaryOp.right, margin) || *margin < 0)
+            return NULL;
+        end = end->binaryOp.left;
+    }
+    if (!end || end->type != AST_FUNC_CALL || strcmp(end->funcCall.name, "len") != 0 ||
+        end->funcCall.argCount != 1)
+        return NULL;
+    AstNode *array = end->funcCall.arguments[0];
+    return array->type == AST_IDENTIFIER ? array->identifier.name : NULL;
+}
+
+/* Construye el hecho de un bucle si se puede demostrar; 0 si no */
+static int loopFact(AstNode *loop, Fact *fact) {
+    long long margin;
+    const char *array = lengthBound(loop->forStmt.rangeEnd, &margin);
+    if (!array || !literalValue(loop->forStmt.rangeStart, &fact->lo))
+        return 0;
+    const char *iterator = loop->forStmt.iterator;
+    if (strcmp(iterator, array) == 0)
+        return 0;
+    /* El cuerpo no puede mover el iterador ni cambiar de arreglo */
+    Name *writes = NULL;
+    collectWritesList(loop->forStmt.body, loop->forStmt.bodyCount, &writes);
+    int safe = !hasName(writes, iterator) && !hasName(writes, array);
+    freeNames(&writes);
+    /* Ni puede hacerlo otra función llamada desde el cuerpo o en otro hilo */
+    if (safe && (hasName(clobbered, iterator) || hasName(clobbered, array)) &&
+        (spawns || hasCallList(loop->forStmt.body, loop->forStmt.bodyCount)))
+        safe = 0;
+    if (!safe)
+        return 0;
+    fact->iterator = iterator;
+    fact->array = array;
+    fact->margin = margin;
+    return 1;
+}
+
+/* Desplazamiento c si el índice es iterator, iterator + c o iterator - c */
+static int indexOffset(AstNode *index, const char *iterator, long long *offset) {
+    *offset = 0;
+    if (index->type == AST_IDENTIFIER)
+        return strcmp(index->identifier.name, iterator) == 0;
+    if (index->type != AST_BINARY_OP)
+        return 0;
+    AstNode *var = index->binaryOp.left;
+    AstNode *lit = index->binaryOp.right;
+    if (index->binaryOp.op == '+' && var->type == AST_NUMBER_LITERAL) {
+        var = index->binaryOp.right;
+        lit = index->binaryOp.left;
+    }
+    if ((index->binaryOp.op != '+' && index->binaryOp.op != '-') ||
+        var->type != AST_IDENTIFIER || strcmp(var->identifier.name, iterator) != 0 ||
+        !literalValue(lit, offset))
+        return 0;
+    /* Desplazamientos desmedidos no se analizan (evita desbordar) */
+    if (*offset > (1LL << 40) || *offset < -(1LL << 40))
+        return 0;
+    if (index->binaryOp.op == '-')
+        *offset = -*offset;
+    return 1;
+}
+
+/* Retorna 1 si algún hecho en curso prueba array[index] dentro de rango */
+static int provenInBounds(const char *array, AstNode *index) {
+    for (Fact *f = facts; f; f = f->next) {
+        long long offset;
+        if (strcmp(f->array, array) != 0 || !indexOffset(index, f->iterator, &offset))
+            continue;
+        if (f->lo + offset >= 0 && offset <= f->margin)
+            return 1;
+    }
+    return 0;
+}
+
+/* ============================
+   Recorrido
+   ============================ */
+
+static void visit(AstNode *node);
+
+static void visitList(AstNode **nodes, int count) {
+    for (int i = 0; i < count; i++)
+        visit(nodes[i]);
+}
+
+/* Las funciones y lambdas se ejecutan fuera del bucle que las contiene */
+static void visitDetached(AstNode **nodes, int count) {
+    Fact *saved = facts;
+    facts = NULL;
+    visitList(nodes, count);
+    facts = saved;
+}
+
+static void visit(AstNode *node) {
+    if (!node)
+        return;
+    switch (node->type) {
+        case AST_INDEX: {
+            AstNode *array = node->indexExpr.array;
+            visit(array);
+            visit(node->indexExpr.index);
+            stats.accesses++;
+            /* Las columnas de un arreglo @soa miden lo mismo que el arreglo */
+            if (array->type == AST_MEMBER_ACCESS && array->memberAccess.column >= 0)
+                array = array->memberAccess.object;
+            if (array->type == AST_IDENTIFIER &&
+                provenInBounds(array->identifier.name, node->indexExpr.index)) {
+                node->indexExpr.checked = 0;
+                stats.eliminated++;
+            }
+            break;
+        }
+        case AST_INDEX_ASSIGN:
+            visit(node->indexAssign.index);
+            visit(node->indexAssign.value);
+            stats.accesses++;
+            if (provenInBounds(node->indexAssign.name, node->indexAssign.index)) {
+                node->indexAssign.checked = 0;
+                stats.eliminated++;
+            }
+            break;
+        case AST_FOR_STMT: {
+            visit(node->forStmt.rangeStart);
+            visit(node->forStmt.rangeEnd);
+            Fact fact;
+            int proven = loopFact(node, &fact);
+            if (proven) {
+                fact.next = facts;
+                facts = &fact;
+            }
+            visitList(node->forStmt.body, node->forStmt.bodyCount);
+            if (proven)
+                facts = fact.next;
+            break;
+        }
+        case AST_FUNC_DEF:
+            visitDetached(node->funcDef.body, node->funcDef.bodyCount);
+            break;
+        case AST_LAMBDA:
+            visitDetached(&node->lambda.body, 1);
+            break;
+        case AST_CLASS_DEF:
+            visitDetached(node->classDef.members, node->classDef.memberCount);
+            break;
+        case AST_PROGRAM:
+            visitList(node->program.statements, node->program.statementCount);
+            break;
+        case AST_VAR_ASSIGN:
+            visit(node->varAssign.initializer);
+            break;
+        case AST_VAR_DECL:
+            visit(node->varDecl.initializer);
+            break;
+        case AST_PRINT_STMT:
+            visit(node->printStmt.expr);
+            break;
+        case AST_RETURN_STMT:
+            visit(node->returnStmt.expr);
+            break;
+        case AST_BINARY_OP:
+            visit(node->binaryOp.left);
+            visit(node->binaryOp.right);
+            break;
+        case AST_FUNC_CALL:
+            visitList(node->funcCall.arguments, node->funcCall.argCount);
+            break;
+        case AST_METHOD_CALL:
+            visit(node->methodCall.object);
+            visitList(node->methodCall.arguments, node->methodCall.argCount);
+            break;
+        case AST_MEMBER_ACCESS:
+            visit(node->memberAccess.object);
+            break;
+        case AST_ARRAY_LITERAL:
+            visitList(node->arrayLiteral.elements, node->arrayLiteral.elementCount);
+            break;
+        case AST_STRING_BUILD:
+            visitList(node->stringBuild.pieces, node->stringBuild.pieceCount);
+            break;
+        case AST_SPAWN:
+            visit(node->spawnExpr.call);
+            break;
+        case AST_AWAIT:
+            visit(node->awaitExpr.future);
+            break;
+        case AST_IF_STMT:
+            visit(node->ifStmt.condition);
+            visitList(node->ifStmt.thenBranch, node->ifStmt.thenCount);
+            visitList(node->ifStmt.elseBranch, node->ifStmt.elseCount);
+            break;
+        default:
+            break;
+    }
+}
+
+void boundsCheckProgram(AstNode *root) {
+    if (!root || root->type != AST_PROGRAM)
+        return;
+    spawns = 0;
+    scanProgram(root);
+    visit(root);
+    facts = NULL;
+    freeNames(&clobbered);
+}
@@ -0,0 +1,46 @@
+#ifndef BOUNDS_H
+#define BOUNDS_H
+
+#include "ast.h"
+
+/**
+ * @brief Contadores de la eliminación de comprobaciones de rango.
+ */
+typedef struct {
+    size_t accesses;     /* Lecturas y escrituras de elementos de arreglos */
+    size_t eliminated;   /* Accesos demostrados dentro de rango */
+} BoundsStats;
+
+/**
+ * @brief Elimina las comprobaciones de rango demostrablemente innecesarias.
+ *
+ * Análisis de rangos sobre los bucles 'for i in range(s, len(a) - k)' con
+ * s y k literales: dentro del cuerpo s <= i < len(a) - k, así que los
+ * accesos a[i + c] con s + c >= 0 y c <= k no necesitan comprobación. El
+ * hecho solo vale si el cuerpo no reasigna i ni a, y, si alguna función o
+ * lambda escribe i o a, si además el cuerpo no llama a funciones y el
+ * programa no lanza tareas. Los accesos probados quedan con checked = 0.
+ *
+ * Debe ejecutarse después del análisis semántico (los índices ya son
+ * enteros y 'len' recibe un arreglo), justo antes de generar código.
+ *
+ * @param root Raíz del AST (AST_PROGRAM); se modifica en el sitio.
+ */
+void boundsCheckProgram(AstNode *root);
+
+/**
+ * @brief Reinicia los contadores de la eliminación de comprobaciones.
+ */
+void boundsResetStats(void);
+
+/**
+ * @brief Retorna los contadores acumulados.
+ */
+const BoundsStats *boundsGetStats(void);
+
+/**
+ * @brief Imprime los contadores acumulados.
+ */
+void boundsDumpStats(void);
+
+#endif /* BOUNDS_H */
@@ -0,0 +1,1345 @@
+/* bytecode.c */
+#include "bytecode.h"
+#include "ast.h"
+#include "memory.h"
+#include "semantic.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+/* Variables del programa que viven en registros como mucho; el resto son
+   globales */
+#define MAX_PROGRAM_REGISTERS 192
+
+/* ============================
+   Conjuntos de nombres
+   Listas enlazadas, igual que las tablas de símbolos del resto del compilador.
+   ============================ */
+
+typedef struct Name {
+    char name[256];
+    int reg;
+    struct Name *next;
+} Name;
+
+static Name *findName(Name *set, const char *name) {
+    for (Name *n = set; n; n = n->next) {
+        if (strcmp(n->name, name) == 0)
+            return n;
+    }
+    return NULL;
+}
+
+static Name *addName(Name **set, const char *name, int reg) {
+    Name *n = findName(*set, name);
+    if (n)
+        return n;
+    n = (Name *)memory_alloc(sizeof(Name));
+    snprintf(n->name, sizeof(n->name), "%s", name);
+    n->reg = reg;
+    n->next = *set;
+    *set = n;
+    return n;
+}
+
+static void freeNames(Name **set) {
+    while (*set) {
+        Name *next = (*set)->next;
+        memory_free(*set);
+        *set = next;
+    }
+}
+
+static Name *topLevelNames = NULL;  /* Asignadas en el nivel superior del programa */
+static Name *sharedNames = NULL;    /* Nombradas dentro de alguna función o lambda */
+static AstNode *programRoot = NULL;
+
+static void compileError(const char *message, const char *name) {
+    fprintf(stderr, "Interpreter error: ");
+    fprintf(stderr, message, name);
+    fprintf(stderr, "\n");
+    exit(1);
+}
+
+/* Variable de 'obj.campo' u otro nombre: la parte antes del punto */
+static void baseName(const char *name, char *out, size_t size) {
+    size_t len = strcspn(name, ".");
+    if (len >= size)
+        len = size - 1;
+    memcpy(out, name, len);
+    out[len] = '\0';
+}
+
+/* ============================
+   Recorrido genérico del AST
+   ============================ */
+
+typedef void (*NodeVisitor)(AstNode *node, void *context);
+
+/* Llama a 'visit' con cada hijo directo del nodo */
+static void forEachChild(AstNode *node, NodeVisitor visit, void *context) {
+    if (!node)
+        return;
+    switch (node->type) {
+        case AST_PROGRAM:
+            for (int i = 0; i < node->program.statementCount; i++)
+                visit(node->program.statements[i], context);
+            break;
+        case AST_VAR_ASSIGN:
+            visit(node->varAssign.initializer, context);
+            break;
+        case AST_VAR_DECL:
+            visit(node->varDecl.initializer, context);
+            break;
+        case AST_FUNC_DEF:
+            for (int i = 0; i < node->funcDef.bodyCount; i++)
+                visit(node->funcDef.body[i], context);
+            break;
+        case AST_FUNC_CALL:
+            for (int i = 0; i < node->funcCall.argCount; i++)
+                visit(node->funcCall.arguments[i], context);
+            break;
+        case AST_RETURN_STMT:
+            visit(node->returnStmt.expr, context);
+            break;
+        case AST_PRINT_STMT:
+            visit(node->printStmt.expr, context);
+            break;
+        case AST_LAMBDA:
+            visit(node->lambda.body, context);
+            break;
+        case AST_CLASS_DEF:
+            for (int i = 0; i < node->classDef.memberCount; i++)
+                visit(node->classDef.members[i], context);
+            break;
+        case AST_IF_STMT:
+            visit(node->ifStmt.condition, context);
+            for (int i = 0; i < node->ifStmt.thenCount; i++)
+                visit(node->ifStmt.thenBranch[i], context);
+            for (int i = 0; i < node->ifStmt.elseCount; i++)
+                visit(node->ifStmt.elseBranch[i], context);
+            break;
+        case AST_FOR_STMT:
+            visit(node->forStmt.rangeStart, context);
+            visit(node->forStmt.rangeEnd, context);
+            for (int i = 0; i < node->forStmt.bodyCount; i++)
+                visit(node->forStmt.body[i], context);
+            break;
+        case AST_ARRAY_LITERAL:
+            for (int i = 0; i < node->arrayLiteral.elementCount; i++)
+                visit(node->arrayLiteral.elements[i], context);
+            break;
+        case AST_BINARY_OP:
+            visit(node->binaryOp.left, context);
+            visit(node->binaryOp.right, context);
+            break;
+        case AST_MEMBER_ACCESS:
+            visit(node->memberAccess.object, context);
+            break;
+        case AST_METHOD_CALL:
+            visit(node->methodCall.object, context);
+            for (int i = 0; i < node->methodCall.argCount; i++)
+                visit(node->methodCall.arguments[i], context);
+            break;
+        case AST_SPAWN:
+            visit(node->spawnExpr.call, context);
+            break;
+        case AST_AWAIT:
+            visit(node->awaitExpr.future, context);
+            break;
+        case AST_INDEX:
+            visit(node->indexExpr.array, context);
+            visit(node->indexExpr.index, context);
+            break;
+        case AST_INDEX_ASSIGN:
+            visit(node->indexAssign.index, context);
+            visit(node->indexAssign.value, context);
+            break;
+        case AST_STRING_BUILD:
+            for (int i = 0; i < node->stringBuild.pieceCount; i++)
+                visit(node->stringBuild.pieces[i], context);
+            break;
+        default:
+            break;
+    }
+}
+
+/* Nombre de variable que el nodo lee o escribe (NULL si no tiene) */
+static void variableName(AstNode *node, char *out, size_t size) {
+    out[0] = '\0';
+    switch (node->type) {
+        case AST_IDENTIFIER:
+            snprintf(out, size, "%s", node->identifier.name);
+            break;
+        case AST_VAR_ASSIGN:
+            baseName(node->varAssign.name, out, size);
+            break;
+        case AST_VAR_DECL:
+            snprintf(out, size, "%s", node->varDecl.name);
+            break;
+        case AST_INDEX_ASSIGN:
+            snprintf(out, size, "%s", node->indexAssign.name);
+            break;
+        case AST_FOR_STMT:
+            snprintf(out, size, "%s", node->forStmt.iterator);
+            break;
+        case AST_FUNC_CALL:
+            if (node->funcCall.kind == CALL_LAMBDA || node->funcCall.kind == CALL_CLOSURE)
+                snprintf(out, size, "%s", node->funcCall.name);
+            break;
+        default:
+            break;
+    }
+}
+
+/* Todos los nombres de variable del subárbol */
+static void collectShared(AstNode *node, void *context) {
+    char name[256];
+    if (!node)
+        return;
+    variableName(node, name, sizeof(name));
+    if (name[0])
+        addName((Name **)context, name, -1);
+    if (node->type == AST_FOR_STMT && node->forStmt.reduceOp != REDUCE_NONE)
+        addName((Name **)context, node->forStmt.reduceVar, -1);
+    forEachChild(node, collectShared, context);
+}
+
+/* Cuerpos de funciones, métodos y lambdas: sus nombres no pueden vivir
+   en registros del programa */
+static void findSharedNames(AstNode *node, void *context) {
+    if (!node)
+        return;
+    if (node->type == AST_FUNC_DEF || node->type == AST_LAMBDA) {
+        forEachChild(node, collectShared, context);
+        return;
+    }
+    forEachChild(node, findSharedNames, context);
+}
+
+/* ============================
+   Programa: prototipos, constantes, globales y clases
+   ============================ */
+
+static int findProto(const BcProgram *program, const char *name) {
+    for (int i = 0; i < program->protoCount; i++) {
+        if (strcmp(program->protos[i]->name, name) == 0)
+            return i;
+    }
+    return -1;
+}
+
+static int addProto(BcProgram *program, const char *name, AstNode *def) {
+    int existing = findProto(program, name);
+    if (existing >= 0)
+        return existing;
+    BcProto *proto = (BcProto *)memory_alloc(sizeof(BcProto));
+    memset(proto, 0, sizeof(BcProto));
+    snprintf(proto->name, sizeof(proto->name), "%s", name);
+    proto->def = def;
+    proto->record = proto;
+    proto->tier = BC_TIER_NONE;
+    program->protos = (BcProto **)memory_realloc(program->protos,
+                          (size_t)(program->protoCount + 1) * sizeof(BcProto *));
+    program->protos[program->protoCount] = proto;
+    return program->protoCount++;
+}
+
+static void lambdaSymbol(AstNode *lambda, char *out, size_t size) {
+    snprintf(out, size, "__lyn_lambda_%d", lambda->lambda.id);
+}
+
+/* Un prototipo por función, método y lambda del programa, antes de
+   compilar ninguno: una llamada puede aparecer antes que la definición */
+static void registerProtos(AstNode *node, void *context) {
+    BcProgram *program = (BcProgram *)context;
+    char symbol[520];
+    if (!node)
+        return;
+    switch (node->type) {
+        case AST_FUNC_DEF:
+            addProto(program, node->funcDef.name, node);
+            break;
+        case AST_CLASS_DEF:
+            for (int i = 0; i < node->classDef.memberCount; i++) {
+                AstNode *member = node->classDef.members[i];
+                if (!member || member->type != AST_FUNC_DEF)
+                    continue;
+                snprintf(symbol, sizeof(symbol), "%s__%s", node->classDef.name, member->funcDef.name);
+                addProto(program, symbol, member);
+                forEachChild(member, registerProtos, context);
+            }
+            return;
+        case AST_LAMBDA:
+            if (node->lambda.id >= 0) {
+                lambdaSymbol(node, symbol, sizeof(symbol));
+                addProto(program, symbol, node);
+            }
+            break;
+        default:
+            break;
+    }
+    forEachChild(node, registerProtos, context);
+}
+
+static int addConstant(BcProgram *program, long value) {
+    for (int i = 0; i < program->constantCount; i++) {
+        if (program->constants[i] == value)
+            return i;
+    }
+    if (program->constantCount > 0xFFFF)
+        compileError("Too many constants in '%s'.", "program");
+    program->constants = (long *)memory_realloc(program->constants,
+                             (size_t)(program->constantCount + 1) * sizeof(long));
+    program->constants[program->constantCount] = value;
+    return program->constantCount++;
+}
+
+/* Literal string: los datos viven con el programa y la constante es el
+   LynStr que los apunta, como el literal en .rodata del código compilado */
+static int addString(BcProgram *program, const char *text) {
+    size_t size = strlen(text) + 1;
+    char *bytes = (char *)memory_alloc(size);
+    size_t length = decodeStringLiteral(text, bytes);
+    bytes[length] = '\0';
+    for (int i = 0; i < program->stringCount; i++) {
+        if (strcmp(program->strings[i], bytes) == 0) {
+            memory_free(bytes);
+            return addConstant(program, (long)(uintptr_t)program->strings[i]);
+        }
+    }
+    program->strings = (char **)memory_realloc(program->strings,
+                           (size_t)(program->stringCount + 1) * sizeof(char *));
+    program->strings[program->stringCount++] = bytes;
+    return addConstant(program, (long)(uintptr_t)bytes);
+}
+
+static int globalSlot(BcProgram *program, const char *name) {
+    for (int i = 0; i < program->globalCount; i++) {
+        if (strcmp(program->globalNames[i], name) == 0)
+            return i;
+    }
+    if (program->globalCount > 0xFFFF)
+        compileError("Too many global variables ('%s').", name);
+    program->globalNames = (char (*)[256])memory_realloc(program->globalNames,
+                               (size_t)(program->globalCount + 1) * sizeof(*program->globalNames));
+    snprintf(program->globalNames[program->globalCount], sizeof(*program->globalNames), "%s", name);
+    return program->globalCount++;
+}
+
+/* CLASS_DEF de nivel superior con ese nombre (NULL si el tree shaking la
+   eliminó) */
+static AstNode *findClassDef(const char *name) {
+    for (int i = 0; i < programRoot->program.statementCount; i++) {
+        AstNode *st = programRoot->program.statements[i];
+        if (st && st->type == AST_CLASS_DEF && strcmp(st->classDef.name, name) == 0)
+            return st;
+    }
+    return NULL;
+}
+
+static int hasMethodDef(AstNode *cls, const char *name) {
+    for (int i = 0; cls && i < cls->classDef.memberCount; i++) {
+        AstNode *member = cls->classDef.members[i];
+        if (member && member->type == AST_FUNC_DEF && strcmp(member->funcDef.name, name) == 0)
+            return 1;
+    }
+    return 0;
+}
+
+/* Clase instanciable con su vtable de prototipos; un hueco cuyo método se
+   eliminó queda a NULL */
+static int classIndex(BcProgram *program, const char *name) {
+    for (int i = 0; i < program->classCount; i++) {
+        if (strcmp(program->classes[i].name, name) == 0)
+            return i;
+    }
+    const ClassInfo *info = semanticFindClass(name);
+    program->classes = (BcClass *)memory_realloc(program->classes,
+                           (size_t)(program->classCount + 1) * sizeof(BcClass));
+    BcClass *cls = &program->classes[program->classCount];
+    memset(cls, 0, sizeof(BcClass));
+    snprintf(cls->name, sizeof(cls->name), "%s", name);
+    cls->size = info ? info->size : 8;
+    if (info && info->hasVtable) {
+        cls->vtableSize = info->vtableSize;
+        cls->vtable = (BcProto **)memory_alloc((size_t)info->vtableSize * sizeof(BcProto *));
+        for (int i = 0; i < info->vtableSize; i++)
+            cls->vtable[i] = NULL;
+        for (int i = 0; i < info->methodCount; i++) {
+            const ClassMethod *m = &info->methods[i];
+            int index = findProto(program, m->symbol);
+            if (m->slot >= 0 && index >= 0 && hasMethodDef(findClassDef(m->owner), m->name))
+                cls->vtable[m->slot] = program->protos[index];
+        }
+    }
+    return program->classCount++;
+}
+
+/* ============================
+   Estado de la función en compilación
+   Los registros de las variables van primero; los temporales se reservan
+   encima como una pila y se liberan restaurando 'top'.
+   ============================ */
+
+typedef struct {
+    BcProgram *program;
+    BcProto *proto;
+    Name *locals;
+    int temps;      /* Primer registro temporal */
+    int top;
+} FnState;
+
+static void growCode(BcProto *proto) {
+    if (proto->codeCount < proto->codeCapacity)
+        return;
+    proto->codeCapacity = proto->codeCapacity ? proto->codeCapacity * 2 : 64;
+    proto->code = (BcInstr *)memory_realloc(proto->code, (size_t)proto->codeCapacity * sizeof(BcInstr));
+}
+
+static int emit(FnState *fs, BcInstr instr) {
+    growCode(fs->proto);
+    fs->proto->code[fs->proto->codeCount] = instr;
+    return fs->proto->codeCount++;
+}
+
+/* Instrucción de dos palabras; retorna la posición de la segunda */
+static int emitWide(FnState *fs, BcInstr instr, long word) {
+    emit(fs, instr);
+    return emit(fs, (BcInstr)(uint32_t)(int32_t)word);
+}
+
+/* Salto hacia delante: el destino se fija con patchJump */
+static int emitJump(FnState *fs, BcInstr instr) {
+    return emitWide(fs, instr, 0);
+}
+
+static void patchJump(FnState *fs, int word) {
+    fs->proto->code[word] = (BcInstr)(uint32_t)(int32_t)(fs->proto->codeCount - (word + 1));
+}
+
+static void emitJumpBack(FnState *fs, BcInstr instr, int target) {
+    emitWide(fs, instr, target - (fs->proto->codeCount + 2));
+}
+
+static int allocRegisters(FnState *fs, int count) {
+    int base = fs->top;
+    fs->top += count > 0 ? count : 1;
+    if (fs->top > BC_MAX_REGISTERS)
+        compileError("Function '%s' needs too many registers.", fs->proto->name);
+    if (fs->top > fs->proto->registerCount)
+        fs->proto->registerCount = fs->top;
+    return base;
+}
+
+static int allocRegister(FnState *fs) {
+    return allocRegisters(fs, 1);
+}
+
+/* Registros consecutivos para una llamada o un objeto en construcción.
+   Si el destino es el último temporal reservado, el resultado se
+   construye en él y se ahorra la copia final. */
+static int allocResult(FnState *fs, int dst, int count) {
+    if (dst >= fs->temps && dst == fs->top - 1) {
+        if (count > 1)
+            allocRegisters(fs, count - 1);
+        return dst;
+    }
+    return allocRegisters(fs, count);
+}
+
+static int bindLocal(FnState *fs, const char *name) {
+    Name *local = findName(fs->locals, name);
+    if (local)
+        return local->reg;
+    return addName(&fs->locals, name, allocRegister(fs))->reg;
+}
+
+/* Registro de la variable, o -1 si es global */
+static int localRegister(FnState *fs, const char *name) {
+    Name *local = findName(fs->locals, name);
+    return local ? local->reg : -1;
+}
+
+/* Variables locales de una función: las que el cuerpo escribe y no se
+   asignan en el nivel superior del programa (como collectLocals del
+   generador de código) */
+static void collectLocals(FnState *fs, AstNode **stmts, int count) {
+    for (int i = 0; i < count; i++) {
+        AstNode *st = stmts[i];
+        const char *name = NULL;
+        if (!st)
+            continue;
+        switch (st->type) {
+            case AST_VAR_ASSIGN:
+                if (!strchr(st->varAssign.name, '.'))
+                    name = st->varAssign.name;
+                break;
+            case AST_VAR_DECL:
+                name = st->varDecl.name;
+                break;
+            case AST_IF_STMT:
+                collectLocals(fs, st->ifStmt.thenBranch, st->ifStmt.thenCount);
+                collectLocals(fs, st->ifStmt.elseBranch, st->ifStmt.elseCount);
+                break;
+            case AST_FOR_STMT:
+                name = st->forStmt.iterator;
+                collectLocals(fs, st->forStmt.body, st->forStmt.bodyCount);
+                break;
+            default:
+                break;
+        }
+        if (name && !findName(topLevelNames, name))
+            bindLocal(fs, name);
+    }
+}
+
+/* Parámetros y variables locales de la función 'def' */
+static void bindFunctionLocals(FnState *fs, AstNode *def) {
+    for (int i = 0; i < def->funcDef.paramCount; i++)
+        bindLocal(fs, def->funcDef.parameters[i]->identifier.name);
+    collectLocals(fs, def->funcDef.body, def->funcDef.bodyCount);
+}
+
+/* Variables del programa que ninguna función nombra: viven en registros */
+static void collectProgramRegisters(AstNode *node, void *context) {
+    FnState *fs = (FnState *)context;
+    char name[256];
+    if (!node || node->type == AST_FUNC_DEF || node->type == AST_CLASS_DEF ||
+        node->type == AST_LAMBDA)
+        return;
+    variableName(node, name, sizeof(name));
+    if (name[0] && !findName(sharedNames, name) && fs->top < MAX_PROGRAM_REGISTERS)
+        bindLocal(fs, name);
+    forEachChild(node, collectProgramRegisters, context);
+}
+
+/* ============================
+   Expresiones
+   ============================ */
+
+static void compileExprTo(FnState *fs, AstNode *expr, int dst);
+static int compileExpr(FnState *fs, AstNode *expr);
+static void compileStatementList(FnState *fs, AstNode **stmts, int count);
+static void compileProto(BcProgram *program, int index);
+
+static void loadConstant(FnState *fs, long value, int dst) {
+    if (value >= -0x8000 && value <= 0x7FFF)
+        emit(fs, BC_ABX(BC_LOADI, dst, (int)value + 0x8000));
+    else
+        emit(fs, BC_ABX(BC_LOADK, dst, addConstant(fs->program, value)));
+}
+
+static void loadVariable(FnState *fs, const char *name, int dst) {
+    int reg = localRegister(fs, name);
+    if (reg >= 0) {
+        if (reg != dst)
+            emit(fs, BC_ABC(BC_MOVE, dst, reg, 0));
+        return;
+    }
+    emit(fs, BC_ABX(BC_GETG, dst, globalSlot(fs->program, name)));
+}
+
+/* Evalúa el valor y lo guarda en la variable */
+static void storeVariable(FnState *fs, const char *name, AstNode *value) {
+    int reg = localRegister(fs, name);
+    if (reg >= 0) {
+        compileExprTo(fs, value, reg);
+        return;
+    }
+    int mark = fs->top;
+    int src = compileExpr(fs, value);
+    emit(fs, BC_ABX(BC_SETG, src, globalSlot(fs->program, name)));
+    fs->top = mark;
+}
+
+static int arithOpcode(char op) {
+    switch (op) {
+        case '+': return BC_ADD;
+        case '-': return BC_SUB;
+        case '*': return BC_MUL;
+        case '/': return BC_DIV;
+        case '%': return BC_MOD;
+        case '<': return BC_LT;
+        case 'L': return BC_LE;
+        case '>': return BC_GT;
+        case 'G': return BC_GE;
+        case 'E': return BC_EQ;
+        case 'N': return BC_NE;
+        default:  return -1;
+    }
+}
+
+/* Salto si la comparación es falsa: la comparación negada */
+static int negatedJump(char op) {
+    switch (op) {
+        case '<': return BC_JGE;
+        case 'L': return BC_JGT;
+        case '>': return BC_JLE;
+        case 'G': return BC_JLT;
+        case 'E': return BC_JNE;
+        case 'N': return BC_JEQ;
+        default:  return -1;
+    }
+}
+
+/* Número de la expresión si es un literal (los float se truncan, como en
+   los backends) */
+static int getConstant(AstNode *node, long *out) {
+    if (!node || node->type != AST_NUMBER_LITERAL)
+        return 0;
+    *out = node->numberLiteral.isFloat ? (long)node->numberLiteral.value
+                                       : (long)node->numberLiteral.intValue;
+    return 1;
+}
+
+static void compileBinary(FnState *fs, AstNode *expr, int dst) {
+    char op = expr->binaryOp.op;
+    int opcode = arithOpcode(op);
+    long value;
+    int mark = fs->top;
+    if (opcode < 0) {
+        char text[2] = { op, '\0' };
+        compileError("Operator '%s' is not supported.", text);
+    }
+    /* i + 1, i - 1: el inmediato va en la instrucción */
+    if ((op == '+' || op == '-') && getConstant(expr->binaryOp.right, &value) &&
+        value >= -127 && value <= 127) {
+        int left = compileExpr(fs, expr->binaryOp.left);
+        emit(fs, BC_ABC(BC_ADDI, dst, left, (uint8_t)(int8_t)(op == '+' ? value : -value)));
+        fs->top = mark;
+        return;
+    }
+    int left = compileExpr(fs, expr->binaryOp.left);
+    int right = compileExpr(fs, expr->binaryOp.right);
+    emit(fs, BC_ABC(opcode, dst, left, right));
+    fs->top = mark;
+}
+
+/* Argumentos en registros consecutivos a partir de 'first' */
+static void compileArguments(FnState *fs, AstNode **args, int count, int first) {
+    for (int i = 0; i < count; i++)
+        compileExprTo(fs, args[i], first + i);
+}
+
+static int protoIndex(FnState *fs, const char *name) {
+    int index = findProto(fs->program, name);
+    if (index < 0)
+        compileError("Function '%s' is not defined.", name);
+    return index;
+}
+
+/* Valores por defecto de los campos del objeto en 'object', heredados
+   primero; el objeto nuevo ya está a cero */
+static void compileFieldDefaults(FnState *fs, const ClassInfo *cls, int object) {
+    for (int i = 0; cls && i < cls->fieldCount; i++) {
+        AstNode *value = cls->fields[i].initializer;
+        if (!value)
+            continue;
+        int mark = fs->top;
+        emit(fs, BC_ABC(BC_SETF, object, cls->fields[i].offset / 8, compileExpr(fs, value)));
+        fs->top = mark;
+    }
+}
+
+/* Llamada a una función, un método, un constructor o una lambda según lo
+   que resolvió el análisis semántico; deja el resultado en 'dst' */
+static void compileCall(FnState *fs, AstNode *call, int dst) {
+    int mark = fs->top;
+    int argCount = call->funcCall.argCount;
+    AstNode **args = call->funcCall.arguments;
+    int base;
+    switch (call->funcCall.kind) {
+        case CALL_NEW:
+            base = allocResult(fs, dst, argCount + 1);
+            emit(fs, BC_ABX(BC_NEWOBJ, base, classIndex(fs->program, call->funcCall.name)));
+            compileFieldDefaults(fs, semanticFindClass(call->funcCall.name), base);
+            if (call->funcCall.target[0]) {
+                compileArguments(fs, args, argCount, base + 1);
+                emitWide(fs, BC_ABC(BC_CALL, base, argCount + 1, 0),
+                         protoIndex(fs, call->funcCall.target));
+            }
+            break;
+        case CALL_METHOD:
+            base = allocResult(fs, dst, argCount);
+            compileArguments(fs, args, argCount, base);
+            emitWide(fs, BC_ABC(BC_CALL, base, argCount, 0), protoIndex(fs, call->funcCall.target));
+            break;
+        case CALL_VIRTUAL:
+            base = allocResult(fs, dst, argCount);
+            compileArguments(fs, args, argCount, base);
+            emitWide(fs, BC_ABC(BC_CALLV, base, argCount, 0), call->funcCall.slot);
+            break;
+        case CALL_LAMBDA:
+            /* Sin capturas, la lambda no necesita su clausura */
+            if (call->funcCall.callee->lambda.captureCount == 0) {
+                base = allocResult(fs, dst, argCount);
+                compileArguments(fs, args, argCount, base);
+                emitWide(fs, BC_ABC(BC_CALL, base, argCount, 0), protoIndex(fs, call->funcCall.target));
+                break;
+            }
+            /* fallthrough */
+        case CALL_CLOSURE:
+            base = allocResult(fs, dst, argCount + 1);
+            loadVariable(fs, call->funcCall.name, base);
+            compileArguments(fs, args, argCount, base + 1);
+            emit(fs, BC_ABC(BC_CALLC, base, argCount, 0));
+            break;
+        default:
+            base = allocResult(fs, dst, argCount);
+            compileArguments(fs, args, argCount, base);
+            emitWide(fs, BC_ABC(BC_CALL, base, argCount, 0), protoIndex(fs, call->funcCall.name));
+            break;
+    }
+    if (base != dst)
+        emit(fs, BC_ABC(BC_MOVE, dst, base, 0));
+    fs->top = mark;
+}
+
+static int isVectorBuiltin(const char *name) {
+    return vecTypeFromName(name) != VEC_NONE || strcmp(name, "hsum") == 0 ||
+           strcmp(name, "hmin") == 0 || strcmp(name, "hmax") == 0 ||
+           strcmp(name, "shuffle") == 0 || strcmp(name, "splat") == 0;
+}
+
+static void compileFuncCall(FnState *fs, AstNode *expr, int dst) {
+    const char *name = expr->funcCall.name;
+    int mark = fs->top;
+    if (isVectorBuiltin(name))
+        compileError("Vector operation '%s' is not supported; compile the program instead.", name);
+    if (strcmp(name, "to_str") == 0 && expr->funcCall.argCount == 1) {
+        AstNode *arg = expr->funcCall.arguments[0];
+        /* Un string ya es su propia representación */
+        if (arg->type == AST_STRING_LITERAL || arg->type == AST_STRING_BUILD) {
+            compileExprTo(fs, arg, dst);
+            return;
+        }
+        emit(fs, BC_ABC(BC_TOSTR, dst, compileExpr(fs, arg), 0));
+        fs->top = mark;
+        return;
+    }
+    if (expr->funcCall.kind == CALL_SOA_ARRAY) {
+        const ClassInfo *cls = semanticFindClass(expr->funcCall.target);
+        int length = compileExpr(fs, expr->funcCall.arguments[0]);
+        emit(fs, BC_ABC(BC_NEWSOA, dst, length, cls->fieldCount));
+        fs->top = mark;
+        return;
+    }
+    if ((strcmp(name, "len") == 0 || strcmp(name, "array") == 0) &&
+        expr->funcCall.argCount == 1) {
+        int arg = compileExpr(fs, expr->funcCall.arguments[0]);
+        emit(fs, BC_ABC(name[0] == 'l' ? BC_LEN : BC_NEWARR, dst, arg, 0));
+        fs->top = mark;
+        return;
+    }
+    compileCall(fs, expr, dst);
+}
+
+/* Registro de clausura: el prototipo de la lambda y una copia de cada
+   variable capturada */
+static void compileLambda(FnState *fs, AstNode *lambda, int dst) {
+    char symbol[32];
+    int mark = fs->top;
+    int captureCount = lambda->lambda.captureCount;
+    lambdaSymbol(lambda, symbol, sizeof(symbol));
+    int index = protoIndex(fs, symbol);
+    compileProto(fs->program, index);
+    int base = allocResult(fs, dst, captureCount + 1);
+    for (int i = 0; i < captureCount; i++)
+        loadVariable(fs, lambda->lambda.captures[i], base + 1 + i);
+    emitWide(fs, BC_ABC(BC_CLOSURE, base, captureCount, 0), index);
+    if (base != dst)
+        emit(fs, BC_ABC(BC_MOVE, dst, base, 0));
+    fs->top = mark;
+}
+
+/* Cadena de concatenaciones: el constructor ocupa un temporal mientras se
+   evalúan las piezas; con print != 0 se imprime sin crear el string */
+static void compileStringBuild(FnState *fs, AstNode *expr, int dst, int print) {
+    int mark = fs->top;
+    long capacity = 0;
+    for (int i = 0; i < expr->stringBuild.pieceCount; i++) {
+        AstNode *piece = expr->stringBuild.pieces[i];
+        if (piece->type == AST_STRING_LITERAL)
+            capacity += (long)strlen(piece->stringLiteral.value);
+        else
+            capacity += expr->stringBuild.intPiece[i] ? 20 : 16;
+    }
+    if (capacity > 0xFFFF)
+        capacity = 0xFFFF;
+    int builder = allocRegister(fs);
+    emit(fs, BC_ABX(BC_SBNEW, builder, capacity));
+    for (int i = 0; i < expr->stringBuild.pieceCount; i++) {
+        int inner = fs->top;
+        int piece = compileExpr(fs, expr->stringBuild.pieces[i]);
+        emit(fs, BC_ABC(expr->stringBuild.intPiece[i] ? BC_SBADDI : BC_SBADDS, builder, piece, 0));
+        fs->top = inner;
+    }
+    if (print)
+        emit(fs, BC_ABC(BC_SBPRINT, builder, 0, 0));
+    else
+        emit(fs, BC_ABC(BC_SBEND, dst, builder, 0));
+    fs->top = mark;
+}
+
+static void compileExprTo(FnState *fs, AstNode *expr, int dst) {
+    int mark = fs->top;
+    if (!expr) {
+        loadConstant(fs, 0, dst);
+        return;
+    }
+    switch (expr->type) {
+        case AST_NUMBER_LITERAL: {
+            long value;
+            getConstant(expr, &value);
+            loadConstant(fs, value, dst);
+            break;
+        }
+        case AST_STRING_LITERAL:
+            emit(fs, BC_ABX(BC_LOADK, dst, addString(fs->program, expr->stringLiteral.value)));
+            break;
+        case AST_IDENTIFIER:
+            loadVariable(fs, expr->identifier.name, dst);
+            break;
+        case AST_BINARY_OP:
+            compileBinary(fs, expr, dst);
+            break;
+        case AST_FUNC_CALL:
+            compileFuncCall(fs, expr, dst);
+            break;
+        case AST_METHOD_CALL: {
+            int argCount = expr->methodCall.argCount;
+            int base = allocResult(fs, dst, argCount + 1);
+            compileExprTo(fs, expr->methodCall.object, base);
+            compileArguments(fs, expr->methodCall.arguments, argCount, base + 1);
+            emitWide(fs, BC_ABC(BC_CALL, base, argCount + 1, 0),
+                     protoIndex(fs, expr->methodCall.method));
+            if (base != dst)
+                emit(fs, BC_ABC(BC_MOVE, dst, base, 0));
+            break;
+        }
+        case AST_MEMBER_ACCESS: {
+            /* La columna f de un arreglo @soa es su palabra f + 1 */
+            int word = expr->memberAccess.column >= 0 ? expr->memberAccess.column + 1
+                                                      : expr->memberAccess.offset / 8;
+            if (expr->memberAccess.column < 0 && expr->memberAccess.offset < 0)
+                compileError("Field '%s' is not resolved.", expr->memberAccess.member);
+            int object = compileExpr(fs, expr->memberAccess.object);
+            emit(fs, BC_ABC(BC_GETF, dst, object, word));
+            break;
+        }
+        case AST_SPAWN:
+            /* La tarea se ejecuta en el acto: el futuro es su resultado */
+            compileExprTo(fs, expr->spawnExpr.call, dst);
+            break;
+        case AST_AWAIT:
+            compileExprTo(fs, expr->awaitExpr.future, dst);
+            break;
+        case AST_LAMBDA:
+            compileLambda(fs, expr, dst);
+            break;
+        case AST_STRING_BUILD:
+            compileStringBuild(fs, expr, dst, 0);
+            break;
+        case AST_ARRAY_LITERAL: {
+            /* Se construye en un temporal: los elementos pueden leer 'dst' */
+            int array = allocResult(fs, dst, 1);
+            int index = allocRegister(fs);
+            loadConstant(fs, expr->arrayLiteral.elementCount, index);
+            emit(fs, BC_ABC(BC_NEWARR, array, index, 0));
+            for (int i = 0; i < expr->arrayLiteral.elementCount; i++) {
+                int inner = fs->top;
+                loadConstant(fs, i, index);
+                int value = compileExpr(fs, expr->arrayLiteral.elements[i]);
+                emit(fs, BC_ABC(BC_SETIU, array, index, value));
+                fs->top = inner;
+            }
+            if (array != dst)
+                emit(fs, BC_ABC(BC_MOVE, dst, array, 0));
+            break;
+        }
+        case AST_INDEX: {
+            int array = compileExpr(fs, expr->indexExpr.array);
+            int index = compileExpr(fs, expr->indexExpr.index);
+            emit(fs, BC_ABC(expr->indexExpr.checked ? BC_GETI : BC_GETIU, dst, array, index));
+            break;
+        }
+        default:
+            /* Declaraciones, clases e imports en posición de expresión */
+            loadConstant(fs, 0, dst);
+            break;
+    }
+    fs->top = mark;
+}
+
+/* Registro con el valor: el de la variable si es local, o un temporal */
+static int compileExpr(FnState *fs, AstNode *expr) {
+    if (expr && expr->type == AST_IDENTIFIER) {
+        int reg = localRegister(fs, expr->identifier.name);
+        if (reg >= 0)
+            return reg;
+    }
+    int dst = allocRegister(fs);
+    compileExprTo(fs, expr, dst);
+    return dst;
+}
+
+/* Salta si la condición es falsa; retorna el salto a completar. Las
+   comparaciones se fusionan con el salto. */
+static int compileJumpIfFalse(FnState *fs, AstNode *cond) {
+    int mark = fs->top;
+    int jump;
+    if (cond && cond->type == AST_BINARY_OP && negatedJump(cond->binaryOp.op) >= 0) {
+        int left = compileExpr(fs, cond->binaryOp.left);
+        int right = compileExpr(fs, cond->binaryOp.right);
+        jump = emitJump(fs, BC_ABC(negatedJump(cond->binaryOp.op), left, right, 0));
+    } else {
+        jump = emitJump(fs, BC_ABC(BC_JZ, compileExpr(fs, cond), 0, 0));
+    }
+    fs->top = mark;
+    return jump;
+}
+
+/* ============================
+   Sentencias
+   ============================ */
+
+static void compileReturn(FnState *fs, AstNode *expr) {
+    int mark = fs->top;
+    emit(fs, BC_ABC(BC_RET, compileExpr(fs, expr), 0, 0));
+    fs->top = mark;
+}
+
+/* for i in range(s, e): la condición va al final y, como en el código
+   compilado, e se evalúa en cada vuelta */
+static void compileFor(FnState *fs, AstNode *stmt) {
+    const char *iterator = stmt->forStmt.iterator;
+    int reg = localRegister(fs, iterator);
+    int mark = fs->top;
+    storeVariable(fs, iterator, stmt->forStmt.rangeStart);
+    int toCondition = emitJump(fs, BC_ABC(BC_JMP, 0, 0, 0));
+    int loop = fs->proto->codeCount;
+    compileStatementList(fs, stmt->forStmt.body, stmt->forStmt.bodyCount);
+    if (reg >= 0) {
+        emit(fs, BC_ABC(BC_ADDI, reg, reg, 1));
+    } else {
+        int slot = globalSlot(fs->program, iterator);
+        int tmp = allocRegister(fs);
+        emit(fs, BC_ABX(BC_GETG, tmp, slot));
+        emit(fs, BC_ABC(BC_ADDI, tmp, tmp, 1));
+        emit(fs, BC_ABX(BC_SETG, tmp, slot));
+        fs->top = mark;
+    }
+    patchJump(fs, toCondition);
+    int current = reg;
+    if (current < 0) {
+        current = allocRegister(fs);
+        loadVariable(fs, iterator, current);
+    }
+    int end = compileExpr(fs, stmt->forStmt.rangeEnd);
+    emitJumpBack(fs, BC_ABC(BC_JLT, current, end, 0), loop);
+    fs->top = mark;
+}
+
+static void compileStatement(FnState *fs, AstNode *stmt) {
+    int mark = fs->top;
+    if (!stmt)
+        return;
+    switch (stmt->type) {
+        case AST_VAR_ASSIGN: {
+            if (stmt->varAssign.fieldOffset >= 0) {
+                /* 'obj.campo = v' */
+                char object[256];
+                baseName(stmt->varAssign.name, object, sizeof(object));
+                int base = allocRegister(fs);
+                loadVariable(fs, object, base);
+                int value = compileExpr(fs, stmt->varAssign.initializer);
+                emit(fs, BC_ABC(BC_SETF, base, stmt->varAssign.fieldOffset / 8, value));
+                break;
+            }
+            if (vecTypeFromName(stmt->varAssign.initializer && stmt->varAssign.initializer->type == AST_FUNC_CALL
+                                    ? stmt->varAssign.initializer->funcCall.name : "") != VEC_NONE)
+                compileError("Vector variable '%s' is not supported; compile the program instead.",
+                             stmt->varAssign.name);
+            storeVariable(fs, stmt->varAssign.name, stmt->varAssign.initializer);
+            break;
+        }
+        case AST_VAR_DECL:
+            if (vecTypeFromName(stmt->varDecl.type) != VEC_NONE)
+                compileError("Vector variable '%s' is not supported; compile the program instead.",
+                             stmt->varDecl.name);
+            if (stmt->varDecl.initializer)
+                storeVariable(fs, stmt->varDecl.name, stmt->varDecl.initializer);
+            break;
+        case AST_INDEX_ASSIGN: {
+            int array = allocRegister(fs);
+            loadVariable(fs, stmt->indexAssign.name, array);
+            int index = compileExpr(fs, stmt->indexAssign.index);
+            if (stmt->indexAssign.fieldOffset >= 0) {
+                /* arr[i].campo = v: campo del objeto guardado en el elemento */
+                emit(fs, BC_ABC(stmt->indexAssign.checked ? BC_GETI : BC_GETIU, array, array, index));
+                int value = compileExpr(fs, stmt->indexAssign.value);
+                emit(fs, BC_ABC(BC_SETF, array, stmt->indexAssign.fieldOffset / 8, value));
+                break;
+            }
+            /* arr[i].campo = v en un arreglo @soa: se escribe en la columna */
+            if (stmt->indexAssign.column >= 0)
+                emit(fs, BC_ABC(BC_GETF, array, array, stmt->indexAssign.column + 1));
+            int value = compileExpr(fs, stmt->indexAssign.value);
+            emit(fs, BC_ABC(stmt->indexAssign.checked ? BC_SETI : BC_SETIU, array, index, value));
+            break;
+        }
+        case AST_PRINT_STMT:
+            if (stmt->printStmt.expr && stmt->printStmt.expr->type == AST_STRING_BUILD) {
+                compileStringBuild(fs, stmt->printStmt.expr, 0, 1);
+                break;
+            }
+            emit(fs, BC_ABC(stmt->printStmt.isString ? BC_PRINTS : BC_PRINTI,
+                            compileExpr(fs, stmt->printStmt.expr), 0, 0));
+            break;
+        case AST_RETURN_STMT:
+            compileReturn(fs, stmt->returnStmt.expr);
+            break;
+        case AST_IF_STMT: {
+            int toElse = compileJumpIfFalse(fs, stmt->ifStmt.condition);
+            compileStatementList(fs, stmt->ifStmt.thenBranch, stmt->ifStmt.thenCount);
+            if (stmt->ifStmt.elseCount > 0) {
+                int toEnd = emitJump(fs, BC_ABC(BC_JMP, 0, 0, 0));
+                patchJump(fs, toElse);
+                compileStatementList(fs, stmt->ifStmt.elseBranch, stmt->ifStmt.elseCount);
+                patchJump(fs, toEnd);
+            } else {
+                patchJump(fs, toElse);
+            }
+            break;
+        }
+        case AST_FOR_STMT:
+            /* Un 'parallel for' se ejecuta secuencialmente */
+            compileFor(fs, stmt);
+            break;
+        case AST_FUNC_DEF:
+        case AST_CLASS_DEF:
+        case AST_IMPORT:
+        case AST_LAMBDA:
+            /* Las funciones, métodos y lambdas son prototipos propios */
+            break;
+        default:
+            compileExpr(fs, stmt);
+            break;
+    }
+    fs->top = mark;
+}
+
+static void compileStatementList(FnState *fs, AstNode **stmts, int count) {
+    for (int i = 0; i < count; i++)
+        compileStatement(fs, stmts[i]);
+}
+
+/* ============================
+   Prototipos
+   ============================ */
+
+static void compileProto(BcProgram *program, int index) {
+    BcProto *proto = program->protos[index];
+    AstNode *def = proto->def;
+    FnState fs = { program, proto, NULL, 0, 0 };
+    if (proto->compiled)
+        return;
+    proto->compiled = 1;
+    if (!def) {
+        /* El programa: variables en registros a cero y sentencias */
+        forEachChild(programRoot, collectProgramRegisters, &fs);
+        fs.temps = fs.top;
+        compileStatementList(&fs, programRoot->program.statements, programRoot->program.statementCount);
+        compileReturn(&fs, NULL);
+    } else if (def->type == AST_LAMBDA) {
+        /* Parámetros y después capturas, copiadas de la clausura */
+        proto->paramCount = def->lambda.paramCount;
+        proto->captureCount = def->lambda.captureCount;
+        for (int i = 0; i < def->lambda.paramCount; i++)
+            bindLocal(&fs, def->lambda.parameters[i]->identifier.name);
+        for (int i = 0; i < def->lambda.captureCount; i++)
+            bindLocal(&fs, def->lambda.captures[i]);
+        fs.temps = fs.top;
+        compileReturn(&fs, def->lambda.body);
+    } else {
+        proto->paramCount = def->funcDef.paramCount;
+        bindFunctionLocals(&fs, def);
+        fs.temps = fs.top;
+        compileStatementList(&fs, def->funcDef.body, def->funcDef.bodyCount);
+        /* Sin 'return': 0, o 'self' en un constructor */
+        if (strcmp(def->funcDef.name, "__init__") == 0 && def->funcDef.paramCount > 0)
+            emit(&fs, BC_ABC(BC_RET, 0, 0, 0));
+        else
+            compileReturn(&fs, NULL);
+    }
+    if (proto->registerCount == 0)
+        proto->registerCount = 1;
+    freeNames(&fs.locals);
+}
+
+/* ============================
+   Candidatas al nivel nativo
+   Funciones de nivel superior que solo usan sus parámetros y variables
+   locales, aritmética entera, if, for y llamadas a otras candidatas: el
+   generador de código las compila a un módulo sin globales ni runtime.
+   ============================ */
+
+static int nativeStatements(FnState *fs, AstNode **stmts, int count);
+
+static int nativeExpr(FnState *fs, AstNode *node) {
+    if (!node)
+        return 0;
+    switch (node->type) {
+        case AST_NUMBER_LITERAL:
+            return 1;
+        case AST_IDENTIFIER:
+            return localRegister(fs, node->identifier.name) >= 0;
+        case AST_BINARY_OP:
+            return arithOpcode(node->binaryOp.op) >= 0 && nativeExpr(fs, node->binaryOp.left) &&
+                   nativeExpr(fs, node->binaryOp.right);
+        case AST_FUNC_CALL: {
+            int index = findProto(fs->program, node->funcCall.name);
+            if (node->funcCall.kind != CALL_FUNCTION || index < 0 ||
+                fs->program->protos[index]->tier != BC_TIER_CANDIDATE)
+                return 0;
+            for (int i = 0; i < node->funcCall.argCount; i++) {
+                if (!nativeExpr(fs, node->funcCall.arguments[i]))
+                    return 0;
+            }
+            return 1;
+        }
+        default:
+            return 0;
+    }
+}
+
+static int nativeStatement(FnState *fs, AstNode *st) {
+    if (!st)
+        return 1;
+    switch (st->type) {
+        case AST_VAR_ASSIGN:
+            return localRegister(fs, st->varAssign.name) >= 0 && nativeExpr(fs, st->varAssign.initializer);
+        case AST_VAR_DECL:
+            return localRegister(fs, st->varDecl.name) >= 0 &&
+                   (!st->varDecl.initializer || nativeExpr(fs, st->varDecl.initializer));
+        case AST_RETURN_STMT:
+            return nativeExpr(fs, st->returnStmt.expr);
+        case AST_IF_STMT:
+            return nativeExpr(fs, st->ifStmt.condition) &&
+                   nativeStatements(fs, st->ifStmt.thenBranch, st->ifStmt.thenCount) &&
+                   nativeStatements(fs, st->ifStmt.elseBranch, st->ifStmt.elseCount);
+        case AST_FOR_STMT:
+            return !st->forStmt.parallel && localRegister(fs, st->forStmt.iterator) >= 0 &&
+                   nativeExpr(fs, st->forStmt.rangeStart) && nativeExpr(fs, st->forStmt.rangeEnd) &&
+                   nativeStatements(fs, st->forStmt.body, st->forStmt.bodyCount);
+        case AST_FUNC_CALL:
+            return nativeExpr(fs, st);
+        default:
+            return 0;
+    }
+}
+
+static int nativeStatements(FnState *fs, AstNode **stmts, int count) {
+    for (int i = 0; i < count; i++) {
+        if (!nativeStatement(fs, stmts[i]))
+            return 0;
+    }
+    return 1;
+}
+
+static int isNativeCandidate(BcProgram *program, BcProto *proto) {
+    FnState fs = { program, proto, NULL, 0, 0 };
+    bindFunctionLocals(&fs, proto->def);
+    int result = nativeStatements(&fs, proto->def->funcDef.body, proto->def->funcDef.bodyCount);
+    freeNames(&fs.locals);
+    return result;
+}
+
+/* Se parte de todas las funciones y se descartan hasta un punto fijo las
+   que llaman a alguna no candidata */
+static void markNativeCandidates(BcProgram *program) {
+    int changed = 1;
+    for (int i = 0; i < program->protoCount; i++) {
+        BcProto *proto = program->protos[i];
+        if (proto->def && proto->def->type == AST_FUNC_DEF &&
+            strcmp(proto->name, proto->def->funcDef.name) == 0)
+            proto->tier = BC_TIER_CANDIDATE;
+    }
+    while (changed) {
+        changed = 0;
+        for (int i = 0; i < program->protoCount; i++) {
+            BcProto *proto = program->protos[i];
+            if (proto->tier == BC_TIER_CANDIDATE && !isNativeCandidate(program, proto)) {
+                proto->tier = BC_TIER_NONE;
+                changed = 1;
+            }
+        }
+    }
+}
+
+/* ============================
+   API pública
+   ============================ */
+
+BcProgram *bytecodeCompile(AstNode *root) {
+    BcProgram *program = (BcProgram *)memory_alloc(sizeof(BcProgram));
+    memset(program, 0, sizeof(BcProgram));
+    programRoot = root;
+    for (int i = 0; i < root->program.statementCount; i++) {
+        AstNode *st = root->program.statements[i];
+        if (st && st->type == AST_VAR_ASSIGN && st->varAssign.fieldOffset < 0)
+            addName(&topLevelNames, st->varAssign.name, -1);
+        else if (st && st->type == AST_VAR_DECL)
+            addName(&topLevelNames, st->varDecl.name, -1);
+    }
+    forEachChild(root, findSharedNames, &sharedNames);
+    addProto(program, "__lyn_program", NULL);
+    forEachChild(root, registerProtos, program);
+    for (int i = 0; i < program->protoCount; i++)
+        compileProto(program, i);
+    markNativeCandidates(program);
+    freeNames(&topLevelNames);
+    freeNames(&sharedNames);
+    programRoot = NULL;
+    return program;
+}
+
+void bytecodeFree(BcProgram *program) {
+    if (!program)
+        return;
+    for (int i = 0; i < program->protoCount; i++) {
+        if (program->protos[i]->code)
+            memory_free(program->protos[i]->code);
+        memory_free(program->protos[i]);
+    }
+    for (int i = 0; i < program->stringCount; i++)
+        memory_free(program->strings[i]);
+    for (int i = 0; i < program->classCount; i++) {
+        if (program->classes[i].vtable)
+            memory_free(program->classes[i].vtable);
+    }
+    if (program->protos)
+        memory_free(program->protos);
+    if (program->constants)
+        memory_free(program->constants);
+    if (program->strings)
+        memory_free(program->strings);
+    if (program->globalNames)
+        memory_free(program->globalNames);
+    if (program->classes)
+        memory_free(program->classes);
+    memory_free(program);
+}
+
+/* ============================
+   Desensamblado
+   ============================ */
+
+static const char *const opNames[] = {
+#define BC_NAME(name) #name,
+    BC_OPCODES(BC_NAME)
+#undef BC_NAME
+};
+
+const char *bytecodeOpName(int op) {
+    return op >= 0 && op < BC_OPCODE_COUNT ? opNames[op] : "?";
+}
+
+int bytecodeLength(BcInstr instr) {
+    switch (BC_OP(instr)) {
+        case BC_JMP: case BC_JZ: case BC_JLT: case BC_JLE: case BC_JGT:
+        case BC_JGE: case BC_JEQ: case BC_JNE: case BC_CALL: case BC_CALLV:
+        case BC_CLOSURE:
+            return 2;
+        default:
+            return 1;
+    }
+}
+
+static void dumpInstr(const BcProgram *program, const BcProto *proto, int pc, FILE *out) {
+    BcInstr instr = proto->code[pc];
+    int op = BC_OP(instr);
+    fprintf(out, "  %4d  %-8s", pc, bytecodeOpName(op));
+    switch (op) {
+        case BC_LOADI:
+            fprintf(out, "r%d, %d\n", BC_A(instr), BC_SBX(instr));
+            return;
+        case BC_LOADK:
+            fprintf(out, "r%d, k%d (%ld)\n", BC_A(instr), BC_BX(instr), program->constants[BC_BX(instr)]);
+            return;
+        case BC_GETG:
+        case BC_SETG:
+            fprintf(out, "r%d, %s\n", BC_A(instr), program->globalNames[BC_BX(instr)]);
+            return;
+        case BC_NEWOBJ:
+            fprintf(out, "r%d, %s\n", BC_A(instr), program->classes[BC_BX(instr)].name);
+            return;
+        case BC_SBNEW:
+            fprintf(out, "r%d, %d\n", BC_A(instr), BC_BX(instr));
+            return;
+        case BC_ADDI:
+            fprintf(out, "r%d, r%d, %d\n", BC_A(instr), BC_B(instr), BC_SC(instr));
+            return;
+        case BC_GETF:
+        case BC_NEWSOA:
+            fprintf(out, "r%d, r%d, %d\n", BC_A(instr), BC_B(instr), BC_C(instr));
+            return;
+        case BC_SETF:
+            fprintf(out, "r%d, %d, r%d\n", BC_A(instr), BC_B(instr), BC_C(instr));
+            return;
+        case BC_JMP:
+        case BC_JZ:
+        case BC_JLT: case BC_JLE: case BC_JGT: case BC_JGE: case BC_JEQ: case BC_JNE: {
+            int target = pc + 2 + (int32_t)proto->code[pc + 1];
+            if (op == BC_JMP)
+                fprintf(out, "-> %d\n", target);
+            else if (op == BC_JZ)
+                fprintf(out, "r%d -> %d\n", BC_A(instr), target);
+            else
+                fprintf(out, "r%d, r%d -> %d\n", BC_A(instr), BC_B(instr), target);
+            return;
+        }
+        case BC_CALL:
+        case BC_CLOSURE:
+            fprintf(out, "r%d, %d, %s\n", BC_A(instr), BC_B(instr),
+                    program->protos[proto->code[pc + 1]]->name);
+            return;
+        case BC_CALLV:
+            fprintf(out, "r%d, %d, slot %u\n", BC_A(instr), BC_B(instr), proto->code[pc + 1]);
+            return;
+        case BC_CALLC:
+            fprintf(out, "r%d, %d\n", BC_A(instr), BC_B(instr));
+            return;
+        case BC_MOVE:
+        case BC_NEWARR:
+        case BC_LEN:
+        case BC_SBADDS:
+        case BC_SBADDI:
+        case BC_SBEND:
+        case BC_TOSTR:
+            fprintf(out, "r%d, r%d\n", BC_A(instr), BC_B(instr));
+            return;
+        case BC_RET:
+        case BC_SBPRINT:
+        case BC_PRINTI:
+        case BC_PRINTS:
+            fprintf(out, "r%d\n", BC_A(instr));
+            return;
+        default:
+            fprintf(out, "r%d, r%d, r%d\n", BC_A(instr), BC_B(instr), BC_C(instr));
+            return;
+    }
+}
+
+void bytecodeDump(const BcProgram *program, FILE *out) {
+    for (int i = 0; i < program->protoCount; i++) {
+        const BcProto *proto = program->protos[i];
+        fprintf(out, "%s: %d parámetros, %d capturas, %d registros%s\n", proto->name,
+                proto->paramCount, proto->captureCount, proto->registerCount,
+                proto->tier == BC_TIER_CANDIDATE ? " (candidata al nivel nativo)" : "");
+        for (int pc = 0; pc < proto->codeCount; pc += bytecodeLength(proto->code[pc]))
+            dumpInstr(program, proto, pc, out);
+        fprintf(out, "\n");
+    }
+}
@@ -0,0 +1,198 @@
+#ifndef BYTECODE_H
+#define BYTECODE_H
+
+#include <stdint.h>
+#include <stdio.h>
+#include "ast.h"
+
+/* ============================
+   Bytecode de registros para 'run'
+   Cada función es un prototipo con su código y un número fijo de
+   registros: los parámetros primero, después las capturas (en una lambda)
+   y las variables locales, y encima los temporales. Los valores son una
+   palabra, igual que en el código compilado, y los arreglos, objetos y
+   strings son los del runtime.
+   ============================ */
+
+/* Instrucción de 32 bits: opcode en el byte bajo y operandos A, B y C de
+   un byte, o A y Bx de 16 bits. Las instrucciones marcadas con '+ w'
+   ocupan además la palabra siguiente (un índice o un desplazamiento de
+   salto con signo, relativo a la instrucción siguiente). */
+typedef uint32_t BcInstr;
+
+#define BC_OP(i)   ((int)((i) & 0xFF))
+#define BC_A(i)    ((int)(((i) >> 8) & 0xFF))
+#define BC_B(i)    ((int)(((i) >> 16) & 0xFF))
+#define BC_C(i)    ((int)((i) >> 24))
+#define BC_BX(i)   ((int)((i) >> 16))
+#define BC_SBX(i)  (BC_BX(i) - 0x8000)
+#define BC_SC(i)   ((int)(int8_t)BC_C(i))
+
+#define BC_ABC(op, a, b, c) \
+    ((BcInstr)(op) | ((BcInstr)(a) << 8) | ((BcInstr)(b) << 16) | ((BcInstr)(c) << 24))
+#define BC_ABX(op, a, bx)   ((BcInstr)(op) | ((BcInstr)(a) << 8) | ((BcInstr)(bx) << 16))
+
+/* Registros por función (A, B y C son de un byte) */
+#define BC_MAX_REGISTERS 255
+
+/* Opcodes: nombre y descripción (R = registros, G = globales, K =
+   constantes). El orden fija la tabla de despacho del intérprete. */
+#define BC_OPCODES(X) \
+    X(MOVE)     /* R[A] = R[B] */ \
+    X(LOADI)    /* R[A] = sBx */ \
+    X(LOADK)    /* R[A] = K[Bx] */ \
+    X(GETG)     /* R[A] = G[Bx] */ \
+    X(SETG)     /* G[Bx] = R[A] */ \
+    X(ADD)      /* R[A] = R[B] + R[C] */ \
+    X(SUB)      /* R[A] = R[B] - R[C] */ \
+    X(MUL)      /* R[A] = R[B] * R[C] */ \
+    X(DIV)      /* R[A] = R[B] / R[C] */ \
+    X(MOD)      /* R[A] = R[B] % R[C] */ \
+    X(ADDI)     /* R[A] = R[B] + sC */ \
+    X(LT)       /* R[A] = R[B] < R[C] */ \
+    X(LE)       /* R[A] = R[B] <= R[C] */ \
+    X(GT)       /* R[A] = R[B] > R[C] */ \
+    X(GE)       /* R[A] = R[B] >= R[C] */ \
+    X(EQ)       /* R[A] = R[B] == R[C] */ \
+    X(NE)       /* R[A] = R[B] != R[C] */ \
+    X(JMP)      /* + w: salta */ \
+    X(JZ)       /* + w: salta si R[A] == 0 */ \
+    X(JLT)      /* + w: salta si R[A] < R[B] */ \
+    X(JLE)      /* + w: salta si R[A] <= R[B] */ \
+    X(JGT)      /* + w: salta si R[A] > R[B] */ \
+    X(JGE)      /* + w: salta si R[A] >= R[B] */ \
+    X(JEQ)      /* + w: salta si R[A] == R[B] */ \
+    X(JNE)      /* + w: salta si R[A] != R[B] */ \
+    X(CALL)     /* + w: R[A] = prototipo w (R[A..A+B-1]) */ \
+    X(CALLV)    /* + w: R[A] = hueco w de la vtable de R[A] (R[A..A+B-1]) */ \
+    X(CALLC)    /* R[A] = clausura R[A] (R[A+1..A+B]) */ \
+    X(RET)      /* retorna R[A] */ \
+    X(CLOSURE)  /* + w: R[A] = clausura del prototipo w con capturas R[A+1..A+B] */ \
+    X(NEWOBJ)   /* R[A] = objeto nuevo de la clase Bx */ \
+    X(GETF)     /* R[A] = palabra C del objeto R[B] */ \
+    X(SETF)     /* palabra B del objeto R[A] = R[C] */ \
+    X(NEWARR)   /* R[A] = arreglo nuevo de R[B] elementos */ \
+    X(NEWSOA)   /* R[A] = arreglo @soa de R[B] elementos y C columnas */ \
+    X(LEN)      /* R[A] = longitud del arreglo R[B] */ \
+    X(GETI)     /* R[A] = R[B][R[C]], con comprobación de rango */ \
+    X(GETIU)    /* R[A] = R[B][R[C]] */ \
+    X(SETI)     /* R[A][R[B]] = R[C], con comprobación de rango */ \
+    X(SETIU)    /* R[A][R[B]] = R[C] */ \
+    X(SBNEW)    /* R[A] = constructor de strings con capacidad Bx */ \
+    X(SBADDS)   /* añade el string R[B] al constructor R[A] */ \
+    X(SBADDI)   /* añade el entero R[B] en decimal al constructor R[A] */ \
+    X(SBEND)    /* R[A] = string del constructor R[B] */ \
+    X(SBPRINT)  /* imprime el constructor R[A] */ \
+    X(TOSTR)    /* R[A] = el entero R[B] en decimal */ \
+    X(PRINTI)   /* imprime el entero R[A] */ \
+    X(PRINTS)   /* imprime el string R[A] */
+
+typedef enum {
+#define BC_ENUM(name) BC_##name,
+    BC_OPCODES(BC_ENUM)
+#undef BC_ENUM
+    BC_OPCODE_COUNT
+} BcOpcode;
+
+/* Estado del nivel nativo de un prototipo */
+typedef enum {
+    BC_TIER_NONE = 0,   /* Solo se interpreta */
+    BC_TIER_CANDIDATE,  /* Aritmética entera pura: se puede compilar */
+    BC_TIER_NATIVE,     /* Las llamadas van a 'native' */
+    BC_TIER_FAILED      /* No se pudo compilar: se sigue interpretando */
+} BcTier;
+
+/**
+ * @brief Entrada de una función compilada a código nativo.
+ */
+typedef long (*BcNativeFunc)(const long *args);
+
+/**
+ * @brief Función, método, lambda o el programa (el prototipo 0).
+ */
+typedef struct BcProto {
+    char name[256];
+    BcInstr *code;
+    int codeCount;
+    int codeCapacity;
+    int paramCount;         /* Argumentos que recibe */
+    int captureCount;       /* Capturas que copia de su clausura (lambdas) */
+    int registerCount;
+    AstNode *def;           /* FUNC_DEF o LAMBDA de origen (NULL en el programa) */
+    struct BcProto *record; /* Registro de clausura de una lambda sin capturas:
+                               su única palabra es el propio prototipo */
+    int compiled;
+    /* Nivel nativo */
+    BcTier tier;
+    long calls;             /* Llamadas interpretadas */
+    BcNativeFunc native;
+} BcProto;
+
+/**
+ * @brief Clase instanciable: tamaño del objeto y vtable de prototipos.
+ */
+typedef struct {
+    char name[256];
+    long size;
+    BcProto **vtable;       /* NULL si la clase no tiene métodos virtuales */
+    int vtableSize;
+} BcClass;
+
+/**
+ * @brief Programa compilado a bytecode.
+ */
+typedef struct {
+    BcProto **protos;
+    int protoCount;
+    long *constants;
+    int constantCount;
+    char **strings;         /* Datos de los literales string (K los apunta) */
+    int stringCount;
+    char (*globalNames)[256];
+    int globalCount;
+    BcClass *classes;
+    int classCount;
+} BcProgram;
+
+/**
+ * @brief Compila a bytecode el AST analizado.
+ *
+ * Debe ejecutarse después del análisis semántico (llamadas resueltas,
+ * campos con su desplazamiento, capturas de las lambdas) y, si se quiere,
+ * de la eliminación de comprobaciones de rango, cuyos accesos probados
+ * usan las instrucciones sin comprobación. Las variables del nivel
+ * superior que ninguna función lee ni escribe viven en registros del
+ * programa; las demás son globales. Un 'parallel for' se compila como un
+ * bucle secuencial y 'spawn' como una llamada directa, cuyo resultado es
+ * el futuro que 'await' devuelve tal cual.
+ *
+ * Ante una construcción que el intérprete no admite (tipos vectoriales,
+ * funciones externas) informa del error y termina, como el análisis
+ * semántico.
+ *
+ * @param root Raíz del AST (AST_PROGRAM).
+ * @return BcProgram* Programa que se libera con bytecodeFree.
+ */
+BcProgram *bytecodeCompile(AstNode *root);
+
+/**
+ * @brief Libera el programa. El AST debe seguir vivo mientras se usa.
+ */
+void bytecodeFree(BcProgram *program);
+
+/**
+ * @brief Escribe el bytecode desensamblado.
+ */
+void bytecodeDump(const BcProgram *program, FILE *out);
+
+/**
+ * @brief Nombre del opcode ("ADD"), o "?" si no existe.
+ */
+const char *bytecodeOpName(int op);
+
+/**
+ * @brief Número de palabras que ocupa la instrucción (1 o 2).
+ */
+int bytecodeLength(BcInstr instr);
+
+#endif /* BYTECODE_H */
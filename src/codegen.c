@@ -2,15 +2,21 @@
 #include "ast.h"
 #include "memory.h"
 #include "arch.h"
+#include "semantic.h"
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <limits.h>
 
 /* ==========================================================
    Backend Symbol Table (variables globales)
    ========================================================== */
 typedef struct Symbol {
     char name[256];
+    int threadLocal;    /* Variable privada de un bucle paralelo (.tbss) */
+    int emitted;        /* Ya reservada en la salida */
+    int topLevel;       /* Asignada en el nivel superior del programa */
+    VecType vecType;    /* Tipo vectorial (VEC_NONE si es escalar) */
     struct Symbol *next;
 } Symbol;
 
@@ -20,18 +26,35 @@ static void addSymbol(const char *name) {
     Symbol *sym = (Symbol *)memory_alloc(sizeof(Symbol));
     strncpy(sym->name, name, sizeof(sym->name) - 1);
     sym->name[sizeof(sym->name) - 1] = '\0';
+    sym->threadLocal = 0;
+    sym->emitted = 0;
+    sym->topLevel = 0;
+    sym->vecType = VEC_NONE;
     sym->next = symbolTable;
     symbolTable = sym;
 }
 
-static int isSymbolInTable(const char *name) {
+static Symbol *findSymbol(const char *name) {
     Symbol *sym = symbolTable;
     while (sym) {
         if (strcmp(sym->name, name) == 0)
-            return 1;
+            return sym;
         sym = sym->next;
     }
-    return 0;
+    return NULL;
+}
+
+static int isSymbolInTable(const char *name) {
+    return findSymbol(name) != NULL;
+}
+
+/* Reserva de una variable: .quad o el tamaño del vector, alineado para
+   las cargas de 32 bytes */
+static void emitSymbolStorage(FILE *fp, Symbol *sym) {
+    if (sym->vecType != VEC_NONE)
+        fprintf(fp, ".balign 32\n%s: .zero %d\n", sym->name, 4 * vecLanes(sym->vecType));
+    else
+        fprintf(fp, "%s: .quad 0\n", sym->name);
 }
 
 static void freeSymbolTable() {
@@ -44,6 +67,99 @@ static void freeSymbolTable() {
     symbolTable = NULL;
 }
 
+/* ==========================================================
+   Pool de literales string
+   Cada contenido distinto recibe un identificador la primera vez que se
+   usa; el código lo referencia por identificador y los datos se emiten
+   al final. Un literal que es sufijo de otro más largo (incluido el '\0'
+   final) no ocupa memoria propia: es un alias dentro del otro.
+   ========================================================== */
+typedef struct PooledString {
+    int id;
+    char *bytes;        /* Contenido con las secuencias de escape resueltas */
+    size_t length;
+    int base;           /* Literal que lo contiene (-1 si se emite él mismo) */
+    size_t offset;      /* Posición dentro de 'base' */
+    struct PooledString *next;
+} PooledString;
+
+static PooledString *stringPool = NULL;
+static int stringCount = 0;
+
+static int internString(const char *text) {
+    char bytes[256];
+    size_t length = decodeStringLiteral(text, bytes);
+    for (PooledString *str = stringPool; str; str = str->next) {
+        if (str->length == length && memcmp(str->bytes, bytes, length) == 0)
+            return str->id;
+    }
+    PooledString *str = (PooledString *)memory_alloc(sizeof(PooledString));
+    str->id = stringCount++;
+    str->bytes = (char *)memory_alloc(length + 1);
+    memcpy(str->bytes, bytes, length);
+    str->bytes[length] = '\0';
+    str->length = length;
+    str->base = -1;
+    str->offset = 0;
+    str->next = stringPool;
+    stringPool = str;
+    return str->id;
+}
+
+/* Ordena de mayor a menor longitud: un literal solo puede ser sufijo de
+   otro al menos igual de largo, que ya estará colocado */
+static int compareByLength(const void *a, const void *b) {
+    const PooledString *x = *(PooledString *const *)a;
+    const PooledString *y = *(PooledString *const *)b;
+    if (x->length != y->length)
+        return x->length < y->length ? 1 : -1;
+    return x->id - y->id;
+}
+
+/* Emite los literales usados: cada uno seguido de sus alias */
+static void emitStringPool(void) {
+    if (stringCount == 0)
+        return;
+    PooledString **sorted = (PooledString **)memory_alloc(stringCount * sizeof(PooledString *));
+    int n = 0;
+    for (PooledString *str = stringPool; str; str = str->next)
+        sorted[n++] = str;
+    qsort(sorted, n, sizeof(PooledString *), compareByLength);
+    for (int i = 0; i < n; i++) {
+        PooledString *str = sorted[i];
+        for (int j = 0; j < i; j++) {
+            PooledString *root = sorted[j];
+            if (root->base < 0 &&
+                memcmp(root->bytes + root->length - str->length, str->bytes, str->length) == 0) {
+                str->base = root->id;
+                str->offset = root->length - str->length;
+                break;
+            }
+        }
+    }
+    for (int i = 0; i < n; i++) {
+        PooledString *root = sorted[i];
+        if (root->base >= 0)
+            continue;
+        g_backend->emitStringData(root->id, root->bytes, root->length);
+        for (int j = i + 1; j < n; j++) {
+            if (sorted[j]->base == root->id)
+                g_backend->emitStringAlias(sorted[j]->id, root->id, sorted[j]->offset);
+        }
+    }
+    memory_free(sorted);
+}
+
+static void freeStringPool(void) {
+    while (stringPool) {
+        PooledString *next = stringPool->next;
+        memory_free(stringPool->bytes);
+        memory_free(stringPool);
+        stringPool = next;
+    }
+    stringCount = 0;
+}
+
 /* ==========================================================
    Utilidades para etiquetas en ensamblador
    ========================================================== */
@@ -52,11 +168,908 @@ static void getNewLabel(char *buffer, const char *prefix) {
     sprintf(buffer, ".%s_%d", prefix, labelCount++);
 }
 
+/* ==========================================================
+   Variables privadas de los bucles paralelos
+   Dentro del cuerpo de un 'parallel for' el iterador, el acumulador
+   de la reducción y toda variable que el cuerpo escriba se sustituyen
+   por una variable thread-local propia del bucle.
+   ========================================================== */
+#define MAX_PRIVATE_VARS 256
+
+typedef struct {
+    char name[256];
+    char privateName[256];
+} PrivateVar;
+
+static PrivateVar privateVars[MAX_PRIVATE_VARS];
+static int privateCount = 0;
+static int parallelCount = 0;
+static int parallelDepth = 0;   /* > 0 mientras se genera un trozo */
+static int taskCount = 0;       /* Trampolines de 'spawn' generados */
+static int functionDepth = 0;   /* > 0 mientras se genera una función */
+static int privateFloor = 0;    /* Primera variable visible: el cuerpo de una
+                                   lambda no ve las locales de quien la crea */
+
+static const char *findPrivate(const char *name) {
+    for (int i = privateCount - 1; i >= privateFloor; i--) {
+        if (strcmp(privateVars[i].name, name) == 0)
+            return privateVars[i].privateName;
+    }
+    return NULL;
+}
+
+/* Crea la copia thread-local '<func>_<name>' y la retorna */
+static const char *privatize(const char *func, const char *name) {
+    const char *existing = findPrivate(name);
+    if (existing)
+        return existing;
+    if (privateCount == MAX_PRIVATE_VARS) {
+        fprintf(stderr, "Error: too many private variables in parallel loops.\n");
+        exit(1);
+    }
+    PrivateVar *var = &privateVars[privateCount++];
+    snprintf(var->name, sizeof(var->name), "%s", name);
+    snprintf(var->privateName, sizeof(var->privateName), "%s_%s", func, name);
+    if (!isSymbolInTable(var->privateName)) {
+        addSymbol(var->privateName);
+        symbolTable->threadLocal = 1;
+    }
+    return var->privateName;
+}
+
+/* Variables escritas por el cuerpo; los campos ('obj.f') son memoria
+   compartida y no se privatizan */
+static void privatizeWrites(const char *func, AstNode **stmts, int count) {
+    for (int i = 0; i < count; i++) {
+        AstNode *st = stmts[i];
+        if (!st)
+            continue;
+        switch (st->type) {
+            case AST_VAR_ASSIGN:
+                if (!strchr(st->varAssign.name, '.'))
+                    privatize(func, st->varAssign.name);
+                break;
+            case AST_VAR_DECL:
+                privatize(func, st->varDecl.name);
+                break;
+            case AST_IF_STMT:
+                privatizeWrites(func, st->ifStmt.thenBranch, st->ifStmt.thenCount);
+                privatizeWrites(func, st->ifStmt.elseBranch, st->ifStmt.elseCount);
+                break;
+            case AST_FOR_STMT:
+                privatize(func, st->forStmt.iterator);
+                privatizeWrites(func, st->forStmt.body, st->forStmt.bodyCount);
+                break;
+            default:
+                break;
+        }
+    }
+}
+
+/* Variable local '<func>_<name>' de una función. A diferencia de
+   privatize, oculta siempre cualquier variable anterior con ese nombre. */
+static const char *bindLocal(const char *func, const char *name) {
+    if (privateCount == MAX_PRIVATE_VARS) {
+        fprintf(stderr, "Error: too many local variables in functions.\n");
+        exit(1);
+    }
+    PrivateVar *var = &privateVars[privateCount++];
+    snprintf(var->name, sizeof(var->name), "%s", name);
+    snprintf(var->privateName, sizeof(var->privateName), "%s_%s", func, name);
+    if (!isSymbolInTable(var->privateName)) {
+        addSymbol(var->privateName);
+        symbolTable->threadLocal = 1;
+    }
+    return var->privateName;
+}
+
+static void loadVariable(const char *name) {
+    const char *tls = findPrivate(name);
+    if (tls)
+        g_backend->emitLoadThreadLocal(tls);
+    else
+        g_backend->emitLoadGlobal(name);
+}
+
+static void storeVariable(const char *name) {
+    const char *tls = findPrivate(name);
+    if (tls)
+        g_backend->emitStoreThreadLocal(tls);
+    else
+        g_backend->emitStoreGlobal(name);
+}
+
 /* ==========================================================
    Prototipos privados
    ========================================================== */
 static void generateExpression(AstNode *expr);
 static void generateStatement(AstNode *stmt);
+static void generateStatementList(AstNode **stmts, int count);
+static void generateParallelFor(AstNode *stmt);
+static void generateJumpIfFalse(AstNode *cond, const char *label);
+static void generateVectorExpression(AstNode *expr, VecType type);
+
+/* ==========================================================
+   Tipos vectoriales
+   Los vectores son variables globales de 4 u 8 carriles de 32 bits.
+   Las expresiones vectoriales no pasan por el registro primario
+   escalar: se generan con los hooks emitVec* del backend.
+   ========================================================== */
+static int isVectorBuiltin(const char *name) {
+    return vecTypeFromName(name) != VEC_NONE || strcmp(name, "shuffle") == 0 ||
+           strcmp(name, "hsum") == 0 || strcmp(name, "hmin") == 0 ||
+           strcmp(name, "hmax") == 0;
+}
+
+/* Tipo vectorial de una expresión (VEC_NONE si es escalar) */
+static VecType vectorTypeOf(AstNode *expr) {
+    if (!expr)
+        return VEC_NONE;
+    switch (expr->type) {
+        case AST_IDENTIFIER: {
+            Symbol *sym = findSymbol(expr->identifier.name);
+            return sym ? sym->vecType : VEC_NONE;
+        }
+        case AST_FUNC_CALL:
+            if (strcmp(expr->funcCall.name, "shuffle") == 0 && expr->funcCall.argCount > 0)
+                return vectorTypeOf(expr->funcCall.arguments[0]);
+            return vecTypeFromName(expr->funcCall.name);
+        case AST_BINARY_OP: {
+            VecType left = vectorTypeOf(expr->binaryOp.left);
+            return left != VEC_NONE ? left : vectorTypeOf(expr->binaryOp.right);
+        }
+        default:
+            return VEC_NONE;
+    }
+}
+
+/* Registra la variable si es nueva y, si es un vector, anota su tipo. Las
+   variables locales de una función no son globales. */
+static void registerVariable(const char *name, VecType vecType) {
+    if (functionDepth > 0 && findPrivate(name))
+        return;
+    if (!isSymbolInTable(name))
+        addSymbol(name);
+    if (vecType != VEC_NONE)
+        findSymbol(name)->vecType = vecType;
+}
+
+static VecType declVectorType(AstNode *decl) {
+    VecType type = vecTypeFromName(decl->varDecl.type);
+    return type != VEC_NONE ? type : vectorTypeOf(decl->varDecl.initializer);
+}
+
+/* Operando de una operación vectorial: un escalar se replica en todos los
+   carriles (un literal, como constante) */
+static void generateVectorOperand(AstNode *node, VecType type) {
+    if (vectorTypeOf(node) != VEC_NONE) {
+        generateVectorExpression(node, type);
+    } else if (node->type == AST_NUMBER_LITERAL) {
+        double lanes[8];
+        double value = node->numberLiteral.isFloat ? node->numberLiteral.value
+                                                   : (double)node->numberLiteral.intValue;
+        for (int i = 0; i < vecLanes(type); i++)
+            lanes[i] = value;
+        g_backend->emitVecConst(type, lanes);
+    } else {
+        generateExpression(node);
+        g_backend->emitVecSplat(type);
+    }
+}
+
+/* vecNx(a, b, ...): literales como constante; si no, cada carril se
+   apila y el backend los reúne */
+static void generateVectorConstructor(AstNode *call, VecType type) {
+    int argCount = call->funcCall.argCount;
+    if (argCount == 1) {
+        generateVectorOperand(call->funcCall.arguments[0], type);
+        return;
+    }
+    double lanes[8];
+    int literal = 1;
+    for (int i = 0; i < argCount; i++) {
+        AstNode *arg = call->funcCall.arguments[i];
+        if (arg->type != AST_NUMBER_LITERAL) {
+            literal = 0;
+            break;
+        }
+        lanes[i] = arg->numberLiteral.isFloat ? arg->numberLiteral.value
+                                              : (double)arg->numberLiteral.intValue;
+    }
+    if (literal) {
+        g_backend->emitVecConst(type, lanes);
+        return;
+    }
+    for (int i = 0; i < argCount; i++) {
+        generateExpression(call->funcCall.arguments[i]);
+        g_backend->emitPushPrimary();
+    }
+    g_backend->emitVecFromStack(type);
+}
+
+/* Deja en el vector principal el resultado de 'expr' */
+static void generateVectorExpression(AstNode *expr, VecType type) {
+    switch (expr->type) {
+        case AST_IDENTIFIER:
+            g_backend->emitVecLoad(expr->identifier.name, type);
+            break;
+        case AST_FUNC_CALL:
+            if (strcmp(expr->funcCall.name, "shuffle") == 0) {
+                int lanes[8];
+                for (int i = 0; i < vecLanes(type); i++)
+                    lanes[i] = (int)expr->funcCall.arguments[i + 1]->numberLiteral.intValue;
+                generateVectorExpression(expr->funcCall.arguments[0], type);
+                g_backend->emitVecShuffle(type, lanes);
+            } else {
+                generateVectorConstructor(expr, type);
+            }
+            break;
+        case AST_BINARY_OP:
+            generateVectorOperand(expr->binaryOp.left, type);
+            g_backend->emitVecPush(type);
+            generateVectorOperand(expr->binaryOp.right, type);
+            g_backend->emitVecPopSecondary(type);
+            g_backend->emitVecBinary(expr->binaryOp.op, type);
+            break;
+        default:
+            fprintf(g_backend->out, "    ; ERROR: Expresión vectorial tipo %d no soportada\n", expr->type);
+            break;
+    }
+}
+
+/* ==========================================================
+   Operadores relacionales
+   El parser codifica >=, <=, == y != como 'G', 'L', 'E' y 'N'.
+   ========================================================== */
+static int toCompareOp(char op, CompareOp *out) {
+    switch (op) {
+        case '>': *out = CMP_GT; return 1;
+        case '<': *out = CMP_LT; return 1;
+        case 'G': *out = CMP_GE; return 1;
+        case 'L': *out = CMP_LE; return 1;
+        case 'E': *out = CMP_EQ; return 1;
+        case 'N': *out = CMP_NE; return 1;
+        default:  return 0;
+    }
+}
+
+/* Indica si el nodo es un literal numérico entero y retorna su valor */
+static int getIntegerConstant(AstNode *node, long *out) {
+    if (!node || node->type != AST_NUMBER_LITERAL || node->numberLiteral.isFloat)
+        return 0;
+    *out = (long)node->numberLiteral.intValue;
+    return 1;
+}
+
+/* Reducción de fuerza: '*', '/' y '%' con operando constante se delegan en
+   secuencias específicas del backend (desplazamientos, lea, número mágico).
+   Retorna 1 si se generó el código. */
+static int generateConstArith(AstNode *L, char op, AstNode *R) {
+    long value;
+    if (op == '*' && getIntegerConstant(L, &value) && !getIntegerConstant(R, &value)) {
+        getIntegerConstant(L, &value);
+        generateExpression(R);
+        g_backend->emitMulConst(value);
+        return 1;
+    }
+    if (!getIntegerConstant(R, &value))
+        return 0;
+    switch (op) {
+        case '*':
+            generateExpression(L);
+            g_backend->emitMulConst(value);
+            return 1;
+        case '/':
+            if (value == 0)
+                return 0;
+            generateExpression(L);
+            g_backend->emitDivConst(value);
+            return 1;
+        case '%':
+            if (value == 0)
+                return 0;
+            generateExpression(L);
+            g_backend->emitModConst(value);
+            return 1;
+        default:
+            return 0;
+    }
+}
+
+/* Evalúa ambos operandos dejando L en el registro secundario y R en el principal */
+static void generateOperands(AstNode *L, AstNode *R) {
+    generateExpression(L);
+    g_backend->emitPushPrimary();
+    generateExpression(R);
+    g_backend->emitPopSecondary();
+}
+
+/* Principal = arreglo @soa -> principal = su columna 'column', que es
+   su elemento 'column' (dentro de rango por construcción) */
+static void generateSoaColumn(int column) {
+    g_backend->emitPushPrimary();
+    g_backend->emitLoadImmInt(column);
+    g_backend->emitPopSecondary();
+    g_backend->emitArrayLoad(0);
+}
+
+/* Cadena de concatenaciones (AST_STRING_BUILD): el constructor queda en
+   la pila mientras se evalúan las piezas, que pueden contener otras
+   cadenas. La capacidad inicial cubre los literales y una estimación del
+   resto, así que el constructor casi nunca crece. */
+static void generateStringBuild(AstNode *expr, int print) {
+    long capacity = 0;
+    for (int i = 0; i < expr->stringBuild.pieceCount; i++) {
+        AstNode *piece = expr->stringBuild.pieces[i];
+        if (piece->type == AST_STRING_LITERAL)
+            capacity += (long)strlen(piece->stringLiteral.value);
+        else
+            capacity += expr->stringBuild.intPiece[i] ? 20 : 16;
+    }
+    g_backend->emitLoadImmInt(capacity);
+    g_backend->emitStrBuilderNew();
+    g_backend->emitPushPrimary();
+    for (int i = 0; i < expr->stringBuild.pieceCount; i++) {
+        generateExpression(expr->stringBuild.pieces[i]);
+        g_backend->emitStrAppend(expr->stringBuild.intPiece[i]);
+    }
+    g_backend->emitStrBuilderFinish(print);
+}
+
+/* ==========================================================
+   Funciones, métodos y objetos
+   Los parámetros y variables locales de una función son variables
+   thread-local propias ('<func>_<nombre>'). Si la función llama a otras,
+   el prólogo apila su valor anterior y el epílogo lo restaura, así que
+   cada activación ve el suyo aunque haya recursión; una función hoja no
+   guarda nada. Los argumentos se apilan en orden y quien llama los
+   desapila.
+   ========================================================== */
+static char returnLabel[32];    /* Epílogo de la función en generación */
+
+/* Sustituciones activas al expandir en línea un método: cada parámetro
+   se lee directamente del argumento (una variable o un literal) */
+#define MAX_SUBSTITUTIONS 16
+
+typedef struct {
+    const char *name;
+    AstNode *value;
+} Substitution;
+
+static Substitution substitutions[MAX_SUBSTITUTIONS];
+static int substitutionCount = 0;
+
+static AstNode *findSubstitution(const char *name) {
+    for (int i = substitutionCount - 1; i >= 0; i--) {
+        if (strcmp(substitutions[i].name, name) == 0)
+            return substitutions[i].value;
+    }
+    return NULL;
+}
+
+/* El objeto nuevo ya está a cero: ese valor por defecto no se guarda */
+static int isZeroLiteral(AstNode *value) {
+    return value->type == AST_NUMBER_LITERAL && !value->numberLiteral.isFloat &&
+           value->numberLiteral.intValue == 0;
+}
+
+static int callsOut(AstNode *node);
+
+/* Llamadas que el generador resuelve sin saltar a otra función */
+static int isInlineBuiltin(AstNode *call) {
+    const char *name = call->funcCall.name;
+    if (call->funcCall.kind == CALL_NEW) {
+        if (call->funcCall.target[0])
+            return 0;
+        const ClassInfo *cls = semanticFindClass(name);
+        for (int i = 0; cls && i < cls->fieldCount; i++) {
+            if (callsOut(cls->fields[i].initializer))
+                return 0;
+        }
+        return 1;
+    }
+    if (call->funcCall.kind == CALL_SOA_ARRAY)
+        return 1;
+    if (call->funcCall.kind != CALL_FUNCTION)
+        return 0;
+    return isVectorBuiltin(name) || strcmp(name, "to_str") == 0 ||
+           strcmp(name, "len") == 0 || strcmp(name, "array") == 0;
+}
+
+static int statementsCallOut(AstNode **stmts, int count);
+
+/* 1 si el nodo puede ejecutar código de otra función del programa:
+   llamadas, tareas (esperar una ejecuta otras) y bucles paralelos */
+static int callsOut(AstNode *node) {
+    if (!node)
+        return 0;
+    switch (node->type) {
+        case AST_FUNC_CALL:
+            if (!isInlineBuiltin(node))
+                return 1;
+            for (int i = 0; i < node->funcCall.argCount; i++) {
+                if (callsOut(node->funcCall.arguments[i]))
+                    return 1;
+            }
+            return 0;
+        case AST_METHOD_CALL:
+        case AST_SPAWN:
+        case AST_AWAIT:
+            return 1;
+        case AST_BINARY_OP:
+            return callsOut(node->binaryOp.left) || callsOut(node->binaryOp.right);
+        case AST_MEMBER_ACCESS:
+            return callsOut(node->memberAccess.object);
+        case AST_INDEX:
+            return callsOut(node->indexExpr.array) || callsOut(node->indexExpr.index);
+        case AST_STRING_BUILD:
+            for (int i = 0; i < node->stringBuild.pieceCount; i++) {
+                if (callsOut(node->stringBuild.pieces[i]))
+                    return 1;
+            }
+            return 0;
+        case AST_ARRAY_LITERAL:
+            for (int i = 0; i < node->arrayLiteral.elementCount; i++) {
+                if (callsOut(node->arrayLiteral.elements[i]))
+                    return 1;
+            }
+            return 0;
+        case AST_VAR_ASSIGN:
+            return callsOut(node->varAssign.initializer);
+        case AST_VAR_DECL:
+            return callsOut(node->varDecl.initializer);
+        case AST_INDEX_ASSIGN:
+            return callsOut(node->indexAssign.index) || callsOut(node->indexAssign.value);
+        case AST_PRINT_STMT:
+            return callsOut(node->printStmt.expr);
+        case AST_RETURN_STMT:
+            return callsOut(node->returnStmt.expr);
+        case AST_IF_STMT:
+            return callsOut(node->ifStmt.condition) ||
+                   statementsCallOut(node->ifStmt.thenBranch, node->ifStmt.thenCount) ||
+                   statementsCallOut(node->ifStmt.elseBranch, node->ifStmt.elseCount);
+        case AST_FOR_STMT:
+            return node->forStmt.parallel || callsOut(node->forStmt.rangeStart) ||
+                   callsOut(node->forStmt.rangeEnd) ||
+                   statementsCallOut(node->forStmt.body, node->forStmt.bodyCount);
+        default:
+            return 0;
+    }
+}
+
+static int statementsCallOut(AstNode **stmts, int count) {
+    for (int i = 0; i < count; i++) {
+        if (callsOut(stmts[i]))
+            return 1;
+    }
+    return 0;
+}
+
+/* Índice de la variable local 'name' de la función que empieza en 'mark' */
+static int findLocal(int mark, const char *name) {
+    for (int i = mark; i < privateCount; i++) {
+        if (strcmp(privateVars[i].name, name) == 0)
+            return i;
+    }
+    return -1;
+}
+
+/* Variables locales: las que el cuerpo escribe y no se asignan en el
+   nivel superior del programa. Las vectoriales siguen siendo globales. */
+static void collectLocals(const char *func, int mark, AstNode **stmts, int count) {
+    for (int i = 0; i < count; i++) {
+        AstNode *st = stmts[i];
+        const char *name = NULL;
+        if (!st)
+            continue;
+        switch (st->type) {
+            case AST_VAR_ASSIGN:
+                if (!strchr(st->varAssign.name, '.') &&
+                    vectorTypeOf(st->varAssign.initializer) == VEC_NONE)
+                    name = st->varAssign.name;
+                break;
+            case AST_VAR_DECL:
+                if (declVectorType(st) == VEC_NONE)
+                    name = st->varDecl.name;
+                break;
+            case AST_IF_STMT:
+                collectLocals(func, mark, st->ifStmt.thenBranch, st->ifStmt.thenCount);
+                collectLocals(func, mark, st->ifStmt.elseBranch, st->ifStmt.elseCount);
+                break;
+            case AST_FOR_STMT:
+                name = st->forStmt.iterator;
+                collectLocals(func, mark, st->forStmt.body, st->forStmt.bodyCount);
+                break;
+            default:
+                break;
+        }
+        Symbol *global = name ? findSymbol(name) : NULL;
+        if (name && findLocal(mark, name) < 0 && !(global && global->topLevel))
+            bindLocal(func, name);
+    }
+}
+
+/* Genera la función 'def' con el símbolo 'symbol'. El cuerpo se emite en
+   línea y el flujo principal lo salta. Un constructor retorna 'self'. */
+static void generateFunction(AstNode *def, const char *symbol) {
+    char labelSkip[32], labelReturn[32], outerReturn[32];
+    const char *saved[MAX_PRIVATE_VARS];
+    int savedCount = 0;
+    int mark = privateCount;
+    int argCount = def->funcDef.paramCount;
+    getNewLabel(labelSkip, "FUNCSKIP");
+    getNewLabel(labelReturn, "FUNCRET");
+    for (int i = 0; i < argCount; i++)
+        bindLocal(symbol, def->funcDef.parameters[i]->identifier.name);
+    collectLocals(symbol, mark, def->funcDef.body, def->funcDef.bodyCount);
+    if (statementsCallOut(def->funcDef.body, def->funcDef.bodyCount)) {
+        for (int i = mark; i < privateCount; i++)
+            saved[savedCount++] = privateVars[i].privateName;
+    }
+    g_backend->emitJump(labelSkip);
+    g_backend->emitFunctionBegin(symbol, argCount);
+    for (int i = 0; i < savedCount; i++) {
+        g_backend->emitLoadThreadLocal(saved[i]);
+        g_backend->emitPushPrimary();
+    }
+    for (int i = 0; i < argCount; i++) {
+        g_backend->emitLoadArg(i, argCount, savedCount);
+        g_backend->emitStoreThreadLocal(privateVars[mark + i].privateName);
+    }
+    memcpy(outerReturn, returnLabel, sizeof(outerReturn));
+    memcpy(returnLabel, labelReturn, sizeof(returnLabel));
+    functionDepth++;
+    generateStatementList(def->funcDef.body, def->funcDef.bodyCount);
+    functionDepth--;
+    if (strcmp(def->funcDef.name, "__init__") == 0 && argCount > 0)
+        g_backend->emitLoadThreadLocal(privateVars[mark].privateName);
+    else
+        g_backend->emitLoadImmInt(0);
+    g_backend->emitSetLabel(labelReturn);
+    g_backend->emitFunctionEnd(saved, savedCount);
+    g_backend->emitSetLabel(labelSkip);
+    memcpy(returnLabel, outerReturn, sizeof(returnLabel));
+    privateCount = mark;
+}
+
+/* Métodos de la clase como funciones '<Clase>__<método>' */
+static void generateClass(AstNode *cls) {
+    char symbol[520];
+    for (int i = 0; i < cls->classDef.memberCount; i++) {
+        AstNode *member = cls->classDef.members[i];
+        if (!member || member->type != AST_FUNC_DEF)
+            continue;
+        snprintf(symbol, sizeof(symbol), "%s__%s", cls->classDef.name, member->funcDef.name);
+        generateFunction(member, symbol);
+    }
+}
+
+static void pushArguments(AstNode *call) {
+    for (int i = 0; i < call->funcCall.argCount; i++) {
+        generateExpression(call->funcCall.arguments[i]);
+        g_backend->emitPushPrimary();
+    }
+}
+
+/* Nodos de una expresión que se puede expandir en línea (-1 si contiene
+   algo que no sea aritmética, variables, literales o campos) */
+#define MAX_INLINE_NODES 16
+
+static int inlineCost(AstNode *node) {
+    if (!node)
+        return -1;
+    switch (node->type) {
+        case AST_NUMBER_LITERAL:
+        case AST_STRING_LITERAL:
+        case AST_IDENTIFIER:
+            return 1;
+        case AST_MEMBER_ACCESS: {
+            int cost = inlineCost(node->memberAccess.object);
+            return cost < 0 || node->memberAccess.offset < 0 ? -1 : cost + 1;
+        }
+        case AST_BINARY_OP: {
+            int left = inlineCost(node->binaryOp.left);
+            int right = inlineCost(node->binaryOp.right);
+            return left < 0 || right < 0 ? -1 : left + right + 1;
+        }
+        default:
+            return -1;
+    }
+}
+
+/* Expande en línea la llamada 'call' a una función cuyo resultado es la
+   expresión sencilla 'body'. Si todos los argumentos son variables o
+   literales se sustituyen en la expresión; si no, se evalúan una vez en
+   las variables de los parámetros, que la función no puede estar usando
+   porque no llama a nadie. Retorna 1 si expandió la llamada. */
+static int generateInlineBody(AstNode *call, AstNode **params, AstNode *body) {
+    int cost = inlineCost(body);
+    if (cost < 0 || cost > MAX_INLINE_NODES)
+        return 0;
+    int argCount = call->funcCall.argCount;
+    int simple = substitutionCount + argCount <= MAX_SUBSTITUTIONS;
+    for (int i = 0; simple && i < argCount; i++) {
+        AstNodeType type = call->funcCall.arguments[i]->type;
+        simple = type == AST_IDENTIFIER || type == AST_NUMBER_LITERAL;
+    }
+    fprintf(g_backend->out, "    ; %s en línea\n", call->funcCall.target);
+    if (simple) {
+        int mark = substitutionCount;
+        for (int i = 0; i < argCount; i++) {
+            substitutions[substitutionCount].name = params[i]->identifier.name;
+            substitutions[substitutionCount].value = call->funcCall.arguments[i];
+            substitutionCount++;
+        }
+        generateExpression(body);
+        substitutionCount = mark;
+        return 1;
+    }
+    int mark = privateCount;
+    pushArguments(call);
+    for (int i = 0; i < argCount; i++)
+        bindLocal(call->funcCall.target, params[i]->identifier.name);
+    for (int i = argCount - 1; i >= 0; i--)
+        g_backend->emitPopThreadLocal(privateVars[mark + i].privateName);
+    generateExpression(body);
+    privateCount = mark;
+    return 1;
+}
+
+/* Método cuyo cuerpo es solo 'return <expresión sencilla>' (típicamente
+   un getter) */
+static int generateInlineMethod(AstNode *call) {
+    AstNode *def = call->funcCall.callee;
+    if (!def || def->funcDef.bodyCount != 1 || !def->funcDef.body[0] ||
+        def->funcDef.body[0]->type != AST_RETURN_STMT ||
+        def->funcDef.paramCount != call->funcCall.argCount)
+        return 0;
+    return generateInlineBody(call, def->funcDef.parameters,
+                              def->funcDef.body[0]->returnStmt.expr);
+}
+
+/* ==========================================================
+   Lambdas
+   Cada lambda es una función '__lyn_lambda_<id>' cuyo argumento 0 es su
+   registro de clausura: un objeto con la vtable '__lyn_lambda_<id>_vt'
+   (un hueco, la función) y una palabra por variable capturada, copiada
+   al crear la lambda; sin capturas el registro es estático, en solo
+   lectura. Dentro de la función, parámetros y capturas son
+   variables locales. Una llamada a una variable cuya lambda se conoce va
+   directa a su función, o se expande en línea si la lambda no captura
+   nada y es una expresión sencilla; las demás pasan por la vtable.
+   ========================================================== */
+#define CLOSURE_WORD 8          /* Palabra de un registro, como los campos */
+
+static AstNode **liftedLambdas = NULL;
+static int liftedCount = 0;
+
+/* 1 si la expresión lee, además de los parámetros de la lambda, una
+   variable que en este punto es local o un argumento sustituido: la lambda
+   leería la global con ese nombre */
+static int readsShadowed(AstNode *node, AstNode *lambda) {
+    if (!node)
+        return 0;
+    switch (node->type) {
+        case AST_IDENTIFIER:
+            for (int i = 0; i < lambda->lambda.paramCount; i++) {
+                if (strcmp(lambda->lambda.parameters[i]->identifier.name, node->identifier.name) == 0)
+                    return 0;
+            }
+            return findPrivate(node->identifier.name) || findSubstitution(node->identifier.name);
+        case AST_MEMBER_ACCESS:
+            return readsShadowed(node->memberAccess.object, lambda);
+        case AST_BINARY_OP:
+            return readsShadowed(node->binaryOp.left, lambda) ||
+                   readsShadowed(node->binaryOp.right, lambda);
+        default:
+            return 0;
+    }
+}
+
+static int generateInlineLambda(AstNode *call) {
+    AstNode *lambda = call->funcCall.callee;
+    if (lambda->lambda.captureCount > 0 || readsShadowed(lambda->lambda.body, lambda))
+        return 0;
+    return generateInlineBody(call, lambda->lambda.parameters, lambda->lambda.body);
+}
+
+/* Emite la función de la lambda (saltada por el flujo principal) y deja
+   en el principal un registro de clausura nuevo con las capturas */
+static void generateLambda(AstNode *lambda) {
+    char symbol[32], vtable[40], env[40], labelSkip[32];
+    const char *saved[MAX_PRIVATE_VARS];
+    int savedCount = 0;
+    int mark = privateCount;
+    int outerFloor = privateFloor;
+    int paramCount = lambda->lambda.paramCount;
+    int captureCount = lambda->lambda.captureCount;
+    int argCount = paramCount + 1;
+    snprintf(symbol, sizeof(symbol), "__lyn_lambda_%d", lambda->lambda.id);
+    snprintf(vtable, sizeof(vtable), "%s_vt", symbol);
+    getNewLabel(labelSkip, "LAMBDASKIP");
+    for (int i = 0; i < paramCount; i++)
+        bindLocal(symbol, lambda->lambda.parameters[i]->identifier.name);
+    for (int i = 0; i < captureCount; i++)
+        bindLocal(symbol, lambda->lambda.captures[i]);
+    if (callsOut(lambda->lambda.body)) {
+        for (int i = mark; i < privateCount; i++)
+            saved[savedCount++] = privateVars[i].privateName;
+    }
+    g_backend->emitJump(labelSkip);
+    g_backend->emitFunctionBegin(symbol, argCount);
+    for (int i = 0; i < savedCount; i++) {
+        g_backend->emitLoadThreadLocal(saved[i]);
+        g_backend->emitPushPrimary();
+    }
+    for (int i = 0; i < paramCount; i++) {
+        g_backend->emitLoadArg(i + 1, argCount, savedCount);
+        g_backend->emitStoreThreadLocal(privateVars[mark + i].privateName);
+    }
+    for (int i = 0; i < captureCount; i++) {
+        g_backend->emitLoadArg(0, argCount, savedCount);
+        g_backend->emitLoadField(CLOSURE_WORD * (i + 1));
+        g_backend->emitStoreThreadLocal(privateVars[mark + paramCount + i].privateName);
+    }
+    privateFloor = mark;
+    functionDepth++;
+    generateExpression(lambda->lambda.body);
+    functionDepth--;
+    privateFloor = outerFloor;
+    g_backend->emitFunctionEnd(saved, savedCount);
+    g_backend->emitSetLabel(labelSkip);
+    privateCount = mark;
+    liftedLambdas = (AstNode **)memory_realloc(liftedLambdas,
+                                               (size_t)(liftedCount + 1) * sizeof(AstNode *));
+    liftedLambdas[liftedCount++] = lambda;
+
+    /* Sin capturas el registro es siempre el mismo: no se asigna */
+    if (captureCount == 0) {
+        snprintf(env, sizeof(env), "%s_rec", symbol);
+        g_backend->emitLoadStatic(env);
+        return;
+    }
+    /* Registro: las capturas se copian con el registro en una variable
+       thread-local, porque escribir un campo no lo conserva */
+    g_backend->emitObjectNew(CLOSURE_WORD * (captureCount + 1), vtable);
+    snprintf(env, sizeof(env), "%s_env", symbol);
+    if (!isSymbolInTable(env)) {
+        addSymbol(env);
+        symbolTable->threadLocal = 1;
+    }
+    g_backend->emitStoreThreadLocal(env);
+    for (int i = 0; i < captureCount; i++) {
+        g_backend->emitLoadThreadLocal(env);
+        g_backend->emitPushPrimary();
+        loadVariable(lambda->lambda.captures[i]);
+        g_backend->emitPopSecondary();
+        g_backend->emitStoreField(CLOSURE_WORD * (i + 1));
+    }
+    g_backend->emitLoadThreadLocal(env);
+}
+
+/* Vtables de las lambdas generadas (un hueco con su función) y registros
+   estáticos de las que no capturan nada */
+static void emitLambdaVtables(void) {
+    char symbol[32], vtable[40], record[40];
+    for (int i = 0; i < liftedCount; i++) {
+        snprintf(symbol, sizeof(symbol), "__lyn_lambda_%d", liftedLambdas[i]->lambda.id);
+        snprintf(vtable, sizeof(vtable), "%s_vt", symbol);
+        const char *methods[1] = { symbol };
+        g_backend->emitVtable(vtable, methods, 1);
+        if (liftedLambdas[i]->lambda.captureCount == 0) {
+            snprintf(record, sizeof(record), "%s_rec", symbol);
+            g_backend->emitStaticClosure(record, vtable);
+        }
+    }
+    if (liftedLambdas)
+        memory_free(liftedLambdas);
+    liftedLambdas = NULL;
+    liftedCount = 0;
+}
+
+/* Llamada a una función, un método o un constructor según lo que resolvió
+   el análisis semántico */
+static void generateCall(AstNode *call) {
+    int argCount = call->funcCall.argCount;
+    switch (call->funcCall.kind) {
+        case CALL_NEW: {
+            const ClassInfo *cls = semanticFindClass(call->funcCall.name);
+            char vtable[288];
+            snprintf(vtable, sizeof(vtable), "__lyn_vt_%s", call->funcCall.name);
+            g_backend->emitObjectNew(cls ? cls->size : 8, cls && cls->hasVtable ? vtable : NULL);
+            /* Valores por defecto, heredados primero, antes de __init__ */
+            for (int i = 0; cls && i < cls->fieldCount; i++) {
+                AstNode *value = cls->fields[i].initializer;
+                if (!value || isZeroLiteral(value))
+                    continue;
+                g_backend->emitPushPrimary();
+                generateExpression(value);
+                g_backend->emitInitField(cls->fields[i].offset);
+            }
+            if (!call->funcCall.target[0])
+                break;
+            g_backend->emitPushPrimary();
+            pushArguments(call);
+            g_backend->emitCall(call->funcCall.target, argCount + 1);
+            break;
+        }
+        case CALL_METHOD:
+            if (generateInlineMethod(call))
+                break;
+            pushArguments(call);
+            g_backend->emitCall(call->funcCall.target, argCount);
+            break;
+        case CALL_VIRTUAL:
+            pushArguments(call);
+            g_backend->emitCallVirtual(call->funcCall.slot, argCount);
+            break;
+        case CALL_LAMBDA:
+            if (generateInlineLambda(call))
+                break;
+            /* Sin capturas, la función no lee su registro */
+            if (call->funcCall.callee->lambda.captureCount > 0)
+                loadVariable(call->funcCall.name);
+            else
+                g_backend->emitLoadImmInt(0);
+            g_backend->emitPushPrimary();
+            pushArguments(call);
+            g_backend->emitCall(call->funcCall.target, argCount + 1);
+            break;
+        case CALL_CLOSURE:
+            loadVariable(call->funcCall.name);
+            g_backend->emitPushPrimary();
+            pushArguments(call);
+            g_backend->emitCallVirtual(0, argCount + 1);
+            break;
+        default:
+            pushArguments(call);
+            g_backend->emitCall(call->funcCall.name, argCount);
+            break;
+    }
+}
+
+/* CLASS_DEF de nivel superior con ese nombre (NULL si el tree shaking la
+   eliminó) */
+static AstNode *findClassDef(AstNode *root, const char *name) {
+    if (root->type != AST_PROGRAM)
+        return NULL;
+    for (int i = 0; i < root->program.statementCount; i++) {
+        AstNode *st = root->program.statements[i];
+        if (st && st->type == AST_CLASS_DEF && strcmp(st->classDef.name, name) == 0)
+            return st;
+    }
+    return NULL;
+}
+
+static int hasMethodDef(AstNode *cls, const char *name) {
+    for (int i = 0; cls && i < cls->classDef.memberCount; i++) {
+        AstNode *member = cls->classDef.members[i];
+        if (member && member->type == AST_FUNC_DEF && strcmp(member->funcDef.name, name) == 0)
+            return 1;
+    }
+    return 0;
+}
+
+/* Vtables de las clases generadas; un hueco cuyo método se eliminó queda
+   a cero */
+static void emitVtables(AstNode *root) {
+    for (const ClassInfo *cls = semanticClasses(); cls; cls = cls->next) {
+        if (!cls->hasVtable || !findClassDef(root, cls->name))
+            continue;
+        const char **methods = (const char **)memory_alloc((size_t)cls->vtableSize * sizeof(char *));
+        for (int i = 0; i < cls->vtableSize; i++)
+            methods[i] = NULL;
+        for (int i = 0; i < cls->methodCount; i++) {
+            const ClassMethod *m = &cls->methods[i];
+            if (m->slot >= 0 && hasMethodDef(findClassDef(root, m->owner), m->name))
+                methods[m->slot] = m->symbol;
+        }
+        char label[288];
+        snprintf(label, sizeof(label), "__lyn_vt_%s", cls->name);
+        g_backend->emitVtable(label, methods, cls->vtableSize);
+        memory_free(methods);
+    }
+}
 
 /* ==========================================================
    generateExpression
@@ -69,27 +1082,41 @@ static void generateExpression(AstNode *expr) {
     }
     switch (expr->type) {
     case AST_NUMBER_LITERAL: {
-        long val = (long)expr->numberLiteral.value;
+        /* Los backends solo manejan enteros: los float se truncan */
+        long val = expr->numberLiteral.isFloat ? (long)expr->numberLiteral.value
+                                               : (long)expr->numberLiteral.intValue;
         g_backend->emitLoadImmInt(val);
         break;
     }
     case AST_STRING_LITERAL: {
-        fprintf(g_backend->out, "    lea rax, [rip+str_%s]    ; cargar literal string\n",
-                expr->stringLiteral.value);
+        g_backend->emitLoadString(internString(expr->stringLiteral.value));
         break;
     }
     case AST_IDENTIFIER: {
-        g_backend->emitLoadGlobal(expr->identifier.name);
+        AstNode *value = findSubstitution(expr->identifier.name);
+        if (value) {
+            /* El argumento pertenece a quien llama: sin sustituciones */
+            int mark = substitutionCount;
+            substitutionCount = 0;
+            generateExpression(value);
+            substitutionCount = mark;
+            break;
+        }
+        loadVariable(expr->identifier.name);
         break;
     }
     case AST_BINARY_OP: {
         AstNode *L = expr->binaryOp.left;
         AstNode *R = expr->binaryOp.right;
         char op = expr->binaryOp.op;
-        generateExpression(L);
-        fprintf(g_backend->out, "    push rax          ; stack = L\n");
-        generateExpression(R);
-        fprintf(g_backend->out, "    pop rbx           ; rbx = L, rax = R\n");
+        CompareOp cmp;
+        if (generateConstArith(L, op, R))
+            break;
+        generateOperands(L, R);
+        if (toCompareOp(op, &cmp)) {
+            g_backend->emitCompare(cmp);
+            break;
+        }
         switch (op) {
             case '+':
                 g_backend->emitAdd();
@@ -103,8 +1130,8 @@ static void generateExpression(AstNode *expr) {
             case '/':
                 g_backend->emitIDiv();
                 break;
-            case '>':
-                g_backend->emitCmpGreater();
+            case '%':
+                g_backend->emitIMod();
                 break;
             default:
                 fprintf(g_backend->out, "    ; ERROR: Operador '%c' no soportado\n", op);
@@ -113,37 +1140,120 @@ static void generateExpression(AstNode *expr) {
         break;
     }
     case AST_FUNC_CALL: {
-        for (int i = 0; i < expr->funcCall.argCount; i++) {
-            generateExpression(expr->funcCall.arguments[i]);
-            fprintf(g_backend->out, "    push rax    ; argumento %d\n", i);
+        const char *name = expr->funcCall.name;
+        if (isVectorBuiltin(name)) {
+            /* En contexto escalar solo caben las reducciones hsum/hmin/hmax */
+            if (vectorTypeOf(expr) != VEC_NONE) {
+                fprintf(g_backend->out, "    ; ERROR: Vector '%s' en contexto escalar\n", name);
+                break;
+            }
+            AstNode *vec = expr->funcCall.arguments[0];
+            VecType type = vectorTypeOf(vec);
+            ReduceOp op = name[1] == 's' ? REDUCE_ADD : name[2] == 'i' ? REDUCE_MIN : REDUCE_MAX;
+            generateVectorExpression(vec, type);
+            g_backend->emitVecReduce(op, type);
+            break;
+        }
+        if (strcmp(name, "to_str") == 0 && expr->funcCall.argCount == 1) {
+            AstNode *arg = expr->funcCall.arguments[0];
+            generateExpression(arg);
+            /* Un string ya es su propia representación */
+            if (arg->type != AST_STRING_LITERAL && arg->type != AST_STRING_BUILD)
+                g_backend->emitIntToStr();
+            break;
+        }
+        if (expr->funcCall.kind == CALL_SOA_ARRAY) {
+            generateExpression(expr->funcCall.arguments[0]);
+            g_backend->emitSoaNew(semanticFindClass(expr->funcCall.target)->fieldCount);
+            break;
         }
-        fprintf(g_backend->out, "    call %s\n", expr->funcCall.name);
+        if ((strcmp(name, "len") == 0 || strcmp(name, "array") == 0) &&
+            expr->funcCall.argCount == 1) {
+            generateExpression(expr->funcCall.arguments[0]);
+            if (name[0] == 'l')
+                g_backend->emitArrayLength();
+            else
+                g_backend->emitArrayNew();
+            break;
+        }
+        generateCall(expr);
         break;
     }
     case AST_METHOD_CALL: {
         generateExpression(expr->methodCall.object);
-        fprintf(g_backend->out, "    push rax    ; push 'this'\n");
+        g_backend->emitPushPrimary();
         for (int i = 0; i < expr->methodCall.argCount; i++) {
             generateExpression(expr->methodCall.arguments[i]);
-            fprintf(g_backend->out, "    push rax    ; arg %d\n", i);
+            g_backend->emitPushPrimary();
         }
-        fprintf(g_backend->out, "    call %s\n", expr->methodCall.method);
+        g_backend->emitCall(expr->methodCall.method, expr->methodCall.argCount + 1);
         break;
     }
     case AST_MEMBER_ACCESS: {
-        fprintf(g_backend->out, "    ; (pendiente) Acceso a miembro: %s\n", expr->memberAccess.member);
+        if (expr->memberAccess.column >= 0) {
+            generateExpression(expr->memberAccess.object);
+            generateSoaColumn(expr->memberAccess.column);
+            break;
+        }
+        if (expr->memberAccess.offset < 0) {
+            fprintf(g_backend->out, "    ; ERROR: Campo '%s' sin resolver\n", expr->memberAccess.member);
+            break;
+        }
+        generateExpression(expr->memberAccess.object);
+        g_backend->emitLoadField(expr->memberAccess.offset);
+        break;
+    }
+    case AST_SPAWN: {
+        /* Trampolín que el runtime llama como long f(long arg); el flujo
+           principal lo salta */
+        AstNode *call = expr->spawnExpr.call;
+        char thunk[64], labelSkip[32];
+        snprintf(thunk, sizeof(thunk), "__lyn_task_%d", taskCount++);
+        getNewLabel(labelSkip, "TASKSKIP");
+        g_backend->emitJump(labelSkip);
+        g_backend->emitTaskEntry(thunk, call->funcCall.name, call->funcCall.argCount);
+        g_backend->emitSetLabel(labelSkip);
+        if (call->funcCall.argCount > 0)
+            generateExpression(call->funcCall.arguments[0]);
+        else
+            g_backend->emitLoadImmInt(0);
+        g_backend->emitSpawn(thunk);
+        break;
+    }
+    case AST_AWAIT: {
+        generateExpression(expr->awaitExpr.future);
+        g_backend->emitAwait();
         break;
     }
     case AST_LAMBDA: {
-        fprintf(g_backend->out, "    ; (lambda expresion) => STUB, no implementado\n");
+        generateLambda(expr);
         break;
     }
     case AST_VAR_DECL: {
         fprintf(g_backend->out, "    ; (varDecl en expr) => sin acción\n");
         break;
     }
+    case AST_STRING_BUILD: {
+        generateStringBuild(expr, 0);
+        break;
+    }
     case AST_ARRAY_LITERAL: {
-        fprintf(g_backend->out, "    ; (array literal) => pendiente de implementación\n");
+        /* Se reserva con su longitud y cada elemento se escribe sin
+           comprobación: el índice es una constante dentro de rango */
+        g_backend->emitLoadImmInt(expr->arrayLiteral.elementCount);
+        g_backend->emitArrayNew();
+        for (int i = 0; i < expr->arrayLiteral.elementCount; i++) {
+            g_backend->emitPushPrimary();
+            g_backend->emitLoadImmInt(i);
+            g_backend->emitPushPrimary();
+            generateExpression(expr->arrayLiteral.elements[i]);
+            g_backend->emitArrayStore(0);
+        }
+        break;
+    }
+    case AST_INDEX: {
+        generateOperands(expr->indexExpr.array, expr->indexExpr.index);
+        g_backend->emitArrayLoad(expr->indexExpr.checked);
         break;
     }
     case AST_CLASS_DEF: {
@@ -160,6 +1270,23 @@ static void generateExpression(AstNode *expr) {
     }
 }
 
+/* ==========================================================
+   generateJumpIfFalse
+   Salta a 'label' si la condición es falsa. Las comparaciones se
+   fusionan en cmp + salto condicional en lugar de materializar 0/1
+   y volver a compararlo contra cero.
+   ========================================================== */
+static void generateJumpIfFalse(AstNode *cond, const char *label) {
+    CompareOp cmp;
+    if (cond && cond->type == AST_BINARY_OP && toCompareOp(cond->binaryOp.op, &cmp)) {
+        generateOperands(cond->binaryOp.left, cond->binaryOp.right);
+        g_backend->emitCompareJumpIfFalse(cmp, label);
+        return;
+    }
+    generateExpression(cond);
+    g_backend->emitJumpIfZero(label);
+}
+
 /* ==========================================================
    generateStatement
    Genera código para sentencias usando el backend.
@@ -173,25 +1300,80 @@ static void generateStatement(AstNode *stmt) {
     }
     switch (stmt->type) {
     case AST_VAR_ASSIGN: {
-        if (!isSymbolInTable(stmt->varAssign.name))
-            addSymbol(stmt->varAssign.name);
+        if (stmt->varAssign.fieldOffset >= 0) {
+            /* 'obj.campo = v' */
+            char object[256];
+            size_t len = strcspn(stmt->varAssign.name, ".");
+            memcpy(object, stmt->varAssign.name, len);
+            object[len] = '\0';
+            loadVariable(object);
+            g_backend->emitPushPrimary();
+            generateExpression(stmt->varAssign.initializer);
+            g_backend->emitPopSecondary();
+            g_backend->emitStoreField(stmt->varAssign.fieldOffset);
+            break;
+        }
+        VecType vecType = vectorTypeOf(stmt->varAssign.initializer);
+        registerVariable(stmt->varAssign.name, vecType);
+        if (vecType != VEC_NONE) {
+            generateVectorExpression(stmt->varAssign.initializer, vecType);
+            g_backend->emitVecStore(stmt->varAssign.name, vecType);
+            break;
+        }
         generateExpression(stmt->varAssign.initializer);
-        g_backend->emitStoreGlobal(stmt->varAssign.name);
+        storeVariable(stmt->varAssign.name);
         break;
     }
     case AST_VAR_DECL: {
-        if (!isSymbolInTable(stmt->varDecl.name))
-            addSymbol(stmt->varDecl.name);
-        if (stmt->varDecl.initializer) {
+        VecType vecType = declVectorType(stmt);
+        registerVariable(stmt->varDecl.name, vecType);
+        if (vecType != VEC_NONE && stmt->varDecl.initializer) {
+            generateVectorExpression(stmt->varDecl.initializer, vecType);
+            g_backend->emitVecStore(stmt->varDecl.name, vecType);
+        } else if (stmt->varDecl.initializer) {
             generateExpression(stmt->varDecl.initializer);
-            fprintf(g_backend->out, "    mov [%s], rax ; inicializar varDecl\n", stmt->varDecl.name);
+            storeVariable(stmt->varDecl.name);
         } else {
             fprintf(g_backend->out, "    ; varDecl '%s' sin init => 0\n", stmt->varDecl.name);
         }
         break;
     }
+    case AST_INDEX_ASSIGN: {
+        if (stmt->indexAssign.fieldOffset >= 0) {
+            /* arr[i].campo = v: campo del objeto guardado en el elemento */
+            loadVariable(stmt->indexAssign.name);
+            g_backend->emitPushPrimary();
+            generateExpression(stmt->indexAssign.index);
+            g_backend->emitPopSecondary();
+            g_backend->emitArrayLoad(stmt->indexAssign.checked);
+            g_backend->emitPushPrimary();
+            generateExpression(stmt->indexAssign.value);
+            g_backend->emitPopSecondary();
+            g_backend->emitStoreField(stmt->indexAssign.fieldOffset);
+            break;
+        }
+        loadVariable(stmt->indexAssign.name);
+        /* arr[i].campo = v en un arreglo @soa: se escribe en la columna */
+        if (stmt->indexAssign.column >= 0)
+            generateSoaColumn(stmt->indexAssign.column);
+        g_backend->emitPushPrimary();
+        generateExpression(stmt->indexAssign.index);
+        g_backend->emitPushPrimary();
+        generateExpression(stmt->indexAssign.value);
+        g_backend->emitArrayStore(stmt->indexAssign.checked);
+        break;
+    }
     case AST_PRINT_STMT: {
+        /* Una cadena se imprime desde el constructor, sin crear el string */
+        if (stmt->printStmt.expr && stmt->printStmt.expr->type == AST_STRING_BUILD) {
+            generateStringBuild(stmt->printStmt.expr, 1);
+            break;
+        }
         generateExpression(stmt->printStmt.expr);
+        if (stmt->printStmt.isString) {
+            g_backend->emitStrPrint();
+            break;
+        }
         fprintf(g_backend->out, "    mov rsi, rax\n");
         fprintf(g_backend->out, "    lea rdi, [rip+fmt]\n");
         fprintf(g_backend->out, "    xor eax, eax\n");
@@ -199,58 +1381,59 @@ static void generateStatement(AstNode *stmt) {
         break;
     }
     case AST_FUNC_DEF: {
-        fprintf(g_backend->out, "\n.global %s\n%s:\n", stmt->funcDef.name, stmt->funcDef.name);
-        for (int i = 0; i < stmt->funcDef.bodyCount; i++) {
-            generateStatement(stmt->funcDef.body[i]);
-        }
-        fprintf(g_backend->out, "    ret    ; fin de función %s\n", stmt->funcDef.name);
+        generateFunction(stmt, stmt->funcDef.name);
         break;
     }
     case AST_RETURN_STMT: {
         generateExpression(stmt->returnStmt.expr);
-        fprintf(g_backend->out, "    ret\n");
+        if (returnLabel[0])
+            g_backend->emitJump(returnLabel);
+        else
+            g_backend->emitFunctionEnd(NULL, 0);
         break;
     }
     case AST_IF_STMT: {
         char labelElse[32], labelEnd[32];
         getNewLabel(labelElse, "ELSE");
         getNewLabel(labelEnd, "ENDIF");
-        generateExpression(stmt->ifStmt.condition);
-        fprintf(g_backend->out, "    cmp rax, 0\n");
-        g_backend->emitJumpIfZero(labelElse);
-        for (int i = 0; i < stmt->ifStmt.thenCount; i++) {
-            generateStatement(stmt->ifStmt.thenBranch[i]);
-        }
+        generateJumpIfFalse(stmt->ifStmt.condition, labelElse);
+        generateStatementList(stmt->ifStmt.thenBranch, stmt->ifStmt.thenCount);
         g_backend->emitJump(labelEnd);
-        fprintf(g_backend->out, "%s:\n", labelElse);
-        for (int i = 0; i < stmt->ifStmt.elseCount; i++) {
-            generateStatement(stmt->ifStmt.elseBranch[i]);
-        }
-        fprintf(g_backend->out, "%s:\n", labelEnd);
+        g_backend->emitSetLabel(labelElse);
+        generateStatementList(stmt->ifStmt.elseBranch, stmt->ifStmt.elseCount);
+        g_backend->emitSetLabel(labelEnd);
         break;
     }
     case AST_FOR_STMT: {
-        if (!isSymbolInTable(stmt->forStmt.iterator))
-            addSymbol(stmt->forStmt.iterator);
+        /* Un 'parallel for' dentro de otro se ejecuta secuencialmente en
+           el trozo: sus variables ya son privadas del bucle exterior */
+        if (stmt->forStmt.parallel && parallelDepth == 0) {
+            generateParallelFor(stmt);
+            break;
+        }
+        registerVariable(stmt->forStmt.iterator, VEC_NONE);
         char labelLoop[32], labelEnd[32];
         getNewLabel(labelLoop, "LOOP");
         getNewLabel(labelEnd, "LOOPEND");
         generateExpression(stmt->forStmt.rangeStart);
-        fprintf(g_backend->out, "    mov [%s], rax\n", stmt->forStmt.iterator);
-        fprintf(g_backend->out, "%s:\n", labelLoop);
+        storeVariable(stmt->forStmt.iterator);
+        g_backend->emitSetLabel(labelLoop);
+        /* Condición de continuación i < end, fusionada con el salto de salida */
+        loadVariable(stmt->forStmt.iterator);
+        g_backend->emitPushPrimary();
         generateExpression(stmt->forStmt.rangeEnd);
-        fprintf(g_backend->out, "    mov rbx, rax    ; rbx = end\n");
-        fprintf(g_backend->out, "    mov rax, [%s]   ; rax = i\n", stmt->forStmt.iterator);
-        fprintf(g_backend->out, "    cmp rax, rbx\n");
-        g_backend->emitJumpIfZero(labelEnd);
-        for (int i = 0; i < stmt->forStmt.bodyCount; i++) {
-            generateStatement(stmt->forStmt.body[i]);
-        }
-        fprintf(g_backend->out, "    mov rax, [%s]\n", stmt->forStmt.iterator);
-        fprintf(g_backend->out, "    add rax, 1\n");
-        fprintf(g_backend->out, "    mov [%s], rax\n", stmt->forStmt.iterator);
+        g_backend->emitPopSecondary();
+        g_backend->emitCompareJumpIfFalse(CMP_LT, labelEnd);
+        generateStatementList(stmt->forStmt.body, stmt->forStmt.bodyCount);
+        /* i = i + 1 */
+        loadVariable(stmt->forStmt.iterator);
+        g_backend->emitPushPrimary();
+        g_backend->emitLoadImmInt(1);
+        g_backend->emitPopSecondary();
+        g_backend->emitAdd();
+        storeVariable(stmt->forStmt.iterator);
         g_backend->emitJump(labelLoop);
-        fprintf(g_backend->out, "%s:\n", labelEnd);
+        g_backend->emitSetLabel(labelEnd);
         break;
     }
     case AST_IMPORT: {
@@ -259,11 +1442,11 @@ static void generateStatement(AstNode *stmt) {
         break;
     }
     case AST_CLASS_DEF: {
-        fprintf(g_backend->out, "    ; (class %s) => pendiente de implementación real\n", stmt->classDef.name);
+        generateClass(stmt);
         break;
     }
     case AST_LAMBDA: {
-        fprintf(g_backend->out, "    ; (lambda) => pendiente de implementación real\n");
+        fprintf(g_backend->out, "    ; (lambda sin usar) => sin efecto\n");
         break;
     }
     case AST_ARRAY_LITERAL: {
@@ -277,6 +1460,91 @@ static void generateStatement(AstNode *stmt) {
     fprintf(g_backend->out, "    ; ---- Fin Sentencia ----\n\n");
 }
 
+/* ==========================================================
+   generateParallelFor
+   El cuerpo se extrae a una función long f(inicio, fin) que recorre
+   su trozo con variables privadas y retorna la reducción parcial,
+   partiendo del elemento neutro. El flujo principal la salta y llama a
+   lyn_parallel_for, que reparte los trozos entre los hilos del runtime
+   y combina los parciales con el valor inicial de la variable.
+   ========================================================== */
+static long reduceIdentity(ReduceOp op) {
+    switch (op) {
+        case REDUCE_MUL: return 1;
+        case REDUCE_MIN: return LONG_MAX;
+        case REDUCE_MAX: return LONG_MIN;
+        default: return 0;
+    }
+}
+
+static void generateParallelFor(AstNode *stmt) {
+    char func[64], labelSkip[32], labelLoop[32], labelEnd[32], endName[96];
+    snprintf(func, sizeof(func), "__lyn_par_%d", parallelCount++);
+    getNewLabel(labelSkip, "PARSKIP");
+    getNewLabel(labelLoop, "PARLOOP");
+    getNewLabel(labelEnd, "PARLOOPEND");
+    ReduceOp op = stmt->forStmt.reduceOp;
+    int mark = privateCount;
+    const char *iterator = privatize(func, stmt->forStmt.iterator);
+    snprintf(endName, sizeof(endName), "%s__end", func);
+    if (!isSymbolInTable(endName)) {
+        addSymbol(endName);
+        symbolTable->threadLocal = 1;
+    }
+    const char *accumulator = op != REDUCE_NONE ? privatize(func, stmt->forStmt.reduceVar) : NULL;
+    privatizeWrites(func, stmt->forStmt.body, stmt->forStmt.bodyCount);
+
+    g_backend->emitJump(labelSkip);
+    g_backend->emitChunkBegin(func, iterator, endName);
+    if (accumulator) {
+        g_backend->emitLoadImmInt(reduceIdentity(op));
+        g_backend->emitStoreThreadLocal(accumulator);
+    }
+    g_backend->emitSetLabel(labelLoop);
+    g_backend->emitLoadThreadLocal(iterator);
+    g_backend->emitPushPrimary();
+    g_backend->emitLoadThreadLocal(endName);
+    g_backend->emitPopSecondary();
+    g_backend->emitCompareJumpIfFalse(CMP_LT, labelEnd);
+    parallelDepth++;
+    generateStatementList(stmt->forStmt.body, stmt->forStmt.bodyCount);
+    parallelDepth--;
+    g_backend->emitLoadThreadLocal(iterator);
+    g_backend->emitPushPrimary();
+    g_backend->emitLoadImmInt(1);
+    g_backend->emitPopSecondary();
+    g_backend->emitAdd();
+    g_backend->emitStoreThreadLocal(iterator);
+    g_backend->emitJump(labelLoop);
+    g_backend->emitSetLabel(labelEnd);
+    if (accumulator)
+        g_backend->emitLoadThreadLocal(accumulator);
+    else
+        g_backend->emitLoadImmInt(0);
+    g_backend->emitChunkEnd();
+    g_backend->emitSetLabel(labelSkip);
+    privateCount = mark;
+
+    /* Llamada al runtime con el rango y el valor inicial de la reducción */
+    generateExpression(stmt->forStmt.rangeStart);
+    g_backend->emitPushPrimary();
+    generateExpression(stmt->forStmt.rangeEnd);
+    g_backend->emitPushPrimary();
+    if (accumulator)
+        loadVariable(stmt->forStmt.reduceVar);
+    else
+        g_backend->emitLoadImmInt(0);
+    g_backend->emitParallelFor(func, (int)op);
+    if (accumulator)
+        storeVariable(stmt->forStmt.reduceVar);
+}
+
+/* Genera un bloque de sentencias en orden */
+static void generateStatementList(AstNode **stmts, int count) {
+    for (int i = 0; i < count; i++)
+        generateStatement(stmts[i]);
+}
+
 /* ==========================================================
    generateCode
    Función principal para generar el ensamblador final.
@@ -287,17 +1555,28 @@ void generateCode(AstNode *root, const char *filename) {
         fprintf(stderr, "Error al abrir archivo de salida.\n");
         exit(1);
     }
+    privateCount = 0;
+    parallelCount = 0;
+    parallelDepth = 0;
+    taskCount = 0;
+    functionDepth = 0;
+    privateFloor = 0;
+    substitutionCount = 0;
+    returnLabel[0] = '\0';
     /* Registrar variables globales */
     if (root->type == AST_PROGRAM) {
         for (int i = 0; i < root->program.statementCount; i++) {
             AstNode *st = root->program.statements[i];
-            if (st->type == AST_VAR_ASSIGN) {
-                if (!isSymbolInTable(st->varAssign.name))
-                    addSymbol(st->varAssign.name);
+            const char *name = NULL;
+            if (st->type == AST_VAR_ASSIGN && st->varAssign.fieldOffset < 0) {
+                name = st->varAssign.name;
+                registerVariable(name, vectorTypeOf(st->varAssign.initializer));
             } else if (st->type == AST_VAR_DECL) {
-                if (!isSymbolInTable(st->varDecl.name))
-                    addSymbol(st->varDecl.name);
+                name = st->varDecl.name;
+                registerVariable(name, declVectorType(st));
             }
+            if (name)
+                findSymbol(name)->topLevel = 1;
         }
     }
     /* Sección .data */
@@ -306,7 +1585,8 @@ void generateCode(AstNode *root, const char *filename) {
     fprintf(fp, "fmt: .asciz \"Result: %%ld\\n\"\n\n");
     Symbol *sym = symbolTable;
     while (sym) {
-        fprintf(fp, "%s: .quad 0\n", sym->name);
+        emitSymbolStorage(fp, sym);
+        sym->emitted = 1;
         sym = sym->next;
     }
     /* Sección .text */
@@ -315,20 +1595,78 @@ void generateCode(AstNode *root, const char *filename) {
     g_backend->out = fp;
     if (root->type == AST_PROGRAM) {
         fprintf(fp, "main:\n");
-        for (int i = 0; i < root->program.statementCount; i++) {
-            generateStatement(root->program.statements[i]);
-        }
-        /* Exit syscall */
-        fprintf(g_backend->out, "    mov rax, 60    ; exit\n");
+        generateStatementList(root->program.statements, root->program.statementCount);
+        /* exit_group: termina también los hilos del runtime paralelo */
+        fprintf(g_backend->out, "    mov rax, 231   ; exit_group\n");
         fprintf(g_backend->out, "    xor rdi, rdi   ; status=0\n");
         fprintf(g_backend->out, "    syscall\n");
     } else {
         fprintf(fp, "main:\n");
         generateStatement(root);
-        fprintf(g_backend->out, "    mov rax, 60\n");
+        fprintf(g_backend->out, "    mov rax, 231\n");
         fprintf(g_backend->out, "    xor rdi, rdi\n");
         fprintf(g_backend->out, "    syscall\n");
     }
+    /* Variables que aparecieron durante la generación (iteradores,
+       variables privadas de bucles paralelos) */
+    for (sym = symbolTable; sym; sym = sym->next) {
+        if (sym->emitted || sym->threadLocal)
+            continue;
+        fprintf(fp, "\n.data\n");
+        emitSymbolStorage(fp, sym);
+        sym->emitted = 1;
+    }
+    for (sym = symbolTable; sym; sym = sym->next) {
+        if (sym->emitted)
+            continue;
+        fprintf(fp, "\n.section .tbss,\"awT\",%%nobits\n.align 8\n%s: .zero 8\n", sym->name);
+        sym->emitted = 1;
+    }
+    if (root->type == AST_PROGRAM)
+        emitVtables(root);
+    emitLambdaVtables();
+    emitStringPool();
+    fclose(fp);
+    freeSymbolTable();
+    freeStringPool();
+}
+
+/* ==========================================================
+   generateNativeModule
+   Funciones sueltas para el nivel nativo de 'run', ensambladas como
+   biblioteca compartida: cada función con su entrada
+   '__lyn_native_<nombre>' y sus variables como globales del módulo.
+   ========================================================== */
+int generateNativeModule(AstNode **functions, int count, const char *filename) {
+    FILE *fp = fopen(filename, "w");
+    if (!fp)
+        return -1;
+    privateCount = 0;
+    parallelCount = 0;
+    parallelDepth = 0;
+    taskCount = 0;
+    functionDepth = 0;
+    privateFloor = 0;
+    substitutionCount = 0;
+    returnLabel[0] = '\0';
+    g_backend->out = fp;
+    g_backend->sharedObject = 1;
+    fprintf(fp, ".intel_syntax noprefix\n");
+    fprintf(fp, "\n.text\n");
+    for (int i = 0; i < count; i++)
+        generateFunction(functions[i], functions[i]->funcDef.name);
+    for (int i = 0; i < count; i++) {
+        char entry[288];
+        snprintf(entry, sizeof(entry), "__lyn_native_%s", functions[i]->funcDef.name);
+        g_backend->emitNativeEntry(entry, functions[i]->funcDef.name,
+                                   functions[i]->funcDef.paramCount);
+    }
+    fprintf(fp, "\n.data\n");
+    for (Symbol *sym = symbolTable; sym; sym = sym->next)
+        emitSymbolStorage(fp, sym);
+    g_backend->sharedObject = 0;
     fclose(fp);
     freeSymbolTable();
+    freeStringPool();
+    return 0;
 }
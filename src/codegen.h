@@ -11,4 +11,20 @@
  */
 void generateCode(AstNode *root, const char *filename);
 
+/**
+ * @brief Genera un módulo ensamblador con funciones sueltas, para cargarlo
+ *        como biblioteca compartida (el nivel nativo del intérprete).
+ *
+ * Cada función 'f' tiene además la entrada long __lyn_native_f(const long
+ * *args) para llamarla desde C. Las funciones solo pueden usar sus
+ * parámetros y variables locales, aritmética entera y llamadas entre
+ * ellas: el módulo no tiene variables globales ni enlaza con el runtime.
+ *
+ * @param functions FUNC_DEF de las funciones, con todas las que llaman.
+ * @param count Número de funciones.
+ * @param filename Archivo donde se escribe el ensamblador.
+ * @return int 0 si se escribió el módulo, -1 si no se pudo abrir el archivo.
+ */
+int generateNativeModule(AstNode **functions, int count, const char *filename);
+
 #endif
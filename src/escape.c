@@ -0,0 +1,644 @@
+/* escape.c */
+#include "escape.h"
+#include "ast.h"
+#include "memory.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+/* ============================
+   Estadísticas
+   ============================ */
+
+static EscapeStats stats;
+
+void escapeResetStats(void) {
+    memset(&stats, 0, sizeof(stats));
+}
+
+const EscapeStats *escapeGetStats(void) {
+    return &stats;
+}
+
+void escapeDumpStats(void) {
+    printf("Escape Analysis Stats:\n");
+    printf("  Objects           : %zu\n", stats.objects);
+    printf("  Arrays            : %zu\n", stats.arrays);
+    printf("  Heap allocated    : %zu\n", stats.heap);
+    printf("  Scalar replaced   : %zu\n", stats.scalarReplaced);
+    printf("  Field slots       : %zu\n", stats.fields);
+}
+
+static AstNode *program = NULL;
+static AstNode *definition = NULL;  /* Sentencia que crea el candidato en curso */
+static int inlineFailed = 0;        /* El constructor no se pudo expandir */
+
+/* ============================
+   Clases
+   ============================ */
+
+static AstNode *findClass(const char *name) {
+    for (int i = 0; i < program->program.statementCount; i++) {
+        AstNode *st = program->program.statements[i];
+        if (st->type == AST_CLASS_DEF && strcmp(st->classDef.name, name) == 0)
+            return st;
+    }
+    return NULL;
+}
+
+static AstNode *findMethod(AstNode *cls, const char *name) {
+    for (int i = 0; i < cls->classDef.memberCount; i++) {
+        AstNode *m = cls->classDef.members[i];
+        if (m && m->type == AST_FUNC_DEF && strcmp(m->funcDef.name, name) == 0)
+            return m;
+    }
+    return NULL;
+}
+
+static int isField(AstNode *cls, const char *field) {
+    for (int i = 0; i < cls->classDef.memberCount; i++) {
+        AstNode *m = cls->classDef.members[i];
+        if (m && m->type == AST_VAR_DECL && strcmp(m->varDecl.name, field) == 0)
+            return 1;
+    }
+    return 0;
+}
+
+/* Retorna el campo si 'name' tiene la forma "object.campo" */
+static const char *fieldOf(const char *name, const char *object) {
+    size_t len = strlen(object);
+    if (strncmp(name, object, len) == 0 && name[len] == '.')
+        return name + len + 1;
+    return NULL;
+}
+
+/* Nombre del slot que sustituye al campo: "p$x" no choca con ningún
+   identificador del lenguaje y el ensamblador lo acepta como símbolo */
+static int slotName(char *out, size_t size, const char *object, const char *field) {
+    return snprintf(out, size, "%s$%s", object, field) < (int)size;
+}
+
+/* ============================
+   Escape
+   ============================ */
+
+static int escapes(AstNode *node, const char *name, AstNode *cls);
+
+static int escapesList(AstNode **nodes, int count, const char *name, AstNode *cls) {
+    for (int i = 0; i < count; i++) {
+        if (escapes(nodes[i], name, cls))
+            return 1;
+    }
+    return 0;
+}
+
+/* Retorna 1 si algún uso de 'name' dentro de 'node' hace escapar la
+   referencia. Solo el acceso a campos de 'cls' no escapa; con cls == NULL
+   cualquier mención cuenta como escape. */
+static int escapes(AstNode *node, const char *name, AstNode *cls) {
+    if (!node)
+        return 0;
+    switch (node->type) {
+        case AST_IDENTIFIER:
+            return strcmp(node->identifier.name, name) == 0;
+        case AST_MEMBER_ACCESS: {
+            AstNode *object = node->memberAccess.object;
+            if (object && object->type == AST_IDENTIFIER &&
+                strcmp(object->identifier.name, name) == 0)
+                return !cls || !isField(cls, node->memberAccess.member);
+            return escapes(object, name, cls);
+        }
+        case AST_VAR_ASSIGN: {
+            if (node != definition) {
+                const char *field = fieldOf(node->varAssign.name, name);
+                if (strcmp(node->varAssign.name, name) == 0)
+                    return 1;
+                if (field && (!cls || !isField(cls, field)))
+                    return 1;
+            }
+            return escapes(node->varAssign.initializer, name, cls);
+        }
+        case AST_VAR_DECL:
+            if (node != definition && strcmp(node->varDecl.name, name) == 0)
+                return 1;
+            return escapes(node->varDecl.initializer, name, cls);
+        case AST_FUNC_CALL:
+            /* Argumento de una función o receptor de un método */
+            return escapesList(node->funcCall.arguments, node->funcCall.argCount, name, cls);
+        case AST_METHOD_CALL:
+            return escapes(node->methodCall.object, name, cls) ||
+                   escapesList(node->methodCall.arguments, node->methodCall.argCount, name, cls);
+        case AST_SPAWN:
+            /* La tarea puede ejecutarse en otro hilo después del ámbito */
+            return escapes(node->spawnExpr.call, name, cls);
+        case AST_AWAIT:
+            return escapes(node->awaitExpr.future, name, cls);
+        case AST_INDEX:
+            return escapes(node->indexExpr.array, name, cls) ||
+                   escapes(node->indexExpr.index, name, cls);
+        case AST_INDEX_ASSIGN:
+            return strcmp(node->indexAssign.name, name) == 0 ||
+                   escapes(node->indexAssign.index, name, cls) ||
+                   escapes(node->indexAssign.value, name, cls);
+        case AST_BINARY_OP:
+            return escapes(node->binaryOp.left, name, cls) ||
+                   escapes(node->binaryOp.right, name, cls);
+        case AST_ARRAY_LITERAL:
+            return escapesList(node->arrayLiteral.elements, node->arrayLiteral.elementCount, name, cls);
+        case AST_STRING_BUILD:
+            return escapesList(node->stringBuild.pieces, node->stringBuild.pieceCount, name, cls);
+        case AST_RETURN_STMT:
+            return escapes(node->returnStmt.expr, name, cls);
+        case AST_PRINT_STMT:
+            return escapes(node->printStmt.expr, name, cls);
+        case AST_IF_STMT:
+            return escapes(node->ifStmt.condition, name, cls) ||
+                   escapesList(node->ifStmt.thenBranch, node->ifStmt.thenCount, name, cls) ||
+                   escapesList(node->ifStmt.elseBranch, node->ifStmt.elseCount, name, cls);
+        case AST_FOR_STMT:
+            return strcmp(node->forStmt.iterator, name) == 0 ||
+                   escapes(node->forStmt.rangeStart, name, cls) ||
+                   escapes(node->forStmt.rangeEnd, name, cls) ||
+                   escapesList(node->forStmt.body, node->forStmt.bodyCount, name, cls);
+        case AST_LAMBDA:
+            /* Capturada por la lambda: puede sobrevivir al ámbito */
+            return escapes(node->lambda.body, name, NULL);
+        case AST_FUNC_DEF:
+            /* Global usada desde otra función */
+            return escapesList(node->funcDef.body, node->funcDef.bodyCount, name, NULL);
+        case AST_CLASS_DEF:
+            return escapesList(node->classDef.members, node->classDef.memberCount, name, NULL);
+        default:
+            return 0;
+    }
+}
+
+/* ============================
+   Expansión del constructor
+   ============================ */
+
+typedef struct {
+    const char *object;   /* Variable que recibe la instancia */
+    AstNode *cls;
+    AstNode *init;        /* __init__ o NULL */
+    AstNode **args;       /* Argumentos de la llamada al constructor */
+    int uses[64];         /* Usos de cada parámetro (sin contar self) */
+} Inline;
+
+static int paramIndex(Inline *ctx, const char *name) {
+    for (int i = 1; i < ctx->init->funcDef.paramCount && i <= 64; i++) {
+        AstNode *param = ctx->init->funcDef.parameters[i];
+        if (param->type == AST_IDENTIFIER && strcmp(param->identifier.name, name) == 0)
+            return i - 1;
+    }
+    return -1;
+}
+
+static const char *selfName(Inline *ctx) {
+    return ctx->init->funcDef.parameters[0]->identifier.name;
+}
+
+/* Copia 'expr'. Con ctx != NULL se copia desde el cuerpo de __init__: los
+   parámetros se sustituyen por los argumentos y self.campo por su slot. */
+static AstNode *inlineExpr(AstNode *expr, Inline *ctx) {
+    if (!expr || inlineFailed)
+        return NULL;
+    AstNode *copy = NULL;
+    switch (expr->type) {
+        case AST_NUMBER_LITERAL:
+            copy = createAstNode(AST_NUMBER_LITERAL);
+            copy->numberLiteral = expr->numberLiteral;
+            return copy;
+        case AST_STRING_LITERAL:
+            copy = createAstNode(AST_STRING_LITERAL);
+            memcpy(copy->stringLiteral.value, expr->stringLiteral.value,
+                   sizeof(copy->stringLiteral.value));
+            return copy;
+        case AST_IDENTIFIER:
+            if (ctx && ctx->init) {
+                int param = paramIndex(ctx, expr->identifier.name);
+                if (param >= 0) {
+                    ctx->uses[param]++;
+                    return inlineExpr(ctx->args[param], NULL);
+                }
+                if (strcmp(expr->identifier.name, selfName(ctx)) == 0) {
+                    /* self completo escapa desde el constructor */
+                    inlineFailed = 1;
+                    return NULL;
+                }
+            }
+            copy = createAstNode(AST_IDENTIFIER);
+            memcpy(copy->identifier.name, expr->identifier.name, sizeof(copy->identifier.name));
+            return copy;
+        case AST_MEMBER_ACCESS: {
+            AstNode *object = expr->memberAccess.object;
+            if (ctx && ctx->init && object && object->type == AST_IDENTIFIER &&
+                strcmp(object->identifier.name, selfName(ctx)) == 0) {
+                copy = createAstNode(AST_IDENTIFIER);
+                if (!isField(ctx->cls, expr->memberAccess.member) ||
+                    !slotName(copy->identifier.name, sizeof(copy->identifier.name),
+                              ctx->object, expr->memberAccess.member)) {
+                    freeAstNode(copy);
+                    inlineFailed = 1;
+                    return NULL;
+                }
+                return copy;
+            }
+            copy = createAstNode(AST_MEMBER_ACCESS);
+            copy->memberAccess.object = inlineExpr(object, ctx);
+            memcpy(copy->memberAccess.member, expr->memberAccess.member,
+                   sizeof(copy->memberAccess.member));
+            copy->memberAccess.offset = expr->memberAccess.offset;
+            copy->memberAccess.column = expr->memberAccess.column;
+            return copy;
+        }
+        case AST_BINARY_OP:
+            copy = createAstNode(AST_BINARY_OP);
+            copy->binaryOp.op = expr->binaryOp.op;
+            copy->binaryOp.left = inlineExpr(expr->binaryOp.left, ctx);
+            copy->binaryOp.right = inlineExpr(expr->binaryOp.right, ctx);
+            return copy;
+        case AST_FUNC_CALL:
+            copy = createAstNode(AST_FUNC_CALL);
+            memcpy(copy->funcCall.name, expr->funcCall.name, sizeof(copy->funcCall.name));
+            copy->funcCall.kind = expr->funcCall.kind;
+            memcpy(copy->funcCall.target, expr->funcCall.target, sizeof(copy->funcCall.target));
+            copy->funcCall.slot = expr->funcCall.slot;
+            copy->funcCall.callee = expr->funcCall.callee;
+            if (expr->funcCall.argCount > 0) {
+                copy->funcCall.arguments =
+                    (AstNode **)memory_alloc(expr->funcCall.argCount * sizeof(AstNode *));
+                for (int i = 0; i < expr->funcCall.argCount; i++)
+                    copy->funcCall.arguments[i] = inlineExpr(expr->funcCall.arguments[i], ctx);
+                copy->funcCall.argCount = expr->funcCall.argCount;
+            }
+            return copy;
+        default:
+            /* Lambdas, arreglos y llamadas a métodos se quedan en el montón */
+            inlineFailed = 1;
+            return NULL;
+    }
+}
+
+/* Lectura de self.campo en algún punto del cuerpo de __init__ */
+static int readsField(AstNode *node, const char *self, const char *field) {
+    if (!node)
+        return 0;
+    switch (node->type) {
+        case AST_MEMBER_ACCESS: {
+            AstNode *object = node->memberAccess.object;
+            if (object && object->type == AST_IDENTIFIER &&
+                strcmp(object->identifier.name, self) == 0 &&
+                strcmp(node->memberAccess.member, field) == 0)
+                return 1;
+            return readsField(object, self, field);
+        }
+        case AST_BINARY_OP:
+            return readsField(node->binaryOp.left, self, field) ||
+                   readsField(node->binaryOp.right, self, field);
+        case AST_FUNC_CALL:
+            for (int i = 0; i < node->funcCall.argCount; i++) {
+                if (readsField(node->funcCall.arguments[i], self, field))
+                    return 1;
+            }
+            return 0;
+        case AST_VAR_ASSIGN:
+            return readsField(node->varAssign.initializer, self, field);
+        default:
+            return 0;
+    }
+}
+
+static int assignsField(AstNode *init, const char *field) {
+    for (int i = 0; i < init->funcDef.bodyCount; i++) {
+        const char *target = fieldOf(init->funcDef.body[i]->varAssign.name,
+                                     init->funcDef.parameters[0]->identifier.name);
+        if (strcmp(target, field) == 0)
+            return 1;
+    }
+    return 0;
+}
+
+static int initReadsField(AstNode *init, const char *field) {
+    const char *self = init->funcDef.parameters[0]->identifier.name;
+    for (int i = 0; i < init->funcDef.bodyCount; i++) {
+        if (readsField(init->funcDef.body[i], self, field))
+            return 1;
+    }
+    return 0;
+}
+
+static AstNode *makeSlotStore(const char *object, const char *field, AstNode *value) {
+    AstNode *store = createAstNode(AST_VAR_ASSIGN);
+    slotName(store->varAssign.name, sizeof(store->varAssign.name), object, field);
+    store->varAssign.initializer = value;
+    return store;
+}
+
+/* El cuerpo de __init__ solo puede inicializar campos de self */
+static int isSimpleInit(AstNode *init, AstNode *cls, int argCount) {
+    if (init->funcDef.paramCount < 1 || init->funcDef.paramCount > 65 ||
+        init->funcDef.paramCount - 1 != argCount)
+        return 0;
+    for (int i = 0; i < init->funcDef.paramCount; i++) {
+        if (init->funcDef.parameters[i]->type != AST_IDENTIFIER)
+            return 0;
+    }
+    const char *self = init->funcDef.parameters[0]->identifier.name;
+    for (int i = 0; i < init->funcDef.bodyCount; i++) {
+        AstNode *st = init->funcDef.body[i];
+        const char *field = st && st->type == AST_VAR_ASSIGN ? fieldOf(st->varAssign.name, self) : NULL;
+        if (!field || !isField(cls, field))
+            return 0;
+    }
+    return 1;
+}
+
+static int isSimpleArg(AstNode *arg) {
+    return arg->type == AST_NUMBER_LITERAL || arg->type == AST_STRING_LITERAL ||
+           arg->type == AST_IDENTIFIER;
+}
+
+/* Expande 'object = Clase(args)' en almacenamientos a los slots de los
+   campos. Retorna el número de sentencias generadas o -1 si el constructor
+   hace algo más que inicializar campos. */
+static int expandConstructor(const char *object, AstNode *cls, AstNode *call, AstNode ***out) {
+    Inline ctx;
+    memset(&ctx, 0, sizeof(ctx));
+    ctx.object = object;
+    ctx.cls = cls;
+    ctx.init = findMethod(cls, "__init__");
+    ctx.args = call->funcCall.arguments;
+    if (ctx.init ? !isSimpleInit(ctx.init, cls, call->funcCall.argCount)
+                 : call->funcCall.argCount != 0)
+        return -1;
+
+    int capacity = cls->classDef.memberCount + (ctx.init ? ctx.init->funcDef.bodyCount : 0);
+    AstNode **items = (AstNode **)memory_alloc((capacity > 0 ? capacity : 1) * sizeof(AstNode *));
+    int n = 0;
+    char slot[256];
+    inlineFailed = 0;
+
+    /* Valores por defecto: se omiten si __init__ asigna el campo sin leerlo */
+    for (int i = 0; i < cls->classDef.memberCount && !inlineFailed; i++) {
+        AstNode *m = cls->classDef.members[i];
+        if (!m || m->type != AST_VAR_DECL)
+            continue;
+        if (!slotName(slot, sizeof(slot), object, m->varDecl.name)) {
+            inlineFailed = 1;
+            break;
+        }
+        if (ctx.init && assignsField(ctx.init, m->varDecl.name) &&
+            !initReadsField(ctx.init, m->varDecl.name))
+            continue;
+        AstNode *value = m->varDecl.initializer ? inlineExpr(m->varDecl.initializer, NULL)
+                                                : createAstNode(AST_NUMBER_LITERAL);
+        items[n++] = makeSlotStore(object, m->varDecl.name, value);
+    }
+
+    /* Cuerpo de __init__ con los argumentos sustituidos */
+    const char *self = ctx.init ? selfName(&ctx) : NULL;
+    for (int i = 0; ctx.init && i < ctx.init->funcDef.bodyCount && !inlineFailed; i++) {
+        AstNode *st = ctx.init->funcDef.body[i];
+        AstNode *value = inlineExpr(st->varAssign.initializer, &ctx);
+        items[n++] = makeSlotStore(object, fieldOf(st->varAssign.name, self), value);
+    }
+
+    /* Un argumento con posibles efectos debe evaluarse exactamente una vez y
+       ser el único, para no alterar el orden de evaluación */
+    int effects = 0;
+    for (int i = 0; i < call->funcCall.argCount && !inlineFailed; i++) {
+        if (isSimpleArg(ctx.args[i]))
+            continue;
+        if (ctx.uses[i] != 1 || ++effects > 1)
+            inlineFailed = 1;
+    }
+
+    if (inlineFailed) {
+        for (int i = 0; i < n; i++)
+            freeAstNode(items[i]);
+        memory_free(items);
+        return -1;
+    }
+    *out = items;
+    return n;
+}
+
+/* ============================
+   Reescritura de los usos
+   ============================ */
+
+static void rewriteList(AstNode **nodes, int count, const char *object);
+
+/* p.x pasa a leer el slot p$x y p.x = v a escribirlo */
+static void rewriteUses(AstNode *node, const char *object) {
+    if (!node)
+        return;
+    char slot[256];
+    switch (node->type) {
+        case AST_MEMBER_ACCESS: {
+            AstNode *target = node->memberAccess.object;
+            if (!target || target->type != AST_IDENTIFIER ||
+                strcmp(target->identifier.name, object) != 0) {
+                rewriteUses(target, object);
+                break;
+            }
+            slotName(slot, sizeof(slot), object, node->memberAccess.member);
+            freeAstNode(target);
+            node->type = AST_IDENTIFIER;
+            memcpy(node->identifier.name, slot, sizeof(node->identifier.name));
+            break;
+        }
+        case AST_VAR_ASSIGN: {
+            const char *field = fieldOf(node->varAssign.name, object);
+            if (field) {
+                slotName(slot, sizeof(slot), object, field);
+                memcpy(node->varAssign.name, slot, sizeof(node->varAssign.name));
+                node->varAssign.fieldOffset = -1;
+            }
+            rewriteUses(node->varAssign.initializer, object);
+            break;
+        }
+        case AST_VAR_DECL:
+            rewriteUses(node->varDecl.initializer, object);
+            break;
+        case AST_FUNC_CALL:
+            rewriteList(node->funcCall.arguments, node->funcCall.argCount, object);
+            break;
+        case AST_METHOD_CALL:
+            rewriteUses(node->methodCall.object, object);
+            rewriteList(node->methodCall.arguments, node->methodCall.argCount, object);
+            break;
+        case AST_AWAIT:
+            rewriteUses(node->awaitExpr.future, object);
+            break;
+        case AST_INDEX:
+            rewriteUses(node->indexExpr.array, object);
+            rewriteUses(node->indexExpr.index, object);
+            break;
+        case AST_INDEX_ASSIGN:
+            rewriteUses(node->indexAssign.index, object);
+            rewriteUses(node->indexAssign.value, object);
+            break;
+        case AST_BINARY_OP:
+            rewriteUses(node->binaryOp.left, object);
+            rewriteUses(node->binaryOp.right, object);
+            break;
+        case AST_ARRAY_LITERAL:
+            rewriteList(node->arrayLiteral.elements, node->arrayLiteral.elementCount, object);
+            break;
+        case AST_STRING_BUILD:
+            rewriteList(node->stringBuild.pieces, node->stringBuild.pieceCount, object);
+            break;
+        case AST_RETURN_STMT:
+            rewriteUses(node->returnStmt.expr, object);
+            break;
+        case AST_PRINT_STMT:
+            rewriteUses(node->printStmt.expr, object);
+            break;
+        case AST_IF_STMT:
+            rewriteUses(node->ifStmt.condition, object);
+            rewriteList(node->ifStmt.thenBranch, node->ifStmt.thenCount, object);
+            rewriteList(node->ifStmt.elseBranch, node->ifStmt.elseCount, object);
+            break;
+        case AST_FOR_STMT:
+            rewriteUses(node->forStmt.rangeStart, object);
+            rewriteUses(node->forStmt.rangeEnd, object);
+            rewriteList(node->forStmt.body, node->forStmt.bodyCount, object);
+            break;
+        default:
+            /* Lambdas y definiciones no mencionan a un objeto que no escapa */
+            break;
+    }
+}
+
+static void rewriteList(AstNode **nodes, int count, const char *object) {
+    for (int i = 0; i < count; i++)
+        rewriteUses(nodes[i], object);
+}
+
+/* ============================
+   Recorrido de ámbitos
+   ============================ */
+
+/* Cuerpo completo en el que se buscan los usos de un candidato */
+typedef struct {
+    AstNode ***body;
+    int *count;
+} Scope;
+
+/* Sustituye la sentencia 'index' de la lista por 'items' */
+static void spliceStatements(AstNode ***list, int *count, int index, AstNode **items, int n) {
+    int newCount = *count - 1 + n;
+    AstNode **result = (AstNode **)memory_alloc((newCount > 0 ? newCount : 1) * sizeof(AstNode *));
+    memcpy(result, *list, index * sizeof(AstNode *));
+    memcpy(result + index, items, n * sizeof(AstNode *));
+    memcpy(result + index + n, *list + index + 1, (*count - index - 1) * sizeof(AstNode *));
+    freeAstNode((*list)[index]);
+    memory_free(*list);
+    *list = result;
+    *count = newCount;
+}
+
+/* Analiza la sentencia 'index'; si crea un objeto que no escapa lo reemplaza
+   por sus campos y retorna el número de sentencias insertadas (-1 si no) */
+static int analyzeCandidate(AstNode ***list, int *count, int index, Scope *scope) {
+    AstNode *st = (*list)[index];
+    const char *name;
+    AstNode *init;
+    if (st->type == AST_VAR_DECL) {
+        name = st->varDecl.name;
+        init = st->varDecl.initializer;
+    } else if (st->type == AST_VAR_ASSIGN && !strchr(st->varAssign.name, '.')) {
+        name = st->varAssign.name;
+        init = st->varAssign.initializer;
+    } else {
+        return -1;
+    }
+    if (!init)
+        return -1;
+
+    AstNode *cls = NULL;
+    if (init->type == AST_ARRAY_LITERAL)
+        stats.arrays++;
+    else if (init->type == AST_FUNC_CALL && (cls = findClass(init->funcCall.name)))
+        stats.objects++;
+    else
+        return -1;
+
+    definition = st;
+    int escaped = escapesList(*scope->body, *scope->count, name, cls);
+    definition = NULL;
+
+    /* Los arreglos se quedan en el montón: el código indexa sus elementos
+       a partir de la dirección, y uno que nunca se usa ya lo elimina el
+       tree shaking. Las clases derivadas también: sus campos heredados se
+       inicializan en la base. */
+    AstNode **items = NULL;
+    int n = (escaped || !cls || cls->classDef.parent[0]) ? -1
+                                                        : expandConstructor(name, cls, init, &items);
+    if (n < 0) {
+        stats.heap++;
+        return -1;
+    }
+
+    char object[256];
+    memcpy(object, name, sizeof(object));
+    stats.scalarReplaced++;
+    for (int i = 0; i < cls->classDef.memberCount; i++) {
+        if (cls->classDef.members[i] && cls->classDef.members[i]->type == AST_VAR_DECL)
+            stats.fields++;
+    }
+    spliceStatements(list, count, index, items, n);
+    memory_free(items);
+    rewriteList(*scope->body, *scope->count, object);
+    return n;
+}
+
+static void analyzeList(AstNode ***list, int *count, Scope *scope) {
+    for (int i = 0; i < *count; i++) {
+        AstNode *st = (*list)[i];
+        if (!st)
+            continue;
+        if (st->type == AST_IF_STMT) {
+            analyzeList(&st->ifStmt.thenBranch, &st->ifStmt.thenCount, scope);
+            analyzeList(&st->ifStmt.elseBranch, &st->ifStmt.elseCount, scope);
+        } else if (st->type == AST_FOR_STMT) {
+            analyzeList(&st->forStmt.body, &st->forStmt.bodyCount, scope);
+        } else {
+            int inserted = analyzeCandidate(list, count, i, scope);
+            if (inserted >= 0)
+                i += inserted - 1;
+        }
+    }
+}
+
+static void analyzeFunction(AstNode *func) {
+    Scope scope = { &func->funcDef.body, &func->funcDef.bodyCount };
+    analyzeList(&func->funcDef.body, &func->funcDef.bodyCount, &scope);
+}
+
+void escapeAnalyzeProgram(AstNode *root) {
+    if (!root || root->type != AST_PROGRAM)
+        return;
+    program = root;
+
+    /* Primero el nivel superior: así una global que una función también
+       nombra se considera escapada antes de reescribir esa función */
+    Scope top = { &root->program.statements, &root->program.statementCount };
+    analyzeList(&root->program.statements, &root->program.statementCount, &top);
+
+    for (int i = 0; i < root->program.statementCount; i++) {
+        AstNode *st = root->program.statements[i];
+        if (st->type == AST_FUNC_DEF) {
+            analyzeFunction(st);
+        } else if (st->type == AST_CLASS_DEF) {
+            for (int j = 0; j < st->classDef.memberCount; j++) {
+                AstNode *m = st->classDef.members[j];
+                if (m && m->type == AST_FUNC_DEF)
+                    analyzeFunction(m);
+            }
+        }
+    }
+    program = NULL;
+}
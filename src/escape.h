@@ -0,0 +1,56 @@
+#ifndef ESCAPE_H
+#define ESCAPE_H
+
+#include "ast.h"
+
+/**
+ * @brief Contadores del análisis de escape.
+ */
+typedef struct {
+    size_t objects;         /* Instancias de clase asignadas a una variable */
+    size_t arrays;          /* Arreglos literales asignados a una variable */
+    size_t heap;            /* Sitios que siguen en el montón: escapan o su
+                               constructor no se puede expandir */
+    size_t scalarReplaced;  /* Objetos reemplazados por un slot por campo */
+    size_t fields;          /* Slots creados para los campos reemplazados */
+} EscapeStats;
+
+/**
+ * @brief Análisis de escape y reemplazo escalar de objetos.
+ *
+ * Para cada variable inicializada con una instancia de clase (`p: P = P(...)`)
+ * o un arreglo literal, comprueba dentro de su ámbito (el cuerpo de la función
+ * o el nivel superior) si la referencia escapa: pasarla como argumento o a un
+ * método, retornarla, reasignarla, imprimirla, capturarla en una lambda o, en
+ * el nivel superior, usarla desde una función.
+ *
+ * Los objetos que solo se usan a través de sus campos se reemplazan por un
+ * slot por campo (`p$x`, `p$y`) que el backend reserva como al resto de
+ * variables: el constructor se expande en almacenamientos a esos slots y
+ * `p.x` pasa a leer `p$x`. Así no se emite ninguna asignación en el montón
+ * para ellos.
+ * Los constructores que hacen algo más que inicializar campos se conservan.
+ *
+ * Debe ejecutarse después del análisis semántico y antes del tree shaking,
+ * que elimina los campos que nunca se leen.
+ *
+ * @param root Raíz del AST (AST_PROGRAM); se modifica en el sitio.
+ */
+void escapeAnalyzeProgram(AstNode *root);
+
+/**
+ * @brief Reinicia los contadores del análisis de escape.
+ */
+void escapeResetStats(void);
+
+/**
+ * @brief Retorna los contadores del análisis de escape acumulados.
+ */
+const EscapeStats *escapeGetStats(void);
+
+/**
+ * @brief Imprime los contadores del análisis de escape acumulados.
+ */
+void escapeDumpStats(void);
+
+#endif /* ESCAPE_H */
@@ -0,0 +1,335 @@
+/* gc.c - Recolector mark-sweep para el runtime (USE_GC) */
+#define _POSIX_C_SOURCE 200112L
+#include "memory.h"
+
+#ifdef USE_GC
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+#include <pthread.h>
+
+/* ============================
+   Estado global del heap
+   ============================ */
+
+/* Raíz global registrada */
+typedef struct GCRoot {
+    void **slot;
+    struct GCRoot *next;
+} GCRoot;
+
+/* Hilo mutador: su cima de la pila sombra */
+typedef struct GCThread {
+    GCFrame *top;
+    struct GCThread *next;
+} GCThread;
+
+/* gcLock protege todo el estado; gcCond despierta al recolector cuando un
+   hilo se detiene y a los hilos detenidos cuando la recolección termina. */
+static pthread_mutex_t gcLock = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t gcCond = PTHREAD_COND_INITIALIZER;
+
+static GCHeader *heapObjects = NULL;    /* Todos los objetos vivos o no marcados */
+static GCRoot *globalRoots = NULL;
+static GCThread *threads = NULL;
+static size_t threadCount = 0;
+static size_t parkedThreads = 0;
+static int collecting = 0;
+
+static SlabAllocator *gcSlab = NULL;    /* Objetos pequeños; no móvil */
+static size_t bytesSinceCollect = 0;
+static size_t nextCollectAt = MEMORY_GC_MIN_HEAP;
+static GCStats stats;
+
+static _Thread_local GCThread *currentThread = NULL;
+
+/* Pila de marcado explícita para no recurrir en estructuras profundas */
+static GCHeader **markStack = NULL;
+static size_t markCount = 0;
+static size_t markCapacity = 0;
+
+static double nowMs(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec * 1e3 + (double)ts.tv_nsec / 1e6;
+}
+
+static GCHeader *headerOf(void *ptr) {
+    return ((GCHeader *)ptr) - 1;
+}
+
+/* ============================
+   Hilos y safepoints
+   ============================ */
+
+/* Requiere gcLock */
+static void registerLocked(void) {
+    if (currentThread)
+        return;
+    GCThread *t = (GCThread *)memory_alloc(sizeof(GCThread));
+    t->top = NULL;
+    t->next = threads;
+    threads = t;
+    threadCount++;
+    currentThread = t;
+}
+
+/* Detiene el hilo mientras otro recolecta. Requiere gcLock. */
+static void parkLocked(void) {
+    while (collecting) {
+        parkedThreads++;
+        pthread_cond_broadcast(&gcCond);
+        pthread_cond_wait(&gcCond, &gcLock);
+        parkedThreads--;
+    }
+}
+
+void memory_gc_register_thread(void) {
+    pthread_mutex_lock(&gcLock);
+    parkLocked();
+    registerLocked();
+    pthread_mutex_unlock(&gcLock);
+}
+
+void memory_gc_unregister_thread(void) {
+    pthread_mutex_lock(&gcLock);
+    parkLocked();
+    GCThread **link = &threads;
+    while (*link && *link != currentThread)
+        link = &(*link)->next;
+    if (*link) {
+        *link = currentThread->next;
+        threadCount--;
+        memory_free(currentThread);
+    }
+    currentThread = NULL;
+    /* El recolector puede estar esperando a este hilo */
+    pthread_cond_broadcast(&gcCond);
+    pthread_mutex_unlock(&gcLock);
+}
+
+void memory_gc_safepoint(void) {
+    pthread_mutex_lock(&gcLock);
+    parkLocked();
+    pthread_mutex_unlock(&gcLock);
+}
+
+/* ============================
+   Pila sombra y raíces globales
+   ============================ */
+
+void memory_gc_push_frame(GCFrame *frame, void **roots, size_t rootCount) {
+    if (!currentThread)
+        memory_gc_register_thread();
+    frame->roots = roots;
+    frame->rootCount = rootCount;
+    frame->prev = currentThread->top;
+    currentThread->top = frame;
+}
+
+void memory_gc_pop_frame(GCFrame *frame) {
+    currentThread->top = frame->prev;
+}
+
+void memory_gc_add_root(void **slot) {
+    GCRoot *root = (GCRoot *)memory_alloc(sizeof(GCRoot));
+    root->slot = slot;
+    pthread_mutex_lock(&gcLock);
+    root->next = globalRoots;
+    globalRoots = root;
+    pthread_mutex_unlock(&gcLock);
+}
+
+void memory_gc_remove_root(void **slot) {
+    pthread_mutex_lock(&gcLock);
+    GCRoot **link = &globalRoots;
+    while (*link && (*link)->slot != slot)
+        link = &(*link)->next;
+    if (*link) {
+        GCRoot *dead = *link;
+        *link = dead->next;
+        memory_free(dead);
+    }
+    pthread_mutex_unlock(&gcLock);
+}
+
+/* ============================
+   Mark
+   ============================ */
+
+static void markPush(void *ptr) {
+    if (!ptr)
+        return;
+    GCHeader *header = headerOf(ptr);
+    if (header->marked)
+        return;
+    header->marked = 1;
+    if (!header->type || header->type->pointerCount == 0)
+        return;
+    if (markCount == markCapacity) {
+        markCapacity = markCapacity ? markCapacity * 2 : 256;
+        markStack = (GCHeader **)memory_realloc(markStack, markCapacity * sizeof(GCHeader *));
+    }
+    markStack[markCount++] = header;
+}
+
+static void markFromRoots(void) {
+    for (GCRoot *root = globalRoots; root; root = root->next)
+        markPush(*root->slot);
+    for (GCThread *t = threads; t; t = t->next) {
+        for (GCFrame *frame = t->top; frame; frame = frame->prev) {
+            for (size_t i = 0; i < frame->rootCount; i++)
+                markPush(frame->roots[i]);
+        }
+    }
+    while (markCount > 0) {
+        GCHeader *header = markStack[--markCount];
+        char *data = (char *)(header + 1);
+        for (size_t i = 0; i < header->type->pointerCount; i++)
+            markPush(*(void **)(data + header->type->pointerOffsets[i]));
+    }
+}
+
+/* ============================
+   Sweep
+   ============================ */
+
+static void sweep(void) {
+    GCHeader **link = &heapObjects;
+    size_t live = 0;
+    while (*link) {
+        GCHeader *header = *link;
+        if (header->marked) {
+            header->marked = 0;
+            live += header->size;
+            link = &header->next;
+            continue;
+        }
+        *link = header->next;
+        stats.objectsFreed++;
+        stats.bytesFreed += header->size;
+        memory_slab_free(gcSlab, header, sizeof(GCHeader) + header->size);
+    }
+    stats.liveBytes = live;
+}
+
+/* Recolección stop-the-world. Requiere gcLock y collecting == 0. */
+static void collectLocked(void) {
+    collecting = 1;
+    /* Espera a que el resto de hilos registrados se detengan */
+    size_t others = threadCount - (currentThread ? 1 : 0);
+    while (parkedThreads < others) {
+        pthread_cond_wait(&gcCond, &gcLock);
+        others = threadCount - (currentThread ? 1 : 0);
+    }
+    double start = nowMs();
+    markFromRoots();
+    sweep();
+    double pause = nowMs() - start;
+
+    stats.collections++;
+    stats.totalPauseMs += pause;
+    if (pause > stats.maxPauseMs)
+        stats.maxPauseMs = pause;
+    bytesSinceCollect = 0;
+    nextCollectAt = stats.liveBytes * MEMORY_GC_GROWTH;
+    if (nextCollectAt < MEMORY_GC_MIN_HEAP)
+        nextCollectAt = MEMORY_GC_MIN_HEAP;
+
+    collecting = 0;
+    pthread_cond_broadcast(&gcCond);
+}
+
+void memory_gc_collect(void) {
+    pthread_mutex_lock(&gcLock);
+    parkLocked();
+    registerLocked();
+    collectLocked();
+    pthread_mutex_unlock(&gcLock);
+}
+
+/* ============================
+   Asignación
+   ============================ */
+
+static void *allocObject(size_t size, const GCType *type) {
+    pthread_mutex_lock(&gcLock);
+    parkLocked();
+    registerLocked();
+    if (!gcSlab)
+        gcSlab = memory_slab_create();
+    if (bytesSinceCollect + size > nextCollectAt)
+        collectLocked();
+
+    GCHeader *header = (GCHeader *)memory_slab_alloc(gcSlab, sizeof(GCHeader) + size);
+    if (!header) {
+        fprintf(stderr, "Error: memory_alloc_gc failed to allocate %zu bytes\n", size);
+        exit(EXIT_FAILURE);
+    }
+    header->type = type;
+    header->size = size;
+    header->marked = 0;
+    header->next = heapObjects;
+    heapObjects = header;
+    bytesSinceCollect += size;
+    stats.objectsAllocated++;
+    stats.bytesAllocated += size;
+    pthread_mutex_unlock(&gcLock);
+
+    memset(header + 1, 0, size);
+#ifdef DEBUG_MEMORY
+    fprintf(stderr, "[memory_alloc_gc] header=%p data_ptr=%p size=%zu type=%s\n",
+            (void *)header, (void *)(header + 1), size, type ? type->name : "leaf");
+#endif
+    return (void *)(header + 1);
+}
+
+/* Los objetos del GC se muestrean sin seguimiento de bajas: mueren sin
+   pasar por memory_free */
+void* memory_alloc_gc_typed(size_t size, const GCType *type) {
+    void *ptr = allocObject(size, type);
+    if (memory_profile_active())
+        memory_profile_record(ptr, size, __builtin_return_address(0), 0);
+    return ptr;
+}
+
+void* memory_alloc_gc(size_t size) {
+    void *ptr = allocObject(size, NULL);
+    if (memory_profile_active())
+        memory_profile_record(ptr, size, __builtin_return_address(0), 0);
+    return ptr;
+}
+
+void memory_inc_ref(void *ptr) {
+    (void)ptr;
+}
+
+void memory_dec_ref(void *ptr) {
+    (void)ptr;
+}
+
+/* ============================
+   Estadísticas
+   ============================ */
+
+void memory_gc_get_stats(GCStats *out) {
+    pthread_mutex_lock(&gcLock);
+    *out = stats;
+    pthread_mutex_unlock(&gcLock);
+}
+
+void memory_gc_dumpStats(void) {
+    GCStats s;
+    memory_gc_get_stats(&s);
+    printf("GC Stats:\n");
+    printf("  Collections   : %zu\n", s.collections);
+    printf("  Objects alloc : %zu (%zu bytes)\n", s.objectsAllocated, s.bytesAllocated);
+    printf("  Objects freed : %zu (%zu bytes)\n", s.objectsFreed, s.bytesFreed);
+    printf("  Live bytes    : %zu\n", s.liveBytes);
+    printf("  Pause total   : %.3f ms\n", s.totalPauseMs);
+    printf("  Pause max     : %.3f ms\n", s.maxPauseMs);
+    printf("  Pause avg     : %.3f ms\n", s.collections ? s.totalPauseMs / (double)s.collections : 0.0);
+}
+
+#endif /* USE_GC */
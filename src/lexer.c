@@ -6,7 +6,7 @@
 #include <stdlib.h>
 
 #ifdef DEBUG_MEMORY
-    #define DBG_PRINT(...) fprintf(stderr, __VA_ARGS__)
+    #define DBG_PRINT(...) do { if (memory_trace_enabled()) fprintf(stderr, __VA_ARGS__); } while (0)
 #else
     #define DBG_PRINT(...) /* No hace nada */
 #endif
@@ -155,6 +155,10 @@ Token getNextToken(void) {
         else if (strcmp(token.lexeme, "css") == 0) token.type = TOKEN_CSS;
         else if (strcmp(token.lexeme, "register_event") == 0) token.type = TOKEN_REGISTER_EVENT;
         else if (strcmp(token.lexeme, "range") == 0) token.type = TOKEN_RANGE;
+        else if (strcmp(token.lexeme, "parallel") == 0) token.type = TOKEN_PARALLEL;
+        else if (strcmp(token.lexeme, "reduce") == 0) token.type = TOKEN_REDUCE;
+        else if (strcmp(token.lexeme, "spawn") == 0) token.type = TOKEN_SPAWN;
+        else if (strcmp(token.lexeme, "await") == 0) token.type = TOKEN_AWAIT;
         else if (strcmp(token.lexeme, "int") == 0) {
             token.type = TOKEN_INT;
             DBG_PRINT("Detected token: int as TOKEN_INT\n");
@@ -241,6 +245,11 @@ Token getNextToken(void) {
             token.lexeme[0] = '/';
             token.lexeme[1] = '\0';
             break;
+        case '%':
+            token.type = TOKEN_PERCENT;
+            token.lexeme[0] = '%';
+            token.lexeme[1] = '\0';
+            break;
         case '(':
             token.type = TOKEN_LPAREN;
             token.lexeme[0] = '(';
@@ -298,6 +307,10 @@ Token getNextToken(void) {
                 snprintf(token.lexeme, sizeof(token.lexeme), "Unknown character");
             }
             break;
+        case '@':
+            token.type = TOKEN_AT;
+            strcpy(token.lexeme, "@");
+            break;
         case '[':
             token.type = TOKEN_LBRACKET;
             strcpy(token.lexeme, "[");
@@ -46,7 +46,13 @@ typedef enum {
     TOKEN_UNKNOWN,         // 38: Caracteres no reconocidos
     TOKEN_LBRACKET,        // 39: [
     TOKEN_RBRACKET,         // 40: ]
-    TOKEN_COLON
+    TOKEN_COLON,           // 41: :
+    TOKEN_PERCENT,         // 42: %
+    TOKEN_PARALLEL,        // 43: parallel
+    TOKEN_REDUCE,          // 44: reduce
+    TOKEN_SPAWN,           // 45: spawn
+    TOKEN_AWAIT,           // 46: await
+    TOKEN_AT               // 47: @ (atributo)
 } TokenType;
 
 /**
@@ -1,12 +1,20 @@
+#define _POSIX_C_SOURCE 200809L
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>     // Para strcmp
+#include <fcntl.h>
+#include <unistd.h>     // dup/dup2 para silenciar las fases en 'run'
 #include "lexer.h"
 #include "parser.h"
 #include "ast.h"
 #include "semantic.h"
 #include "optimize.h"
+#include "escape.h"
+#include "treeshake.h"
+#include "bounds.h"
 #include "codegen.h"
+#include "bytecode.h"
+#include "vm.h"
 #include "memory.h"
 #include "arch.h"  // Define Architecture, setCurrentBackend(), etc.
 
@@ -17,17 +25,29 @@ void runLexerTest(const char *source);
 void runParserTest(const char *source, AstNode **astOut);
 void runOptimizeTest(AstNode **ast);
 void runSemanticTest(AstNode *ast);
+void runEscapeTest(AstNode *ast);
+void runTreeShakeTest(AstNode *ast);
+void runBoundsTest(AstNode *ast);
 void runCodegenTest(AstNode *ast);
 void runMemoryStats(void);
 
+// Modo 'run': interpreta un programa sin ensamblarlo
+int runScript(int argc, char **argv);
+
 // Prototipo para testear todos los backends
 void runAllBackendTests(const char *source);
 
 int main(int argc, char **argv) {
+    if (argc > 1 && strcmp(argv[1], "run") == 0)
+        return runScript(argc, argv);
+
     printf("=== Ejecución de pruebas de Lync Compiler ===\n\n");
 
-    /* 1) Detectar argumentos --target=arm|riscv|wasm|x86 */
+    /* 1) Detectar argumentos --target=arm|riscv|wasm|x86,
+          --memprof=<archivo> y --memprof-interval=<bytes> */
     Architecture arch = ARCH_X86_64;  /* Por defecto: x86_64 */
+    const char *memprofPath = NULL;
+    size_t memprofInterval = 0;
     for (int i = 1; i < argc; i++) {
         if (strncmp(argv[i], "--target=", 9) == 0) {
             const char *targetName = argv[i] + 9;
@@ -45,7 +65,16 @@ int main(int argc, char **argv) {
                 arch = ARCH_X86_64;
             }
         }
+        else if (strncmp(argv[i], "--memprof=", 10) == 0) {
+            memprofPath = argv[i] + 10;
+        }
+        else if (strncmp(argv[i], "--memprof-interval=", 19) == 0) {
+            memprofInterval = strtoul(argv[i] + 19, NULL, 10);
+        }
     }
+    /* Perfil de asignaciones del propio compilador, escrito al salir */
+    if (memprofPath && memory_profile_start(memprofPath, memprofInterval) != 0)
+        printf("Aviso: no se pudo activar el perfilador de memoria.\n");
     /* Se configura el backend seleccionado (la salida se puede redirigir a un archivo si se desea) */
     setCurrentBackend(arch, stdout);
 
@@ -98,6 +127,38 @@ int main(int argc, char **argv) {
         "    print(\"Iteración \" + i.to_str());\n"
         "end;\n"
         "\n"
+        "// Prueba de bucle paralelo con reducción\n"
+        "total: int = 0;\n"
+        "parallel for k in range(0, 1000) reduce(+: total);\n"
+        "    total = total + k * x;\n"
+        "end;\n"
+        "print(total);\n"
+        "\n"
+        "// Prueba de tareas ligeras\n"
+        "func triple(n: int) -> int;\n"
+        "    return n * 3;\n"
+        "end;\n"
+        "tarea = spawn triple(x);\n"
+        "print(await tarea);\n"
+        "\n"
+        "// Prueba de vectores SIMD\n"
+        "va: vec4i = vec4i(1, 2, 3, 4);\n"
+        "vb = va * 2 + vec4i(x);\n"
+        "print(hsum(shuffle(vb, 3, 2, 1, 0)));\n"
+        "vf: vec8f = vec8f(0.5);\n"
+        "print(hmax(vf * vec8f(1, 2, 3, 4, 5, 6, 7, 8)));\n"
+        "\n"
+        "// Prueba de arreglos tipados (sin comprobaciones de rango en el bucle)\n"
+        "datos: [int] = array(8);\n"
+        "for k in range(len(datos));\n"
+        "    datos[k] = k * k;\n"
+        "end;\n"
+        "acum: int = 0;\n"
+        "for k in range(1, len(datos));\n"
+        "    acum = acum + datos[k] - datos[k - 1];\n"
+        "end;\n"
+        "print(acum);\n"
+        "\n"
         "// Prueba de importación\n"
         "import python \"numpy\";\n"
         "arr: [int] = [1, 2, 3, 4];\n"
@@ -122,6 +183,15 @@ int main(int argc, char **argv) {
     runSemanticTest(ast);
     printf("Semantic Analysis: Análisis semántico completado.\n\n");
 
+    runEscapeTest(ast);
+    printf("Escape Analysis: Objetos que no escapan reemplazados por sus campos.\n\n");
+
+    runTreeShakeTest(ast);
+    printf("Tree Shaking: Definiciones no alcanzables eliminadas.\n\n");
+
+    runBoundsTest(ast);
+    printf("Bounds Checks: Accesos probados dentro de rango sin comprobación.\n\n");
+
     runCodegenTest(ast);
     printf("Code Generation: Código ensamblador generado.\n\n");
 
@@ -167,16 +237,44 @@ void runParserTest(const char *source, AstNode **astOut) {
 
 void runOptimizeTest(AstNode **ast) {
     printf("Running AST Optimization Test...\n");
+    optimizeResetStats();
     *ast = optimizeAST(*ast);
+    optimizeDumpStats();
     printf("AST Optimization Test Passed!\n\n");
 }
 
 void runSemanticTest(AstNode *ast) {
     printf("Running Semantic Analysis Test...\n");
     analyzeSemantics(ast);
+    buildStringChains(ast);
+    printf("String chains: %zu\n", optimizeGetStats()->stringChains);
     printf("Semantic Analysis Test Passed!\n\n");
 }
 
+void runEscapeTest(AstNode *ast) {
+    printf("Running Escape Analysis Test...\n");
+    escapeResetStats();
+    escapeAnalyzeProgram(ast);
+    escapeDumpStats();
+    printf("Escape Analysis Test Passed!\n\n");
+}
+
+void runTreeShakeTest(AstNode *ast) {
+    printf("Running Tree Shaking Test...\n");
+    treeShakeResetStats();
+    treeShakeProgram(ast);
+    treeShakeDumpStats();
+    printf("Tree Shaking Test Passed!\n\n");
+}
+
+void runBoundsTest(AstNode *ast) {
+    printf("Running Bounds Check Elimination Test...\n");
+    boundsResetStats();
+    boundsCheckProgram(ast);
+    boundsDumpStats();
+    printf("Bounds Check Elimination Test Passed!\n\n");
+}
+
 void runCodegenTest(AstNode *ast) {
     printf("Running Code Generation Test...\n");
     generateCode(ast, "output.s");
@@ -198,9 +296,105 @@ void runMemoryStats(void) {
 #endif
 }
 
+/* ==========================================================
+   runScript
+   lync run <archivo.lyn> [--tier-up[=N]] [--dump-bytecode] [--stats]
+   Las fases del compilador se ejecutan como en las pruebas, con su
+   salida de depuración descartada, y el programa se interpreta como
+   bytecode: sin ensamblador ni enlazador, un script corto arranca en
+   milisegundos.
+   ========================================================== */
+static char *readSource(const char *path) {
+    FILE *file = fopen(path, "rb");
+    if (!file)
+        return NULL;
+    fseek(file, 0, SEEK_END);
+    long size = ftell(file);
+    fseek(file, 0, SEEK_SET);
+    char *source = (char *)memory_alloc(size > 0 ? (size_t)size + 1 : 1);
+    size_t length = size > 0 ? fread(source, 1, (size_t)size, file) : 0;
+    source[length] = '\0';
+    fclose(file);
+    return source;
+}
+
+int runScript(int argc, char **argv) {
+    const char *path = NULL;
+    int dumpBytecode = 0;
+    int showStats = 0;
+    VmOptions options = { 0 };
+    for (int i = 2; i < argc; i++) {
+        if (strcmp(argv[i], "--tier-up") == 0)
+            options.tierThreshold = VM_DEFAULT_TIER_THRESHOLD;
+        else if (strncmp(argv[i], "--tier-up=", 10) == 0)
+            options.tierThreshold = strtol(argv[i] + 10, NULL, 10);
+        else if (strcmp(argv[i], "--dump-bytecode") == 0)
+            dumpBytecode = 1;
+        else if (strcmp(argv[i], "--stats") == 0)
+            showStats = 1;
+        else if (!path)
+            path = argv[i];
+        else
+            printf("Aviso: argumento '%s' ignorado.\n", argv[i]);
+    }
+    if (!path) {
+        fprintf(stderr, "Usage: %s run <file.lyn> [--tier-up[=N]] [--dump-bytecode] [--stats]\n", argv[0]);
+        return 1;
+    }
+    /* Con DEBUG_MEMORY cada asignación deja una línea en stderr; allí solo
+       deben verse los errores del compilador y del programa */
+    memory_set_trace(0);
+    char *source = readSource(path);
+    if (!source) {
+        fprintf(stderr, "Error: Cannot read '%s'.\n", path);
+        return 1;
+    }
+
+    /* Las fases escriben trazas en stdout: solo se ve la salida del programa */
+    fflush(stdout);
+    int savedStdout = dup(STDOUT_FILENO);
+    int devNull = open("/dev/null", O_WRONLY);
+    if (savedStdout >= 0 && devNull >= 0)
+        dup2(devNull, STDOUT_FILENO);
+    lexerInit(source);
+    AstNode *ast = parseProgram();
+    if (ast) {
+        ast = optimizeAST(ast);
+        analyzeSemantics(ast);
+        buildStringChains(ast);
+        escapeAnalyzeProgram(ast);
+        treeShakeProgram(ast);
+        boundsCheckProgram(ast);
+    }
+    BcProgram *program = ast ? bytecodeCompile(ast) : NULL;
+    fflush(stdout);
+    if (savedStdout >= 0 && devNull >= 0)
+        dup2(savedStdout, STDOUT_FILENO);
+    if (devNull >= 0)
+        close(devNull);
+    if (savedStdout >= 0)
+        close(savedStdout);
+    if (!program) {
+        fprintf(stderr, "Error: Parsing failed.\n");
+        memory_free(source);
+        return 1;
+    }
+
+    if (dumpBytecode)
+        bytecodeDump(program, stdout);
+    vmResetStats();
+    int status = vmRun(program, &options);
+    if (showStats)
+        vmDumpStats();
+    bytecodeFree(program);
+    freeAst(ast);
+    memory_free(source);
+    return status;
+}
+
 /* ==========================================================
    runAllBackendTests
-   Ejecuta todas las fases (lexer, parser, optimización, semántica, codegen)
+   Ejecuta todas las fases (lexer, parser, optimización, semántica, escape, tree shaking, rangos, codegen)
    para cada backend disponible.
    ========================================================== */
 void runAllBackendTests(const char *source) {
@@ -226,8 +420,18 @@ void runAllBackendTests(const char *source) {
         printf("Optimizer: AST optimizado para %s.\n", archNames[i]);
 
         analyzeSemantics(ast);
+        buildStringChains(ast);
         printf("Semantic Analysis: Completado para %s.\n", archNames[i]);
 
+        escapeAnalyzeProgram(ast);
+        printf("Escape Analysis: Completado para %s.\n", archNames[i]);
+
+        treeShakeProgram(ast);
+        printf("Tree Shaking: Completado para %s.\n", archNames[i]);
+
+        boundsCheckProgram(ast);
+        printf("Bounds Checks: Completado para %s.\n", archNames[i]);
+
         generateCode(ast, "output.s");
         printf("Code Generation: Ensamblador generado para %s.\n", archNames[i]);
 
@@ -1,20 +1,131 @@
 #define _POSIX_C_SOURCE 200112L
+#define _DEFAULT_SOURCE
 #include "memory.h"
 #include <stdlib.h>
 #include <stdio.h>
 #include <string.h>
+#include <stdint.h>
+#include <stdatomic.h>
 #include <pthread.h>
 
-#ifdef USE_GC
-#include <stdatomic.h>
+#if defined(__unix__) || defined(__APPLE__)
+#define MEMORY_HAVE_MMAP 1
+#include <sys/mman.h>
+#else
+#define MEMORY_HAVE_MMAP 0
+#endif
+
+/* NUMA sin libnuma: getcpu y mbind con syscall directo */
+#if defined(__linux__)
+#define MEMORY_HAVE_NUMA 1
+#include <unistd.h>
+#include <sys/syscall.h>
+#ifndef MPOL_PREFERRED
+#define MPOL_PREFERRED 1
+#endif
+#else
+#define MEMORY_HAVE_NUMA 0
 #endif
 
 /* ============================
    Wrappers Básicos de Memoria
    ============================ */
 
-static size_t globalAllocCount = 0;
-static size_t globalFreeCount  = 0;
+/* Contadores por hilo. Solo el hilo dueño escribe su shard, así que un
+   incremento es una carga y un almacenamiento relajados (sin lock ni RMW);
+   los lectores suman todos los shards. Cada shard ocupa su propia línea de
+   caché para que los hilos no se la disputen. */
+#define MEMORY_CACHE_LINE 64
+
+typedef struct StatsShard {
+    atomic_size_t allocs;
+    atomic_size_t frees;
+    atomic_size_t bytes;
+    atomic_size_t classAllocs[MEMORY_STATS_SIZE_CLASSES];
+    atomic_size_t classBytes[MEMORY_STATS_SIZE_CLASSES];
+    struct StatsShard *next;
+    struct StatsShard *prev;
+} StatsShard;
+
+static pthread_mutex_t shardMutex = PTHREAD_MUTEX_INITIALIZER;
+static StatsShard *shards = NULL;
+static MemoryAllocStats retiredStats;   /* Hilos terminados; requiere shardMutex */
+static pthread_once_t shardKeyOnce = PTHREAD_ONCE_INIT;
+static pthread_key_t shardKey;
+static _Thread_local StatsShard *threadShard = NULL;
+
+/* Trazas de DEBUG_MEMORY en stderr; memory_set_trace las apaga */
+static atomic_int traceEnabled = 1;
+
+static void shardAdd(atomic_size_t *counter, size_t value) {
+    atomic_store_explicit(counter, atomic_load_explicit(counter, memory_order_relaxed) + value,
+                          memory_order_relaxed);
+}
+
+static size_t shardRead(atomic_size_t *counter) {
+    return atomic_load_explicit(counter, memory_order_relaxed);
+}
+
+/* Requiere shardMutex */
+static void shardAccumulate(StatsShard *shard, MemoryAllocStats *out) {
+    out->allocs += shardRead(&shard->allocs);
+    out->frees += shardRead(&shard->frees);
+    out->bytes += shardRead(&shard->bytes);
+    for (int c = 0; c < MEMORY_STATS_SIZE_CLASSES; c++) {
+        out->classAllocs[c] += shardRead(&shard->classAllocs[c]);
+        out->classBytes[c] += shardRead(&shard->classBytes[c]);
+    }
+}
+
+/* Destructor de pthread_key: los contadores del hilo pasan a retiredStats */
+static void retireShard(void *arg) {
+    StatsShard *shard = (StatsShard *)arg;
+    pthread_mutex_lock(&shardMutex);
+    shardAccumulate(shard, &retiredStats);
+    if (shard->prev)
+        shard->prev->next = shard->next;
+    else
+        shards = shard->next;
+    if (shard->next)
+        shard->next->prev = shard->prev;
+    pthread_mutex_unlock(&shardMutex);
+    threadShard = NULL;
+    free(shard);
+}
+
+static void createShardKey(void) {
+    pthread_key_create(&shardKey, retireShard);
+}
+
+/* Shard del hilo actual (NULL si no se pudo crear). Usa posix_memalign y no
+   memory_alloc, que lo llama. */
+static StatsShard *getShard(void) {
+    if (threadShard)
+        return threadShard;
+    void *mem = NULL;
+    size_t size = (sizeof(StatsShard) + MEMORY_CACHE_LINE - 1) & ~(size_t)(MEMORY_CACHE_LINE - 1);
+    if (posix_memalign(&mem, MEMORY_CACHE_LINE, size) != 0)
+        return NULL;
+    memset(mem, 0, size);
+    StatsShard *shard = (StatsShard *)mem;
+    pthread_once(&shardKeyOnce, createShardKey);
+    pthread_mutex_lock(&shardMutex);
+    shard->next = shards;
+    if (shards)
+        shards->prev = shard;
+    shards = shard;
+    pthread_mutex_unlock(&shardMutex);
+    pthread_setspecific(shardKey, shard);
+    threadShard = shard;
+    return shard;
+}
+
+static int statsClass(size_t size) {
+    int c = 0;
+    while (c + 1 < MEMORY_STATS_SIZE_CLASSES && ((size_t)1 << c) < size)
+        c++;
+    return c;
+}
 
 void* memory_alloc(size_t size) {
     void *ptr = malloc(size);
@@ -22,35 +133,53 @@ void* memory_alloc(size_t size) {
         fprintf(stderr, "Error: memory_alloc failed to allocate %zu bytes\n", size);
         exit(EXIT_FAILURE);
     }
+    StatsShard *shard = getShard();
+    if (shard) {
+        int c = statsClass(size);
+        shardAdd(&shard->allocs, 1);
+        shardAdd(&shard->bytes, size);
+        shardAdd(&shard->classAllocs[c], 1);
+        shardAdd(&shard->classBytes[c], size);
+    }
 #ifdef DEBUG_MEMORY
-    globalAllocCount++;
-    fprintf(stderr, "[memory_alloc] ptr=%p size=%zu (globalAllocCount=%zu)\n",
-            ptr, size, globalAllocCount);
+    if (atomic_load_explicit(&traceEnabled, memory_order_relaxed))
+        fprintf(stderr, "[memory_alloc] ptr=%p size=%zu (threadAllocCount=%zu)\n",
+                ptr, size, shard ? shardRead(&shard->allocs) : (size_t)0);
 #endif
+    if (memory_profile_active())
+        memory_profile_record(ptr, size, __builtin_return_address(0), 1);
     return ptr;
 }
 
 void memory_free(void *ptr) {
-#ifdef DEBUG_MEMORY
+    memory_profile_release(ptr);
     if (ptr) {
-        globalFreeCount++;
-        fprintf(stderr, "[memory_free] ptr=%p (globalFreeCount=%zu)\n",
-                ptr, globalFreeCount);
-    }
+        StatsShard *shard = getShard();
+        if (shard)
+            shardAdd(&shard->frees, 1);
+#ifdef DEBUG_MEMORY
+        if (atomic_load_explicit(&traceEnabled, memory_order_relaxed))
+            fprintf(stderr, "[memory_free] ptr=%p (threadFreeCount=%zu)\n",
+                    ptr, shard ? shardRead(&shard->frees) : (size_t)0);
 #endif
+    }
     free(ptr);
 }
 
 void* memory_realloc(void *ptr, size_t new_size) {
+    memory_profile_release(ptr);
     void *new_ptr = realloc(ptr, new_size);
     if (!new_ptr && new_size != 0) {
         fprintf(stderr, "Error: memory_realloc failed to reallocate to %zu bytes\n", new_size);
         exit(EXIT_FAILURE);
     }
 #ifdef DEBUG_MEMORY
-    fprintf(stderr, "[memory_realloc] old_ptr=%p new_ptr=%p new_size=%zu\n",
-            ptr, new_ptr, new_size);
+    if (atomic_load_explicit(&traceEnabled, memory_order_relaxed))
+        fprintf(stderr, "[memory_realloc] old_ptr=%p new_ptr=%p new_size=%zu\n",
+                ptr, new_ptr, new_size);
 #endif
+    if (memory_profile_active())
+        memory_profile_record(new_ptr, new_size, __builtin_return_address(0), 1);
     return new_ptr;
 }
 
@@ -58,29 +187,485 @@ void* memory_realloc(void *ptr, size_t new_size) {
    Implementación del Memory Pooling
    ============================ */
 
+typedef struct FreeBlock {
+    struct FreeBlock *next;
+} FreeBlock;
+
+/* Un slab ocupa slabSize bytes alineados a slabSize, de modo que el slab de
+   cualquier bloque se obtiene enmascarando su dirección. La cabecera va al
+   principio y los bloques a continuación. */
+/* Los bloques nunca usados no se enlazan: se sirven con un índice de avance
+   (bumpNext) y solo los bloques devueltos pasan por la lista libre. Así crear
+   un slab no toca más que la página de la cabecera. */
+typedef struct Slab {
+    struct Slab *next;         /* Lista de todos los slabs del pool */
+    struct Slab *prev;
+    struct Slab *partialNext;  /* Lista de slabs con bloques libres */
+    struct Slab *partialPrev;
+    FreeBlock *freeList;       /* Bloques devueltos de este slab */
+    char *bumpNext;            /* Primer bloque nunca usado */
+    size_t bumpLeft;           /* Bloques nunca usados restantes */
+    size_t freeCount;          /* Bloques libres (devueltos + nunca usados) */
+    size_t capacity;           /* Bloques que caben en el slab */
+    int inPartial;
+    int node;                  /* Nodo NUMA (0 sin MEMORY_POOL_NUMA) */
+} Slab;
+
 struct MemoryPool {
-    size_t blockSize;         /* Tamaño de cada bloque */
-    size_t poolSize;          /* Número total de bloques */
-    void *poolMemory;         /* Bloque contiguo de memoria asignado */
-    void *freeList;           /* Lista enlazada de bloques libres */
+    size_t blockSize;         /* Tamaño de cada bloque (múltiplo de la alineación) */
+    size_t poolSize;          /* Bloques reservados al crear el pool */
+    size_t alignment;         /* Alineación de cada bloque */
+    int flags;                /* MEMORY_POOL_POPULATE, MEMORY_POOL_HUGEPAGES, MEMORY_POOL_NUMA */
+    size_t slabSize;          /* Tamaño (potencia de dos) de cada slab */
+    size_t blocksOffset;      /* Desplazamiento del primer bloque en el slab */
+    size_t blocksPerSlab;
+    size_t minSlabs;          /* Slabs que nunca se devuelven al sistema */
+    size_t maxSlabs;          /* 0 = sin límite */
+    Slab *slabs;              /* Todos los slabs */
+    Slab *partial[MEMORY_NUMA_MAX_NODES]; /* Slabs con bloques libres, por nodo */
+    size_t slabCount;         /* Slabs actuales */
+    size_t peakSlabs;         /* Máximo de slabs simultáneos */
+    size_t slabsCreated;      /* Slabs reservados en total */
+    size_t slabsReleased;     /* Slabs devueltos al sistema */
+    size_t freeCount;         /* Bloques libres en los slabs (sin contar magazines) */
     size_t totalAllocs;       /* Número total de asignaciones realizadas */
     size_t totalFrees;        /* Número total de liberaciones realizadas */
-    pthread_mutex_t mutex;    /* Mutex para thread-safety */
+    size_t id;                /* Identificador único (no se reutiliza) */
+    struct MemoryPool *nextPool; /* Registro de pools vivos */
+    pthread_mutex_t mutex;    /* Protege los slabs y los contadores */
 };
 
-typedef struct FreeBlock {
-    struct FreeBlock *next;
-} FreeBlock;
+static size_t alignUp(size_t value, size_t alignment) {
+    return (value + alignment - 1) & ~(alignment - 1);
+}
+
+static size_t nextPowerOfTwo(size_t value) {
+    size_t p = 1;
+    while (p < value)
+        p <<= 1;
+    return p;
+}
+
+/* ----------------------------
+   Topología NUMA
+   ---------------------------- */
+
+static pthread_once_t numaOnce = PTHREAD_ONCE_INIT;
+static int numaNodes = 1;
+
+/* Cada hilo cachea su nodo y lo vuelve a consultar cada
+   MEMORY_NUMA_REFRESH rellenos por si el planificador lo migró */
+#define MEMORY_NUMA_REFRESH 64
+static _Thread_local int threadNode = -1;
+static _Thread_local unsigned threadNodeAge = 0;
+
+static void detectNumaNodes(void) {
+#if MEMORY_HAVE_NUMA
+    char path[64];
+    int count = 0;
+    for (int n = 0; n < 1024; n++) {
+        snprintf(path, sizeof(path), "/sys/devices/system/node/node%d", n);
+        if (access(path, F_OK) != 0)
+            break;
+        count++;
+    }
+    numaNodes = count < 1 ? 1 : (count > MEMORY_NUMA_MAX_NODES ? MEMORY_NUMA_MAX_NODES : count);
+#endif
+}
+
+int memory_numa_node_count(void) {
+    pthread_once(&numaOnce, detectNumaNodes);
+    return numaNodes;
+}
+
+int memory_numa_current_node(void) {
+    if (threadNode >= 0 && threadNodeAge++ % MEMORY_NUMA_REFRESH != 0)
+        return threadNode;
+    int node = 0;
+#if MEMORY_HAVE_NUMA && defined(SYS_getcpu)
+    unsigned cpu = 0, n = 0;
+    if (memory_numa_node_count() > 1 && syscall(SYS_getcpu, &cpu, &n, NULL) == 0)
+        node = (int)(n % MEMORY_NUMA_MAX_NODES);
+#endif
+    threadNode = node;
+    threadNodeAge = 1;
+    return node;
+}
+
+/* Nodo cuyos slabs usa el hilo actual en este pool */
+static int poolNode(MemoryPool *pool) {
+    return (pool->flags & MEMORY_POOL_NUMA) ? memory_numa_current_node() : 0;
+}
+
+/* Prefiere el nodo para las páginas aún no tocadas. Si mbind no está
+   disponible queda el primer toque, que las coloca en el nodo del hilo que
+   las escribe primero: el mismo que pidió el slab. */
+static void bindToNode(void *mem, size_t size, int node) {
+#if MEMORY_HAVE_NUMA && defined(SYS_mbind)
+    if (memory_numa_node_count() < 2)
+        return;
+    unsigned long mask = 1UL << node;
+    syscall(SYS_mbind, mem, size, MPOL_PREFERRED, &mask, sizeof(mask) * 8, 0);
+#else
+    (void)mem; (void)size; (void)node;
+#endif
+}
+
+/* Memoria de un slab alineada a su tamaño. Con mmap las páginas de un slab
+   liberado vuelven al sistema operativo inmediatamente, y las que nunca se
+   tocan no llegan a reservarse. */
+static void *slabMap(size_t size, int flags, int node) {
+#if MEMORY_HAVE_MMAP
+    char *mem = NULL;
+#ifdef MAP_POPULATE
+    /* Primer intento: el tamaño exacto ya prefaltado; sirve si sale alineado.
+       Con NUMA no: las páginas deben ligarse al nodo antes de tocarse. */
+    if ((flags & MEMORY_POOL_POPULATE) && !(flags & MEMORY_POOL_NUMA)) {
+        char *raw = mmap(NULL, size, PROT_READ | PROT_WRITE,
+                         MAP_PRIVATE | MAP_ANONYMOUS | MAP_POPULATE, -1, 0);
+        if (raw != MAP_FAILED && ((uintptr_t)raw & (size - 1)) == 0)
+            mem = raw;
+        else if (raw != MAP_FAILED)
+            munmap(raw, size);
+    }
+#endif
+    if (!mem) {
+        size_t span = size * 2;
+        char *raw = mmap(NULL, span, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+        if (raw == MAP_FAILED)
+            return NULL;
+        uintptr_t aligned = alignUp((uintptr_t)raw, size);
+        size_t head = aligned - (uintptr_t)raw;
+        if (head)
+            munmap(raw, head);
+        if (span - head - size)
+            munmap((char *)aligned + size, span - head - size);
+        mem = (char *)aligned;
+#ifdef MADV_HUGEPAGE
+        if (flags & MEMORY_POOL_HUGEPAGES)
+            madvise(mem, size, MADV_HUGEPAGE);
+#endif
+        if (flags & MEMORY_POOL_NUMA)
+            bindToNode(mem, size, node);
+        if (flags & MEMORY_POOL_POPULATE) {
+            /* Prefault manual: una escritura por página */
+            for (size_t off = 0; off < size; off += MEMORY_PAGE_SIZE)
+                ((volatile char *)mem)[off] = 0;
+        }
+    }
+    return mem;
+#else
+    (void)node;
+    void *mem = NULL;
+    if (posix_memalign(&mem, size, size) != 0)
+        return NULL;
+    if (flags & MEMORY_POOL_POPULATE)
+        memset(mem, 0, size);
+    return mem;
+#endif
+}
+
+static void slabUnmap(void *mem, size_t size) {
+#if MEMORY_HAVE_MMAP
+    munmap(mem, size);
+#else
+    (void)size;
+    free(mem);
+#endif
+}
+
+static Slab *slabOf(MemoryPool *pool, void *block) {
+    return (Slab *)((uintptr_t)block & ~(uintptr_t)(pool->slabSize - 1));
+}
+
+static void partialPush(MemoryPool *pool, Slab *slab) {
+    Slab **head = &pool->partial[slab->node];
+    slab->partialPrev = NULL;
+    slab->partialNext = *head;
+    if (*head)
+        (*head)->partialPrev = slab;
+    *head = slab;
+    slab->inPartial = 1;
+}
+
+static void partialRemove(MemoryPool *pool, Slab *slab) {
+    if (slab->partialPrev)
+        slab->partialPrev->partialNext = slab->partialNext;
+    else
+        pool->partial[slab->node] = slab->partialNext;
+    if (slab->partialNext)
+        slab->partialNext->partialPrev = slab->partialPrev;
+    slab->inPartial = 0;
+}
+
+/* Reserva un slab nuevo en el nodo indicado. Requiere pool->mutex. */
+static Slab *poolGrow(MemoryPool *pool, int node) {
+    if (pool->maxSlabs && pool->slabCount >= pool->maxSlabs)
+        return NULL;
+    Slab *slab = (Slab *)slabMap(pool->slabSize, pool->flags, node);
+    if (!slab)
+        return NULL;
+    slab->node = node;
+    slab->capacity = pool->blocksPerSlab;
+    slab->freeList = NULL;
+    slab->bumpNext = (char *)slab + pool->blocksOffset;
+    slab->bumpLeft = slab->capacity;
+    slab->freeCount = slab->capacity;
+    slab->prev = NULL;
+    slab->next = pool->slabs;
+    if (pool->slabs)
+        pool->slabs->prev = slab;
+    pool->slabs = slab;
+    partialPush(pool, slab);
+    pool->freeCount += slab->capacity;
+    pool->slabCount++;
+    pool->slabsCreated++;
+    if (pool->slabCount > pool->peakSlabs)
+        pool->peakSlabs = pool->slabCount;
+    return slab;
+}
+
+/* Devuelve al sistema un slab sin bloques en uso. Requiere pool->mutex. */
+static void poolRelease(MemoryPool *pool, Slab *slab) {
+    if (slab->inPartial)
+        partialRemove(pool, slab);
+    if (slab->prev)
+        slab->prev->next = slab->next;
+    else
+        pool->slabs = slab->next;
+    if (slab->next)
+        slab->next->prev = slab->prev;
+    pool->freeCount -= slab->freeCount;
+    pool->slabCount--;
+    pool->slabsReleased++;
+    slabUnmap(slab, pool->slabSize);
+}
+
+/* Toma un bloque libre del nodo, creciendo si hace falta y 'allowGrow' lo
+   permite. Si el nodo no puede crecer se toma de otro. Requiere pool->mutex. */
+static void *poolTakeBlock(MemoryPool *pool, int node, int allowGrow) {
+    Slab *slab = pool->partial[node];
+    if (!slab && allowGrow) {
+        slab = poolGrow(pool, node);
+        for (int n = 0; !slab && n < MEMORY_NUMA_MAX_NODES; n++)
+            slab = pool->partial[n];
+    }
+    if (!slab)
+        return NULL;
+    void *block;
+    if (slab->freeList) {
+        block = slab->freeList;
+        slab->freeList = slab->freeList->next;
+    } else {
+        block = slab->bumpNext;
+        slab->bumpNext += pool->blockSize;
+        slab->bumpLeft--;
+    }
+    slab->freeCount--;
+    pool->freeCount--;
+    if (slab->freeCount == 0)
+        partialRemove(pool, slab);
+    return block;
+}
+
+/* Devuelve un bloque a su slab; un slab vacío se libera si sobra.
+   Requiere pool->mutex. */
+static void poolReturnBlock(MemoryPool *pool, void *ptr) {
+    Slab *slab = slabOf(pool, ptr);
+    FreeBlock *block = (FreeBlock *)ptr;
+    block->next = slab->freeList;
+    slab->freeList = block;
+    slab->freeCount++;
+    pool->freeCount++;
+    if (!slab->inPartial)
+        partialPush(pool, slab);
+    if (slab->freeCount == slab->capacity && pool->slabCount > pool->minSlabs)
+        poolRelease(pool, slab);
+}
+
+/* ----------------------------
+   Cachés por hilo (magazines)
+   Cada hilo guarda hasta MEMORY_POOL_MAGAZINE_SIZE bloques por pool. La
+   ruta rápida de alloc/free no toma ningún lock; el mutex del pool solo se
+   toma para mover lotes de MEMORY_POOL_BATCH_SIZE bloques entre el magazine
+   y los slabs. Los contadores se acumulan en el magazine y se publican en
+   cada intercambio de lote.
+   ---------------------------- */
+
+typedef struct {
+    size_t poolId;            /* 0 = ranura libre */
+    size_t lastUse;           /* Reloj de la caché en el último uso (LRU) */
+    size_t count;             /* Bloques en el magazine */
+    size_t pendingAllocs;     /* Asignaciones aún no publicadas en el pool */
+    size_t pendingFrees;      /* Liberaciones aún no publicadas en el pool */
+    void *blocks[MEMORY_POOL_MAGAZINE_SIZE];
+} PoolMagazine;
+
+typedef struct {
+    PoolMagazine slots[MEMORY_POOL_CACHE_SLOTS];
+    size_t clock;
+} PoolCache;
+
+#define MEMORY_POOL_CACHE_SETS (MEMORY_POOL_CACHE_SLOTS / MEMORY_POOL_CACHE_WAYS)
+
+static _Thread_local PoolCache *threadCache = NULL;
+
+static pthread_mutex_t registryMutex = PTHREAD_MUTEX_INITIALIZER;
+static MemoryPool *poolRegistry = NULL;
+static size_t nextPoolId = 1;
+
+static pthread_once_t cacheKeyOnce = PTHREAD_ONCE_INIT;
+static pthread_key_t cacheKey;
+
+/* Requiere registryMutex */
+static MemoryPool *findPoolById(size_t id) {
+    for (MemoryPool *p = poolRegistry; p; p = p->nextPool) {
+        if (p->id == id)
+            return p;
+    }
+    return NULL;
+}
+
+/* Devuelve todo el magazine a su pool. Si el pool ya fue destruido, los
+   bloques desaparecieron con él y basta con vaciar la ranura. */
+static void flushMagazine(PoolMagazine *mag) {
+    if (mag->poolId == 0)
+        return;
+    pthread_mutex_lock(&registryMutex);
+    MemoryPool *pool = findPoolById(mag->poolId);
+    if (pool) {
+        pthread_mutex_lock(&pool->mutex);
+        for (size_t i = 0; i < mag->count; i++)
+            poolReturnBlock(pool, mag->blocks[i]);
+        pool->totalAllocs += mag->pendingAllocs;
+        pool->totalFrees += mag->pendingFrees;
+        pthread_mutex_unlock(&pool->mutex);
+    }
+    pthread_mutex_unlock(&registryMutex);
+    mag->poolId = 0;
+    mag->count = 0;
+    mag->pendingAllocs = 0;
+    mag->pendingFrees = 0;
+}
+
+/* Destructor de pthread_key: vacía los magazines del hilo que termina */
+static void destroyThreadCache(void *arg) {
+    PoolCache *cache = (PoolCache *)arg;
+    for (int i = 0; i < MEMORY_POOL_CACHE_SLOTS; i++)
+        flushMagazine(&cache->slots[i]);
+    free(cache);
+}
+
+static void createCacheKey(void) {
+    pthread_key_create(&cacheKey, destroyThreadCache);
+}
+
+/* Primera vía del conjunto que le corresponde al pool */
+static PoolMagazine *cacheSet(PoolCache *cache, size_t poolId) {
+    return &cache->slots[(poolId % MEMORY_POOL_CACHE_SETS) * MEMORY_POOL_CACHE_WAYS];
+}
+
+/* Magazine del hilo actual para el pool si ya tiene uno (NULL si no) */
+static PoolMagazine *findMagazine(size_t poolId) {
+    if (!threadCache)
+        return NULL;
+    PoolMagazine *set = cacheSet(threadCache, poolId);
+    for (int way = 0; way < MEMORY_POOL_CACHE_WAYS; way++) {
+        if (set[way].poolId == poolId)
+            return &set[way];
+    }
+    return NULL;
+}
+
+/* Magazine del hilo actual para el pool (NULL si no se pudo crear) */
+static PoolMagazine *getMagazine(MemoryPool *pool) {
+    if (!threadCache) {
+        pthread_once(&cacheKeyOnce, createCacheKey);
+        threadCache = (PoolCache *)calloc(1, sizeof(PoolCache));
+        if (!threadCache)
+            return NULL;
+        pthread_setspecific(cacheKey, threadCache);
+    }
+    PoolMagazine *set = cacheSet(threadCache, pool->id);
+    PoolMagazine *victim = &set[0];
+    for (int way = 0; way < MEMORY_POOL_CACHE_WAYS; way++) {
+        PoolMagazine *mag = &set[way];
+        if (mag->poolId == pool->id) {
+            mag->lastUse = ++threadCache->clock;
+            return mag;
+        }
+        /* Una vía libre, o si no la usada hace más tiempo */
+        if (victim->poolId != 0 && (mag->poolId == 0 || mag->lastUse < victim->lastUse))
+            victim = mag;
+    }
+    /* Conjunto lleno: se desaloja la vía menos reciente (camino poco frecuente) */
+    flushMagazine(victim);
+    victim->poolId = pool->id;
+    victim->lastUse = ++threadCache->clock;
+    return victim;
+}
+
+/* Mueve hasta MEMORY_POOL_BATCH_SIZE bloques de los slabs al magazine */
+static void refillMagazine(MemoryPool *pool, PoolMagazine *mag) {
+    pthread_mutex_lock(&pool->mutex);
+    pool->totalAllocs += mag->pendingAllocs;
+    pool->totalFrees += mag->pendingFrees;
+    mag->pendingAllocs = 0;
+    mag->pendingFrees = 0;
+    /* Solo se crece si el magazine sigue vacío: un lote no debe reservar
+       varios slabs de golpe */
+    int node = poolNode(pool);
+    while (mag->count < MEMORY_POOL_BATCH_SIZE) {
+        void *block = poolTakeBlock(pool, node, mag->count == 0);
+        if (!block)
+            break;
+        mag->blocks[mag->count++] = block;
+    }
+    pthread_mutex_unlock(&pool->mutex);
+}
+
+/* Devuelve un lote de MEMORY_POOL_BATCH_SIZE bloques a sus slabs */
+static void drainMagazine(MemoryPool *pool, PoolMagazine *mag) {
+    pthread_mutex_lock(&pool->mutex);
+    pool->totalAllocs += mag->pendingAllocs;
+    pool->totalFrees += mag->pendingFrees;
+    mag->pendingAllocs = 0;
+    mag->pendingFrees = 0;
+    for (size_t i = 0; i < MEMORY_POOL_BATCH_SIZE && mag->count > 0; i++)
+        poolReturnBlock(pool, mag->blocks[--mag->count]);
+    pthread_mutex_unlock(&pool->mutex);
+}
 
 MemoryPool *memory_pool_create(size_t blockSize, size_t poolSize, size_t alignment) {
+    return memory_pool_create_ex(blockSize, poolSize, alignment, 0);
+}
+
+MemoryPool *memory_pool_create_ex(size_t blockSize, size_t poolSize, size_t alignment, int flags) {
+    if (alignment == 0 || (alignment & (alignment - 1)) != 0) {
+        fprintf(stderr, "Error: memory pool alignment %zu is not a power of two.\n", alignment);
+        return NULL;
+    }
+    if (alignment < sizeof(FreeBlock *))
+        alignment = sizeof(FreeBlock *);
     if (blockSize < sizeof(FreeBlock *))
         blockSize = sizeof(FreeBlock *);
+    blockSize = alignUp(blockSize, alignment);
 
     MemoryPool *pool = (MemoryPool *)memory_alloc(sizeof(MemoryPool));
+    memset(pool, 0, sizeof(MemoryPool));
     pool->blockSize = blockSize;
     pool->poolSize = poolSize;
-    pool->totalAllocs = 0;
-    pool->totalFrees = 0;
+    pool->alignment = alignment;
+    pool->flags = flags;
+    pool->blocksOffset = alignUp(sizeof(Slab), alignment);
+    /* Al menos MEMORY_SLAB_MIN_BLOCKS bloques por slab */
+    size_t needed = pool->blocksOffset + blockSize * MEMORY_SLAB_MIN_BLOCKS;
+    size_t minSlab = (flags & MEMORY_POOL_HUGEPAGES) ? MEMORY_HUGEPAGE_SIZE : MEMORY_SLAB_SIZE;
+    pool->slabSize = nextPowerOfTwo(needed > minSlab ? needed : minSlab);
+    pool->blocksPerSlab = (pool->slabSize - pool->blocksOffset) / blockSize;
+    pool->minSlabs = (poolSize + pool->blocksPerSlab - 1) / pool->blocksPerSlab;
+    if (pool->minSlabs == 0)
+        pool->minSlabs = 1;
 
     if (pthread_mutex_init(&pool->mutex, NULL) != 0) {
         fprintf(stderr, "Error: Failed to initialize mutex in memory pool.\n");
@@ -88,168 +673,318 @@ MemoryPool *memory_pool_create(size_t blockSize, size_t poolSize, size_t alignme
         return NULL;
     }
 
-    int res = posix_memalign(&pool->poolMemory, alignment, blockSize * poolSize);
-    if (res != 0) {
-        fprintf(stderr, "Error: posix_memalign failed with error %d\n", res);
-        pthread_mutex_destroy(&pool->mutex);
-        memory_free(pool);
-        return NULL;
+    /* Sin MEMORY_POOL_POPULATE la creación es O(1): los slabs de la reserva se
+       mapean con el primer uso. Con él se mapean y prefaltan ahora. */
+    /* Con MEMORY_POOL_NUMA la reserva se reparte entre los nodos. */
+    int nodes = (flags & MEMORY_POOL_NUMA) ? memory_numa_node_count() : 1;
+    for (size_t i = 0; (flags & MEMORY_POOL_POPULATE) && i < pool->minSlabs && poolSize > 0; i++) {
+        if (!poolGrow(pool, (int)(i % (size_t)nodes))) {
+            fprintf(stderr, "Error: failed to map %zu bytes for memory pool slab\n", pool->slabSize);
+            while (pool->slabs)
+                poolRelease(pool, pool->slabs);
+            pthread_mutex_destroy(&pool->mutex);
+            memory_free(pool);
+            return NULL;
+        }
     }
-    memset(pool->poolMemory, 0, blockSize * poolSize);
 
-    pool->freeList = NULL;
-    for (size_t i = 0; i < poolSize; i++) {
-        void *block = (char *)pool->poolMemory + i * blockSize;
-        ((FreeBlock *)block)->next = pool->freeList;
-        pool->freeList = block;
-    }
+    pthread_mutex_lock(&registryMutex);
+    pool->id = nextPoolId++;
+    pool->nextPool = poolRegistry;
+    poolRegistry = pool;
+    pthread_mutex_unlock(&registryMutex);
 #ifdef DEBUG_MEMORY
-    fprintf(stderr, "[memory_pool_create] pool=%p blockSize=%zu poolSize=%zu alignment=%zu\n",
-            pool, blockSize, poolSize, alignment);
+    if (atomic_load_explicit(&traceEnabled, memory_order_relaxed))
+        fprintf(stderr, "[memory_pool_create] pool=%p blockSize=%zu poolSize=%zu alignment=%zu slabSize=%zu flags=%d\n",
+                pool, blockSize, poolSize, alignment, pool->slabSize, flags);
 #endif
     return pool;
 }
 
+void memory_pool_set_max_blocks(MemoryPool *pool, size_t maxBlocks) {
+    if (!pool) return;
+    pthread_mutex_lock(&pool->mutex);
+    pool->maxSlabs = (maxBlocks + pool->blocksPerSlab - 1) / pool->blocksPerSlab;
+    pthread_mutex_unlock(&pool->mutex);
+}
+
 void *memory_pool_alloc(MemoryPool *pool) {
     void *block = NULL;
-    pthread_mutex_lock(&pool->mutex);
-    if (pool->freeList) {
-        block = pool->freeList;
-        pool->freeList = ((FreeBlock *)block)->next;
-        pool->totalAllocs++;
+    PoolMagazine *mag = getMagazine(pool);
+    if (!mag) {
+        /* Sin caché por hilo: se usan directamente los slabs */
+        pthread_mutex_lock(&pool->mutex);
+        block = poolTakeBlock(pool, poolNode(pool), 1);
+        if (block)
+            pool->totalAllocs++;
+        pthread_mutex_unlock(&pool->mutex);
+        return block;
+    }
+    if (mag->count == 0)
+        refillMagazine(pool, mag);
+    if (mag->count > 0) {
+        block = mag->blocks[--mag->count];
+        mag->pendingAllocs++;
 #ifdef DEBUG_MEMORY
-        fprintf(stderr, "[memory_pool_alloc] pool=%p block=%p (totalAllocs=%zu)\n",
-                pool, block, pool->totalAllocs);
+        if (atomic_load_explicit(&traceEnabled, memory_order_relaxed))
+            fprintf(stderr, "[memory_pool_alloc] pool=%p block=%p\n", pool, block);
 #endif
     }
-    pthread_mutex_unlock(&pool->mutex);
     return block;
 }
 
 void memory_pool_free(MemoryPool *pool, void *ptr) {
     if (!ptr) return;
-    pthread_mutex_lock(&pool->mutex);
-    ((FreeBlock *)ptr)->next = pool->freeList;
-    pool->freeList = ptr;
-    pool->totalFrees++;
+    PoolMagazine *mag = getMagazine(pool);
+    if (!mag) {
+        pthread_mutex_lock(&pool->mutex);
+        poolReturnBlock(pool, ptr);
+        pool->totalFrees++;
+        pthread_mutex_unlock(&pool->mutex);
+        return;
+    }
+    /* Un bloque liberado en otro hilo entra en el magazine local y vuelve a
+       su slab dentro de un lote. Con NUMA, uno de otro nodo vuelve ya a su
+       slab: el magazine solo debe servir memoria local. */
+    if ((pool->flags & MEMORY_POOL_NUMA) && slabOf(pool, ptr)->node != memory_numa_current_node()) {
+        pthread_mutex_lock(&pool->mutex);
+        poolReturnBlock(pool, ptr);
+        pool->totalFrees++;
+        pthread_mutex_unlock(&pool->mutex);
+        return;
+    }
+    if (mag->count == MEMORY_POOL_MAGAZINE_SIZE)
+        drainMagazine(pool, mag);
+    mag->blocks[mag->count++] = ptr;
+    mag->pendingFrees++;
 #ifdef DEBUG_MEMORY
-    fprintf(stderr, "[memory_pool_free] pool=%p block=%p (totalFrees=%zu)\n",
-            pool, ptr, pool->totalFrees);
+    if (atomic_load_explicit(&traceEnabled, memory_order_relaxed))
+        fprintf(stderr, "[memory_pool_free] pool=%p block=%p\n", pool, ptr);
 #endif
-    pthread_mutex_unlock(&pool->mutex);
+}
+
+void memory_pool_flush_thread_cache(MemoryPool *pool) {
+    if (!pool)
+        return;
+    PoolMagazine *mag = findMagazine(pool->id);
+    if (mag)
+        flushMagazine(mag);
 }
 
 void memory_pool_destroy(MemoryPool *pool) {
     if (!pool) return;
+    /* Tras salir del registro ningún hilo puede devolverle bloques */
+    pthread_mutex_lock(&registryMutex);
+    MemoryPool **link = &poolRegistry;
+    while (*link && *link != pool)
+        link = &(*link)->nextPool;
+    if (*link)
+        *link = pool->nextPool;
+    pthread_mutex_unlock(&registryMutex);
+    PoolMagazine *mag = findMagazine(pool->id);
+    if (mag) {
+        mag->poolId = 0;
+        mag->count = 0;
+        mag->pendingAllocs = 0;
+        mag->pendingFrees = 0;
+    }
+    while (pool->slabs) {
+        Slab *next = pool->slabs->next;
+        slabUnmap(pool->slabs, pool->slabSize);
+        pool->slabs = next;
+    }
     pthread_mutex_destroy(&pool->mutex);
-    memory_free(pool->poolMemory);
     memory_free(pool);
 }
 
 size_t memory_pool_get_total_allocs(MemoryPool *pool) {
-    return pool ? pool->totalAllocs : 0;
+    if (!pool) return 0;
+    pthread_mutex_lock(&pool->mutex);
+    size_t total = pool->totalAllocs;
+    pthread_mutex_unlock(&pool->mutex);
+    return total;
 }
 
 size_t memory_pool_get_total_frees(MemoryPool *pool) {
-    return pool ? pool->totalFrees : 0;
+    if (!pool) return 0;
+    pthread_mutex_lock(&pool->mutex);
+    size_t total = pool->totalFrees;
+    pthread_mutex_unlock(&pool->mutex);
+    return total;
 }
 
 void memory_pool_dumpStats(MemoryPool *pool) {
     if (!pool) return;
+    /* Publica los contadores del hilo actual antes de mostrarlos */
+    memory_pool_flush_thread_cache(pool);
+    pthread_mutex_lock(&pool->mutex);
+    size_t allocs = pool->totalAllocs;
+    size_t frees = pool->totalFrees;
+    size_t freeCount = pool->freeCount;
+    size_t slabCount = pool->slabCount;
+    size_t peakSlabs = pool->peakSlabs;
+    size_t slabsCreated = pool->slabsCreated;
+    size_t slabsReleased = pool->slabsReleased;
+    size_t nodeSlabs[MEMORY_NUMA_MAX_NODES] = { 0 };
+    for (Slab *s = pool->slabs; s; s = s->next)
+        nodeSlabs[s->node]++;
+    pthread_mutex_unlock(&pool->mutex);
     printf("Memory Pool Stats:\n");
     printf("  Block size   : %zu\n", pool->blockSize);
     printf("  Pool size    : %zu\n", pool->poolSize);
-    printf("  Allocs       : %zu\n", pool->totalAllocs);
-    printf("  Frees        : %zu\n", pool->totalFrees);
-    size_t inUse = (pool->totalAllocs > pool->totalFrees)
-                    ? (pool->totalAllocs - pool->totalFrees)
-                    : 0;
+    printf("  Allocs       : %zu\n", allocs);
+    printf("  Frees        : %zu\n", frees);
+    size_t inUse = (allocs > frees) ? (allocs - frees) : 0;
     printf("  Blocks in use: %zu\n", inUse);
+    printf("  Free in slabs: %zu\n", freeCount);
+    printf("  Slabs        : %zu x %zu bytes (%zu blocks each, peak %zu)\n",
+           slabCount, pool->slabSize, pool->blocksPerSlab, peakSlabs);
+    printf("  Slabs mapped : %zu (released %zu)\n", slabsCreated, slabsReleased);
+    if (pool->flags & MEMORY_POOL_NUMA) {
+        printf("  NUMA slabs   :");
+        for (int n = 0; n < memory_numa_node_count(); n++)
+            printf(" node%d=%zu", n, nodeSlabs[n]);
+        printf("\n");
+    }
     printf("  Pool pointer : %p\n", (void*)pool);
 }
 
 /* ============================
-   Tracking Global de Memoria
+   Slab Allocator por Clases de Tamaño
    ============================ */
 
-size_t memory_get_global_alloc_count(void) {
-    return globalAllocCount;
+struct SlabAllocator {
+    MemoryPool *classes[MEMORY_SLAB_MAX_CLASSES];
+    size_t classSizes[MEMORY_SLAB_MAX_CLASSES];
+    int classCount;
+    size_t largeAllocs;       /* Peticiones mayores que la clase más grande */
+    size_t largeFrees;
+    pthread_mutex_t mutex;    /* Protege los contadores de objetos grandes */
+};
+
+SlabAllocator *memory_slab_create(void) {
+    return memory_slab_create_ex(0);
 }
 
-size_t memory_get_global_free_count(void) {
-    return globalFreeCount;
+SlabAllocator *memory_slab_create_ex(int flags) {
+    SlabAllocator *sa = (SlabAllocator *)memory_alloc(sizeof(SlabAllocator));
+    memset(sa, 0, sizeof(SlabAllocator));
+    /* Potencias de dos con tres pasos intermedios de 1/4: 32, 40, 48, 56,
+       64, 80... A partir de 32 bytes cada clase es como mucho 1.25 veces la
+       anterior, así que el desperdicio interno queda acotado al 25%. Los
+       pasos que no respetan la alineación se omiten (16, 24). */
+    for (size_t pow2 = MEMORY_SLAB_MIN_SIZE; pow2 < MEMORY_SLAB_MAX_SIZE; pow2 <<= 1) {
+        for (size_t step = 0; step < 4; step++) {
+            size_t size = pow2 + step * (pow2 / 4);
+            if (size % MEMORY_SLAB_ALIGNMENT != 0)
+                continue;
+            sa->classSizes[sa->classCount++] = size;
+        }
+    }
+    sa->classSizes[sa->classCount++] = MEMORY_SLAB_MAX_SIZE;
+    for (int i = 0; i < sa->classCount; i++) {
+        /* Sin reserva previa: cada clase crece bajo demanda */
+        sa->classes[i] = memory_pool_create_ex(sa->classSizes[i], 0, MEMORY_SLAB_ALIGNMENT, flags);
+        if (!sa->classes[i]) {
+            fprintf(stderr, "Error: memory_slab_create failed for class %zu\n", sa->classSizes[i]);
+            exit(EXIT_FAILURE);
+        }
+    }
+    pthread_mutex_init(&sa->mutex, NULL);
+    return sa;
 }
 
-/* ============================
-   Garbage Collection Opcional
-   ============================ */
-#ifdef USE_GC
-
-/**
- * @brief Asigna memoria gestionada por el GC.
- *
- * Reserva un bloque que incluye un encabezado GCHeader seguido de la data solicitada.
- *
- * @param size Tamaño de la data.
- * @return void* Puntero a la data (después del encabezado).
- */
-void* memory_alloc_gc(size_t size) {
-    size_t totalSize = sizeof(GCHeader) + size;
-    GCHeader *header = (GCHeader *)malloc(totalSize);
-    if (!header) {
-        fprintf(stderr, "Error: memory_alloc_gc failed to allocate %zu bytes\n", totalSize);
-        exit(EXIT_FAILURE);
+/* Índice de la clase más pequeña que contiene 'size' (-1 si es grande) */
+static int slabClassIndex(SlabAllocator *sa, size_t size) {
+    int lo = 0, hi = sa->classCount - 1;
+    if (size > sa->classSizes[hi])
+        return -1;
+    while (lo < hi) {
+        int mid = (lo + hi) / 2;
+        if (sa->classSizes[mid] >= size)
+            hi = mid;
+        else
+            lo = mid + 1;
     }
-    atomic_init(&header->refCount, 1);
-#ifdef DEBUG_MEMORY
-    globalAllocCount++;
-    fprintf(stderr, "[memory_alloc_gc] header=%p data_ptr=%p size=%zu, refcount=%zu (globalAllocCount=%zu)\n",
-            header, (void*)(header + 1), size, atomic_load(&header->refCount), globalAllocCount);
-#endif
-    return (void*)(header + 1);
+    return lo;
 }
 
-/**
- * @brief Incrementa el contador de referencias de un objeto GC.
- */
-void memory_inc_ref(void *ptr) {
-    if (ptr) {
-        GCHeader *header = ((GCHeader *)ptr) - 1;
-        size_t oldCount = atomic_fetch_add(&header->refCount, 1);
-#ifdef DEBUG_MEMORY
-        fprintf(stderr, "[memory_inc_ref] ptr=%p old refCount=%zu, new refCount=%zu\n",
-                ptr, oldCount, atomic_load(&header->refCount));
-#endif
+void *memory_slab_alloc(SlabAllocator *sa, size_t size) {
+    int idx = slabClassIndex(sa, size ? size : 1);
+    if (idx < 0) {
+        pthread_mutex_lock(&sa->mutex);
+        sa->largeAllocs++;
+        pthread_mutex_unlock(&sa->mutex);
+        return memory_alloc(size);
     }
+    return memory_pool_alloc(sa->classes[idx]);
 }
 
-/**
- * @brief Decrementa el contador de referencias y libera el objeto si llega a cero.
- *
- * Se usa un ciclo de compare_exchange para evitar problemas de concurrencia y se aborta
- * si se detecta que el contador ya es 0 (lo que indicaría un doble free).
- */
-void memory_dec_ref(void *ptr) {
+void memory_slab_free(SlabAllocator *sa, void *ptr, size_t size) {
     if (!ptr) return;
-    GCHeader *header = ((GCHeader *)ptr) - 1;
-    size_t expected = atomic_load(&header->refCount);
-    while (expected > 0) {
-        if (atomic_compare_exchange_weak(&header->refCount, &expected, expected - 1)) {
-#ifdef DEBUG_MEMORY
-            fprintf(stderr, "[memory_dec_ref] ptr=%p old refCount=%zu\n", ptr, expected);
-#endif
-            if (expected == 1) {
-                free(header);
-#ifdef DEBUG_MEMORY
-                globalFreeCount++;
-                fprintf(stderr, "[memory_dec_ref] ptr=%p freed (globalFreeCount=%zu)\n", ptr, globalFreeCount);
-#endif
-            }
-            return;
-        }
-        // Si falla, 'expected' se actualiza; repetir el ciclo.
+    int idx = slabClassIndex(sa, size ? size : 1);
+    if (idx < 0) {
+        pthread_mutex_lock(&sa->mutex);
+        sa->largeFrees++;
+        pthread_mutex_unlock(&sa->mutex);
+        memory_free(ptr);
+        return;
+    }
+    memory_pool_free(sa->classes[idx], ptr);
+}
+
+void memory_slab_dumpStats(SlabAllocator *sa) {
+    if (!sa) return;
+    printf("Slab Allocator Stats (%d size classes):\n", sa->classCount);
+    for (int i = 0; i < sa->classCount; i++) {
+        memory_pool_flush_thread_cache(sa->classes[i]);
+        if (memory_pool_get_total_allocs(sa->classes[i]) == 0)
+            continue;
+        printf("[class %zu bytes]\n", sa->classSizes[i]);
+        memory_pool_dumpStats(sa->classes[i]);
     }
-    fprintf(stderr, "Error: memory_dec_ref called on ptr=%p with refCount==0\n", ptr);
-    abort();
+    pthread_mutex_lock(&sa->mutex);
+    printf("Large allocs : %zu\n", sa->largeAllocs);
+    printf("Large frees  : %zu\n", sa->largeFrees);
+    pthread_mutex_unlock(&sa->mutex);
+}
+
+void memory_slab_destroy(SlabAllocator *sa) {
+    if (!sa) return;
+    for (int i = 0; i < sa->classCount; i++)
+        memory_pool_destroy(sa->classes[i]);
+    pthread_mutex_destroy(&sa->mutex);
+    memory_free(sa);
+}
+
+/* ============================
+   Tracking Global de Memoria
+   ============================ */
+
+void memory_get_alloc_stats(MemoryAllocStats *out) {
+    pthread_mutex_lock(&shardMutex);
+    *out = retiredStats;
+    for (StatsShard *shard = shards; shard; shard = shard->next)
+        shardAccumulate(shard, out);
+    pthread_mutex_unlock(&shardMutex);
+}
+
+size_t memory_get_global_alloc_count(void) {
+    MemoryAllocStats stats;
+    memory_get_alloc_stats(&stats);
+    return stats.allocs;
+}
+
+size_t memory_get_global_free_count(void) {
+    MemoryAllocStats stats;
+    memory_get_alloc_stats(&stats);
+    return stats.frees;
+}
+
+void memory_set_trace(int enabled) {
+    atomic_store_explicit(&traceEnabled, enabled != 0, memory_order_relaxed);
+}
+
+int memory_trace_enabled(void) {
+    return atomic_load_explicit(&traceEnabled, memory_order_relaxed);
 }
-#endif /* USE_GC */
@@ -50,23 +50,117 @@ void* memory_realloc(void *ptr, size_t new_size);
  *
  * El pool reserva un bloque contiguo de memoria, lo divide en bloques fijos,
  * mantiene una lista de bloques libres para reutilización y registra estadísticas.
+ * Cada hilo mantiene un magazine de bloques por pool, de modo que alloc/free
+ * no toman el mutex del pool salvo para intercambiar lotes con la lista compartida.
  */
 typedef struct MemoryPool MemoryPool;
 
+/* Capacidad del magazine por hilo y por pool */
+#ifndef MEMORY_POOL_MAGAZINE_SIZE
+#define MEMORY_POOL_MAGAZINE_SIZE 64
+#endif
+
+/* Bloques que se mueven de una vez entre el magazine y la lista compartida */
+#ifndef MEMORY_POOL_BATCH_SIZE
+#define MEMORY_POOL_BATCH_SIZE (MEMORY_POOL_MAGAZINE_SIZE / 2)
+#endif
+
+/* Pools con magazine simultáneo en un mismo hilo. La caché es asociativa
+   por conjuntos de MEMORY_POOL_CACHE_WAYS vías: los ~40 pools de clase de
+   un SlabAllocator, con ids consecutivos, caben sin desalojarse. */
+#ifndef MEMORY_POOL_CACHE_SLOTS
+#define MEMORY_POOL_CACHE_SLOTS 64
+#endif
+
+#ifndef MEMORY_POOL_CACHE_WAYS
+#define MEMORY_POOL_CACHE_WAYS 4
+#endif
+
+#if MEMORY_POOL_CACHE_SLOTS % MEMORY_POOL_CACHE_WAYS != 0
+#error "MEMORY_POOL_CACHE_SLOTS debe ser múltiplo de MEMORY_POOL_CACHE_WAYS"
+#endif
+
+/* Tamaño mínimo de un slab (potencia de dos); cada slab está alineado a su tamaño */
+#ifndef MEMORY_SLAB_SIZE
+#define MEMORY_SLAB_SIZE 65536
+#endif
+
+/* Bloques mínimos por slab para pools de bloques grandes */
+#ifndef MEMORY_SLAB_MIN_BLOCKS
+#define MEMORY_SLAB_MIN_BLOCKS 8
+#endif
+
 /**
  * @brief Crea un pool de memoria para objetos de tamaño fijo.
  *
- * @param blockSize Tamaño de cada bloque en bytes.
- * @param poolSize Número total de bloques a reservar.
+ * La memoria se organiza en slabs alineados a página que se mapean al primer
+ * uso. Si se agotan los bloques el pool crece con un slab nuevo, y los slabs
+ * que quedan vacíos por encima de la reserva se devuelven al sistema operativo.
+ *
+ * @param blockSize Tamaño de cada bloque en bytes (se redondea a la alineación).
+ * @param poolSize Número de bloques de la reserva (sus slabs nunca se liberan).
  * @param alignment Alineación requerida (por ejemplo, 16, 32 o 64 bytes).
  * @return MemoryPool* Puntero al pool creado o NULL en caso de error.
  */
 MemoryPool *memory_pool_create(size_t blockSize, size_t poolSize, size_t alignment);
 
+/* Flags de memory_pool_create_ex */
+#define MEMORY_POOL_POPULATE  0x1   /* Mapear y prefaltar la reserva al crear el pool */
+#define MEMORY_POOL_HUGEPAGES 0x2   /* Slabs de MEMORY_HUGEPAGE_SIZE con MADV_HUGEPAGE */
+#define MEMORY_POOL_NUMA      0x4   /* Slabs ligados a un nodo NUMA; cada hilo usa los de su nodo */
+
+#ifndef MEMORY_PAGE_SIZE
+#define MEMORY_PAGE_SIZE 4096
+#endif
+#ifndef MEMORY_HUGEPAGE_SIZE
+#define MEMORY_HUGEPAGE_SIZE (2 * 1024 * 1024)
+#endif
+#ifndef MEMORY_NUMA_MAX_NODES
+#define MEMORY_NUMA_MAX_NODES 8     /* Los nodos por encima se pliegan sobre estos */
+#endif
+
+/**
+ * @brief Crea un pool de memoria con opciones de respaldo.
+ *
+ * Igual que memory_pool_create con flags = 0. Sin MEMORY_POOL_POPULATE la
+ * creación es O(1): los slabs se mapean al primer uso y sus bloques se
+ * sirven con un índice de avance, así que la memoria que nunca se usa no
+ * llega a tocarse. Con MEMORY_POOL_POPULATE la reserva se mapea y prefalta
+ * al crear el pool (MAP_POPULATE), útil cuando la latencia del primer
+ * acceso importa más que el tiempo de arranque.
+ *
+ * Con MEMORY_POOL_NUMA cada slab pertenece a un nodo NUMA (mbind con
+ * MPOL_PREFERRED, o primer toque si el sistema no lo admite) y el pool
+ * guarda una lista de slabs parciales por nodo: el magazine de un hilo se
+ * rellena con bloques de su nodo y solo toma de otro cuando el suyo no
+ * puede crecer. La reserva prefaltada se reparte entre los nodos.
+ *
+ * @param blockSize Tamaño de cada bloque en bytes.
+ * @param poolSize Número de bloques reservados (nunca se liberan).
+ * @param alignment Alineación requerida de cada bloque.
+ * @param flags Combinación de MEMORY_POOL_POPULATE, MEMORY_POOL_HUGEPAGES y
+ *              MEMORY_POOL_NUMA.
+ * @return MemoryPool* Puntero al pool creado o NULL en caso de error.
+ */
+MemoryPool *memory_pool_create_ex(size_t blockSize, size_t poolSize, size_t alignment, int flags);
+
+/**
+ * @brief Limita el número de bloques que el pool puede llegar a tener.
+ *
+ * Pensado para el modo embedded: con un límite el consumo de memoria queda
+ * acotado y memory_pool_alloc retorna NULL al alcanzarlo. El límite se
+ * redondea hacia arriba a slabs completos.
+ *
+ * @param pool Puntero al pool.
+ * @param maxBlocks Máximo de bloques (0 = sin límite).
+ */
+void memory_pool_set_max_blocks(MemoryPool *pool, size_t maxBlocks);
+
 /**
  * @brief Asigna un bloque de memoria desde el pool.
  *
- * Retorna un bloque libre o NULL si no hay bloques disponibles.
+ * Retorna un bloque libre, creciendo si hace falta, o NULL si se alcanzó el
+ * límite del pool o el sistema no tiene memoria.
  *
  * @param pool Puntero al pool.
  * @return void* Puntero al bloque asignado.
@@ -81,6 +175,16 @@ void *memory_pool_alloc(MemoryPool *pool);
  */
 void memory_pool_free(MemoryPool *pool, void *ptr);
 
+/**
+ * @brief Devuelve al pool los bloques cacheados por el hilo actual.
+ *
+ * Publica además los contadores pendientes del hilo. Se hace automáticamente
+ * al terminar el hilo; es útil antes de leer estadísticas exactas.
+ *
+ * @param pool Puntero al pool.
+ */
+void memory_pool_flush_thread_cache(MemoryPool *pool);
+
 /**
  * @brief Destruye el pool de memoria y libera todos sus recursos.
  *
@@ -91,6 +195,8 @@ void memory_pool_destroy(MemoryPool *pool);
 /**
  * @brief Obtiene el número total de asignaciones realizadas desde el pool.
  *
+ * No incluye las operaciones que otros hilos aún no han publicado desde sus magazines.
+ *
  * @param pool Puntero al pool.
  * @return size_t Número de asignaciones.
  */
@@ -107,16 +213,131 @@ size_t memory_pool_get_total_frees(MemoryPool *pool);
 /**
  * @brief Imprime estadísticas del pool de memoria.
  *
- * Muestra información sobre el tamaño de bloque, número de bloques, asignaciones y liberaciones.
+ * Muestra información sobre el tamaño de bloque, número de bloques, asignaciones,
+ * liberaciones y slabs reservados y devueltos al sistema.
  *
  * @param pool Puntero al pool.
  */
 void memory_pool_dumpStats(MemoryPool *pool);
 
+/**
+ * @brief Número de nodos NUMA del sistema (1 si no es NUMA o no se sabe).
+ *
+ * Se lee una vez de /sys/devices/system/node y se acota a MEMORY_NUMA_MAX_NODES.
+ */
+int memory_numa_node_count(void);
+
+/**
+ * @brief Nodo NUMA en el que se ejecuta el hilo actual (0 si no se sabe).
+ */
+int memory_numa_current_node(void);
+
+/* ============================
+   Slab Allocator por Clases de Tamaño
+   ============================ */
+
+/* Clase más pequeña y más grande; las peticiones mayores van a memory_alloc */
+#ifndef MEMORY_SLAB_MIN_SIZE
+#define MEMORY_SLAB_MIN_SIZE 16
+#endif
+#ifndef MEMORY_SLAB_MAX_SIZE
+#define MEMORY_SLAB_MAX_SIZE 32768
+#endif
+#define MEMORY_SLAB_ALIGNMENT 16
+#define MEMORY_SLAB_MAX_CLASSES 64
+
+/**
+ * @brief Allocator de tamaño variable formado por un MemoryPool por clase.
+ *
+ * Las clases son potencias de dos con pasos intermedios de 1/4 (32, 40, 48,
+ * 56, 64, 80...), de modo que cada clase es como mucho 1.25 veces la anterior.
+ */
+typedef struct SlabAllocator SlabAllocator;
+
+/**
+ * @brief Crea un slab allocator con todas sus clases vacías.
+ *
+ * @return SlabAllocator* Puntero al allocator creado.
+ */
+SlabAllocator *memory_slab_create(void);
+
+/**
+ * @brief Crea un slab allocator cuyas clases usan los flags indicados.
+ *
+ * @param flags Flags de memory_pool_create_ex para todas las clases (por
+ *              ejemplo MEMORY_POOL_NUMA | MEMORY_POOL_HUGEPAGES).
+ * @return SlabAllocator* Puntero al allocator creado.
+ */
+SlabAllocator *memory_slab_create_ex(int flags);
+
+/**
+ * @brief Asigna 'size' bytes desde la clase de tamaño correspondiente.
+ *
+ * @param sa Puntero al allocator.
+ * @param size Tamaño solicitado en bytes.
+ * @return void* Bloque alineado a MEMORY_SLAB_ALIGNMENT o NULL si no hay memoria.
+ */
+void *memory_slab_alloc(SlabAllocator *sa, size_t size);
+
+/**
+ * @brief Libera un bloque obtenido con memory_slab_alloc.
+ *
+ * @param sa Puntero al allocator.
+ * @param ptr Bloque a liberar.
+ * @param size Tamaño con el que se pidió el bloque.
+ */
+void memory_slab_free(SlabAllocator *sa, void *ptr, size_t size);
+
+/**
+ * @brief Imprime las estadísticas de cada clase usada mediante memory_pool_dumpStats.
+ *
+ * @param sa Puntero al allocator.
+ */
+void memory_slab_dumpStats(SlabAllocator *sa);
+
+/**
+ * @brief Destruye el allocator y todas sus clases.
+ *
+ * @param sa Puntero al allocator.
+ */
+void memory_slab_destroy(SlabAllocator *sa);
+
 /* ============================
    Tracking Global de Memoria
    ============================ */
 
+/* Clases de tamaño de los contadores: la clase c agrupa las asignaciones
+   de hasta 2^c bytes (la última, todas las mayores) */
+#ifndef MEMORY_STATS_SIZE_CLASSES
+#define MEMORY_STATS_SIZE_CLASSES 32
+#endif
+
+/**
+ * @brief Contadores de memory_alloc/memory_free agregados de todos los hilos.
+ *
+ * Cada hilo incrementa su propio shard (una línea de caché propia, sin
+ * operaciones atómicas de lectura-modificación-escritura); la lectura suma
+ * los shards vivos y los de los hilos ya terminados. Los contadores están
+ * siempre activos, también fuera de DEBUG_MEMORY.
+ */
+typedef struct {
+    size_t allocs;                                  /* Llamadas a memory_alloc */
+    size_t frees;                                   /* Llamadas a memory_free con ptr != NULL */
+    size_t bytes;                                   /* Bytes pedidos a memory_alloc */
+    size_t classAllocs[MEMORY_STATS_SIZE_CLASSES];  /* Asignaciones por clase */
+    size_t classBytes[MEMORY_STATS_SIZE_CLASSES];   /* Bytes por clase */
+} MemoryAllocStats;
+
+/**
+ * @brief Suma los contadores de todos los hilos.
+ *
+ * Es una instantánea: los incrementos concurrentes pueden verse o no, pero
+ * ningún valor se lee a medias.
+ *
+ * @param out Destino de los contadores agregados.
+ */
+void memory_get_alloc_stats(MemoryAllocStats *out);
+
 /**
  * @brief Retorna el número total de asignaciones globales realizadas.
  *
@@ -131,39 +352,279 @@ size_t memory_get_global_alloc_count(void);
  */
 size_t memory_get_global_free_count(void);
 
+/**
+ * @brief Activa o desactiva las trazas de DEBUG_MEMORY en stderr.
+ *
+ * Con DEBUG_MEMORY cada memory_alloc/free/realloc y cada operación de pool
+ * escribe una línea; están activas al arrancar. Sin DEBUG_MEMORY no hace
+ * nada. Los contadores no se ven afectados.
+ *
+ * @param enabled 0 para silenciarlas, distinto de 0 para reactivarlas.
+ */
+void memory_set_trace(int enabled);
+
+/**
+ * @brief Indica si las trazas de DEBUG_MEMORY están activas.
+ *
+ * Otros módulos que solo trazan con DEBUG_MEMORY la consultan para
+ * callarse junto con el allocator.
+ *
+ * @return int 1 si están activas, 0 si se silenciaron.
+ */
+int memory_trace_enabled(void);
+
+/* ============================
+   Perfilador de Asignaciones por Muestreo
+   ============================ */
+
+/* Intervalo medio de muestreo en bytes: en promedio se registra una
+   asignación por cada MEMORY_PROFILE_SAMPLE_BYTES bytes asignados */
+#ifndef MEMORY_PROFILE_SAMPLE_BYTES
+#define MEMORY_PROFILE_SAMPLE_BYTES (512 * 1024)
+#endif
+
+#define MEMORY_PROFILE_MAX_SITES     4096   /* Sitios de llamada distintos */
+#define MEMORY_PROFILE_SIZE_BUCKETS  48     /* Histograma por potencias de dos */
+#define MEMORY_PROFILE_TIMELINE      1024   /* Puntos de la serie de bytes vivos */
+#define MEMORY_PROFILE_FILTER        4096   /* Cubetas del filtro de memory_free (potencia de dos) */
+
+/**
+ * Totales estimados del perfilador (escalados por el intervalo de muestreo).
+ */
+typedef struct {
+    size_t samples;         /* Asignaciones muestreadas */
+    size_t sites;           /* Sitios de llamada distintos */
+    size_t allocBytes;      /* Bytes asignados estimados */
+    size_t liveBytes;       /* Bytes vivos estimados */
+    size_t peakLiveBytes;   /* Máximo de liveBytes */
+} MemoryProfileStats;
+
+/**
+ * @brief Activa el perfilador de asignaciones.
+ *
+ * Con el perfilador inactivo memory_alloc solo paga una comprobación. Activo,
+ * cada hilo descuenta los bytes asignados de un contador propio y, al
+ * agotarse, registra la asignación: sitio de llamada (dirección de retorno),
+ * tamaño y, si después se libera con memory_free, su baja. El intervalo entre
+ * muestras es aleatorio con media 'sampleBytes' para no sesgar hacia
+ * patrones periódicos; cada muestra pesa lo que representa.
+ *
+ * Al terminar el proceso (o con memory_profile_stop) se escribe 'path' en
+ * formato de pilas colapsadas (flamegraph.pl, speedscope, inferno):
+ * "memory_alloc;<sitio>;<tamaño> <bytes>", y 'path'.live con la serie
+ * "<segundos> <bytes vivos>".
+ *
+ * @param path Archivo de salida.
+ * @param sampleBytes Intervalo medio de muestreo (0 = MEMORY_PROFILE_SAMPLE_BYTES).
+ * @return int 0 si se activó, -1 si ya estaba activo o 'path' no es válido.
+ */
+int memory_profile_start(const char *path, size_t sampleBytes);
+
+/**
+ * @brief Desactiva el perfilador y escribe los archivos de salida.
+ */
+void memory_profile_stop(void);
+
+/**
+ * @brief Registra una asignación de otro asignador (el GC, por ejemplo).
+ *
+ * Los asignadores llaman a esta función solo cuando el perfilador está
+ * activo; decide si la asignación se muestrea.
+ *
+ * @param ptr Puntero asignado.
+ * @param size Tamaño solicitado.
+ * @param site Sitio de llamada (dirección de retorno o id de codegen).
+ * @param track 1 si se liberará con memory_free y cuenta como bytes vivos.
+ */
+void memory_profile_record(void *ptr, size_t size, const void *site, int track);
+
+/**
+ * @brief Da de baja una asignación registrada con track = 1 al liberarla.
+ *
+ * @param ptr Puntero que se libera.
+ */
+void memory_profile_release(void *ptr);
+
+/**
+ * @brief Retorna 1 si el perfilador está activo.
+ */
+int memory_profile_active(void);
+
+/**
+ * @brief Copia los totales estimados del perfilador.
+ *
+ * @param out Destino.
+ */
+void memory_profile_get_stats(MemoryProfileStats *out);
+
 /* ============================
    Garbage Collection Opcional (USE_GC)
    ============================ */
 #ifdef USE_GC
-#include <stdatomic.h>
+
+/*
+ * Recolector mark-sweep no móvil (src/gc.c).
+ *
+ * Las raíces son precisas: variables globales registradas con
+ * memory_gc_add_root y marcos de la pila sombra que el código C que usa el
+ * recolector enlaza al entrar en cada función (memory_gc_push_frame). Los
+ * objetos describen dónde tienen punteros mediante un GCType. La
+ * recolección es stop-the-world cooperativa: se dispara desde la asignación
+ * y espera a que los demás hilos registrados lleguen a un safepoint.
+ *
+ * Es una biblioteca para código C: sustituye a la API de conteo de
+ * referencias atómico (memory_inc_ref y memory_dec_ref quedan vacías) y
+ * nada más. Ni el compilador ni el runtime la usan: el código generado no
+ * registra raíces ni marcos (no hay mapas de pila), y los objetos, arreglos,
+ * clausuras y strings de los programas Lyn los asigna el runtime
+ * (lyn_object_new, lyn_array_new) fuera de este recolector.
+ */
+
+/* Bytes asignados que disparan la primera recolección */
+#ifndef MEMORY_GC_MIN_HEAP
+#define MEMORY_GC_MIN_HEAP (1024 * 1024)
+#endif
+
+/* El siguiente umbral es (bytes vivos tras recolectar) * MEMORY_GC_GROWTH */
+#ifndef MEMORY_GC_GROWTH
+#define MEMORY_GC_GROWTH 2
+#endif
+
+/**
+ * Descriptor de tipo: posiciones (en bytes) de los campos puntero del objeto.
+ */
+typedef struct GCType {
+    const char *name;
+    size_t pointerCount;
+    const size_t *pointerOffsets;
+} GCType;
 
 /**
  * Estructura de encabezado para objetos gestionados por GC.
  * Se almacena justo antes de los datos asignados.
  */
 typedef struct GCHeader {
-    atomic_size_t refCount;
+    struct GCHeader *next;    /* Lista de todos los objetos del heap */
+    const GCType *type;       /* NULL = objeto sin punteros */
+    size_t size;              /* Tamaño de la data */
+    size_t marked;            /* Marca de la fase mark */
 } GCHeader;
 
 /**
- * @brief Asigna memoria gestionada por el GC.
- *
- * Reserva un bloque con espacio para el encabezado y la data.
+ * Marco de la pila sombra: 'roots' apunta a 'rootCount' variables locales
+ * que contienen punteros a objetos del GC (o NULL).
+ */
+typedef struct GCFrame {
+    struct GCFrame *prev;
+    size_t rootCount;
+    void **roots;
+} GCFrame;
+
+/**
+ * Estadísticas del recolector.
+ */
+typedef struct {
+    size_t collections;       /* Recolecciones completas */
+    size_t objectsAllocated;
+    size_t objectsFreed;
+    size_t bytesAllocated;
+    size_t bytesFreed;
+    size_t liveBytes;         /* Bytes vivos tras la última recolección */
+    double totalPauseMs;      /* Suma de pausas stop-the-world */
+    double maxPauseMs;        /* Pausa más larga */
+} GCStats;
+
+/**
+ * @brief Asigna un objeto sin punteros internos gestionado por el GC.
  *
  * @param size Tamaño de la data solicitada.
- * @return void* Puntero a la data (después del header).
+ * @return void* Puntero a la data (después del header), inicializada a cero.
  */
 void* memory_alloc_gc(size_t size);
 
 /**
- * @brief Incrementa el contador de referencias del objeto.
+ * @brief Asigna un objeto cuyos campos puntero describe 'type'.
+ *
+ * @param size Tamaño de la data solicitada.
+ * @param type Descriptor de tipo (debe vivir mientras viva el objeto).
+ * @return void* Puntero a la data, inicializada a cero.
+ */
+void* memory_alloc_gc_typed(size_t size, const GCType *type);
+
+/**
+ * @brief Enlaza un marco de la pila sombra del hilo actual.
+ *
+ * @param frame Marco (normalmente en la pila del llamador).
+ * @param roots Variables locales que contienen punteros a objetos.
+ * @param rootCount Número de variables.
+ */
+void memory_gc_push_frame(GCFrame *frame, void **roots, size_t rootCount);
+
+/**
+ * @brief Desenlaza el marco más reciente del hilo actual.
+ *
+ * @param frame Marco enlazado con memory_gc_push_frame.
+ */
+void memory_gc_pop_frame(GCFrame *frame);
+
+/**
+ * @brief Registra una variable global como raíz.
+ *
+ * @param slot Dirección de la variable que contiene el puntero.
+ */
+void memory_gc_add_root(void **slot);
+
+/**
+ * @brief Elimina una raíz global registrada con memory_gc_add_root.
+ *
+ * @param slot Dirección de la variable.
+ */
+void memory_gc_remove_root(void **slot);
+
+/**
+ * @brief Registra el hilo actual como mutador (el primero se registra solo).
+ */
+void memory_gc_register_thread(void);
+
+/**
+ * @brief Da de baja el hilo actual; debe llamarse antes de que termine.
+ */
+void memory_gc_unregister_thread(void);
+
+/**
+ * @brief Punto seguro: si hay una recolección pendiente, el hilo se detiene hasta que termine.
+ */
+void memory_gc_safepoint(void);
+
+/**
+ * @brief Fuerza una recolección completa.
+ */
+void memory_gc_collect(void);
+
+/**
+ * @brief Copia las estadísticas del recolector.
+ *
+ * @param out Destino de las estadísticas.
+ */
+void memory_gc_get_stats(GCStats *out);
+
+/**
+ * @brief Imprime las estadísticas del recolector.
+ */
+void memory_gc_dumpStats(void);
+
+/**
+ * @brief Compatibilidad con el modelo de conteo de referencias.
+ *
+ * Con el recolector de trazado no hacen nada: la vida de los objetos la
+ * decide la alcanzabilidad desde las raíces, incluidos los ciclos.
  *
  * @param ptr Puntero a la data del objeto.
  */
 void memory_inc_ref(void *ptr);
 
 /**
- * @brief Decrementa el contador de referencias y libera el objeto si llega a cero.
+ * @brief Ver memory_inc_ref; no libera el objeto.
  *
  * @param ptr Puntero a la data del objeto.
  */
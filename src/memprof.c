@@ -0,0 +1,380 @@
+/* memprof.c */
+#define _GNU_SOURCE
+#include "memory.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <stdatomic.h>
+#include <pthread.h>
+#include <time.h>
+
+#if defined(__GLIBC__) || defined(__APPLE__)
+#define MEMORY_HAVE_DLADDR 1
+#include <dlfcn.h>
+#else
+#define MEMORY_HAVE_DLADDR 0
+#endif
+
+/* ============================
+   Estado del perfilador
+   ============================ */
+
+typedef struct {
+    const void *site;                               /* NULL = entrada libre */
+    size_t samples;
+    size_t allocBytes;                              /* Estimados */
+    size_t liveBytes;                               /* Estimados */
+    size_t buckets[MEMORY_PROFILE_SIZE_BUCKETS];    /* Bytes estimados por tamaño */
+} ProfileSite;
+
+/* Muestra viva: se busca por puntero al liberar */
+typedef struct {
+    void *ptr;      /* NULL = entrada libre */
+    size_t weight;
+    size_t site;
+} LiveSample;
+
+typedef struct {
+    double seconds;
+    size_t liveBytes;
+} TimelinePoint;
+
+static pthread_mutex_t profileLock = PTHREAD_MUTEX_INITIALIZER;
+static atomic_int profileOn = 0;       /* Se lee sin el mutex en el camino rápido */
+static atomic_size_t liveCount = 0;    /* Ídem: memory_free no busca si es 0 */
+static int atexitRegistered = 0;
+static size_t sampleInterval = MEMORY_PROFILE_SAMPLE_BYTES;
+static char profilePath[1024];
+static double startSeconds;
+
+/* Tabla hash de sitios con direccionamiento abierto; la última entrada
+   agrupa los sitios que ya no caben */
+static ProfileSite sites[MEMORY_PROFILE_MAX_SITES + 1];
+static LiveSample *live = NULL;
+static size_t liveCapacity = 0;
+
+/* Filtro de memory_free: muestras vivas por cubeta según el hash del
+   puntero. Cambia con profileLock y se lee sin él, así que solo los
+   punteros de una cubeta ocupada toman el mutex para buscar en la tabla */
+static atomic_uint liveFilter[MEMORY_PROFILE_FILTER];
+
+/* Serie de bytes vivos: al llenarse se descarta un punto de cada dos y se
+   duplica el paso, así cubre toda la ejecución con memoria acotada */
+static TimelinePoint timeline[MEMORY_PROFILE_TIMELINE];
+static size_t timelineCount = 0;
+static size_t timelineStride = 1;
+static size_t timelineSkip = 0;
+
+static MemoryProfileStats totals;
+
+/* Cada hilo descuenta sus bytes hasta la próxima muestra */
+static _Thread_local long long untilSample = 0;
+static _Thread_local uint64_t rngState = 0;
+
+static double nowSeconds(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec + (double)ts.tv_nsec / 1e9;
+}
+
+/* Intervalo uniforme en [1, 2 * sampleInterval]: media sampleInterval */
+static long long nextInterval(void) {
+    if (!rngState)
+        rngState = ((uint64_t)(uintptr_t)&rngState ^ (uint64_t)(nowSeconds() * 1e9)) | 1;
+    rngState ^= rngState << 13;
+    rngState ^= rngState >> 7;
+    rngState ^= rngState << 17;
+    return (long long)(rngState % (2 * (uint64_t)sampleInterval)) + 1;
+}
+
+static size_t hashPointer(const void *ptr, size_t mask) {
+    uint64_t h = (uint64_t)(uintptr_t)ptr;
+    h ^= h >> 33;
+    h *= 0xff51afd7ed558ccdULL;
+    h ^= h >> 33;
+    return (size_t)h & mask;
+}
+
+static size_t sizeBucket(size_t size) {
+    size_t bucket = 0;
+    while (bucket + 1 < MEMORY_PROFILE_SIZE_BUCKETS && ((size_t)1 << bucket) < size)
+        bucket++;
+    return bucket;
+}
+
+static size_t findSite(const void *site) {
+    size_t mask = MEMORY_PROFILE_MAX_SITES - 1;
+    size_t i = hashPointer(site, mask);
+    for (size_t probes = 0; probes < MEMORY_PROFILE_MAX_SITES / 2; probes++) {
+        if (sites[i].site == site)
+            return i;
+        if (!sites[i].site) {
+            sites[i].site = site;
+            totals.sites++;
+            return i;
+        }
+        i = (i + 1) & mask;
+    }
+    return MEMORY_PROFILE_MAX_SITES;
+}
+
+/* ============================
+   Tabla de muestras vivas
+   Memoria propia con calloc para no volver a entrar en memory_alloc.
+   ============================ */
+
+/* Rehace la tabla con el doble de capacidad. El número de muestras no
+   cambia, así que liveCount no se toca: memory_free lo lee sin el mutex */
+static void liveGrow(void) {
+    LiveSample *old = live;
+    size_t oldCapacity = liveCapacity;
+    liveCapacity = liveCapacity ? liveCapacity * 2 : 1024;
+    live = (LiveSample *)calloc(liveCapacity, sizeof(LiveSample));
+    if (!live) {
+        fprintf(stderr, "Error: memory profiler failed to grow its live table\n");
+        exit(EXIT_FAILURE);
+    }
+    size_t mask = liveCapacity - 1;
+    for (size_t i = 0; i < oldCapacity; i++) {
+        if (!old[i].ptr)
+            continue;
+        size_t j = hashPointer(old[i].ptr, mask);
+        while (live[j].ptr)
+            j = (j + 1) & mask;
+        live[j] = old[i];
+    }
+    free(old);
+}
+
+/* Retorna 1 si el puntero no estaba en la tabla */
+static int liveInsert(void *ptr, size_t weight, size_t site) {
+    if ((atomic_load_explicit(&liveCount, memory_order_relaxed) + 1) * 2 > liveCapacity)
+        liveGrow();
+    size_t mask = liveCapacity - 1;
+    size_t i = hashPointer(ptr, mask);
+    while (live[i].ptr && live[i].ptr != ptr)
+        i = (i + 1) & mask;
+    int added = !live[i].ptr;
+    if (added)
+        atomic_fetch_add_explicit(&liveCount, 1, memory_order_relaxed);
+    live[i].ptr = ptr;
+    live[i].weight = weight;
+    live[i].site = site;
+    return added;
+}
+
+/* Borrado con desplazamiento hacia atrás: sin marcas de borrado */
+static int liveRemove(void *ptr, LiveSample *out) {
+    if (!liveCapacity)
+        return 0;
+    size_t mask = liveCapacity - 1;
+    size_t i = hashPointer(ptr, mask);
+    while (live[i].ptr != ptr) {
+        if (!live[i].ptr)
+            return 0;
+        i = (i + 1) & mask;
+    }
+    *out = live[i];
+    size_t hole = i;
+    for (size_t j = (i + 1) & mask; live[j].ptr; j = (j + 1) & mask) {
+        size_t home = hashPointer(live[j].ptr, mask);
+        /* Se mueve si su posición ideal no está entre el hueco y j */
+        if (((j - home) & mask) >= ((j - hole) & mask)) {
+            live[hole] = live[j];
+            hole = j;
+        }
+    }
+    live[hole].ptr = NULL;
+    atomic_fetch_sub_explicit(&liveCount, 1, memory_order_relaxed);
+    return 1;
+}
+
+static void timelineAppend(void) {
+    if (timelineSkip++ % timelineStride != 0)
+        return;
+    if (timelineCount == MEMORY_PROFILE_TIMELINE) {
+        for (size_t i = 0; i < MEMORY_PROFILE_TIMELINE / 2; i++)
+            timeline[i] = timeline[2 * i];
+        timelineCount = MEMORY_PROFILE_TIMELINE / 2;
+        timelineStride *= 2;
+    }
+    timeline[timelineCount].seconds = nowSeconds() - startSeconds;
+    timeline[timelineCount].liveBytes = totals.liveBytes;
+    timelineCount++;
+}
+
+/* ============================
+   Registro
+   ============================ */
+
+int memory_profile_active(void) {
+    return atomic_load_explicit(&profileOn, memory_order_relaxed);
+}
+
+void memory_profile_record(void *ptr, size_t size, const void *site, int track) {
+    if (!atomic_load_explicit(&profileOn, memory_order_relaxed) || !ptr)
+        return;
+    untilSample -= (long long)size;
+    if (untilSample > 0)
+        return;
+    /* Una asignación menor que el intervalo representa un intervalo entero;
+       una mayor se muestrea siempre y pesa su tamaño */
+    size_t weight = size >= sampleInterval ? size : sampleInterval;
+    untilSample = nextInterval();
+
+    pthread_mutex_lock(&profileLock);
+    if (profileOn) {
+        size_t index = findSite(site);
+        ProfileSite *s = &sites[index];
+        s->samples++;
+        s->allocBytes += weight;
+        s->buckets[sizeBucket(size)] += weight;
+        totals.samples++;
+        totals.allocBytes += weight;
+        if (track) {
+            s->liveBytes += weight;
+            totals.liveBytes += weight;
+            if (totals.liveBytes > totals.peakLiveBytes)
+                totals.peakLiveBytes = totals.liveBytes;
+            if (liveInsert(ptr, weight, index))
+                atomic_fetch_add_explicit(&liveFilter[hashPointer(ptr, MEMORY_PROFILE_FILTER - 1)],
+                                          1, memory_order_relaxed);
+        }
+        timelineAppend();
+    }
+    pthread_mutex_unlock(&profileLock);
+}
+
+/* La muestra se insertó antes de que memory_alloc retornara el puntero, así
+   que quien lo libera ve el contador de su cubeta sin tomar el mutex */
+void memory_profile_release(void *ptr) {
+    if (!ptr || !atomic_load_explicit(&liveCount, memory_order_relaxed))
+        return;
+    atomic_uint *bucket = &liveFilter[hashPointer(ptr, MEMORY_PROFILE_FILTER - 1)];
+    if (!atomic_load_explicit(bucket, memory_order_relaxed))
+        return;
+    pthread_mutex_lock(&profileLock);
+    LiveSample sample;
+    if (liveRemove(ptr, &sample)) {
+        atomic_fetch_sub_explicit(bucket, 1, memory_order_relaxed);
+        sites[sample.site].liveBytes -= sample.weight;
+        totals.liveBytes -= sample.weight;
+        timelineAppend();
+    }
+    pthread_mutex_unlock(&profileLock);
+}
+
+void memory_profile_get_stats(MemoryProfileStats *out) {
+    pthread_mutex_lock(&profileLock);
+    *out = totals;
+    pthread_mutex_unlock(&profileLock);
+}
+
+/* ============================
+   Salida
+   ============================ */
+
+/* Nombre del sitio: función+desplazamiento si hay símbolo, si no
+   módulo+desplazamiento (utilizable con addr2line) */
+static void describeSite(const void *site, char *buf, size_t size) {
+    if (!site) {
+        snprintf(buf, size, "[otros]");
+        return;
+    }
+#if MEMORY_HAVE_DLADDR
+    Dl_info info;
+    if (dladdr(site, &info) && info.dli_fname) {
+        const char *module = strrchr(info.dli_fname, '/');
+        module = module ? module + 1 : info.dli_fname;
+        if (info.dli_sname)
+            snprintf(buf, size, "%s`%s+0x%lx", module, info.dli_sname,
+                     (unsigned long)((const char *)site - (const char *)info.dli_saddr));
+        else
+            snprintf(buf, size, "%s+0x%lx", module,
+                     (unsigned long)((const char *)site - (const char *)info.dli_fbase));
+        return;
+    }
+#endif
+    snprintf(buf, size, "%p", site);
+}
+
+static void writeProfile(void) {
+    FILE *out = fopen(profilePath, "w");
+    if (!out) {
+        fprintf(stderr, "Error: memory profiler could not write '%s'\n", profilePath);
+        return;
+    }
+    char name[512];
+    for (size_t i = 0; i <= MEMORY_PROFILE_MAX_SITES; i++) {
+        ProfileSite *s = &sites[i];
+        if (!s->samples)
+            continue;
+        describeSite(s->site, name, sizeof(name));
+        for (size_t b = 0; b < MEMORY_PROFILE_SIZE_BUCKETS; b++) {
+            if (s->buckets[b])
+                fprintf(out, "memory_alloc;%s;<=%zuB %zu\n", name, (size_t)1 << b, s->buckets[b]);
+        }
+    }
+    fclose(out);
+
+    char livePath[sizeof(profilePath) + 8];
+    snprintf(livePath, sizeof(livePath), "%s.live", profilePath);
+    out = fopen(livePath, "w");
+    if (!out)
+        return;
+    for (size_t i = 0; i < timelineCount; i++)
+        fprintf(out, "%.6f %zu\n", timeline[i].seconds, timeline[i].liveBytes);
+    fclose(out);
+
+    fprintf(stderr, "[memory_profile] %zu samples, %zu sites, ~%zu bytes allocated, "
+            "peak live ~%zu bytes -> %s\n", totals.samples, totals.sites,
+            totals.allocBytes, totals.peakLiveBytes, profilePath);
+}
+
+static void profileAtExit(void) {
+    memory_profile_stop();
+}
+
+int memory_profile_start(const char *path, size_t sampleBytes) {
+    if (!path || strlen(path) >= sizeof(profilePath))
+        return -1;
+    pthread_mutex_lock(&profileLock);
+    if (profileOn) {
+        pthread_mutex_unlock(&profileLock);
+        return -1;
+    }
+    strcpy(profilePath, path);
+    sampleInterval = sampleBytes ? sampleBytes : MEMORY_PROFILE_SAMPLE_BYTES;
+    memset(sites, 0, sizeof(sites));
+    memset(&totals, 0, sizeof(totals));
+    timelineCount = 0;
+    timelineStride = 1;
+    timelineSkip = 0;
+    startSeconds = nowSeconds();
+    untilSample = nextInterval();
+    if (!atexitRegistered) {
+        atexit(profileAtExit);
+        atexitRegistered = 1;
+    }
+    profileOn = 1;
+    pthread_mutex_unlock(&profileLock);
+    return 0;
+}
+
+void memory_profile_stop(void) {
+    pthread_mutex_lock(&profileLock);
+    if (!profileOn) {
+        pthread_mutex_unlock(&profileLock);
+        return;
+    }
+    profileOn = 0;
+    writeProfile();
+    free(live);
+    live = NULL;
+    liveCapacity = 0;
+    atomic_store_explicit(&liveCount, 0, memory_order_relaxed);
+    for (size_t i = 0; i < MEMORY_PROFILE_FILTER; i++)
+        atomic_store_explicit(&liveFilter[i], 0, memory_order_relaxed);
+    pthread_mutex_unlock(&profileLock);
+}
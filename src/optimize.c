@@ -1,58 +1,838 @@
 /* optimize.c */
 #include "optimize.h"
 #include "ast.h"
+#include "memory.h"
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
 #include <math.h>
+#include <stdint.h>
+#include <limits.h>
 
-/* Función auxiliar para crear un nodo literal numérico a partir de un valor double */
-static AstNode *makeNumberLiteral(double value) {
+/* ============================
+   Estadísticas del optimizador
+   ============================ */
+
+static OptimizeStats stats;
+
+void optimizeResetStats(void) {
+    memset(&stats, 0, sizeof(stats));
+}
+
+const OptimizeStats *optimizeGetStats(void) {
+    return &stats;
+}
+
+void optimizeDumpStats(void) {
+    printf("Optimizer Stats:\n");
+    printf("  Constant folds    : %zu\n", stats.constantFolds);
+    printf("  Identities        : %zu\n", stats.identities);
+    printf("  Annihilations     : %zu\n", stats.annihilations);
+    printf("  Reassociations    : %zu\n", stats.reassociations);
+    printf("  Canonicalizations : %zu\n", stats.canonicalizations);
+    printf("  Simplifier passes : %zu\n", stats.passes);
+}
+
+/* Funciones auxiliares para crear literales numéricos tipados */
+static AstNode *makeIntLiteral(long long value) {
     AstNode *node = createAstNode(AST_NUMBER_LITERAL);
+    node->numberLiteral.isFloat = 0;
+    node->numberLiteral.intValue = value;
+    return node;
+}
+
+static AstNode *makeFloatLiteral(double value) {
+    AstNode *node = createAstNode(AST_NUMBER_LITERAL);
+    node->numberLiteral.isFloat = 1;
     node->numberLiteral.value = value;
     return node;
 }
 
-/* Optimización de expresiones binarias: constant folding */
-static AstNode *optimizeBinaryOp(AstNode *node) {
+/* Valor de un literal como double (para operaciones mixtas int/float) */
+static double literalAsDouble(AstNode *node) {
+    return node->numberLiteral.isFloat ? node->numberLiteral.value
+                                       : (double)node->numberLiteral.intValue;
+}
+
+/* Aritmética entera en complemento a dos: el desbordamiento da la vuelta
+   igual que en el código generado, en lugar de ser comportamiento indefinido */
+static long long wrapAdd(long long a, long long b) {
+    return (long long)((unsigned long long)a + (unsigned long long)b);
+}
+
+static long long wrapSub(long long a, long long b) {
+    return (long long)((unsigned long long)a - (unsigned long long)b);
+}
+
+static long long wrapMul(long long a, long long b) {
+    return (long long)((unsigned long long)a * (unsigned long long)b);
+}
+
+/* ============================
+   Variables vectoriales, enteras y float
+   El optimizador corre antes del análisis semántico, así que se recogen
+   por adelantado las variables que se saben enteras. Las identidades, los
+   aniquiladores y la reasociación solo valen para enteros: 'f * 0' con f
+   float no es el entero 0 (ni siquiera vale 0 si f es NaN o infinito), y
+   con un string '+' es concatenación. Los vectores tampoco: 'v * 0' o
+   'v - v' no son el escalar 0. Los nombres no tienen ámbito: una variable
+   que es float en alguna parte no es entera en ninguna.
+   ============================ */
+
+typedef struct VarName {
+    char name[256];
+    struct VarName *next;
+} VarName;
+
+static VarName *vectorVars = NULL;
+static VarName *intVars = NULL;
+static VarName *floatVars = NULL;    /* Float, o de tipo desconocido */
+static VarName *intFuncs = NULL;     /* Funciones, métodos y lambdas '-> int' */
+static VarName *otherFuncs = NULL;   /* Los que retornan otra cosa */
+
+static int inVarList(VarName *list, const char *name) {
+    for (VarName *v = list; v; v = v->next) {
+        if (strcmp(v->name, name) == 0)
+            return 1;
+    }
+    return 0;
+}
+
+static void addVarName(VarName **list, const char *name) {
+    if (inVarList(*list, name))
+        return;
+    VarName *v = (VarName *)memory_alloc(sizeof(VarName));
+    strncpy(v->name, name, sizeof(v->name) - 1);
+    v->name[sizeof(v->name) - 1] = '\0';
+    v->next = *list;
+    *list = v;
+}
+
+static void freeVarList(VarName **list) {
+    while (*list) {
+        VarName *next = (*list)->next;
+        memory_free(*list);
+        *list = next;
+    }
+}
+
+static int varListLength(VarName *list) {
+    int n = 0;
+    for (VarName *v = list; v; v = v->next)
+        n++;
+    return n;
+}
+
+/* Ámbito de tipos de una función o lambda: sus parámetros y variables
+   ocultan a las de fuera con el mismo nombre. Las listas solo crecen por
+   delante, así que las entradas del ámbito son las que preceden a las
+   cabezas guardadas al entrar. */
+typedef struct TypeScope {
+    VarName *names;          /* Parámetros y variables del ámbito */
+    VarName *outerVector;
+    VarName *outerInt;
+    VarName *outerFloat;
+    struct TypeScope *parent;
+} TypeScope;
+
+static TypeScope *typeScope = NULL;
+
+static VarName *scopeOuter(TypeScope *scope, VarName **list) {
+    if (list == &vectorVars) return scope->outerVector;
+    if (list == &intVars) return scope->outerInt;
+    return scope->outerFloat;
+}
+
+/* Busca una variable: si la declara un ámbito, solo entre sus entradas */
+static int hasVar(VarName **list, const char *name) {
+    VarName *limit = NULL;
+    for (TypeScope *scope = typeScope; scope; scope = scope->parent) {
+        if (inVarList(scope->names, name)) {
+            limit = scopeOuter(scope, list);
+            break;
+        }
+    }
+    for (VarName *v = *list; v != limit; v = v->next) {
+        if (strcmp(v->name, name) == 0)
+            return 1;
+    }
+    return 0;
+}
+
+static void addVar(VarName **list, const char *name) {
+    if (hasVar(list, name))
+        return;
+    VarName *v = (VarName *)memory_alloc(sizeof(VarName));
+    strncpy(v->name, name, sizeof(v->name) - 1);
+    v->name[sizeof(v->name) - 1] = '\0';
+    v->next = *list;
+    *list = v;
+}
+
+/* Dentro de una función, la variable que se asigna pertenece a su ámbito */
+static void declareVar(const char *name) {
+    if (typeScope)
+        addVarName(&typeScope->names, name);
+}
+
+static int typedVarCount(void) {
+    return varListLength(vectorVars) + varListLength(intVars) + varListLength(floatVars);
+}
+
+/* Libera las entradas añadidas delante de 'outer' */
+static void truncateVarList(VarName **list, VarName *outer) {
+    while (*list != outer) {
+        VarName *next = (*list)->next;
+        memory_free(*list);
+        *list = next;
+    }
+}
+
+/* Indica si la expresión produce un vector SIMD */
+static int isVectorExpr(AstNode *node) {
+    if (!node)
+        return 0;
+    switch (node->type) {
+        case AST_IDENTIFIER:
+            return hasVar(&vectorVars, node->identifier.name);
+        case AST_FUNC_CALL:
+            return vecTypeFromName(node->funcCall.name) != VEC_NONE ||
+                   strcmp(node->funcCall.name, "shuffle") == 0;
+        case AST_BINARY_OP:
+            return isVectorExpr(node->binaryOp.left) || isVectorExpr(node->binaryOp.right);
+        default:
+            return 0;
+    }
+}
+
+static int isArithOp(char op) {
+    return op == '+' || op == '-' || op == '*' || op == '/' || op == '%';
+}
+
+/* Indica si se sabe que la expresión produce un entero */
+static int isIntExpr(AstNode *node) {
+    if (!node)
+        return 0;
+    switch (node->type) {
+        case AST_NUMBER_LITERAL:
+            return !node->numberLiteral.isFloat;
+        case AST_IDENTIFIER:
+            return hasVar(&intVars, node->identifier.name) &&
+                   !hasVar(&floatVars, node->identifier.name) &&
+                   !hasVar(&vectorVars, node->identifier.name);
+        case AST_FUNC_CALL:
+            if (strcmp(node->funcCall.name, "len") == 0)
+                return 1;
+            return inVarList(intFuncs, node->funcCall.name) && !inVarList(otherFuncs, node->funcCall.name);
+        case AST_METHOD_CALL:
+            /* Sin tipos del receptor: el nombre no debe retornar otra cosa en otra clase */
+            return inVarList(intFuncs, node->methodCall.method) &&
+                   !inVarList(otherFuncs, node->methodCall.method);
+        case AST_BINARY_OP:
+            /* Las comparaciones producen 0 o 1 aunque comparen floats */
+            if (!isArithOp(node->binaryOp.op))
+                return 1;
+            return isIntExpr(node->binaryOp.left) && isIntExpr(node->binaryOp.right);
+        default:
+            return 0;
+    }
+}
+
+/* Clasifica una variable por su tipo declarado o, sin tipo, por el valor
+   que recibe. Un valor que no se sabe entero cuenta como float. */
+static void addTypedVar(const char *name, const char *type, AstNode *value) {
+    if (type && strcmp(type, "int") == 0)
+        addVar(&intVars, name);
+    else if (type && strcmp(type, "float") == 0)
+        addVar(&floatVars, name);
+    else if (type && type[0])
+        return;
+    else if (isIntExpr(value))
+        addVar(&intVars, name);
+    else if (value && !isVectorExpr(value))
+        addVar(&floatVars, name);
+}
+
+static void addTypedFunc(const char *name, const char *returnType) {
+    if (strcmp(returnType, "int") == 0)
+        addVarName(&intFuncs, name);
+    else
+        addVarName(&otherFuncs, name);
+}
+
+/* La variable que recibe una lambda se llama como una función */
+static void addTypedLambda(const char *name, AstNode *value) {
+    if (value && value->type == AST_LAMBDA)
+        addTypedFunc(name, value->lambda.returnType);
+}
+
+static void collectTypedVars(AstNode *node) {
+    if (!node)
+        return;
+    switch (node->type) {
+        case AST_PROGRAM:
+            for (int i = 0; i < node->program.statementCount; i++)
+                collectTypedVars(node->program.statements[i]);
+            break;
+        case AST_VAR_DECL:
+            declareVar(node->varDecl.name);
+            if (vecTypeFromName(node->varDecl.type) != VEC_NONE || isVectorExpr(node->varDecl.initializer))
+                addVar(&vectorVars, node->varDecl.name);
+            addTypedVar(node->varDecl.name, node->varDecl.type, node->varDecl.initializer);
+            addTypedLambda(node->varDecl.name, node->varDecl.initializer);
+            break;
+        case AST_VAR_ASSIGN:
+            declareVar(node->varAssign.name);
+            if (isVectorExpr(node->varAssign.initializer))
+                addVar(&vectorVars, node->varAssign.name);
+            addTypedVar(node->varAssign.name, NULL, node->varAssign.initializer);
+            addTypedLambda(node->varAssign.name, node->varAssign.initializer);
+            break;
+        case AST_FUNC_DEF:
+            /* Parámetros y cuerpo se tipan en su propio ámbito al optimizarla */
+            addTypedFunc(node->funcDef.name, node->funcDef.returnType);
+            break;
+        case AST_IF_STMT:
+            for (int i = 0; i < node->ifStmt.thenCount; i++)
+                collectTypedVars(node->ifStmt.thenBranch[i]);
+            for (int i = 0; i < node->ifStmt.elseCount; i++)
+                collectTypedVars(node->ifStmt.elseBranch[i]);
+            break;
+        case AST_FOR_STMT:
+            declareVar(node->forStmt.iterator);
+            addVar(&intVars, node->forStmt.iterator);
+            for (int i = 0; i < node->forStmt.bodyCount; i++)
+                collectTypedVars(node->forStmt.body[i]);
+            break;
+        case AST_CLASS_DEF:
+            for (int i = 0; i < node->classDef.memberCount; i++)
+                collectTypedVars(node->classDef.members[i]);
+            break;
+        default:
+            break;
+    }
+}
+
+/* Abre el ámbito de una función o lambda con sus parámetros tipados por su
+   declaración y, hasta un punto fijo, las variables de su cuerpo */
+static void pushTypeScope(AstNode **parameters, char (*paramTypes)[64], int paramCount,
+                          AstNode **body, int bodyCount) {
+    TypeScope *scope = (TypeScope *)memory_alloc(sizeof(TypeScope));
+    scope->names = NULL;
+    scope->outerVector = vectorVars;
+    scope->outerInt = intVars;
+    scope->outerFloat = floatVars;
+    scope->parent = typeScope;
+    typeScope = scope;
+    for (int i = 0; i < paramCount; i++) {
+        const char *name = parameters[i]->identifier.name;
+        const char *type = paramTypes ? paramTypes[i] : "";
+        declareVar(name);
+        if (vecTypeFromName(type) != VEC_NONE)
+            addVar(&vectorVars, name);
+        addTypedVar(name, type, NULL);
+    }
+    int known;
+    do {
+        known = typedVarCount();
+        for (int i = 0; i < bodyCount; i++)
+            collectTypedVars(body[i]);
+    } while (known != typedVarCount());
+}
+
+static void popTypeScope(void) {
+    TypeScope *scope = typeScope;
+    truncateVarList(&vectorVars, scope->outerVector);
+    truncateVarList(&intVars, scope->outerInt);
+    truncateVarList(&floatVars, scope->outerFloat);
+    freeVarList(&scope->names);
+    typeScope = scope->parent;
+    memory_free(scope);
+}
+
+/* ============================
+   Simplificador algebraico
+   ============================ */
+
+static int isNumber(AstNode *node) {
+    return node && node->type == AST_NUMBER_LITERAL;
+}
+
+/* Literal entero: identidades y reasociación solo se aplican a enteros para
+   no alterar el tipo del resultado ni el redondeo en punto flotante (el
+   otro operando debe cumplir isIntExpr) */
+static int isIntLiteral(AstNode *node) {
+    return isNumber(node) && !node->numberLiteral.isFloat;
+}
+
+static int isIntValue(AstNode *node, long long value) {
+    return isIntLiteral(node) && node->numberLiteral.intValue == value;
+}
+
+/* Una expresión es pura si evaluarla no tiene efectos: se puede descartar o duplicar */
+static int isPureExpr(AstNode *node) {
+    if (!node)
+        return 0;
+    switch (node->type) {
+        case AST_NUMBER_LITERAL:
+        case AST_STRING_LITERAL:
+        case AST_IDENTIFIER:
+            return 1;
+        case AST_BINARY_OP:
+            /* La división y el módulo pueden fallar en tiempo de ejecución */
+            if (node->binaryOp.op == '/' || node->binaryOp.op == '%')
+                return 0;
+            return isPureExpr(node->binaryOp.left) && isPureExpr(node->binaryOp.right);
+        default:
+            return 0;
+    }
+}
+
+/* Igualdad estructural entre dos expresiones */
+static int astEquals(AstNode *a, AstNode *b) {
+    if (!a || !b || a->type != b->type)
+        return 0;
+    switch (a->type) {
+        case AST_NUMBER_LITERAL:
+            if (a->numberLiteral.isFloat != b->numberLiteral.isFloat)
+                return 0;
+            return a->numberLiteral.isFloat ? a->numberLiteral.value == b->numberLiteral.value
+                                            : a->numberLiteral.intValue == b->numberLiteral.intValue;
+        case AST_STRING_LITERAL:
+            return strcmp(a->stringLiteral.value, b->stringLiteral.value) == 0;
+        case AST_IDENTIFIER:
+            return strcmp(a->identifier.name, b->identifier.name) == 0;
+        case AST_BINARY_OP:
+            return a->binaryOp.op == b->binaryOp.op &&
+                   astEquals(a->binaryOp.left, b->binaryOp.left) &&
+                   astEquals(a->binaryOp.right, b->binaryOp.right);
+        default:
+            return 0;
+    }
+}
+
+/* Reemplaza un nodo binario por uno de sus hijos, liberando el resto */
+static AstNode *replaceWithChild(AstNode *node, AstNode **child) {
+    AstNode *keep = *child;
+    *child = NULL;
+    freeAstNode(node);
+    return keep;
+}
+
+/* Reemplaza un nodo (y sus hijos) por otro nodo ya construido */
+static AstNode *replaceWithNode(AstNode *node, AstNode *replacement) {
+    freeAstNode(node);
+    return replacement;
+}
+
+/* Plegado entre dos enteros de 64 bits con semántica de complemento a dos.
+   La división trunca hacia cero y INT64_MIN / -1 da la vuelta como en hardware
+   sin excepción. Retorna NULL si el operador no se puede plegar. */
+static AstNode *foldIntConstants(char op, long long a, long long b) {
+    switch (op) {
+        case '+': return makeIntLiteral(wrapAdd(a, b));
+        case '-': return makeIntLiteral(wrapSub(a, b));
+        case '*': return makeIntLiteral(wrapMul(a, b));
+        case '/':
+        case '%':
+            if (b == 0) {
+                fprintf(stderr, "Runtime error: %s by zero in constant folding.\n",
+                        op == '/' ? "Division" : "Modulo");
+                exit(1);
+            }
+            if (b == -1)
+                return makeIntLiteral(op == '/' ? wrapSub(0, a) : 0);
+            return makeIntLiteral(op == '/' ? a / b : a % b);
+        /* Relacionales: 'G', 'L', 'E' y 'N' codifican >=, <=, == y != */
+        case '>': return makeIntLiteral(a >  b);
+        case '<': return makeIntLiteral(a <  b);
+        case 'G': return makeIntLiteral(a >= b);
+        case 'L': return makeIntLiteral(a <= b);
+        case 'E': return makeIntLiteral(a == b);
+        case 'N': return makeIntLiteral(a != b);
+        default:  return NULL;
+    }
+}
+
+/* Plegado en punto flotante (al menos un operando es double) */
+static AstNode *foldFloatConstants(char op, double a, double b) {
+    switch (op) {
+        case '+': return makeFloatLiteral(a + b);
+        case '-': return makeFloatLiteral(a - b);
+        case '*': return makeFloatLiteral(a * b);
+        case '/':
+        case '%':
+            if (b == 0) {
+                fprintf(stderr, "Runtime error: %s by zero in constant folding.\n",
+                        op == '/' ? "Division" : "Modulo");
+                exit(1);
+            }
+            /* Resto truncado hacia cero, como fmod */
+            return makeFloatLiteral(op == '/' ? a / b : a - b * (double)(long long)(a / b));
+        /* Las comparaciones producen un entero 0/1 */
+        case '>': return makeIntLiteral(a >  b);
+        case '<': return makeIntLiteral(a <  b);
+        case 'G': return makeIntLiteral(a >= b);
+        case 'L': return makeIntLiteral(a <= b);
+        case 'E': return makeIntLiteral(a == b);
+        case 'N': return makeIntLiteral(a != b);
+        default:  return NULL;
+    }
+}
+
+/* Evalúa una operación binaria entre literales. Retorna NULL si no se puede plegar. */
+static AstNode *foldConstants(char op, AstNode *L, AstNode *R) {
+    if (!L->numberLiteral.isFloat && !R->numberLiteral.isFloat)
+        return foldIntConstants(op, L->numberLiteral.intValue, R->numberLiteral.intValue);
+    return foldFloatConstants(op, literalAsDouble(L), literalAsDouble(R));
+}
+
+/* Operador equivalente al intercambiar los operandos (0 si no existe) */
+static char swappedOp(char op) {
+    switch (op) {
+        case '+': case '*': case 'E': case 'N': return op;
+        case '>': return '<';
+        case '<': return '>';
+        case 'G': return 'L';
+        case 'L': return 'G';
+        default:  return 0;
+    }
+}
+
+/* Aplica una única regla sobre un nodo binario cuyos hijos ya están simplificados.
+   Retorna el nodo resultante y deja *changed a 1 si hubo reescritura. */
+static AstNode *simplifyBinaryOnce(AstNode *node, int *changed) {
+    AstNode *L = node->binaryOp.left;
+    AstNode *R = node->binaryOp.right;
+    char op = node->binaryOp.op;
+    AstNode *folded;
+
+    /* Plegado de constantes */
+    if (isNumber(L) && isNumber(R) && (folded = foldConstants(op, L, R)) != NULL) {
+        stats.constantFolds++;
+        *changed = 1;
+        return replaceWithNode(node, folded);
+    }
+
+    /* '+' puede ser una concatenación de strings: con un literal solo se
+       reordena o se descarta el 0 si el otro operando se sabe entero */
+    if (op == '+' && (isNumber(L) || isNumber(R)) && !isIntExpr(isNumber(L) ? R : L))
+        return node;
+
+    /* Las operaciones vectoriales son elemento a elemento: tampoco */
+    if (isVectorExpr(L) || isVectorExpr(R))
+        return node;
+
+    /* Forma canónica: constante a la derecha (c op x => x op' c) */
+    if (isNumber(L) && !isNumber(R) && swappedOp(op)) {
+        node->binaryOp.left = R;
+        node->binaryOp.right = L;
+        node->binaryOp.op = swappedOp(op);
+        stats.canonicalizations++;
+        *changed = 1;
+        return node;
+    }
+
+    /* Identidades: x + 0, x - 0, x * 1, x / 1 => x */
+    if (((op == '+' || op == '-') && isIntValue(R, 0)) ||
+        ((op == '*' || op == '/') && isIntValue(R, 1))) {
+        stats.identities++;
+        *changed = 1;
+        return replaceWithChild(node, &node->binaryOp.left);
+    }
+
+    /* Aniquiladores: x * 0 => 0, x % 1 => 0, x - x => 0 (si x es pura y entera) */
+    if (((op == '*' && isIntValue(R, 0)) || (op == '%' && isIntValue(R, 1))) && isPureExpr(L) &&
+        isIntExpr(L)) {
+        stats.annihilations++;
+        *changed = 1;
+        return replaceWithNode(node, makeIntLiteral(0));
+    }
+    if (op == '-' && isPureExpr(L) && isIntExpr(L) && astEquals(L, R)) {
+        stats.annihilations++;
+        *changed = 1;
+        return replaceWithNode(node, makeIntLiteral(0));
+    }
+
+    /* Reasociación de constantes enteras:
+       (x + c1) + c2 => x + (c1 + c2)    (x - c1) + c2 => x + (c2 - c1)
+       (x + c1) - c2 => x + (c1 - c2)    (x - c1) - c2 => x - (c1 + c2)
+       (x * c1) * c2 => x * (c1 * c2) */
+    if (L && L->type == AST_BINARY_OP && isIntLiteral(R) && isIntLiteral(L->binaryOp.right) &&
+        isIntExpr(L->binaryOp.left)) {
+        char inner = L->binaryOp.op;
+        long long c1 = L->binaryOp.right->numberLiteral.intValue;
+        long long c2 = R->numberLiteral.intValue;
+        int applied = 1;
+        if ((op == '+' || op == '-') && (inner == '+' || inner == '-')) {
+            /* Exacto en complemento a dos: la suma modular es asociativa */
+            long long sum = wrapAdd(inner == '+' ? c1 : wrapSub(0, c1),
+                                    op == '+' ? c2 : wrapSub(0, c2));
+            int useSub = (sum < 0 && sum != LLONG_MIN);
+            node->binaryOp.op = useSub ? '-' : '+';
+            R->numberLiteral.intValue = useSub ? -sum : sum;
+        } else if (op == '*' && inner == '*') {
+            R->numberLiteral.intValue = wrapMul(c1, c2);
+        } else {
+            applied = 0;
+        }
+        if (applied) {
+            node->binaryOp.left = L->binaryOp.left;
+            L->binaryOp.left = NULL;
+            freeAstNode(L);
+            stats.reassociations++;
+            *changed = 1;
+            return node;
+        }
+    }
+
+    /* Las constantes suben hacia la raíz: x + (y + c) => (x + y) + c, ídem con '*' */
+    if ((op == '+' || op == '*') && R && R->type == AST_BINARY_OP &&
+        R->binaryOp.op == op && isIntLiteral(R->binaryOp.right) && !isNumber(L) &&
+        isIntExpr(L) && isIntExpr(R->binaryOp.left)) {
+        AstNode *c = R->binaryOp.right;
+        R->binaryOp.right = R->binaryOp.left;
+        R->binaryOp.left = L;
+        node->binaryOp.left = R;
+        node->binaryOp.right = c;
+        stats.reassociations++;
+        *changed = 1;
+        return node;
+    }
+
+    return node;
+}
+
+/* Simplifica recursivamente (de las hojas a la raíz) una vez */
+static AstNode *simplifyPass(AstNode *node, int *changed) {
     if (!node || node->type != AST_BINARY_OP)
         return node;
+    node->binaryOp.left = simplifyPass(node->binaryOp.left, changed);
+    node->binaryOp.right = simplifyPass(node->binaryOp.right, changed);
+    int local;
+    do {
+        local = 0;
+        node = simplifyBinaryOnce(node, &local);
+        if (local)
+            *changed = 1;
+    } while (local && node->type == AST_BINARY_OP);
+    return node;
+}
 
-    /* Optimiza primero los operandos recursivamente */
-    node->binaryOp.left = optimizeAST(node->binaryOp.left);
-    node->binaryOp.right = optimizeAST(node->binaryOp.right);
+AstNode *simplifyExpression(AstNode *expr) {
+    int changed;
+    int iterations = 0;
+    do {
+        changed = 0;
+        expr = simplifyPass(expr, &changed);
+        stats.passes++;
+    } while (changed && ++iterations < SIMPLIFY_MAX_PASSES);
+    return expr;
+}
+
+/* ============================
+   Cadenas de concatenación
+   'a + b.to_str() + "c"' se aplana en un AST_STRING_BUILD: el código
+   generado añade cada pieza a un constructor y crea el string una sola
+   vez, en lugar de un string intermedio por cada '+'. Los enteros se
+   añaden en decimal sin pasar por to_str() y los literales contiguos se
+   unen en compilación. Corre tras el análisis semántico, que marca en
+   cada '+' qué operandos son strings.
+   ============================ */
 
-    /* Si ambos operandos son literales numéricos, evaluamos la operación */
-    if (node->binaryOp.left->type == AST_NUMBER_LITERAL &&
-        node->binaryOp.right->type == AST_NUMBER_LITERAL) {
-        double leftVal = node->binaryOp.left->numberLiteral.value;
-        double rightVal = node->binaryOp.right->numberLiteral.value;
-        double result = 0.0;
-        switch (node->binaryOp.op) {
-            case '+': result = leftVal + rightVal; break;
-            case '-': result = leftVal - rightVal; break;
-            case '*': result = leftVal * rightVal; break;
-            case '/': 
-                if (rightVal == 0) {
-                    fprintf(stderr, "Runtime error: Division by zero in constant folding.\n");
-                    exit(1);
-                }
-                result = leftVal / rightVal; 
-                break;
-            default:
-                /* Si la operación no es soportada, retornamos el nodo sin cambios */
-                return node;
+static void addPiece(AstNode *build, AstNode *piece, int isInt) {
+    int n = build->stringBuild.pieceCount;
+    build->stringBuild.pieces = memory_realloc(build->stringBuild.pieces, (n + 1) * sizeof(AstNode *));
+    build->stringBuild.intPiece = memory_realloc(build->stringBuild.intPiece, (n + 1) * sizeof(int));
+    build->stringBuild.pieces[n] = piece;
+    build->stringBuild.intPiece[n] = isInt;
+    build->stringBuild.pieceCount = n + 1;
+}
+
+/* Convierte un literal entero en literal string */
+static AstNode *intLiteralToString(AstNode *node) {
+    AstNode *str = createAstNode(AST_STRING_LITERAL);
+    snprintf(str->stringLiteral.value, sizeof(str->stringLiteral.value), "%lld",
+             node->numberLiteral.intValue);
+    freeAstNode(node);
+    return str;
+}
+
+/* Une la pieza a la última si ambas son literales y caben en uno */
+static int mergeLiteralPiece(AstNode *build, AstNode *piece) {
+    int n = build->stringBuild.pieceCount;
+    if (n == 0 || piece->type != AST_STRING_LITERAL)
+        return 0;
+    AstNode *last = build->stringBuild.pieces[n - 1];
+    if (last->type != AST_STRING_LITERAL)
+        return 0;
+    size_t len = strlen(last->stringLiteral.value);
+    /* Una barra final se uniría con el primer carácter de la pieza en una
+       secuencia de escape */
+    if (len > 0 && last->stringLiteral.value[len - 1] == '\\')
+        return 0;
+    size_t extra = strlen(piece->stringLiteral.value);
+    if (len + extra >= sizeof(last->stringLiteral.value))
+        return 0;
+    memcpy(last->stringLiteral.value + len, piece->stringLiteral.value, extra + 1);
+    freeAstNode(piece);
+    return 1;
+}
+
+/* Añade el operando (se consume) como una o varias piezas */
+static void appendOperand(AstNode *build, AstNode *operand, int isString) {
+    if (operand->type == AST_STRING_BUILD) {
+        /* Subcadena ya aplanada: se trasladan sus piezas */
+        for (int i = 0; i < operand->stringBuild.pieceCount; i++) {
+            AstNode *piece = operand->stringBuild.pieces[i];
+            if (!mergeLiteralPiece(build, piece))
+                addPiece(build, piece, operand->stringBuild.intPiece[i]);
         }
-        /* Libera los nodos hijos del operador */
-        freeAstNode(node->binaryOp.left);
-        freeAstNode(node->binaryOp.right);
-        /* Libera el nodo actual y retorna un nuevo nodo literal con el resultado */
-        freeAstNode(node);
-        return makeNumberLiteral(result);
+        operand->stringBuild.pieceCount = 0;
+        freeAstNode(operand);
+        return;
+    }
+    int isInt = !isString;
+    if (operand->type == AST_FUNC_CALL && strcmp(operand->funcCall.name, "to_str") == 0 &&
+        operand->funcCall.argCount == 1) {
+        /* x.to_str() dentro de la cadena: se añade x directamente, igual
+           que lo convertiría to_str() */
+        AstNode *arg = operand->funcCall.arguments[0];
+        operand->funcCall.argCount = 0;
+        freeAstNode(operand);
+        operand = arg;
+        isInt = arg->type != AST_STRING_LITERAL && arg->type != AST_STRING_BUILD;
+    }
+    if (operand->type == AST_NUMBER_LITERAL && !operand->numberLiteral.isFloat) {
+        operand = intLiteralToString(operand);
+        isInt = 0;
+    }
+    if (!mergeLiteralPiece(build, operand))
+        addPiece(build, operand, isInt);
+}
+
+/* 'node' es un '+' de strings con las subcadenas ya aplanadas */
+static AstNode *buildStringChain(AstNode *node) {
+    AstNode *build = createAstNode(AST_STRING_BUILD);
+    appendOperand(build, node->binaryOp.left, node->binaryOp.leftString);
+    appendOperand(build, node->binaryOp.right, node->binaryOp.rightString);
+    node->binaryOp.left = NULL;
+    node->binaryOp.right = NULL;
+    freeAstNode(node);
+    stats.stringChains++;
+
+    /* Un único literal (todo constante) o un único string no necesitan constructor */
+    if (build->stringBuild.pieceCount == 1 && !build->stringBuild.intPiece[0]) {
+        AstNode *piece = build->stringBuild.pieces[0];
+        build->stringBuild.pieceCount = 0;
+        freeAstNode(build);
+        return piece;
+    }
+    return build;
+}
+
+static void chainList(AstNode **nodes, int count);
+
+/* Aplana de las hojas a la raíz los '+' de strings que cuelgan de 'node' */
+static AstNode *chainNode(AstNode *node) {
+    if (!node)
+        return NULL;
+    switch (node->type) {
+        case AST_PROGRAM:
+            chainList(node->program.statements, node->program.statementCount);
+            break;
+        case AST_VAR_ASSIGN:
+            node->varAssign.initializer = chainNode(node->varAssign.initializer);
+            break;
+        case AST_VAR_DECL:
+            node->varDecl.initializer = chainNode(node->varDecl.initializer);
+            break;
+        case AST_FUNC_DEF:
+            chainList(node->funcDef.body, node->funcDef.bodyCount);
+            break;
+        case AST_FUNC_CALL:
+            chainList(node->funcCall.arguments, node->funcCall.argCount);
+            break;
+        case AST_RETURN_STMT:
+            node->returnStmt.expr = chainNode(node->returnStmt.expr);
+            break;
+        case AST_PRINT_STMT:
+            node->printStmt.expr = chainNode(node->printStmt.expr);
+            break;
+        case AST_LAMBDA:
+            node->lambda.body = chainNode(node->lambda.body);
+            break;
+        case AST_CLASS_DEF:
+            chainList(node->classDef.members, node->classDef.memberCount);
+            break;
+        case AST_IF_STMT:
+            node->ifStmt.condition = chainNode(node->ifStmt.condition);
+            chainList(node->ifStmt.thenBranch, node->ifStmt.thenCount);
+            chainList(node->ifStmt.elseBranch, node->ifStmt.elseCount);
+            break;
+        case AST_FOR_STMT:
+            node->forStmt.rangeStart = chainNode(node->forStmt.rangeStart);
+            node->forStmt.rangeEnd = chainNode(node->forStmt.rangeEnd);
+            chainList(node->forStmt.body, node->forStmt.bodyCount);
+            break;
+        case AST_ARRAY_LITERAL:
+            chainList(node->arrayLiteral.elements, node->arrayLiteral.elementCount);
+            break;
+        case AST_BINARY_OP:
+            node->binaryOp.left = chainNode(node->binaryOp.left);
+            node->binaryOp.right = chainNode(node->binaryOp.right);
+            if (node->binaryOp.leftString || node->binaryOp.rightString)
+                return buildStringChain(node);
+            break;
+        case AST_MEMBER_ACCESS:
+            node->memberAccess.object = chainNode(node->memberAccess.object);
+            break;
+        case AST_METHOD_CALL:
+            node->methodCall.object = chainNode(node->methodCall.object);
+            chainList(node->methodCall.arguments, node->methodCall.argCount);
+            break;
+        case AST_SPAWN:
+            chainList(node->spawnExpr.call->funcCall.arguments,
+                      node->spawnExpr.call->funcCall.argCount);
+            break;
+        case AST_AWAIT:
+            node->awaitExpr.future = chainNode(node->awaitExpr.future);
+            break;
+        case AST_INDEX:
+            node->indexExpr.array = chainNode(node->indexExpr.array);
+            node->indexExpr.index = chainNode(node->indexExpr.index);
+            break;
+        case AST_INDEX_ASSIGN:
+            node->indexAssign.index = chainNode(node->indexAssign.index);
+            node->indexAssign.value = chainNode(node->indexAssign.value);
+            break;
+        default:
+            break;
     }
     return node;
 }
 
+static void chainList(AstNode **nodes, int count) {
+    for (int i = 0; i < count; i++)
+        nodes[i] = chainNode(nodes[i]);
+}
+
+void buildStringChains(AstNode *root) {
+    chainNode(root);
+}
+
+/* Optimización de expresiones binarias: simplificación algebraica hasta punto fijo */
+static AstNode *optimizeBinaryOp(AstNode *node) {
+    if (!node || node->type != AST_BINARY_OP)
+        return node;
+
+    /* Optimiza primero los operandos recursivamente (llamadas, lambdas, etc.) */
+    node->binaryOp.left = optimizeAST(node->binaryOp.left);
+    node->binaryOp.right = optimizeAST(node->binaryOp.right);
+
+    return simplifyExpression(node);
+}
+
 /* Optimización de sentencias if: eliminación de código muerto */
 static AstNode *optimizeIfStmt(AstNode *node) {
     if (!node || node->type != AST_IF_STMT)
@@ -62,8 +842,10 @@ static AstNode *optimizeIfStmt(AstNode *node) {
 
     /* Si la condición es un literal numérico, evaluamos la condición */
     if (node->ifStmt.condition->type == AST_NUMBER_LITERAL) {
-        double condVal = node->ifStmt.condition->numberLiteral.value;
-        int condTrue = (condVal != 0);  /* Se interpreta 0 como false */
+        AstNode *cond = node->ifStmt.condition;
+        int condTrue = cond->numberLiteral.isFloat  /* Se interpreta 0 como false */
+                           ? (cond->numberLiteral.value != 0)
+                           : (cond->numberLiteral.intValue != 0);
 
         /* Elimina la rama no ejecutada */
         if (condTrue) {
@@ -100,11 +882,24 @@ AstNode *optimizeAST(AstNode *root) {
     if (!root) return NULL;
 
     switch (root->type) {
-        case AST_PROGRAM:
+        case AST_PROGRAM: {
+            /* Hasta un punto fijo: una variable puede usarse antes de la
+               sentencia que fija su tipo */
+            int known;
+            do {
+                known = typedVarCount();
+                collectTypedVars(root);
+            } while (known != typedVarCount());
             for (int i = 0; i < root->program.statementCount; i++) {
                 root->program.statements[i] = optimizeAST(root->program.statements[i]);
             }
+            freeVarList(&vectorVars);
+            freeVarList(&intVars);
+            freeVarList(&floatVars);
+            freeVarList(&intFuncs);
+            freeVarList(&otherFuncs);
             break;
+        }
         case AST_VAR_ASSIGN:
             /* Actualizado: usar initializer en lugar de value */
             root->varAssign.initializer = optimizeAST(root->varAssign.initializer);
@@ -115,9 +910,12 @@ AstNode *optimizeAST(AstNode *root) {
                 root->varDecl.initializer = optimizeAST(root->varDecl.initializer);
             break;
         case AST_FUNC_DEF:
+            pushTypeScope(root->funcDef.parameters, root->funcDef.paramTypes, root->funcDef.paramCount,
+                          root->funcDef.body, root->funcDef.bodyCount);
             for (int i = 0; i < root->funcDef.bodyCount; i++) {
                 root->funcDef.body[i] = optimizeAST(root->funcDef.body[i]);
             }
+            popTypeScope();
             break;
         case AST_RETURN_STMT:
             root->returnStmt.expr = optimizeAST(root->returnStmt.expr);
@@ -127,8 +925,26 @@ AstNode *optimizeAST(AstNode *root) {
             break;
         case AST_BINARY_OP:
             return optimizeBinaryOp(root);
+        case AST_FUNC_CALL:
+            for (int i = 0; i < root->funcCall.argCount; i++) {
+                root->funcCall.arguments[i] = optimizeAST(root->funcCall.arguments[i]);
+            }
+            break;
+        case AST_INDEX:
+            /* Índices en forma canónica (i + c): así los reconoce el
+               análisis de rangos */
+            root->indexExpr.array = optimizeAST(root->indexExpr.array);
+            root->indexExpr.index = optimizeAST(root->indexExpr.index);
+            break;
+        case AST_INDEX_ASSIGN:
+            root->indexAssign.index = optimizeAST(root->indexAssign.index);
+            root->indexAssign.value = optimizeAST(root->indexAssign.value);
+            break;
         case AST_LAMBDA:
+            pushTypeScope(root->lambda.parameters, root->lambda.paramTypes, root->lambda.paramCount,
+                          NULL, 0);
             root->lambda.body = optimizeAST(root->lambda.body);
+            popTypeScope();
             break;
         case AST_IF_STMT:
             return optimizeIfStmt(root);
@@ -150,3 +966,65 @@ AstNode *optimizeAST(AstNode *root) {
     }
     return root;
 }
+
+/* ============================
+   Reducción de fuerza para constantes
+   ============================ */
+
+int exactLog2(long value) {
+    uint64_t mag = (value < 0) ? (uint64_t)0 - (uint64_t)value : (uint64_t)value;
+    if (mag == 0 || (mag & (mag - 1)) != 0)
+        return -1;
+    int k = 0;
+    while (mag > 1) {
+        mag >>= 1;
+        k++;
+    }
+    return k;
+}
+
+/* Hacker's Delight, figura 10-1, generalizada a 32 y 64 bits.
+   Se trabaja en aritmética sin signo módulo 2^bits. */
+int computeDivMagic(long divisor, int bits, DivMagic *out) {
+    if (bits != 32 && bits != 64)
+        return 0;
+    const uint64_t mask = (bits == 64) ? UINT64_MAX : ((UINT64_C(1) << bits) - 1);
+    const int64_t minVal = (bits == 64) ? INT64_MIN : INT32_MIN;
+    const int64_t maxVal = (bits == 64) ? INT64_MAX : INT32_MAX;
+    if ((int64_t)divisor < minVal || (int64_t)divisor > maxVal)
+        return 0;
+    if (divisor == (long)minVal || exactLog2(divisor) >= 0 || divisor == 0)
+        return 0;
+
+    const uint64_t two = UINT64_C(1) << (bits - 1);
+    uint64_t ad = (divisor < 0) ? (uint64_t)0 - (uint64_t)divisor : (uint64_t)divisor;
+    uint64_t t = two + (divisor < 0 ? 1 : 0);
+    uint64_t anc = t - 1 - t % ad;
+    int p = bits - 1;
+    uint64_t q1 = two / anc, r1 = two - q1 * anc;
+    uint64_t q2 = two / ad,  r2 = two - q2 * ad;
+    uint64_t delta;
+    do {
+        p++;
+        q1 = (2 * q1) & mask;
+        r1 = (2 * r1) & mask;
+        if (r1 >= anc) { q1 = (q1 + 1) & mask; r1 = (r1 - anc) & mask; }
+        q2 = (2 * q2) & mask;
+        r2 = (2 * r2) & mask;
+        if (r2 >= ad) { q2 = (q2 + 1) & mask; r2 = (r2 - ad) & mask; }
+        delta = (ad - r2) & mask;
+    } while (q1 < delta || (q1 == delta && r1 == 0));
+
+    uint64_t m = (q2 + 1) & mask;
+    if (divisor < 0)
+        m = ((uint64_t)0 - m) & mask;
+    /* Extensión de signo desde 'bits' bits */
+    int64_t magic = (bits == 64) ? (int64_t)m
+                                 : (int64_t)(int32_t)(uint32_t)m;
+
+    out->multiplier = (long)magic;
+    out->shift = p - bits;
+    out->addDividend = (divisor > 0 && magic < 0);
+    out->subDividend = (divisor < 0 && magic > 0);
+    return 1;
+}
@@ -12,4 +12,102 @@
  */
 AstNode *optimizeAST(AstNode *root);
 
+/**
+ * @brief Aplana las cadenas de '+' de strings en nodos AST_STRING_BUILD.
+ *
+ * Se ejecuta después de analyzeSemantics: decide qué '+' son
+ * concatenaciones, y qué piezas se añaden como enteros, con los tipos del
+ * análisis semántico.
+ *
+ * @param root Raíz del AST (AST_PROGRAM).
+ */
+void buildStringChains(AstNode *root);
+
+/* ============================
+   Simplificador algebraico
+   ============================ */
+
+/* Límite de pasadas del simplificador hasta alcanzar el punto fijo */
+#define SIMPLIFY_MAX_PASSES 16
+
+/**
+ * @brief Contadores de reescrituras aplicadas por el optimizador.
+ */
+typedef struct {
+    size_t constantFolds;      /* Operaciones entre literales evaluadas */
+    size_t identities;         /* x + 0, x - 0, x * 1, x / 1 */
+    size_t annihilations;      /* x * 0, x % 1, x - x */
+    size_t reassociations;     /* (x + c1) + c2 => x + c3, etc. */
+    size_t canonicalizations;  /* Constantes movidas a la derecha */
+    size_t stringChains;       /* Cadenas de '+' de strings pasadas a constructor (buildStringChains) */
+    size_t passes;             /* Pasadas del simplificador */
+} OptimizeStats;
+
+/**
+ * @brief Simplifica una expresión hasta un punto fijo.
+ *
+ * Aplica plegado de constantes, identidades algebraicas, reasociación de
+ * constantes enteras y orden canónico de operandos (constante a la derecha).
+ * Es el punto de entrada común para cualquier nivel que represente
+ * expresiones con nodos AST_BINARY_OP.
+ *
+ * @param expr Expresión a simplificar (se consume; puede liberarse).
+ * @return AstNode* Expresión simplificada.
+ */
+AstNode *simplifyExpression(AstNode *expr);
+
+/**
+ * @brief Reinicia los contadores de reescrituras.
+ */
+void optimizeResetStats(void);
+
+/**
+ * @brief Retorna los contadores de reescrituras acumulados.
+ */
+const OptimizeStats *optimizeGetStats(void);
+
+/**
+ * @brief Imprime los contadores de reescrituras acumulados.
+ */
+void optimizeDumpStats(void);
+
+/* ============================
+   Reducción de fuerza para constantes
+   ============================ */
+
+/**
+ * @brief Parámetros para dividir por una constante mediante multiplicación.
+ *
+ * q = ((n * multiplier) >> bits) [+/- n] >> shift, corrigiendo el signo al final.
+ * addDividend/subDividend indican si hay que sumar o restar n a la parte alta.
+ */
+typedef struct {
+    long multiplier;   /* Número mágico con signo (ancho 'bits') */
+    int shift;         /* Desplazamiento aritmético tras la multiplicación */
+    int addDividend;   /* divisor > 0 y multiplicador negativo */
+    int subDividend;   /* divisor < 0 y multiplicador positivo */
+} DivMagic;
+
+/**
+ * @brief Retorna k si |value| == 2^k (k >= 0), o -1 en caso contrario.
+ *
+ * @param value Constante a analizar.
+ * @return int Exponente o -1.
+ */
+int exactLog2(long value);
+
+/**
+ * @brief Calcula el número mágico para la división con signo por una constante.
+ *
+ * Implementa el algoritmo de Hacker's Delight (cap. 10) para enteros con
+ * signo de 'bits' bits (32 o 64). El divisor debe cumplir |divisor| >= 2 y
+ * no ser potencia de dos (esos casos se resuelven con desplazamientos).
+ *
+ * @param divisor Divisor constante.
+ * @param bits Ancho de los enteros del backend (32 o 64).
+ * @param out Parámetros resultantes.
+ * @return int 1 si se calculó el número mágico, 0 si el divisor no es apto.
+ */
+int computeDivMagic(long divisor, int bits, DivMagic *out);
+
 #endif /* OPTIMIZE_H */
\ No newline at end of file
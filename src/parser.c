@@ -5,6 +5,7 @@
 #include <stdlib.h>
 #include <stdio.h>
 #include <string.h>
+#include <errno.h>
 
 /* Variable global para el token actual */
 static Token currentToken;
@@ -21,7 +22,7 @@ static AstNode *parseFactor(void);
 static AstNode *parseFuncDef(void);
 static AstNode *parseReturn(void);
 static AstNode *parseIfStmt(void);
-static AstNode *parseForStmt(void);
+static AstNode *parseForStmt(int parallel);
 static AstNode *parseClassDef(void);
 static AstNode *parseLambda(void);
 static AstNode *parseArrayLiteral(void);
@@ -174,6 +175,15 @@ static AstNode *parsePostfix(AstNode *node) {
                currentToken.type, currentToken.lexeme);
         node = funcCall;
         return parsePostfix(node);
+    } else if (currentToken.type == TOKEN_LBRACKET) {
+        advanceToken(); // consume '['
+        AstNode *indexNode = createAstNode(AST_INDEX);
+        indexNode->indexExpr.array = node;
+        indexNode->indexExpr.index = parseExpression();
+        if (currentToken.type != TOKEN_RBRACKET)
+            parserError("Expected ']' after array index");
+        advanceToken(); // consume ']'
+        return parsePostfix(indexNode);
     }
     printf("parsePostfix: returning, current type=%d, lexeme='%s'\n",
            currentToken.type, currentToken.lexeme);
@@ -230,9 +240,25 @@ static AstNode *parseStatement(void) {
     } else if (currentToken.type == TOKEN_IF) {
         return parseIfStmt();
     } else if (currentToken.type == TOKEN_FOR) {
-        return parseForStmt();
+        return parseForStmt(0);
+    } else if (currentToken.type == TOKEN_PARALLEL) {
+        advanceToken(); // consume "parallel"
+        if (currentToken.type != TOKEN_FOR)
+            parserError("Expected 'for' after 'parallel'");
+        return parseForStmt(1);
     } else if (currentToken.type == TOKEN_CLASS) {
         return parseClassDef();
+    } else if (currentToken.type == TOKEN_AT) {
+        /* Atributo de clase: @soa class Nombre; */
+        advanceToken(); // consume '@'
+        if (currentToken.type != TOKEN_IDENTIFIER || strcmp(currentToken.lexeme, "soa") != 0)
+            parserError("Unknown attribute; expected '@soa'");
+        advanceToken(); // consume "soa"
+        if (currentToken.type != TOKEN_CLASS)
+            parserError("Expected 'class' after '@soa'");
+        AstNode *classNode = parseClassDef();
+        classNode->classDef.soa = 1;
+        return classNode;
     } else if (currentToken.type == TOKEN_IMPORT) {
         AstNode *importNode = createAstNode(AST_IMPORT);
         advanceToken(); // consume "import"
@@ -295,12 +321,11 @@ static AstNode *parseStatement(void) {
             advanceToken(); // consume ':'
             char typeBuffer[256] = "";
             if (currentToken.type == TOKEN_LBRACKET) {
-                /* Se trata de un tipo arreglo, e.g. [int] */
+                /* Se trata de un tipo arreglo, e.g. [int] o [Clase] */
                 strncat(typeBuffer, "[", sizeof(typeBuffer) - strlen(typeBuffer) - 1);
                 advanceToken(); // consume '['
                 if (!(currentToken.type == TOKEN_INT || currentToken.type == TOKEN_FLOAT ||
-                      (currentToken.type == TOKEN_IDENTIFIER &&
-                       (strcmp(currentToken.lexeme, "int") == 0 || strcmp(currentToken.lexeme, "float") == 0))))
+                      currentToken.type == TOKEN_IDENTIFIER))
                     parserError("Expected type inside array declaration");
                 strncat(typeBuffer, currentToken.lexeme, sizeof(typeBuffer) - strlen(typeBuffer) - 1);
                 advanceToken(); // consume el tipo
@@ -326,6 +351,38 @@ static AstNode *parseStatement(void) {
         }
         /* Fin de rama de declaración explícita */
 
+        /* Escritura en un elemento o en su campo: arr[i] = valor, arr[i].campo = valor */
+        if (currentToken.type == TOKEN_LBRACKET) {
+            advanceToken(); // consume '['
+            AstNode *index = parseExpression();
+            if (currentToken.type != TOKEN_RBRACKET)
+                parserError("Expected ']' after array index");
+            advanceToken(); // consume ']'
+            char field[256] = "";
+            int isStore = 1;
+            if (currentToken.type == TOKEN_DOT) {
+                advanceToken(); // consume '.'
+                isStore = currentToken.type == TOKEN_IDENTIFIER;
+                if (isStore) {
+                    strncpy(field, currentToken.lexeme, sizeof(field) - 1);
+                    advanceToken(); // consume el campo
+                }
+            }
+            if (!isStore || currentToken.type != TOKEN_ASSIGN) {
+                freeAstNode(index);
+                lexRestoreState(saved);
+                currentToken = temp;
+                return parseExpression();
+            }
+            advanceToken(); // consume '='
+            AstNode *assignNode = createAstNode(AST_INDEX_ASSIGN);
+            strncpy(assignNode->indexAssign.name, temp.lexeme, sizeof(assignNode->indexAssign.name) - 1);
+            assignNode->indexAssign.index = index;
+            memcpy(assignNode->indexAssign.field, field, sizeof(assignNode->indexAssign.field));
+            assignNode->indexAssign.value = parseExpression();
+            return assignNode;
+        }
+
         /* Si no se encontró ':', se trata de asignación, miembro o llamada a función */
         if (currentToken.type == TOKEN_DOT) {
             advanceToken(); // consume '.'
@@ -448,10 +505,11 @@ static AstNode *parseExpression(void) {
     return node;
 }
 
-/* parseTerm: Maneja operadores '*' y '/' */
+/* parseTerm: Maneja operadores '*', '/' y '%' */
 static AstNode *parseTerm(void) {
     AstNode *left = parseFactor();
-    while (currentToken.type == TOKEN_ASTERISK || currentToken.type == TOKEN_SLASH) {
+    while (currentToken.type == TOKEN_ASTERISK || currentToken.type == TOKEN_SLASH ||
+           currentToken.type == TOKEN_PERCENT) {
         char op = currentToken.lexeme[0];
         advanceToken();
         AstNode *right = parseFactor();
@@ -472,7 +530,16 @@ static AstNode *parseFactor(void) {
     }
     if (currentToken.type == TOKEN_NUMBER) {
         node = createAstNode(AST_NUMBER_LITERAL);
-        node->numberLiteral.value = atof(currentToken.lexeme);
+        if (strchr(currentToken.lexeme, '.')) {
+            node->numberLiteral.isFloat = 1;
+            node->numberLiteral.value = atof(currentToken.lexeme);
+        } else {
+            /* Enteros exactos de 64 bits: no se pasa por double */
+            errno = 0;
+            node->numberLiteral.intValue = strtoll(currentToken.lexeme, NULL, 10);
+            if (errno == ERANGE)
+                parserError("Integer literal out of 64-bit range");
+        }
         advanceToken();
     } else if (currentToken.type == TOKEN_STRING) {
         node = createAstNode(AST_STRING_LITERAL);
@@ -491,6 +558,18 @@ static AstNode *parseFactor(void) {
         advanceToken();
     } else if (currentToken.type == TOKEN_LBRACKET) {
         node = parseArrayLiteral();
+    } else if (currentToken.type == TOKEN_SPAWN) {
+        /* spawn f(args): la llamada se ejecuta como tarea y retorna su futuro */
+        advanceToken(); // consume "spawn"
+        AstNode *call = parseFactor();
+        if (call->type != AST_FUNC_CALL)
+            parserError("Expected function call after 'spawn'");
+        node = createAstNode(AST_SPAWN);
+        node->spawnExpr.call = call;
+    } else if (currentToken.type == TOKEN_AWAIT) {
+        advanceToken(); // consume "await"
+        node = createAstNode(AST_AWAIT);
+        node->awaitExpr.future = parseFactor();
     } else {
         parserError("Unexpected token in expression");
     }
@@ -509,6 +588,7 @@ static AstNode *parseFuncDef(void) {
         parserError("Expected '(' after function name");
     advanceToken();
     AstNode **parameters = NULL;
+    char (*paramTypes)[64] = NULL;
     int paramCount = 0;
     while (currentToken.type != TOKEN_RPAREN) {
         if (currentToken.type != TOKEN_IDENTIFIER)
@@ -525,6 +605,9 @@ static AstNode *parseFuncDef(void) {
         advanceToken();
         if (currentToken.type != TOKEN_IDENTIFIER && currentToken.type != TOKEN_INT && currentToken.type != TOKEN_FLOAT)
             parserError("Expected parameter type in function definition");
+        paramTypes = memory_realloc(paramTypes, paramCount * sizeof(*paramTypes));
+        strncpy(paramTypes[paramCount - 1], currentToken.lexeme, sizeof(paramTypes[0]) - 1);
+        paramTypes[paramCount - 1][sizeof(paramTypes[0]) - 1] = '\0';
         advanceToken();
         if (currentToken.type == TOKEN_COMMA)
             advanceToken();
@@ -560,6 +643,7 @@ static AstNode *parseFuncDef(void) {
     AstNode *funcNode = createAstNode(AST_FUNC_DEF);
     strncpy(funcNode->funcDef.name, funcName, sizeof(funcNode->funcDef.name));
     funcNode->funcDef.parameters = parameters;
+    funcNode->funcDef.paramTypes = paramTypes;
     funcNode->funcDef.paramCount = paramCount;
     strncpy(funcNode->funcDef.returnType, retType, sizeof(funcNode->funcDef.returnType));
     funcNode->funcDef.body = body;
@@ -613,8 +697,37 @@ static AstNode *parseIfStmt(void) {
     return ifNode;
 }
 
-/* parseForStmt: for i in range(...) ... end */
-static AstNode *parseForStmt(void) {
+/* parseReduceClause: reduce(<op>: <variable>) con op en +, *, min, max */
+static void parseReduceClause(AstNode *forNode) {
+    advanceToken(); // consume "reduce"
+    if (currentToken.type != TOKEN_LPAREN)
+        parserError("Expected '(' after 'reduce'");
+    advanceToken();
+    if (currentToken.type == TOKEN_PLUS)
+        forNode->forStmt.reduceOp = REDUCE_ADD;
+    else if (currentToken.type == TOKEN_ASTERISK)
+        forNode->forStmt.reduceOp = REDUCE_MUL;
+    else if (currentToken.type == TOKEN_IDENTIFIER && strcmp(currentToken.lexeme, "min") == 0)
+        forNode->forStmt.reduceOp = REDUCE_MIN;
+    else if (currentToken.type == TOKEN_IDENTIFIER && strcmp(currentToken.lexeme, "max") == 0)
+        forNode->forStmt.reduceOp = REDUCE_MAX;
+    else
+        parserError("Expected reduction operator (+, *, min, max)");
+    advanceToken();
+    if (currentToken.type != TOKEN_COLON)
+        parserError("Expected ':' after reduction operator");
+    advanceToken();
+    if (currentToken.type != TOKEN_IDENTIFIER)
+        parserError("Expected reduction variable");
+    strncpy(forNode->forStmt.reduceVar, currentToken.lexeme, sizeof(forNode->forStmt.reduceVar) - 1);
+    advanceToken();
+    if (currentToken.type != TOKEN_RPAREN)
+        parserError("Expected ')' after reduction variable");
+    advanceToken();
+}
+
+/* parseForStmt: [parallel] for i in range(...) [reduce(op: v)] ... end */
+static AstNode *parseForStmt(int parallel) {
     advanceToken();
     if (currentToken.type != TOKEN_IDENTIFIER)
         parserError("Expected iterator identifier in for loop");
@@ -637,13 +750,17 @@ static AstNode *parseForStmt(void) {
         rangeEnd = parseExpression();
     } else {
         AstNode *zeroNode = createAstNode(AST_NUMBER_LITERAL);
-        zeroNode->numberLiteral.value = 0;
+        zeroNode->numberLiteral.intValue = 0;
         rangeEnd = rangeStart;
         rangeStart = zeroNode;
     }
     if (currentToken.type != TOKEN_RPAREN)
         parserError("Expected ')' after range arguments");
     advanceToken();
+    AstNode *forNode = createAstNode(AST_FOR_STMT);
+    forNode->forStmt.parallel = parallel;
+    if (parallel && currentToken.type == TOKEN_REDUCE)
+        parseReduceClause(forNode);
     skipStatementSeparators();
     AstNode **body = NULL;
     int bodyCount = 0;
@@ -656,7 +773,6 @@ static AstNode *parseForStmt(void) {
     if (currentToken.type != TOKEN_END)
         parserError("Expected 'end' to close for loop");
     advanceToken();
-    AstNode *forNode = createAstNode(AST_FOR_STMT);
     strncpy(forNode->forStmt.iterator, iterator, sizeof(forNode->forStmt.iterator));
     forNode->forStmt.rangeStart = rangeStart;
     forNode->forStmt.rangeEnd = rangeEnd;
@@ -665,7 +781,7 @@ static AstNode *parseForStmt(void) {
     return forNode;
 }
 
-/* parseClassDef: Parsea class <Name>; ... end */
+/* parseClassDef: Parsea class <Name>[(<Base>)]; ... end */
 static AstNode *parseClassDef(void) {
     advanceToken();
     if (currentToken.type != TOKEN_IDENTIFIER)
@@ -673,6 +789,17 @@ static AstNode *parseClassDef(void) {
     char className[256];
     strncpy(className, currentToken.lexeme, sizeof(className));
     advanceToken();
+    char parentName[256] = "";
+    if (currentToken.type == TOKEN_LPAREN) {
+        advanceToken(); // consume '('
+        if (currentToken.type != TOKEN_IDENTIFIER)
+            parserError("Expected base class name after '('");
+        strncpy(parentName, currentToken.lexeme, sizeof(parentName) - 1);
+        advanceToken();
+        if (currentToken.type != TOKEN_RPAREN)
+            parserError("Expected ')' after base class name");
+        advanceToken(); // consume ')'
+    }
     if (currentToken.type == TOKEN_SEMICOLON)
         advanceToken();
     AstNode **members = NULL;
@@ -687,6 +814,7 @@ static AstNode *parseClassDef(void) {
     advanceToken();
     AstNode *classNode = createAstNode(AST_CLASS_DEF);
     strncpy(classNode->classDef.name, className, sizeof(classNode->classDef.name));
+    memcpy(classNode->classDef.parent, parentName, sizeof(classNode->classDef.parent));
     classNode->classDef.members = members;
     classNode->classDef.memberCount = memberCount;
     return classNode;
@@ -696,6 +824,7 @@ static AstNode *parseClassDef(void) {
 static AstNode *parseLambda(void) {
     advanceToken();
     AstNode **parameters = NULL;
+    char (*paramTypes)[64] = NULL;
     int paramCount = 0;
     while (currentToken.type != TOKEN_RPAREN) {
         if (currentToken.type != TOKEN_IDENTIFIER)
@@ -708,13 +837,16 @@ static AstNode *parseLambda(void) {
         advanceToken();
         if (currentToken.type != TOKEN_IDENTIFIER && currentToken.type != TOKEN_INT && currentToken.type != TOKEN_FLOAT)
             parserError("Expected parameter type in lambda after ':'");
+        parameters = memory_realloc(parameters, (paramCount + 1) * sizeof(AstNode *));
+        paramTypes = memory_realloc(paramTypes, (paramCount + 1) * sizeof(*paramTypes));
+        strncpy(paramTypes[paramCount], currentToken.lexeme, sizeof(paramTypes[0]) - 1);
+        paramTypes[paramCount][sizeof(paramTypes[0]) - 1] = '\0';
+        parameters[paramCount++] = param;
         advanceToken();
         if (currentToken.type == TOKEN_COMMA)
             advanceToken();
         else if (currentToken.type != TOKEN_RPAREN)
             parserError("Expected ',' or ')' in lambda parameter list");
-        parameters = memory_realloc(parameters, (paramCount + 1) * sizeof(AstNode *));
-        parameters[paramCount++] = param;
     }
     advanceToken();
     if (currentToken.type != TOKEN_ARROW)
@@ -732,6 +864,7 @@ static AstNode *parseLambda(void) {
     AstNode *lambdaNode = createAstNode(AST_LAMBDA);
     lambdaNode->lambda.parameters = parameters;
     lambdaNode->lambda.paramCount = paramCount;
+    lambdaNode->lambda.paramTypes = paramTypes;
     strncpy(lambdaNode->lambda.returnType, retType, sizeof(lambdaNode->lambda.returnType));
     lambdaNode->lambda.body = body;
     return lambdaNode;
@@ -0,0 +1,756 @@
+/* runtime.c */
+#define _POSIX_C_SOURCE 200112L
+#define _DEFAULT_SOURCE
+#include "runtime.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <limits.h>
+#include <stdatomic.h>
+#include <pthread.h>
+#include <sched.h>
+#include <time.h>
+#include <unistd.h>
+
+/* ============================
+   Pool de hilos con robo de trabajo
+   ============================ */
+
+#define LYN_CACHE_LINE 64
+#define LYN_LOOP_SITES 64   /* Bucles distintos con granularidad recordada */
+#define LYN_IDLE_SPINS 64   /* Intentos de robo antes de dormir */
+#define LYN_FUTURE_CACHE 1024   /* Futuros libres que guarda cada hilo */
+
+/* Un 'parallel for' en curso. Vive en la pila del hilo que lo lanzó hasta
+   que remaining llega a 0: la resta de remaining es el último acceso de
+   cada trozo al trabajo. */
+typedef struct {
+    LynChunkFunc body;
+    int op;
+    long grain;                 /* Iteraciones por trozo como máximo */
+    atomic_long remaining;      /* Iteraciones aún sin ejecutar */
+    atomic_long busyNs;         /* Tiempo total de los trozos */
+    atomic_long result;         /* Reducción acumulada (empieza en init) */
+} LynJob;
+
+struct LynFuture {
+    LynTaskFunc func;
+    long arg;
+    long result;
+    atomic_int done;            /* Publica result (release/acquire) */
+    struct LynFuture *nextFree;
+};
+
+/* Un trozo de un bucle (job) o una tarea lanzada con spawn (future) */
+typedef struct {
+    LynJob *job;
+    LynFuture *future;
+    long lo;
+    long hi;
+} LynTask;
+
+/* Cola de un hilo. El dueño apila y desapila por abajo (LIFO, datos aún
+   en caché); los ladrones toman por arriba las tareas más grandes. Cada
+   cola tiene su propio mutex, así que dos hilos solo compiten cuando uno
+   le roba al otro. */
+typedef struct {
+    pthread_mutex_t lock;
+    long top;                   /* Tareas en [top, bottom) módulo LYN_DEQUE_SIZE */
+    long bottom;
+    atomic_long size;           /* Lectura sin lock para saltar colas vacías */
+    atomic_size_t chunks;
+    atomic_size_t steals;
+    atomic_size_t spawned;
+    pthread_t thread;
+    LynTask tasks[LYN_DEQUE_SIZE];
+} LynWorker;
+
+typedef struct {
+    LynChunkFunc body;
+    double nsPerIter;
+} LoopSite;
+
+static pthread_mutex_t poolMutex = PTHREAD_MUTEX_INITIALIZER;
+static atomic_int poolReady = 0;
+static int workerCount = 0;     /* Hilos del pool, sin contar al que llama */
+/* workers[workerCount] es la cola de los hilos externos al pool */
+static LynWorker *workers[LYN_MAX_WORKERS + 1];
+static _Thread_local int selfIndex = -1;
+static _Thread_local unsigned stealSeed = 0;
+
+/* Futuros libres del hilo: lanzar una tarea no pasa por malloc */
+/* Tareas que el hilo ejecuta anidadas dentro de lyn_await */
+static _Thread_local int helpDepth = 0;
+static _Thread_local LynFuture *freeFutures = NULL;
+static _Thread_local int freeFutureCount = 0;
+
+/* Los hilos ociosos duermen hasta que hay tareas en alguna cola */
+static pthread_mutex_t sleepMutex = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t sleepCond = PTHREAD_COND_INITIALIZER;
+static atomic_long queued = 0;
+static atomic_int sleepers = 0;
+static atomic_int stopping = 0;
+
+static pthread_mutex_t siteMutex = PTHREAD_MUTEX_INITIALIZER;
+static LoopSite sites[LYN_LOOP_SITES];
+
+static atomic_size_t loopCount = 0;
+static atomic_size_t sequentialCount = 0;
+static size_t retiredChunks = 0;    /* De pools ya detenidos; requiere poolMutex */
+static size_t retiredSteals = 0;
+static size_t retiredSpawned = 0;
+
+static long nowNs(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (long)ts.tv_sec * 1000000000L + ts.tv_nsec;
+}
+
+/* Aritmética con desbordamiento módulo 2^64, como el código generado */
+static long combine(int op, long a, long b) {
+    switch (op) {
+        case LYN_REDUCE_ADD: return (long)((unsigned long)a + (unsigned long)b);
+        case LYN_REDUCE_MUL: return (long)((unsigned long)a * (unsigned long)b);
+        case LYN_REDUCE_MIN: return a < b ? a : b;
+        case LYN_REDUCE_MAX: return a > b ? a : b;
+        default: return a;
+    }
+}
+
+static void combineAtomic(atomic_long *target, int op, long value) {
+    long current = atomic_load_explicit(target, memory_order_relaxed);
+    while (!atomic_compare_exchange_weak_explicit(target, &current, combine(op, current, value),
+                                                  memory_order_relaxed, memory_order_relaxed))
+        ;
+}
+
+/* ----------------------------
+   Colas
+   ---------------------------- */
+
+static int pushTask(int self, LynTask task) {
+    LynWorker *w = workers[self];
+    pthread_mutex_lock(&w->lock);
+    if (w->bottom - w->top == LYN_DEQUE_SIZE) {
+        pthread_mutex_unlock(&w->lock);
+        return 0;
+    }
+    w->tasks[w->bottom % LYN_DEQUE_SIZE] = task;
+    w->bottom++;
+    atomic_store_explicit(&w->size, w->bottom - w->top, memory_order_relaxed);
+    atomic_fetch_add(&queued, 1);
+    pthread_mutex_unlock(&w->lock);
+    if (atomic_load(&sleepers) > 0) {
+        pthread_mutex_lock(&sleepMutex);
+        pthread_cond_signal(&sleepCond);
+        pthread_mutex_unlock(&sleepMutex);
+    }
+    return 1;
+}
+
+static int popTask(int self, LynTask *out) {
+    LynWorker *w = workers[self];
+    if (atomic_load_explicit(&w->size, memory_order_relaxed) == 0)
+        return 0;
+    pthread_mutex_lock(&w->lock);
+    if (w->bottom == w->top) {
+        pthread_mutex_unlock(&w->lock);
+        return 0;
+    }
+    w->bottom--;
+    *out = w->tasks[w->bottom % LYN_DEQUE_SIZE];
+    atomic_store_explicit(&w->size, w->bottom - w->top, memory_order_relaxed);
+    atomic_fetch_sub(&queued, 1);
+    pthread_mutex_unlock(&w->lock);
+    return 1;
+}
+
+static int stealTask(int self, int victim, LynTask *out) {
+    LynWorker *w = workers[victim];
+    if (atomic_load_explicit(&w->size, memory_order_relaxed) == 0)
+        return 0;
+    pthread_mutex_lock(&w->lock);
+    if (w->bottom == w->top) {
+        pthread_mutex_unlock(&w->lock);
+        return 0;
+    }
+    *out = w->tasks[w->top % LYN_DEQUE_SIZE];
+    w->top++;
+    atomic_store_explicit(&w->size, w->bottom - w->top, memory_order_relaxed);
+    atomic_fetch_sub(&queued, 1);
+    pthread_mutex_unlock(&w->lock);
+    atomic_fetch_add_explicit(&workers[self]->steals, 1, memory_order_relaxed);
+    return 1;
+}
+
+/* Primero la cola propia; después se roba empezando por una víctima al azar */
+static int findTask(int self, LynTask *out) {
+    if (popTask(self, out))
+        return 1;
+    int queues = workerCount + 1;
+    if (!stealSeed)
+        stealSeed = 0x9e3779b9u * (unsigned)(self + 1) ^ (unsigned)(uintptr_t)&stealSeed;
+    stealSeed = stealSeed * 1103515245u + 12345u;
+    int start = (int)((stealSeed >> 16) % (unsigned)queues);
+    for (int k = 0; k < queues; k++) {
+        int victim = (start + k) % queues;
+        if (victim != self && stealTask(self, victim, out))
+            return 1;
+    }
+    return 0;
+}
+
+/* Ejecuta una tarea. Mientras el rango supere la granularidad se cede la
+   mitad alta a la cola propia (división perezosa): solo se crean tantas
+   tareas como hilos haya para robarlas. */
+static void runTask(int self, LynTask task) {
+    if (task.future) {
+        LynFuture *future = task.future;
+        future->result = future->func(future->arg);
+        atomic_store_explicit(&future->done, 1, memory_order_release);
+        return;
+    }
+    LynJob *job = task.job;
+    long lo = task.lo, hi = task.hi;
+    while (hi - lo > job->grain) {
+        long mid = lo + (hi - lo) / 2;
+        LynTask upper = { job, NULL, mid, hi };
+        if (!pushTask(self, upper))
+            break;
+        hi = mid;
+    }
+    long begin = nowNs();
+    long partial = job->body(lo, hi);
+    atomic_fetch_add_explicit(&job->busyNs, nowNs() - begin, memory_order_relaxed);
+    if (job->op != LYN_REDUCE_NONE)
+        combineAtomic(&job->result, job->op, partial);
+    atomic_fetch_add_explicit(&workers[self]->chunks, 1, memory_order_relaxed);
+    atomic_fetch_sub_explicit(&job->remaining, hi - lo, memory_order_acq_rel);
+}
+
+static void *workerMain(void *arg) {
+    int self = (int)(intptr_t)arg;
+    selfIndex = self;
+    int idle = 0;
+    while (!atomic_load(&stopping)) {
+        LynTask task;
+        if (findTask(self, &task)) {
+            runTask(self, task);
+            idle = 0;
+            continue;
+        }
+        if (++idle < LYN_IDLE_SPINS) {
+            sched_yield();
+            continue;
+        }
+        pthread_mutex_lock(&sleepMutex);
+        atomic_fetch_add(&sleepers, 1);
+        while (atomic_load(&queued) == 0 && !atomic_load(&stopping))
+            pthread_cond_wait(&sleepCond, &sleepMutex);
+        atomic_fetch_sub(&sleepers, 1);
+        pthread_mutex_unlock(&sleepMutex);
+        idle = 0;
+    }
+    return NULL;
+}
+
+/* ----------------------------
+   Creación del pool
+   ---------------------------- */
+
+static int desiredThreads(void) {
+    const char *env = getenv("LYN_THREADS");
+    long threads = env ? strtol(env, NULL, 10) : sysconf(_SC_NPROCESSORS_ONLN);
+    if (threads < 1)
+        threads = 1;
+    if (threads > LYN_MAX_WORKERS + 1)
+        threads = LYN_MAX_WORKERS + 1;
+    return (int)threads;
+}
+
+static LynWorker *createWorker(void) {
+    void *mem = NULL;
+    if (posix_memalign(&mem, LYN_CACHE_LINE, sizeof(LynWorker)) != 0) {
+        fprintf(stderr, "Error: lyn runtime failed to allocate a worker\n");
+        exit(EXIT_FAILURE);
+    }
+    LynWorker *w = (LynWorker *)mem;
+    memset(w, 0, sizeof(LynWorker));
+    pthread_mutex_init(&w->lock, NULL);
+    return w;
+}
+
+static void ensurePool(void) {
+    if (atomic_load_explicit(&poolReady, memory_order_acquire))
+        return;
+    pthread_mutex_lock(&poolMutex);
+    if (!atomic_load_explicit(&poolReady, memory_order_relaxed)) {
+        workerCount = desiredThreads() - 1;
+        for (int i = 0; i <= workerCount; i++)
+            workers[i] = createWorker();
+        atomic_store(&stopping, 0);
+        for (int i = 0; i < workerCount; i++) {
+            if (pthread_create(&workers[i]->thread, NULL, workerMain, (void *)(intptr_t)i) != 0) {
+                fprintf(stderr, "Error: lyn runtime failed to start worker thread %d\n", i);
+                exit(EXIT_FAILURE);
+            }
+        }
+        atomic_store_explicit(&poolReady, 1, memory_order_release);
+    }
+    pthread_mutex_unlock(&poolMutex);
+}
+
+/* ----------------------------
+   Granularidad automática
+   ---------------------------- */
+
+static LoopSite *findSite(LynChunkFunc body) {
+    size_t i = ((uintptr_t)body >> 4) % LYN_LOOP_SITES;
+    for (size_t probes = 0; probes < LYN_LOOP_SITES; probes++) {
+        LoopSite *site = &sites[(i + probes) % LYN_LOOP_SITES];
+        if (site->body == body || !site->body)
+            return site;
+    }
+    /* Tabla llena: se reutiliza la posición natural */
+    return &sites[i];
+}
+
+/* Trozos de unos LYN_TARGET_CHUNK_NS según el coste medido en ejecuciones
+   anteriores, con al menos cuatro trozos por hilo para poder equilibrar.
+   Un bucle cuyo trabajo total no llega a dos trozos se ejecuta entero en
+   el hilo que lo lanza. Sin medidas aún se empieza con ocho por hilo. */
+static long loopGrain(LynChunkFunc body, long iterations, int threads) {
+    pthread_mutex_lock(&siteMutex);
+    LoopSite *site = findSite(body);
+    double nsPerIter = site->body == body ? site->nsPerIter : 0.0;
+    pthread_mutex_unlock(&siteMutex);
+    if (nsPerIter > 0.0 && nsPerIter * (double)iterations < 2.0 * LYN_TARGET_CHUNK_NS)
+        return iterations;
+    long maxGrain = iterations / ((long)threads * 4);
+    long grain = nsPerIter > 0.0 ? (long)(LYN_TARGET_CHUNK_NS / nsPerIter)
+                                 : iterations / ((long)threads * 8);
+    if (grain > maxGrain)
+        grain = maxGrain;
+    return grain < 1 ? 1 : grain;
+}
+
+static void recordLoopCost(LynChunkFunc body, long iterations, long busyNs) {
+    double measured = (double)busyNs / (double)iterations;
+    if (measured <= 0.0)
+        measured = 0.01;
+    pthread_mutex_lock(&siteMutex);
+    LoopSite *site = findSite(body);
+    if (site->body == body)
+        site->nsPerIter = (site->nsPerIter + measured) / 2.0;
+    else {
+        site->body = body;
+        site->nsPerIter = measured;
+    }
+    pthread_mutex_unlock(&siteMutex);
+}
+
+/* ----------------------------
+   Futuros
+   ---------------------------- */
+
+static LynFuture *allocFuture(void) {
+    LynFuture *future = freeFutures;
+    if (future) {
+        freeFutures = future->nextFree;
+        freeFutureCount--;
+        return future;
+    }
+    future = (LynFuture *)malloc(sizeof(LynFuture));
+    if (!future) {
+        fprintf(stderr, "Error: lyn runtime failed to allocate a task\n");
+        exit(EXIT_FAILURE);
+    }
+    return future;
+}
+
+/* Se guarda en el hilo que espera, que suele ser el que vuelve a lanzar */
+static void releaseFuture(LynFuture *future) {
+    if (freeFutureCount == LYN_FUTURE_CACHE) {
+        free(future);
+        return;
+    }
+    future->nextFree = freeFutures;
+    freeFutures = future;
+    freeFutureCount++;
+}
+
+/* ============================
+   API pública
+   ============================ */
+
+long lyn_parallel_for(long start, long end, long init, LynChunkFunc body, int op) {
+    if (end <= start)
+        return init;
+    ensurePool();
+    atomic_fetch_add_explicit(&loopCount, 1, memory_order_relaxed);
+    long iterations = end - start;
+    if (workerCount == 0 || iterations < 2) {
+        atomic_fetch_add_explicit(&sequentialCount, 1, memory_order_relaxed);
+        long partial = body(start, end);
+        return combine(op, init, partial);
+    }
+
+    /* Un hilo ajeno al pool usa la cola compartida de hilos externos */
+    int self = selfIndex >= 0 ? selfIndex : workerCount;
+    LynJob job;
+    job.body = body;
+    job.op = op;
+    job.grain = loopGrain(body, iterations, workerCount + 1);
+    atomic_init(&job.remaining, iterations);
+    atomic_init(&job.busyNs, 0);
+    atomic_init(&job.result, init);
+
+    LynTask root = { &job, NULL, start, end };
+    runTask(self, root);
+    /* Mientras quedan trozos el hilo ayuda, también con otros bucles */
+    while (atomic_load_explicit(&job.remaining, memory_order_acquire) > 0) {
+        LynTask task;
+        if (findTask(self, &task))
+            runTask(self, task);
+        else
+            sched_yield();
+    }
+    recordLoopCost(body, iterations, atomic_load_explicit(&job.busyNs, memory_order_relaxed));
+    return atomic_load_explicit(&job.result, memory_order_relaxed);
+}
+
+LynFuture *lyn_spawn(LynTaskFunc func, long arg) {
+    ensurePool();
+    int self = selfIndex >= 0 ? selfIndex : workerCount;
+    LynFuture *future = allocFuture();
+    future->func = func;
+    future->arg = arg;
+    atomic_init(&future->done, 0);
+    atomic_fetch_add_explicit(&workers[self]->spawned, 1, memory_order_relaxed);
+    LynTask task = { NULL, future, 0, 0 };
+    /* Sin otros hilos, con la cola llena o en el límite de ayuda se ejecuta
+       en el acto: un hilo en el límite no espera tareas que él mismo encola */
+    if (workerCount == 0 || helpDepth >= LYN_AWAIT_HELP_DEPTH || !pushTask(self, task))
+        runTask(self, task);
+    return future;
+}
+
+long lyn_await(LynFuture *future) {
+    if (!future)
+        return 0;
+    if (!atomic_load_explicit(&future->done, memory_order_acquire)) {
+        int self = selfIndex >= 0 ? selfIndex : workerCount;
+        /* La cola propia se vacía en orden LIFO: la tarea más reciente,
+           normalmente la esperada, se ejecuta primero aquí mismo. Cada tarea
+           ejecutada al ayudar anida un marco en la pila; en el límite el
+           hilo solo cede la CPU */
+        while (!atomic_load_explicit(&future->done, memory_order_acquire)) {
+            LynTask task;
+            if (helpDepth < LYN_AWAIT_HELP_DEPTH && findTask(self, &task)) {
+                helpDepth++;
+                runTask(self, task);
+                helpDepth--;
+            } else {
+                sched_yield();
+            }
+        }
+    }
+    long result = future->result;
+    releaseFuture(future);
+    return result;
+}
+
+/* ============================
+   Arreglos tipados
+   ============================ */
+
+LynArray *lyn_array_new(long length) {
+    if (length < 0 || (size_t)length > (SIZE_MAX - sizeof(LynArray)) / sizeof(long)) {
+        fprintf(stderr, "Runtime error: Invalid array length %ld.\n", length);
+        exit(1);
+    }
+    LynArray *array = (LynArray *)calloc(1, sizeof(LynArray) + (size_t)length * sizeof(long));
+    if (!array) {
+        fprintf(stderr, "Runtime error: Out of memory allocating an array of %ld elements.\n", length);
+        exit(1);
+    }
+    array->length = length;
+    return array;
+}
+
+LynSoa *lyn_soa_new(long length, long fields) {
+    if (length < 0) {
+        fprintf(stderr, "Runtime error: Invalid array length %ld.\n", length);
+        exit(1);
+    }
+    if (fields < 0 || (size_t)fields > (SIZE_MAX - sizeof(LynSoa)) / sizeof(LynArray *)) {
+        fprintf(stderr, "Runtime error: Invalid field count %ld.\n", fields);
+        exit(1);
+    }
+    LynSoa *soa = (LynSoa *)malloc(sizeof(LynSoa) + (size_t)fields * sizeof(LynArray *));
+    if (!soa) {
+        fprintf(stderr, "Runtime error: Out of memory allocating an array of %ld objects.\n", length);
+        exit(1);
+    }
+    soa->length = length;
+    for (long f = 0; f < fields; f++)
+        soa->columns[f] = lyn_array_new(length);
+    return soa;
+}
+
+void lyn_bounds_fail(long index, long length) {
+    fprintf(stderr, "Runtime error: Index %ld out of bounds for array of length %ld.\n",
+            index, length);
+    exit(1);
+}
+
+/* ============================
+   Objetos
+   ============================ */
+
+void *lyn_object_new(long size, const void *vtable) {
+    void *object = calloc(1, size > 0 ? (size_t)size : 1);
+    if (!object) {
+        fprintf(stderr, "Runtime error: Out of memory allocating an object of %ld bytes.\n", size);
+        exit(1);
+    }
+    if (vtable)
+        *(const void **)object = vtable;
+    return object;
+}
+
+/* ============================
+   Strings
+   ============================ */
+
+#define LYN_STR_INLINE_TAG ((LynStr)1 << (sizeof(LynStr) * CHAR_BIT - 1))
+#define LYN_STR_LENGTH_SHIFT ((sizeof(LynStr) - 1) * CHAR_BIT)
+#define LYN_INT_CHARS 24          /* Cifras y signo de un long, con margen */
+#define LYN_BUILDER_CACHE 8       /* Constructores libres que guarda cada hilo */
+#define LYN_BUILDER_KEEP 4096     /* Capacidad máxima de un constructor guardado */
+
+struct LynStrBuilder {
+    char *data;
+    size_t length;
+    size_t capacity;
+    LynStrBuilder *next;          /* Siguiente en la lista de libres del hilo */
+};
+
+static _Thread_local LynStrBuilder *freeBuilders = NULL;
+static _Thread_local int freeBuilderCount = 0;
+
+static const char digitPairs[201] =
+    "0001020304050607080910111213141516171819"
+    "2021222324252627282930313233343536373839"
+    "4041424344454647484950515253545556575859"
+    "6061626364656667686970717273747576777879"
+    "8081828384858687888990919293949596979899";
+static void *strAlloc(size_t size) {
+    void *ptr = malloc(size);
+    if (!ptr) {
+        fprintf(stderr, "Runtime error: Out of memory allocating a string of %zu bytes.\n", size);
+        exit(1);
+    }
+    return ptr;
+}
+
+/* Escribe el entero justo antes de 'end' y retorna su primer carácter */
+static char *formatInt(long value, char *end) {
+    unsigned long n = value < 0 ? 0UL - (unsigned long)value : (unsigned long)value;
+    char *p = end;
+    while (n >= 100) {
+        unsigned long pair = (n % 100) * 2;
+        n /= 100;
+        *--p = digitPairs[pair + 1];
+        *--p = digitPairs[pair];
+    }
+    if (n >= 10) {
+        *--p = digitPairs[n * 2 + 1];
+        *--p = digitPairs[n * 2];
+    } else {
+        *--p = (char)('0' + n);
+    }
+    if (value < 0)
+        *--p = '-';
+    return p;
+}
+
+/* String con esos caracteres: en línea si caben, si no una copia */
+static LynStr makeStr(const char *chars, size_t length) {
+#if LYN_STR_INLINE_MAX > 0
+    if (length <= LYN_STR_INLINE_MAX) {
+        LynStr s = 0;
+        memcpy(&s, chars, length);
+        return s | LYN_STR_INLINE_TAG | ((LynStr)length << LYN_STR_LENGTH_SHIFT);
+    }
+#endif
+    char *copy = (char *)strAlloc(length + 1);
+    memcpy(copy, chars, length);
+    copy[length] = '\0';
+    return (LynStr)copy;
+}
+
+/* Caracteres del string; los cortos se copian a 'buf'. Una variable sin
+   asignar (0) es el string vacío. */
+static const char *strChars(LynStr s, char buf[sizeof(LynStr)], size_t *length) {
+#if LYN_STR_INLINE_MAX > 0
+    if (s & LYN_STR_INLINE_TAG) {
+        *length = (size_t)(s >> LYN_STR_LENGTH_SHIFT) & 0x7F;
+        memcpy(buf, &s, sizeof(s));
+        return buf;
+    }
+#else
+    (void)buf;
+#endif
+    const char *chars = s ? (const char *)s : "";
+    *length = strlen(chars);
+    return chars;
+}
+
+static void builderReserve(LynStrBuilder *sb, size_t extra) {
+    if (sb->capacity - sb->length >= extra)
+        return;
+    size_t capacity = sb->capacity ? sb->capacity : 32;
+    while (capacity - sb->length < extra)
+        capacity *= 2;
+    char *data = (char *)realloc(sb->data, capacity);
+    if (!data) {
+        fprintf(stderr, "Runtime error: Out of memory allocating a string of %zu bytes.\n", capacity);
+        exit(1);
+    }
+    sb->data = data;
+    sb->capacity = capacity;
+}
+
+static void builderRelease(LynStrBuilder *sb) {
+    if (freeBuilderCount < LYN_BUILDER_CACHE && sb->capacity <= LYN_BUILDER_KEEP) {
+        sb->next = freeBuilders;
+        freeBuilders = sb;
+        freeBuilderCount++;
+        return;
+    }
+    free(sb->data);
+    free(sb);
+}
+
+LynStr lyn_str_from_int(long value) {
+    char buf[LYN_INT_CHARS];
+    char *end = buf + sizeof(buf);
+    char *start = formatInt(value, end);
+    return makeStr(start, (size_t)(end - start));
+}
+
+size_t lyn_str_length(LynStr s) {
+    char buf[sizeof(LynStr)];
+    size_t length;
+    strChars(s, buf, &length);
+    return length;
+}
+
+void lyn_str_print(LynStr s) {
+    char buf[sizeof(LynStr)];
+    size_t length;
+    const char *chars = strChars(s, buf, &length);
+    fwrite(chars, 1, length, stdout);
+    putchar('\n');
+}
+
+LynStrBuilder *lyn_sb_new(long capacity) {
+    LynStrBuilder *sb = freeBuilders;
+    if (sb) {
+        freeBuilders = sb->next;
+        freeBuilderCount--;
+    } else {
+        sb = (LynStrBuilder *)strAlloc(sizeof(LynStrBuilder));
+        sb->data = NULL;
+        sb->capacity = 0;
+    }
+    sb->length = 0;
+    sb->next = NULL;
+    if (capacity > 0)
+        builderReserve(sb, (size_t)capacity);
+    return sb;
+}
+
+LynStrBuilder *lyn_sb_append_str(LynStrBuilder *sb, LynStr s) {
+    char buf[sizeof(LynStr)];
+    size_t length;
+    const char *chars = strChars(s, buf, &length);
+    builderReserve(sb, length);
+    memcpy(sb->data + sb->length, chars, length);
+    sb->length += length;
+    return sb;
+}
+
+LynStrBuilder *lyn_sb_append_int(LynStrBuilder *sb, long value) {
+    builderReserve(sb, LYN_INT_CHARS);
+    char buf[LYN_INT_CHARS];
+    char *end = buf + sizeof(buf);
+    char *start = formatInt(value, end);
+    size_t length = (size_t)(end - start);
+    memcpy(sb->data + sb->length, start, length);
+    sb->length += length;
+    return sb;
+}
+
+LynStr lyn_sb_finish(LynStrBuilder *sb) {
+    LynStr s = makeStr(sb->data ? sb->data : "", sb->length);
+    builderRelease(sb);
+    return s;
+}
+
+void lyn_sb_print(LynStrBuilder *sb) {
+    if (sb->length)
+        fwrite(sb->data, 1, sb->length, stdout);
+    putchar('\n');
+    builderRelease(sb);
+}
+
+int lyn_runtime_threads(void) {
+    ensurePool();
+    return workerCount + 1;
+}
+
+void lyn_runtime_get_stats(LynRuntimeStats *out) {
+    memset(out, 0, sizeof(LynRuntimeStats));
+    out->loops = atomic_load(&loopCount);
+    out->sequential = atomic_load(&sequentialCount);
+    pthread_mutex_lock(&poolMutex);
+    out->chunks = retiredChunks;
+    out->steals = retiredSteals;
+    out->spawned = retiredSpawned;
+    if (atomic_load(&poolReady)) {
+        for (int i = 0; i <= workerCount; i++) {
+            out->chunks += atomic_load_explicit(&workers[i]->chunks, memory_order_relaxed);
+            out->steals += atomic_load_explicit(&workers[i]->steals, memory_order_relaxed);
+            out->spawned += atomic_load_explicit(&workers[i]->spawned, memory_order_relaxed);
+        }
+    }
+    pthread_mutex_unlock(&poolMutex);
+}
+
+void lyn_runtime_shutdown(void) {
+    pthread_mutex_lock(&poolMutex);
+    if (!atomic_load(&poolReady)) {
+        pthread_mutex_unlock(&poolMutex);
+        return;
+    }
+    pthread_mutex_lock(&sleepMutex);
+    atomic_store(&stopping, 1);
+    pthread_cond_broadcast(&sleepCond);
+    pthread_mutex_unlock(&sleepMutex);
+    for (int i = 0; i < workerCount; i++)
+        pthread_join(workers[i]->thread, NULL);
+    for (int i = 0; i <= workerCount; i++) {
+        retiredChunks += atomic_load(&workers[i]->chunks);
+        retiredSteals += atomic_load(&workers[i]->steals);
+        retiredSpawned += atomic_load(&workers[i]->spawned);
+        pthread_mutex_destroy(&workers[i]->lock);
+        free(workers[i]);
+        workers[i] = NULL;
+    }
+    workerCount = 0;
+    atomic_store_explicit(&poolReady, 0, memory_order_release);
+    pthread_mutex_unlock(&poolMutex);
+}
@@ -0,0 +1,270 @@
+#ifndef RUNTIME_H
+#define RUNTIME_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* ============================
+   Runtime de Lyn
+   Funciones a las que llama el código generado. Se enlaza con los
+   programas compilados (liblynrt.a, ver 'make runtime').
+   ============================ */
+
+/* Operadores de reducción (mismos valores que ReduceOp en ast.h) */
+#define LYN_REDUCE_NONE 0
+#define LYN_REDUCE_ADD  1
+#define LYN_REDUCE_MUL  2
+#define LYN_REDUCE_MIN  3
+#define LYN_REDUCE_MAX  4
+
+/* Hilos de trabajo como máximo (sin contar el que lanza el bucle) */
+#ifndef LYN_MAX_WORKERS
+#define LYN_MAX_WORKERS 64
+#endif
+
+/* Tareas pendientes por hilo; si se llena, el trozo se ejecuta sin dividir
+   y la tarea lanzada se ejecuta en el acto */
+#ifndef LYN_DEQUE_SIZE
+#define LYN_DEQUE_SIZE 1024
+#endif
+
+/* Tareas anidadas que un hilo ejecuta al ayudar mientras espera un futuro;
+   cada nivel ocupa un marco de su pila de C */
+#ifndef LYN_AWAIT_HELP_DEPTH
+#define LYN_AWAIT_HELP_DEPTH 64
+#endif
+
+/* Duración objetivo de un trozo: la granularidad se ajusta a ella */
+#ifndef LYN_TARGET_CHUNK_NS
+#define LYN_TARGET_CHUNK_NS 50000
+#endif
+
+/**
+ * @brief Función de un trozo de bucle paralelo.
+ *
+ * Ejecuta las iteraciones [start, end) y retorna la reducción parcial de
+ * esas iteraciones partiendo del elemento neutro del operador (0 si no hay
+ * reducción).
+ */
+typedef long (*LynChunkFunc)(long start, long end);
+
+/**
+ * @brief Ejecuta un 'parallel for' sobre [start, end).
+ *
+ * El rango se reparte en un pool de hilos con robo de trabajo: cada hilo
+ * divide su rango por la mitad mientras sea mayor que la granularidad,
+ * deja la mitad alta en su cola y los hilos ociosos roban de las colas
+ * ajenas. La granularidad de cada bucle (identificado por 'body') se
+ * ajusta con el tiempo medido por iteración en ejecuciones anteriores para
+ * que cada trozo dure unos LYN_TARGET_CHUNK_NS. El hilo que llama también
+ * ejecuta trozos mientras espera, así que los bucles anidados no bloquean.
+ *
+ * La variable de entorno LYN_THREADS fija el número total de hilos
+ * (1 = secuencial).
+ *
+ * @param start Primera iteración.
+ * @param end Iteración final (excluida).
+ * @param init Valor inicial de la variable de reducción.
+ * @param body Función de un trozo.
+ * @param op Operador LYN_REDUCE_*.
+ * @return long init combinado con las reducciones parciales de todos los
+ *         trozos (init si op es LYN_REDUCE_NONE).
+ */
+long lyn_parallel_for(long start, long end, long init, LynChunkFunc body, int op);
+
+/**
+ * @brief Función de una tarea lanzada con 'spawn'.
+ */
+typedef long (*LynTaskFunc)(long arg);
+
+/** Resultado pendiente de una tarea; se libera al esperarlo. */
+typedef struct LynFuture LynFuture;
+
+/**
+ * @brief Lanza func(arg) como tarea ligera.
+ *
+ * Las tareas se reparten entre los mismos hilos que los bucles paralelos
+ * (M tareas sobre N hilos): se apilan en la cola del hilo que las crea y
+ * los hilos ociosos las roban. No tienen pila propia; se ejecutan hasta
+ * terminar, y quien espera una tarea sin terminar ejecuta otras mientras
+ * tanto. Si la cola está llena, o el hilo ya ayuda con
+ * LYN_AWAIT_HELP_DEPTH tareas anidadas, la tarea se ejecuta en el acto.
+ *
+ * @param func Función de la tarea.
+ * @param arg Argumento de la función.
+ * @return LynFuture* Futuro que debe esperarse exactamente una vez.
+ */
+LynFuture *lyn_spawn(LynTaskFunc func, long arg);
+
+/**
+ * @brief Espera una tarea y retorna su resultado.
+ *
+ * Mientras la tarea no termina, el hilo ejecuta otras de las colas sobre su
+ * propia pila, hasta LYN_AWAIT_HELP_DEPTH niveles de anidamiento; pasado
+ * ese límite cede la CPU hasta que la tarea termine en otro hilo. Libera el
+ * futuro.
+ */
+long lyn_await(LynFuture *future);
+
+/**
+ * @brief Arreglo tipado: la longitud seguida de los elementos contiguos.
+ *
+ * Los elementos ocupan una palabra de la máquina, igual que las variables
+ * escalares; el código generado accede a data[i] directamente y solo llama
+ * al runtime para reservar el arreglo o para fallar un acceso fuera de rango.
+ */
+typedef struct {
+    long length;
+    long data[];
+} LynArray;
+
+/**
+ * @brief Reserva un arreglo de 'length' elementos a cero.
+ *
+ * Los arreglos viven hasta el final del programa. Una longitud negativa o
+ * demasiado grande termina el programa con un error.
+ */
+LynArray *lyn_array_new(long length);
+
+/**
+ * @brief Arreglo de una clase @soa: una columna contigua por campo.
+ *
+ * Comparte la cabecera con LynArray: 'length' es el número de elementos y
+ * columns[f] guarda el campo f de todos ellos, así que recorrer un campo
+ * lee memoria consecutiva sin cargar el resto del objeto. El código
+ * generado obtiene la columna como el elemento f y la indexa como
+ * cualquier arreglo.
+ */
+typedef struct {
+    long length;
+    LynArray *columns[];
+} LynSoa;
+
+/**
+ * @brief Reserva un arreglo @soa de 'length' elementos con 'fields'
+ *        columnas a cero.
+ *
+ * Vive hasta el final del programa, como los arreglos.
+ */
+LynSoa *lyn_soa_new(long length, long fields);
+
+/**
+ * @brief Informa de un acceso fuera de rango y termina el programa.
+ *
+ * El código generado la llama cuando un índice no cumple
+ * 0 <= index < length; no retorna.
+ */
+void lyn_bounds_fail(long index, long length);
+
+/**
+ * @brief Reserva un objeto de 'size' bytes a cero.
+ *
+ * Si 'vtable' no es NULL se guarda en la primera palabra, donde la buscan
+ * las llamadas virtuales. Los campos ocupan una palabra en desplazamientos
+ * fijos calculados por el compilador. Los objetos viven hasta el final del
+ * programa.
+ */
+void *lyn_object_new(long size, const void *vtable);
+
+/* Caracteres que caben en línea en un LynStr (0 si la plataforma no lo
+   admite: hace falta una palabra de 64 bits little-endian) */
+#if UINTPTR_MAX > 0xFFFFFFFFu && defined(__BYTE_ORDER__) && \
+    __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+#define LYN_STR_INLINE_MAX 7
+#else
+#define LYN_STR_INLINE_MAX 0
+#endif
+
+/**
+ * @brief String de Lyn: una palabra, igual que el resto de valores.
+ *
+ * Si el bit alto está a 0 es un puntero a caracteres terminados en '\0'
+ * (un literal o un string del runtime). Si está a 1 es un string corto en
+ * línea: hasta LYN_STR_INLINE_MAX caracteres en los bytes bajos y la
+ * longitud en el byte alto, sin memoria asignada. Los strings son
+ * inmutables y viven hasta el final del programa.
+ */
+typedef uintptr_t LynStr;
+
+/** Constructor de strings para una cadena de concatenaciones. */
+typedef struct LynStrBuilder LynStrBuilder;
+
+/**
+ * @brief Convierte un entero a decimal.
+ *
+ * No usa snprintf: escribe las cifras de dos en dos desde una tabla. Los
+ * números de hasta LYN_STR_INLINE_MAX caracteres no asignan memoria.
+ */
+LynStr lyn_str_from_int(long value);
+
+/** @brief Número de caracteres del string. */
+size_t lyn_str_length(LynStr s);
+
+/** @brief Escribe el string y un salto de línea en stdout. */
+void lyn_str_print(LynStr s);
+
+/**
+ * @brief Obtiene un constructor vacío con espacio para 'capacity' caracteres.
+ *
+ * Cada hilo guarda los constructores terminados y reutiliza su memoria, así
+ * que una concatenación en un bucle no asigna más que el resultado.
+ */
+LynStrBuilder *lyn_sb_new(long capacity);
+
+/** @brief Añade un string; retorna el mismo constructor. */
+LynStrBuilder *lyn_sb_append_str(LynStrBuilder *sb, LynStr s);
+
+/** @brief Añade un entero en decimal; retorna el mismo constructor. */
+LynStrBuilder *lyn_sb_append_int(LynStrBuilder *sb, long value);
+
+/**
+ * @brief Retorna el string construido y devuelve el constructor al hilo.
+ *
+ * El resultado se copia una sola vez, o queda en línea si es corto.
+ */
+LynStr lyn_sb_finish(LynStrBuilder *sb);
+
+/**
+ * @brief Imprime el contenido con un salto de línea y devuelve el
+ *        constructor al hilo, sin crear el string.
+ */
+void lyn_sb_print(LynStrBuilder *sb);
+
+/**
+ * @brief Hilos que ejecutan bucles paralelos, incluido el que los lanza.
+ */
+int lyn_runtime_threads(void);
+
+/**
+ * @brief Contadores del planificador.
+ */
+typedef struct {
+    size_t loops;        /* Llamadas a lyn_parallel_for */
+    size_t sequential;   /* Bucles ejecutados sin repartir (rango corto o un hilo) */
+    size_t chunks;       /* Trozos ejecutados */
+    size_t steals;       /* Tareas robadas de la cola de otro hilo */
+    size_t spawned;      /* Tareas lanzadas con lyn_spawn */
+} LynRuntimeStats;
+
+/**
+ * @brief Suma los contadores de todos los hilos.
+ */
+void lyn_runtime_get_stats(LynRuntimeStats *out);
+
+/**
+ * @brief Detiene y espera a los hilos del pool.
+ *
+ * No debe llamarse con un bucle paralelo o una tarea en curso. Un bucle posterior
+ * vuelve a crear el pool.
+ */
+void lyn_runtime_shutdown(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* RUNTIME_H */
@@ -1,5 +1,6 @@
 #include "semantic.h"
 #include "ast.h"
+#include "memory.h"
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
@@ -13,7 +14,11 @@
 typedef struct Symbol {
     char name[256];
     DataType type;
-    char customType[256]; // Solo se usa si type == TYPE_CLASS
+    char customType[256]; // Clase si type es TYPE_CLASS o TYPE_ARRAY_CLASS
+    int local;            // Declarado fuera del ámbito global
+    int lambdaLevel;      // Lambdas que rodean la declaración
+    int parallelLevel;    // Bucles 'parallel for' que rodean la declaración
+    AstNode *lambda;      // Lambda que la variable contiene siempre (NULL si no se sabe)
     struct Symbol *next;
 } Symbol;
 
@@ -24,6 +29,20 @@ typedef struct SymbolTable {
 } SymbolTable;
 
 static SymbolTable *currentTable = NULL;
+static SymbolTable *globalTable = NULL;
+
+/* Profundidad de bucles 'parallel for' en curso y el más interno */
+static int parallelDepth = 0;
+static AstNode *parallelLoop = NULL;
+
+/* Funciones o métodos cuyo cuerpo se está analizando */
+static int functionDepth = 0;
+
+/* Lambdas cuyo cuerpo se está analizando, de fuera hacia dentro */
+#define MAX_LAMBDA_DEPTH 32
+static AstNode *lambdaStack[MAX_LAMBDA_DEPTH];
+static int lambdaDepth = 0;
+static int lambdaCount = 0;
 
 /**
  * @brief Crea una nueva tabla de símbolos y la empuja en la pila.
@@ -106,12 +125,16 @@ static void addSymbol(const char *name, DataType type, const char *customType) {
     strncpy(sym->name, name, sizeof(sym->name)-1);
     sym->name[sizeof(sym->name)-1] = '\0';
     sym->type = type;
-    if (type == TYPE_CLASS && customType) {
+    if ((type == TYPE_CLASS || type == TYPE_ARRAY_CLASS) && customType) {
         strncpy(sym->customType, customType, sizeof(sym->customType)-1);
         sym->customType[sizeof(sym->customType)-1] = '\0';
     } else {
         sym->customType[0] = '\0';
     }
+    sym->local = currentTable != globalTable;
+    sym->lambdaLevel = lambdaDepth;
+    sym->parallelLevel = parallelDepth;
+    sym->lambda = NULL;
     sym->next = currentTable->symbols;
     currentTable->symbols = sym;
 }
@@ -130,7 +153,7 @@ static void updateSymbol(const char *name, DataType type, const char *customType
         exit(1);
     }
     sym->type = type;
-    if (type == TYPE_CLASS && customType) {
+    if ((type == TYPE_CLASS || type == TYPE_ARRAY_CLASS) && customType) {
         strncpy(sym->customType, customType, sizeof(sym->customType)-1);
         sym->customType[sizeof(sym->customType)-1] = '\0';
     }
@@ -158,6 +181,27 @@ static DataType mapTypeString(const char *typeStr, char *customTypeOut, size_t c
         return TYPE_FLOAT;
     else if (strcmp(typeStr, "string") == 0)
         return TYPE_STRING;
+    else if (strcmp(typeStr, "future") == 0)
+        return TYPE_FUTURE;
+    else if (strcmp(typeStr, "fn") == 0)
+        return TYPE_FUNCTION;
+    else if (strcmp(typeStr, "[int]") == 0)
+        return TYPE_ARRAY_INT;
+    else if (strcmp(typeStr, "[float]") == 0)
+        return TYPE_ARRAY_FLOAT;
+    else if (typeStr[0] == '[') {
+        // [Clase]: el nombre de la clase sin los corchetes
+        if (customTypeOut && customTypeSize > 0) {
+            size_t len = strcspn(typeStr + 1, "]");
+            if (len >= customTypeSize)
+                len = customTypeSize - 1;
+            memcpy(customTypeOut, typeStr + 1, len);
+            customTypeOut[len] = '\0';
+        }
+        return TYPE_ARRAY_CLASS;
+    }
+    else if (vecTypeFromName(typeStr) != VEC_NONE)
+        return TYPE_VEC4I + (vecTypeFromName(typeStr) - VEC_4I);
     else {
         if (customTypeOut && customTypeSize > 0) {
             strncpy(customTypeOut, typeStr, customTypeSize-1);
@@ -167,10 +211,568 @@ static DataType mapTypeString(const char *typeStr, char *customTypeOut, size_t c
     }
 }
 
+/* -------------------------------------------------------------------------- */
+/*                                  Clases                                    */
+/* -------------------------------------------------------------------------- */
+
+/* Bytes de cada campo y del puntero a la vtable */
+#define WORD_SIZE 8
+
+static ClassInfo *classList = NULL;
+static ClassInfo *currentClass = NULL;  /* Clase cuyos miembros se analizan */
+static int inConstructor = 0;           /* Dentro del cuerpo de un __init__ */
+
+static void *classAlloc(size_t size) {
+    void *p = calloc(1, size);
+    if (!p) {
+        fprintf(stderr, "Memory error while building class layouts.\n");
+        exit(1);
+    }
+    return p;
+}
+
+static ClassInfo *findClass(const char *name) {
+    for (ClassInfo *cls = classList; cls; cls = cls->next) {
+        if (strcmp(cls->name, name) == 0)
+            return cls;
+    }
+    return NULL;
+}
+
+const ClassInfo *semanticClasses(void) {
+    return classList;
+}
+
+const ClassInfo *semanticFindClass(const char *name) {
+    return findClass(name);
+}
+
+static void freeClasses(void) {
+    while (classList) {
+        ClassInfo *next = classList->next;
+        free(classList->fields);
+        free(classList->methods);
+        free(classList);
+        classList = next;
+    }
+}
+
+static ClassMethod *findMethod(const ClassInfo *cls, const char *name) {
+    for (int i = 0; i < cls->methodCount; i++) {
+        if (strcmp(cls->methods[i].name, name) == 0)
+            return &cls->methods[i];
+    }
+    return NULL;
+}
+
+static const ClassField *findField(const ClassInfo *cls, const char *name) {
+    for (int i = 0; i < cls->fieldCount; i++) {
+        if (strcmp(cls->fields[i].name, name) == 0)
+            return &cls->fields[i];
+    }
+    return NULL;
+}
+
+static int isSubclassOf(const ClassInfo *cls, const ClassInfo *base) {
+    for (; cls; cls = cls->parent) {
+        if (cls == base)
+            return 1;
+    }
+    return 0;
+}
+
+static int classDepth(const ClassInfo *cls) {
+    int depth = 0;
+    while (cls->parent) {
+        cls = cls->parent;
+        depth++;
+    }
+    return depth;
+}
+
+/* Clase con su definición mientras se construye la tabla */
+typedef struct {
+    ClassInfo *info;
+    AstNode *def;
+    char (*virtuals)[256];  /* Métodos redefinidos en la jerarquía (solo la raíz) */
+    int virtualCount;
+} ClassEntry;
+
+static int compareByDepth(const void *a, const void *b) {
+    return classDepth(((const ClassEntry *)a)->info) - classDepth(((const ClassEntry *)b)->info);
+}
+
+static ClassEntry *findEntry(ClassEntry *entries, int count, const ClassInfo *info) {
+    for (int i = 0; i < count; i++) {
+        if (entries[i].info == info)
+            return &entries[i];
+    }
+    return NULL;
+}
+
+/* Métodos: los heredados con la implementación de la base, sustituida por
+   la propia si la clase los redefine */
+static void buildMethods(ClassEntry *entry) {
+    ClassInfo *cls = entry->info;
+    AstNode *def = entry->def;
+    int capacity = (cls->parent ? cls->parent->methodCount : 0) + def->classDef.memberCount;
+    cls->methods = (ClassMethod *)classAlloc((capacity > 0 ? capacity : 1) * sizeof(ClassMethod));
+    if (cls->parent) {
+        memcpy(cls->methods, cls->parent->methods, cls->parent->methodCount * sizeof(ClassMethod));
+        cls->methodCount = cls->parent->methodCount;
+    }
+    for (int i = 0; i < def->classDef.memberCount; i++) {
+        AstNode *m = def->classDef.members[i];
+        if (!m || m->type != AST_FUNC_DEF)
+            continue;
+        if (m->funcDef.paramCount == 0) {
+            fprintf(stderr, "Semantic error: Method '%s.%s' needs a 'self' parameter.\n",
+                    cls->name, m->funcDef.name);
+            exit(1);
+        }
+        ClassMethod *method = findMethod(cls, m->funcDef.name);
+        if (method && strcmp(method->owner, cls->name) == 0) {
+            fprintf(stderr, "Semantic error: Method '%s.%s' defined twice.\n",
+                    cls->name, m->funcDef.name);
+            exit(1);
+        }
+        if (!method)
+            method = &cls->methods[cls->methodCount++];
+        snprintf(method->name, sizeof(method->name), "%s", m->funcDef.name);
+        snprintf(method->owner, sizeof(method->owner), "%s", cls->name);
+        if (snprintf(method->symbol, sizeof(method->symbol), "%s__%s",
+                     cls->name, m->funcDef.name) >= (int)sizeof(method->symbol)) {
+            fprintf(stderr, "Semantic error: Method name '%s.%s' is too long.\n",
+                    cls->name, m->funcDef.name);
+            exit(1);
+        }
+        method->slot = -1;
+        method->def = m;
+    }
+}
+
+/* Un método propio que también existe en la base la redefine: se añade a
+   los huecos de la vtable de la raíz de la jerarquía. __init__ nunca se
+   despacha en tiempo de ejecución. */
+static void collectOverrides(ClassEntry *entries, int count, ClassEntry *entry) {
+    ClassInfo *cls = entry->info;
+    if (!cls->parent)
+        return;
+    ClassInfo *root = cls;
+    while (root->parent)
+        root = root->parent;
+    ClassEntry *rootEntry = findEntry(entries, count, root);
+    for (int i = 0; i < cls->methodCount; i++) {
+        ClassMethod *method = &cls->methods[i];
+        if (strcmp(method->owner, cls->name) != 0 || strcmp(method->name, "__init__") == 0 ||
+            !findMethod(cls->parent, method->name))
+            continue;
+        int known = 0;
+        for (int j = 0; j < rootEntry->virtualCount && !known; j++)
+            known = strcmp(rootEntry->virtuals[j], method->name) == 0;
+        if (known)
+            continue;
+        rootEntry->virtuals = realloc(rootEntry->virtuals,
+                                      (rootEntry->virtualCount + 1) * sizeof(*rootEntry->virtuals));
+        if (!rootEntry->virtuals) {
+            fprintf(stderr, "Memory error while building class layouts.\n");
+            exit(1);
+        }
+        snprintf(rootEntry->virtuals[rootEntry->virtualCount++], sizeof(rootEntry->virtuals[0]),
+                 "%s", method->name);
+    }
+}
+
+/* Campos: los heredados en la misma posición y los propios a continuación,
+   una palabra cada uno. El puntero a la vtable, si la jerarquía la
+   necesita, ocupa la primera palabra. */
+static void layoutFields(ClassEntry *entries, int count, ClassEntry *entry) {
+    ClassInfo *cls = entry->info;
+    AstNode *def = entry->def;
+    ClassInfo *root = cls;
+    while (root->parent)
+        root = root->parent;
+    ClassEntry *rootEntry = findEntry(entries, count, root);
+    cls->hasVtable = rootEntry->virtualCount > 0;
+    cls->vtableSize = rootEntry->virtualCount;
+    for (int i = 0; i < cls->methodCount; i++) {
+        for (int j = 0; j < rootEntry->virtualCount; j++) {
+            if (strcmp(cls->methods[i].name, rootEntry->virtuals[j]) == 0)
+                cls->methods[i].slot = j;
+        }
+    }
+
+    int capacity = (cls->parent ? cls->parent->fieldCount : 0) + def->classDef.memberCount;
+    cls->fields = (ClassField *)classAlloc((capacity > 0 ? capacity : 1) * sizeof(ClassField));
+    int offset = cls->hasVtable ? WORD_SIZE : 0;
+    if (cls->parent) {
+        memcpy(cls->fields, cls->parent->fields, cls->parent->fieldCount * sizeof(ClassField));
+        cls->fieldCount = cls->parent->fieldCount;
+        if (cls->fieldCount > 0)
+            offset = cls->fields[cls->fieldCount - 1].offset + WORD_SIZE;
+    }
+    for (int i = 0; i < def->classDef.memberCount; i++) {
+        AstNode *m = def->classDef.members[i];
+        if (!m || m->type != AST_VAR_DECL)
+            continue;
+        if (vecTypeFromName(m->varDecl.type) != VEC_NONE) {
+            fprintf(stderr, "Semantic error: Field '%s.%s' cannot be a vector.\n",
+                    cls->name, m->varDecl.name);
+            exit(1);
+        }
+        if (findField(cls, m->varDecl.name)) {
+            fprintf(stderr, "Semantic error: Field '%s.%s' is already defined.\n",
+                    cls->name, m->varDecl.name);
+            exit(1);
+        }
+        ClassField *field = &cls->fields[cls->fieldCount++];
+        snprintf(field->name, sizeof(field->name), "%s", m->varDecl.name);
+        snprintf(field->type, sizeof(field->type), "%s", m->varDecl.type);
+        field->offset = offset;
+        field->initializer = m->varDecl.initializer;
+        offset += WORD_SIZE;
+    }
+    cls->size = offset > 0 ? offset : WORD_SIZE;
+}
+
+/**
+ * @brief Construye la tabla de clases del programa.
+ *
+ * Se hace antes de analizar las sentencias porque el análisis de la
+ * jerarquía necesita conocer todas las subclases de cada clase.
+ */
+static void buildClasses(AstNode *program) {
+    int count = 0;
+    for (int i = 0; i < program->program.statementCount; i++)
+        count += program->program.statements[i]->type == AST_CLASS_DEF;
+    if (count == 0)
+        return;
+
+    ClassEntry *entries = (ClassEntry *)classAlloc(count * sizeof(ClassEntry));
+    ClassInfo **tail = &classList;
+    int n = 0;
+    for (int i = 0; i < program->program.statementCount; i++) {
+        AstNode *st = program->program.statements[i];
+        if (st->type != AST_CLASS_DEF)
+            continue;
+        if (findClass(st->classDef.name)) {
+            fprintf(stderr, "Semantic error: Class '%s' defined twice.\n", st->classDef.name);
+            exit(1);
+        }
+        ClassInfo *cls = (ClassInfo *)classAlloc(sizeof(ClassInfo));
+        snprintf(cls->name, sizeof(cls->name), "%s", st->classDef.name);
+        cls->soa = st->classDef.soa;
+        *tail = cls;
+        tail = &cls->next;
+        entries[n].info = cls;
+        entries[n].def = st;
+        n++;
+    }
+    for (int i = 0; i < count; i++) {
+        const char *parent = entries[i].def->classDef.parent;
+        if (!parent[0])
+            continue;
+        entries[i].info->parent = findClass(parent);
+        if (!entries[i].info->parent) {
+            fprintf(stderr, "Semantic error: Base class '%s' of '%s' is not defined.\n",
+                    parent, entries[i].info->name);
+            exit(1);
+        }
+    }
+    for (int i = 0; i < count; i++) {
+        const ClassInfo *cls = entries[i].info->parent;
+        for (int steps = 0; cls; cls = cls->parent, steps++) {
+            if (cls == entries[i].info || steps > count) {
+                fprintf(stderr, "Semantic error: Class '%s' inherits from itself.\n",
+                        entries[i].info->name);
+                exit(1);
+            }
+        }
+    }
+
+    /* Las bases antes que las derivadas */
+    qsort(entries, count, sizeof(ClassEntry), compareByDepth);
+    for (int i = 0; i < count; i++)
+        buildMethods(&entries[i]);
+    for (int i = 0; i < count; i++)
+        collectOverrides(entries, count, &entries[i]);
+    for (int i = 0; i < count; i++)
+        layoutFields(entries, count, &entries[i]);
+
+    for (int i = 0; i < count; i++)
+        free(entries[i].virtuals);
+    free(entries);
+}
+
+/* Si ninguna subclase de 'cls' (ni ella misma) usa otra implementación de
+   'method', la llamada tiene un único destino posible */
+static int isMonomorphic(const ClassInfo *cls, const ClassMethod *method) {
+    for (const ClassInfo *c = classList; c; c = c->next) {
+        if (!isSubclassOf(c, cls))
+            continue;
+        const ClassMethod *impl = findMethod(c, method->name);
+        if (impl && strcmp(impl->symbol, method->symbol) != 0)
+            return 0;
+    }
+    return 1;
+}
+
+/* Clase estática de una expresión (NULL si no es un objeto de una clase
+   del programa) */
+/* Clase de los elementos si 'array' es una variable [Clase] */
+static ClassInfo *elementClass(AstNode *array) {
+    if (!array || array->type != AST_IDENTIFIER)
+        return NULL;
+    Symbol *sym = lookupSymbol(array->identifier.name);
+    return sym && sym->type == TYPE_ARRAY_CLASS ? findClass(sym->customType) : NULL;
+}
+
+static AstNode *programRoot = NULL;
+
+/* FUNC_DEF de nivel superior llamada 'name' (NULL si no hay) */
+static AstNode *findFunctionDef(const char *name) {
+    if (!programRoot || programRoot->type != AST_PROGRAM)
+        return NULL;
+    for (int i = 0; i < programRoot->program.statementCount; i++) {
+        AstNode *st = programRoot->program.statements[i];
+        if (st && st->type == AST_FUNC_DEF && strcmp(st->funcDef.name, name) == 0)
+            return st;
+    }
+    return NULL;
+}
+
+/* Tipo de retorno declarado de la función, el método o la lambda llamada */
+static const char *calleeReturnType(AstNode *call) {
+    AstNode *callee = call->funcCall.callee;
+    if (!callee && call->funcCall.kind == CALL_FUNCTION)
+        callee = findFunctionDef(call->funcCall.name);
+    if (!callee)
+        return "";
+    return callee->type == AST_LAMBDA ? callee->lambda.returnType : callee->funcDef.returnType;
+}
+
+static ClassInfo *classOf(AstNode *node) {
+    if (!node)
+        return NULL;
+    switch (node->type) {
+        case AST_INDEX: {
+            // Los elementos de un arreglo @soa no son objetos
+            ClassInfo *cls = elementClass(node->indexExpr.array);
+            return cls && !cls->soa ? cls : NULL;
+        }
+        case AST_IDENTIFIER: {
+            Symbol *sym = lookupSymbol(node->identifier.name);
+            return sym && sym->type == TYPE_CLASS ? findClass(sym->customType) : NULL;
+        }
+        case AST_FUNC_CALL:
+            if (node->funcCall.kind == CALL_NEW)
+                return findClass(node->funcCall.name);
+            return findClass(calleeReturnType(node));
+        case AST_MEMBER_ACCESS: {
+            ClassInfo *cls = classOf(node->memberAccess.object);
+            const ClassField *field = cls ? findField(cls, node->memberAccess.member) : NULL;
+            return field ? findClass(field->type) : NULL;
+        }
+        default:
+            return NULL;
+    }
+}
+
+/* -------------------------------------------------------------------------- */
+/*                                 Lambdas                                    */
+/* -------------------------------------------------------------------------- */
+
+static void addCapture(AstNode *lambda, const char *name) {
+    for (int i = 0; i < lambda->lambda.captureCount; i++) {
+        if (strcmp(lambda->lambda.captures[i], name) == 0)
+            return;
+    }
+    int count = lambda->lambda.captureCount;
+    lambda->lambda.captures = memory_realloc(lambda->lambda.captures,
+                                             (size_t)(count + 1) * sizeof(*lambda->lambda.captures));
+    snprintf(lambda->lambda.captures[count], sizeof(lambda->lambda.captures[0]), "%s", name);
+    lambda->lambda.captureCount = count + 1;
+}
+
+static void checkParallelRead(const char *name);
+
+/**
+ * @brief Anota una lectura de 'name' como captura de las lambdas en curso.
+ *
+ * Una variable local declarada fuera de una lambda la captura esa lambda
+ * y todas las que haya entre ella y la lectura, que deben llevarla hasta
+ * la más interna. Las globales se leen directamente y no se capturan.
+ */
+static void recordUse(const char *name) {
+    checkParallelRead(name);
+    Symbol *sym = lookupSymbol(name);
+    if (!sym || !sym->local)
+        return;
+    for (int i = sym->lambdaLevel; i < lambdaDepth; i++)
+        addCapture(lambdaStack[i], name);
+}
+
+/* Veces que el programa escribe una variable llamada 'name', en cualquier
+   ámbito (parámetros e iteradores incluidos) */
+static int countWrites(AstNode *node, const char *name) {
+    if (!node)
+        return 0;
+    int count = 0;
+    switch (node->type) {
+        case AST_PROGRAM:
+            for (int i = 0; i < node->program.statementCount; i++)
+                count += countWrites(node->program.statements[i], name);
+            break;
+        case AST_VAR_ASSIGN:
+            count = strcmp(node->varAssign.name, name) == 0;
+            break;
+        case AST_VAR_DECL:
+            count = strcmp(node->varDecl.name, name) == 0;
+            break;
+        case AST_FUNC_DEF:
+            for (int i = 0; i < node->funcDef.paramCount; i++)
+                count += strcmp(node->funcDef.parameters[i]->identifier.name, name) == 0;
+            for (int i = 0; i < node->funcDef.bodyCount; i++)
+                count += countWrites(node->funcDef.body[i], name);
+            break;
+        case AST_CLASS_DEF:
+            for (int i = 0; i < node->classDef.memberCount; i++)
+                count += countWrites(node->classDef.members[i], name);
+            break;
+        case AST_IF_STMT:
+            for (int i = 0; i < node->ifStmt.thenCount; i++)
+                count += countWrites(node->ifStmt.thenBranch[i], name);
+            for (int i = 0; i < node->ifStmt.elseCount; i++)
+                count += countWrites(node->ifStmt.elseBranch[i], name);
+            break;
+        case AST_FOR_STMT:
+            count = strcmp(node->forStmt.iterator, name) == 0;
+            for (int i = 0; i < node->forStmt.bodyCount; i++)
+                count += countWrites(node->forStmt.body[i], name);
+            break;
+        default:
+            break;
+    }
+    return count;
+}
+
+/* Recuerda la lambda de una variable que solo se escribe al declararla:
+   sus llamadas pueden ir directas a la función de la lambda */
+static void bindLambda(const char *name, AstNode *value) {
+    Symbol *sym = lookupSymbol(name);
+    if (sym && value && value->type == AST_LAMBDA && countWrites(programRoot, name) == 1)
+        sym->lambda = value;
+}
+
+/**
+ * @brief Resuelve una llamada a través de una variable con una lambda.
+ *
+ * @return int 1 si 'name' es una variable de tipo fn.
+ */
+static int resolveLambdaCall(AstNode *node) {
+    Symbol *sym = lookupSymbol(node->funcCall.name);
+    if (!sym || sym->type != TYPE_FUNCTION)
+        return 0;
+    recordUse(node->funcCall.name);
+    AstNode *lambda = sym->lambda;
+    if (!lambda) {
+        node->funcCall.kind = CALL_CLOSURE;
+        return 1;
+    }
+    if (node->funcCall.argCount != lambda->lambda.paramCount) {
+        fprintf(stderr, "Semantic error: Lambda '%s' expects %d arguments.\n",
+                node->funcCall.name, lambda->lambda.paramCount);
+        exit(1);
+    }
+    node->funcCall.kind = CALL_LAMBDA;
+    node->funcCall.callee = lambda;
+    snprintf(node->funcCall.target, sizeof(node->funcCall.target), "__lyn_lambda_%d",
+             lambda->lambda.id);
+    return 1;
+}
+
+/**
+ * @brief Resuelve una llamada a un constructor o a un método.
+ *
+ * El parser convierte 'obj.m(args)' en m(obj, args). Si el primer
+ * argumento es un objeto de una clase con un método 'm', la llamada es a
+ * ese método: directa si ninguna subclase lo redefine y por la vtable si
+ * no. El resto de llamadas se quedan como llamadas a funciones.
+ */
+static void resolveCall(AstNode *node) {
+    const char *name = node->funcCall.name;
+    int argCount = node->funcCall.argCount;
+    if (resolveLambdaCall(node))
+        return;
+    ClassInfo *cls = findClass(name);
+    if (cls) {
+        ClassMethod *init = findMethod(cls, "__init__");
+        int expected = init ? init->def->funcDef.paramCount - 1 : 0;
+        if (argCount != expected) {
+            fprintf(stderr, "Semantic error: Constructor of '%s' expects %d arguments.\n",
+                    name, expected);
+            exit(1);
+        }
+        node->funcCall.kind = CALL_NEW;
+        snprintf(node->funcCall.target, sizeof(node->funcCall.target), "%s",
+                 init ? init->symbol : "");
+        return;
+    }
+    if (argCount == 0 || strcmp(name, "__init__") == 0)
+        return;
+    ClassInfo *receiver = classOf(node->funcCall.arguments[0]);
+    ClassMethod *method = receiver ? findMethod(receiver, name) : NULL;
+    if (!method)
+        return;
+    if (argCount != method->def->funcDef.paramCount) {
+        fprintf(stderr, "Semantic error: Method '%s.%s' expects %d arguments.\n",
+                receiver->name, name, method->def->funcDef.paramCount - 1);
+        exit(1);
+    }
+    node->funcCall.callee = method->def;
+    snprintf(node->funcCall.target, sizeof(node->funcCall.target), "%s", method->symbol);
+    if (isMonomorphic(receiver, method)) {
+        node->funcCall.kind = CALL_METHOD;
+    } else {
+        node->funcCall.kind = CALL_VIRTUAL;
+        node->funcCall.slot = method->slot;
+    }
+}
+
 /* -------------------------------------------------------------------------- */
 /*                     Inferencia y verificación de tipos                     */
 /* -------------------------------------------------------------------------- */
 
+/**
+ * @brief Indica si el operador binario es relacional.
+ *
+ * El parser codifica >=, <=, == y != como 'G', 'L', 'E' y 'N'.
+ */
+static int isRelationalOp(char op) {
+    return op == '>' || op == '<' || op == 'G' || op == 'L' || op == 'E' || op == 'N';
+}
+
+/* Tipo vectorial de un DataType (VEC_NONE si es escalar) */
+static VecType vecTypeOf(DataType type) {
+    if (type >= TYPE_VEC4I && type <= TYPE_VEC8F)
+        return VEC_4I + (type - TYPE_VEC4I);
+    return VEC_NONE;
+}
+
+static int isArrayType(DataType type) {
+    return type == TYPE_ARRAY_INT || type == TYPE_ARRAY_FLOAT || type == TYPE_ARRAY_CLASS;
+}
+
+static int isNumericType(DataType type) {
+    return type == TYPE_INT || type == TYPE_FLOAT || type == TYPE_UNKNOWN;
+}
+
+/* Reducciones horizontales de un vector */
+static int isVecReduction(const char *name) {
+    return strcmp(name, "hsum") == 0 || strcmp(name, "hmin") == 0 ||
+           strcmp(name, "hmax") == 0;
+}
+
 /**
  * @brief Infiera el tipo de un nodo AST.
  *
@@ -184,12 +786,11 @@ static DataType inferType(AstNode *node) {
 
     switch (node->type) {
 
-        case AST_NUMBER_LITERAL: {
-            double val = node->numberLiteral.value;
-            return ((int)val == val) ? TYPE_INT : TYPE_FLOAT;
-        }
+        case AST_NUMBER_LITERAL:
+            return node->numberLiteral.isFloat ? TYPE_FLOAT : TYPE_INT;
 
         case AST_STRING_LITERAL:
+        case AST_STRING_BUILD:
             return TYPE_STRING;
 
         case AST_IDENTIFIER: {
@@ -210,6 +811,16 @@ static DataType inferType(AstNode *node) {
             if (left == TYPE_UNKNOWN || right == TYPE_UNKNOWN)
                 return TYPE_UNKNOWN;
 
+            // Los arreglos no tienen operadores (el error lo da analyzeNode)
+            if (isArrayType(left) || isArrayType(right))
+                return TYPE_UNKNOWN;
+
+            // Un operando vectorial hace vectorial la operación (el escalar se replica)
+            if (vecTypeOf(left) != VEC_NONE)
+                return left;
+            if (vecTypeOf(right) != VEC_NONE)
+                return right;
+
             // Operador '+'
             if (node->binaryOp.op == '+') {
                 // Si alguno es string, el resultado es string (concatenación)
@@ -222,16 +833,22 @@ static DataType inferType(AstNode *node) {
                 return TYPE_INT;
             }
 
-            // Operadores '-', '*', '/'
+            // Operadores '-', '*', '/', '%'
             else if (node->binaryOp.op == '-' ||
                      node->binaryOp.op == '*' ||
-                     node->binaryOp.op == '/') {
+                     node->binaryOp.op == '/' ||
+                     node->binaryOp.op == '%') {
                 // Si alguno es float => float
                 if (left == TYPE_FLOAT || right == TYPE_FLOAT)
                     return TYPE_FLOAT;
                 return TYPE_INT;
             }
 
+            // Operadores relacionales (>, <, >=, <=, ==, !=): resultado booleano como int
+            else if (isRelationalOp(node->binaryOp.op)) {
+                return TYPE_INT;
+            }
+
             // Desconocido si no coincide
             return TYPE_UNKNOWN;
         }
@@ -241,6 +858,15 @@ static DataType inferType(AstNode *node) {
          * podrías reconocer aquí la función y forzar su tipo:
          */
         case AST_FUNC_CALL: {
+            // Constructores y métodos resueltos por resolveCall
+            if (node->funcCall.kind == CALL_NEW)
+                return TYPE_CLASS;
+            if (node->funcCall.kind == CALL_SOA_ARRAY)
+                return TYPE_ARRAY_CLASS;
+            if (calleeReturnType(node)[0])
+                return mapTypeString(calleeReturnType(node), NULL, 0);
+            if (node->funcCall.kind == CALL_LAMBDA || node->funcCall.kind == CALL_CLOSURE)
+                return TYPE_UNKNOWN;
             // Nombre de la función en node->funcCall.name
             if (strcmp(node->funcCall.name, "to_str") == 0) {
                 // to_str() => string
@@ -250,15 +876,400 @@ static DataType inferType(AstNode *node) {
                 // Elige lo que convenga (int o float)
                 return TYPE_INT; 
             }
+            else if (strcmp(node->funcCall.name, "len") == 0) {
+                return TYPE_INT;
+            }
+            else if (strcmp(node->funcCall.name, "array") == 0) {
+                // array(n): n enteros a cero
+                return TYPE_ARRAY_INT;
+            }
+            else if (vecTypeFromName(node->funcCall.name) != VEC_NONE) {
+                // Constructor de vector
+                return mapTypeString(node->funcCall.name, NULL, 0);
+            }
+            else if (strcmp(node->funcCall.name, "shuffle") == 0 &&
+                     node->funcCall.argCount > 0) {
+                return inferType(node->funcCall.arguments[0]);
+            }
+            else if (isVecReduction(node->funcCall.name) &&
+                     node->funcCall.argCount == 1) {
+                VecType vec = vecTypeOf(inferType(node->funcCall.arguments[0]));
+                return (vec != VEC_NONE && vecIsFloat(vec)) ? TYPE_FLOAT : TYPE_INT;
+            }
             // Si no es conocida, lo dejamos como desconocido
             return TYPE_UNKNOWN;
         }
 
+        case AST_SPAWN:
+            return TYPE_FUTURE;
+
+        case AST_LAMBDA:
+            return TYPE_FUNCTION;
+
+        case AST_MEMBER_ACCESS: {
+            if (node->memberAccess.column >= 0) {
+                // Columna de un arreglo @soa: un arreglo del tipo del campo
+                ClassInfo *cls = elementClass(node->memberAccess.object);
+                const ClassField *field = cls ? findField(cls, node->memberAccess.member) : NULL;
+                DataType type = field ? mapTypeString(field->type, NULL, 0) : TYPE_UNKNOWN;
+                return type == TYPE_INT ? TYPE_ARRAY_INT :
+                       type == TYPE_FLOAT ? TYPE_ARRAY_FLOAT : TYPE_UNKNOWN;
+            }
+            ClassInfo *cls = classOf(node->memberAccess.object);
+            const ClassField *field = cls ? findField(cls, node->memberAccess.member) : NULL;
+            return field ? mapTypeString(field->type, NULL, 0) : TYPE_UNKNOWN;
+        }
+
+        case AST_ARRAY_LITERAL:
+            // [float] si algún elemento es float
+            for (int i = 0; i < node->arrayLiteral.elementCount; i++) {
+                if (inferType(node->arrayLiteral.elements[i]) == TYPE_FLOAT)
+                    return TYPE_ARRAY_FLOAT;
+            }
+            return TYPE_ARRAY_INT;
+
+        case AST_INDEX: {
+            DataType array = inferType(node->indexExpr.array);
+            if (array == TYPE_ARRAY_FLOAT)
+                return TYPE_FLOAT;
+            if (array == TYPE_ARRAY_CLASS)
+                return TYPE_CLASS;
+            return array == TYPE_ARRAY_INT ? TYPE_INT : TYPE_UNKNOWN;
+        }
+
+        case AST_AWAIT:
+            // El runtime retorna el resultado de la tarea como entero
+            return TYPE_INT;
+
         default:
             return TYPE_UNKNOWN;
     }
 }
 
+/* -------------------------------------------------------------------------- */
+/*                          Bucles 'parallel for'                             */
+/* -------------------------------------------------------------------------- */
+
+/* Busca en el cuerpo una sentencia que lo saque del bucle o que asigne
+   'name'. Retorna la sentencia encontrada o NULL. */
+static AstNode *findParallelViolation(AstNode **body, int count, const char *name) {
+    for (int i = 0; i < count; i++) {
+        AstNode *st = body[i];
+        if (!st)
+            continue;
+        if (st->type == AST_RETURN_STMT)
+            return st;
+        if (st->type == AST_VAR_ASSIGN && strcmp(st->varAssign.name, name) == 0)
+            return st;
+        AstNode *found = NULL;
+        if (st->type == AST_IF_STMT) {
+            found = findParallelViolation(st->ifStmt.thenBranch, st->ifStmt.thenCount, name);
+            if (!found)
+                found = findParallelViolation(st->ifStmt.elseBranch, st->ifStmt.elseCount, name);
+        } else if (st->type == AST_FOR_STMT) {
+            found = findParallelViolation(st->forStmt.body, st->forStmt.bodyCount, name);
+        }
+        if (found)
+            return found;
+    }
+    return NULL;
+}
+
+/**
+ * @brief Comprueba un 'parallel for'.
+ *
+ * El cuerpo se ejecuta como una función en varios hilos: no puede contener
+ * 'return' ni reasignar el iterador, y la variable de reducción debe ser un
+ * entero ya declarado.
+ */
+static void checkParallelFor(AstNode *node) {
+    AstNode *bad = findParallelViolation(node->forStmt.body, node->forStmt.bodyCount,
+                                         node->forStmt.iterator);
+    if (bad && bad->type == AST_RETURN_STMT) {
+        fprintf(stderr, "Semantic error: 'return' inside parallel loop over '%s'.\n",
+                node->forStmt.iterator);
+        exit(1);
+    }
+    if (bad) {
+        fprintf(stderr, "Semantic error: Iterator '%s' of a parallel loop cannot be assigned.\n",
+                node->forStmt.iterator);
+        exit(1);
+    }
+    if (node->forStmt.reduceOp == REDUCE_NONE)
+        return;
+    Symbol *sym = lookupSymbol(node->forStmt.reduceVar);
+    if (!sym) {
+        fprintf(stderr, "Semantic error: Reduction variable '%s' not declared.\n",
+                node->forStmt.reduceVar);
+        exit(1);
+    }
+    if (sym->type != TYPE_INT) {
+        fprintf(stderr, "Semantic error: Reduction variable '%s' must be int.\n",
+                node->forStmt.reduceVar);
+        exit(1);
+    }
+}
+
+/**
+ * @brief Comprueba una lectura de 'name' dentro de un 'parallel for'.
+ *
+ * Las variables de una función son locales de cada hilo, así que el cuerpo,
+ * que corre en los hilos del runtime, solo ve a cero las que se declaran
+ * fuera del bucle. Valen las privadas del bucle más interno: el iterador,
+ * la variable de reducción y las que el cuerpo escribe.
+ */
+static void checkParallelRead(const char *name) {
+    if (parallelDepth == 0 || functionDepth == 0)
+        return;
+    Symbol *sym = lookupSymbol(name);
+    if (!sym || !sym->local || sym->parallelLevel == parallelDepth)
+        return;
+    if (strcmp(name, parallelLoop->forStmt.reduceVar) == 0)
+        return;
+    for (int i = 0; i < parallelLoop->forStmt.bodyCount; i++) {
+        if (countWrites(parallelLoop->forStmt.body[i], name) > 0)
+            return;
+    }
+    fprintf(stderr,
+            "Semantic error: Parallel loop over '%s' cannot read '%s' from the enclosing function.\n",
+            parallelLoop->forStmt.iterator, name);
+    exit(1);
+}
+
+/* -------------------------------------------------------------------------- */
+/*                           Tipos vectoriales                                */
+/* -------------------------------------------------------------------------- */
+
+/**
+ * @brief Comprueba una operación binaria con algún operando vectorial.
+ *
+ * Solo se admiten + - * /, elemento a elemento. Los dos vectores deben ser
+ * del mismo tipo; un operando escalar se replica en todos los carriles. La
+ * división solo existe para vectores float.
+ */
+static void checkVectorBinary(AstNode *node, DataType leftType, DataType rightType) {
+    char op = node->binaryOp.op;
+    VecType left = vecTypeOf(leftType);
+    VecType right = vecTypeOf(rightType);
+    VecType vec = left != VEC_NONE ? left : right;
+    if (op != '+' && op != '-' && op != '*' && op != '/') {
+        fprintf(stderr, "Semantic error: Operator '%c' is not defined for vectors.\n", op);
+        exit(1);
+    }
+    if (left != VEC_NONE && right != VEC_NONE && left != right) {
+        fprintf(stderr, "Semantic error: Vector operands of '%c' have different types.\n", op);
+        exit(1);
+    }
+    DataType scalar = left == VEC_NONE ? leftType : rightType;
+    if ((left == VEC_NONE || right == VEC_NONE) &&
+        scalar != TYPE_INT && scalar != TYPE_FLOAT && scalar != TYPE_UNKNOWN) {
+        fprintf(stderr, "Semantic error: Vector operation '%c' needs a number or a vector.\n", op);
+        exit(1);
+    }
+    if (op == '/' && !vecIsFloat(vec)) {
+        fprintf(stderr, "Semantic error: Integer vectors do not support '/'.\n");
+        exit(1);
+    }
+}
+
+/**
+ * @brief Comprueba las funciones vectoriales predefinidas.
+ *
+ * - vecNx(a, b, ...): un argumento por carril o uno solo que se replica.
+ * - shuffle(v, i0, i1, ...): un índice literal por carril, dentro de rango.
+ * - hsum/hmin/hmax(v): reducción horizontal de un vector.
+ */
+static void checkVectorCall(AstNode *node) {
+    const char *name = node->funcCall.name;
+    int argCount = node->funcCall.argCount;
+    VecType ctor = vecTypeFromName(name);
+    if (ctor != VEC_NONE) {
+        if (argCount != 1 && argCount != vecLanes(ctor)) {
+            fprintf(stderr, "Semantic error: '%s' takes 1 or %d arguments.\n",
+                    name, vecLanes(ctor));
+            exit(1);
+        }
+        for (int i = 0; i < argCount; i++) {
+            DataType type = inferType(node->funcCall.arguments[i]);
+            if (type != TYPE_INT && type != TYPE_FLOAT && type != TYPE_UNKNOWN) {
+                fprintf(stderr, "Semantic error: Lanes of '%s' must be numbers.\n", name);
+                exit(1);
+            }
+        }
+        return;
+    }
+    if (strcmp(name, "shuffle") == 0) {
+        VecType vec = argCount > 0 ? vecTypeOf(inferType(node->funcCall.arguments[0]))
+                                   : VEC_NONE;
+        if (vec == VEC_NONE) {
+            fprintf(stderr, "Semantic error: 'shuffle' expects a vector.\n");
+            exit(1);
+        }
+        if (argCount != vecLanes(vec) + 1) {
+            fprintf(stderr, "Semantic error: 'shuffle' needs %d lane indices.\n",
+                    vecLanes(vec));
+            exit(1);
+        }
+        for (int i = 1; i < argCount; i++) {
+            AstNode *index = node->funcCall.arguments[i];
+            if (index->type != AST_NUMBER_LITERAL || index->numberLiteral.isFloat ||
+                index->numberLiteral.intValue < 0 ||
+                index->numberLiteral.intValue >= vecLanes(vec)) {
+                fprintf(stderr, "Semantic error: 'shuffle' indices must be literals in [0, %d).\n",
+                        vecLanes(vec));
+                exit(1);
+            }
+        }
+        return;
+    }
+    if (isVecReduction(name)) {
+        if (argCount != 1 || vecTypeOf(inferType(node->funcCall.arguments[0])) == VEC_NONE) {
+            fprintf(stderr, "Semantic error: '%s' expects one vector.\n", name);
+            exit(1);
+        }
+    }
+}
+
+/* -------------------------------------------------------------------------- */
+/*                           Arreglos tipados                                 */
+/* -------------------------------------------------------------------------- */
+
+/* El índice de un acceso debe ser entero */
+static void checkArrayIndex(AstNode *index) {
+    DataType type = inferType(index);
+    if (type != TYPE_INT && type != TYPE_UNKNOWN) {
+        fprintf(stderr, "Semantic error: Array index must be int.\n");
+        exit(1);
+    }
+}
+
+/**
+ * @brief Comprueba las funciones predefinidas de arreglos.
+ *
+ * - len(a): longitud de un arreglo.
+ * - array(n): arreglo de n enteros a cero.
+ */
+static void checkArrayCall(AstNode *node) {
+    const char *name = node->funcCall.name;
+    if (strcmp(name, "len") == 0) {
+        if (node->funcCall.argCount != 1 ||
+            !isArrayType(inferType(node->funcCall.arguments[0]))) {
+            fprintf(stderr, "Semantic error: 'len' expects one array.\n");
+            exit(1);
+        }
+    } else if (strcmp(name, "array") == 0) {
+        if (node->funcCall.argCount != 1 ||
+            !isNumericType(inferType(node->funcCall.arguments[0])) ||
+            inferType(node->funcCall.arguments[0]) == TYPE_FLOAT) {
+            fprintf(stderr, "Semantic error: 'array' expects an int length.\n");
+            exit(1);
+        }
+    }
+}
+
+/**
+ * @brief Comprueba el valor inicial de una variable [Clase].
+ *
+ * Acepta array(n), que en una clase @soa reserva una columna por campo y
+ * en otra un arreglo de referencias a cero, u otro arreglo de la misma
+ * clase.
+ */
+static void checkClassArrayInit(AstNode *init, const char *className, const char *name) {
+    ClassInfo *cls = findClass(className);
+    if (!cls) {
+        fprintf(stderr, "Semantic error: Unknown class '%s' in type of '%s'.\n",
+                className, name);
+        exit(1);
+    }
+    if (!init)
+        return;
+    if (init->type == AST_FUNC_CALL && strcmp(init->funcCall.name, "array") == 0) {
+        if (cls->soa) {
+            init->funcCall.kind = CALL_SOA_ARRAY;
+            snprintf(init->funcCall.target, sizeof(init->funcCall.target), "%s", cls->name);
+        }
+        return;
+    }
+    if (init->type == AST_IDENTIFIER && elementClass(init) == cls)
+        return;
+    fprintf(stderr, "Semantic error: Incompatible initializer for '%s'.\n", name);
+    exit(1);
+}
+
+/* -------------------------------------------------------------------------- */
+/*                          Escritura de campos                               */
+/* -------------------------------------------------------------------------- */
+
+/**
+ * @brief Comprueba 'obj.campo = valor' y anota la posición del campo.
+ *
+ * @return int 1 si el objeto es de una clase conocida (la asignación ya
+ *         está comprobada), 0 si debe tratarse como una variable.
+ */
+static int checkFieldAssign(AstNode *node, DataType assignedType) {
+    const char *dot = strchr(node->varAssign.name, '.');
+    if (!dot)
+        return 0;
+    char object[256];
+    size_t len = (size_t)(dot - node->varAssign.name);
+    memcpy(object, node->varAssign.name, len);
+    object[len] = '\0';
+    checkParallelRead(object);
+    Symbol *sym = lookupSymbol(object);
+    ClassInfo *cls = sym && sym->type == TYPE_CLASS ? findClass(sym->customType) : NULL;
+    if (!cls)
+        return 0;
+    const ClassField *field = findField(cls, dot + 1);
+    if (!field) {
+        fprintf(stderr, "Semantic error: Class '%s' has no field '%s'.\n", cls->name, dot + 1);
+        exit(1);
+    }
+    DataType fieldType = mapTypeString(field->type, NULL, 0);
+    if (assignedType != TYPE_UNKNOWN && assignedType != fieldType) {
+        fprintf(stderr, "Semantic error: Incompatible assignment to field '%s.%s'.\n",
+                cls->name, field->name);
+        exit(1);
+    }
+    node->varAssign.fieldOffset = field->offset;
+    return 1;
+}
+
+/**
+ * @brief Comprueba 'arr[i] = obj' y 'arr[i].campo = valor' sobre un
+ *        arreglo [Clase] y anota dónde se escribe.
+ *
+ * En un arreglo @soa solo se escriben campos (en su columna); en otro, el
+ * elemento es una referencia a un objeto de la clase o de una subclase.
+ */
+static void checkElementAssign(AstNode *node, ClassInfo *cls, DataType valueType) {
+    if (!node->indexAssign.field[0]) {
+        ClassInfo *valueClass = classOf(node->indexAssign.value);
+        if (cls->soa || (valueType != TYPE_UNKNOWN && !valueClass) ||
+            (valueClass && !isSubclassOf(valueClass, cls))) {
+            fprintf(stderr, "Semantic error: Incompatible element assigned to '%s'.\n",
+                    node->indexAssign.name);
+            exit(1);
+        }
+        return;
+    }
+    const ClassField *field = findField(cls, node->indexAssign.field);
+    if (!field) {
+        fprintf(stderr, "Semantic error: Class '%s' has no field '%s'.\n",
+                cls->name, node->indexAssign.field);
+        exit(1);
+    }
+    DataType fieldType = mapTypeString(field->type, NULL, 0);
+    if (valueType != TYPE_UNKNOWN && valueType != fieldType) {
+        fprintf(stderr, "Semantic error: Incompatible assignment to field '%s.%s'.\n",
+                cls->name, field->name);
+        exit(1);
+    }
+    if (cls->soa)
+        node->indexAssign.column = (int)(field - cls->fields);
+    else
+        node->indexAssign.fieldOffset = field->offset;
+}
+
 /* -------------------------------------------------------------------------- */
 /*                      Análisis Semántico Recursivo                          */
 /* -------------------------------------------------------------------------- */
@@ -270,6 +1281,7 @@ static void analyzeNode(AstNode *node) {
 
         case AST_PROGRAM:
             pushScope();  // Ámbito global
+            globalTable = currentTable;
             for (int i = 0; i < node->program.statementCount; i++) {
                 analyzeNode(node->program.statements[i]);
             }
@@ -277,21 +1289,50 @@ static void analyzeNode(AstNode *node) {
             break;
 
         case AST_VAR_DECL: {
+            analyzeNode(node->varDecl.initializer);
             char customType[256] = "";
             DataType declType = mapTypeString(node->varDecl.type,
                                               customType,
                                               sizeof(customType));
+            if (parallelDepth > 0 && vecTypeOf(declType) != VEC_NONE) {
+                fprintf(stderr,
+                        "Semantic error: Vector '%s' cannot be declared inside a parallel loop.\n",
+                        node->varDecl.name);
+                exit(1);
+            }
+            if (declType == TYPE_ARRAY_CLASS)
+                checkClassArrayInit(node->varDecl.initializer, customType, node->varDecl.name);
             addSymbol(node->varDecl.name, declType, customType);
+            bindLambda(node->varDecl.name, node->varDecl.initializer);
             break;
         }
 
         case AST_VAR_ASSIGN: {
             analyzeNode(node->varAssign.initializer);
             DataType assignedType = inferType(node->varAssign.initializer);
+            if (checkFieldAssign(node, assignedType))
+                break;
+            // Los vectores son globales y el cuerpo paralelo solo privatiza escalares
+            if (parallelDepth > 0 && vecTypeOf(assignedType) != VEC_NONE) {
+                fprintf(stderr,
+                        "Semantic error: Vector '%s' cannot be assigned inside a parallel loop.\n",
+                        node->varAssign.name);
+                exit(1);
+            }
             Symbol *sym = lookupSymbol(node->varAssign.name);
+            if (sym && sym->type == TYPE_ARRAY_CLASS) {
+                checkClassArrayInit(node->varAssign.initializer, sym->customType,
+                                    node->varAssign.name);
+                break;
+            }
+            ClassInfo *assignedClass = assignedType == TYPE_ARRAY_CLASS ?
+                                       elementClass(node->varAssign.initializer) :
+                                       classOf(node->varAssign.initializer);
+            const char *className = assignedClass ? assignedClass->name : "";
             if (!sym) {
                 // Declaración implícita
-                addSymbol(node->varAssign.name, assignedType, "");
+                addSymbol(node->varAssign.name, assignedType, className);
+                bindLambda(node->varAssign.name, node->varAssign.initializer);
             } else {
                 if (sym->type != TYPE_UNKNOWN && sym->type != assignedType) {
                     fprintf(stderr,
@@ -300,32 +1341,137 @@ static void analyzeNode(AstNode *node) {
                     exit(1);
                 }
                 if (sym->type == TYPE_UNKNOWN) {
-                    updateSymbol(node->varAssign.name, assignedType, "");
+                    updateSymbol(node->varAssign.name, assignedType, className);
                 }
             }
             break;
         }
 
-        case AST_FUNC_DEF:
+        case AST_FUNC_DEF: {
             pushScope(); // Nuevo ámbito para la función
             for (int i = 0; i < node->funcDef.paramCount; i++) {
-                // Se asume que los parámetros llevan un tipo, o int por defecto
-                addSymbol(node->funcDef.parameters[i]->identifier.name, TYPE_INT, "");
+                // En un método, self es siempre de la clase que lo define
+                char customType[256] = "";
+                DataType paramType = TYPE_INT;
+                if (i == 0 && currentClass) {
+                    paramType = TYPE_CLASS;
+                    snprintf(customType, sizeof(customType), "%s", currentClass->name);
+                } else if (node->funcDef.paramTypes) {
+                    paramType = mapTypeString(node->funcDef.paramTypes[i], customType,
+                                              sizeof(customType));
+                }
+                addSymbol(node->funcDef.parameters[i]->identifier.name, paramType, customType);
             }
+            ClassInfo *savedClass = currentClass;
+            int savedConstructor = inConstructor;
+            inConstructor = currentClass && strcmp(node->funcDef.name, "__init__") == 0;
+            currentClass = NULL;
+            functionDepth++;
             for (int i = 0; i < node->funcDef.bodyCount; i++) {
                 analyzeNode(node->funcDef.body[i]);
             }
+            functionDepth--;
+            currentClass = savedClass;
+            inConstructor = savedConstructor;
             popScope();
             break;
+        }
 
         case AST_RETURN_STMT:
+            // El constructor retorna el objeto
+            if (inConstructor) {
+                fprintf(stderr, "Semantic error: '__init__' cannot return a value.\n");
+                exit(1);
+            }
             analyzeNode(node->returnStmt.expr);
             break;
 
         case AST_PRINT_STMT:
             analyzeNode(node->printStmt.expr);
+            if (isArrayType(inferType(node->printStmt.expr))) {
+                fprintf(stderr, "Semantic error: Cannot print an array; print its elements.\n");
+                exit(1);
+            }
+            if (vecTypeOf(inferType(node->printStmt.expr)) != VEC_NONE) {
+                fprintf(stderr, "Semantic error: Cannot print a vector; reduce it with hsum/hmin/hmax.\n");
+                exit(1);
+            }
+            node->printStmt.isString = inferType(node->printStmt.expr) == TYPE_STRING;
             break;
 
+        case AST_FUNC_CALL:
+            for (int i = 0; i < node->funcCall.argCount; i++) {
+                analyzeNode(node->funcCall.arguments[i]);
+            }
+            resolveCall(node);
+            checkVectorCall(node);
+            checkArrayCall(node);
+            break;
+
+        case AST_ARRAY_LITERAL:
+            for (int i = 0; i < node->arrayLiteral.elementCount; i++) {
+                analyzeNode(node->arrayLiteral.elements[i]);
+                if (!isNumericType(inferType(node->arrayLiteral.elements[i]))) {
+                    fprintf(stderr, "Semantic error: Array elements must be int or float.\n");
+                    exit(1);
+                }
+            }
+            break;
+
+        case AST_INDEX: {
+            analyzeNode(node->indexExpr.array);
+            analyzeNode(node->indexExpr.index);
+            ClassInfo *element = elementClass(node->indexExpr.array);
+            if (element && element->soa) {
+                fprintf(stderr,
+                        "Semantic error: Elements of @soa array '%s' can only be used through their fields.\n",
+                        node->indexExpr.array->identifier.name);
+                exit(1);
+            }
+            if (!isArrayType(inferType(node->indexExpr.array)) &&
+                inferType(node->indexExpr.array) != TYPE_UNKNOWN) {
+                fprintf(stderr, "Semantic error: Only arrays can be indexed.\n");
+                exit(1);
+            }
+            checkArrayIndex(node->indexExpr.index);
+            break;
+        }
+
+        case AST_INDEX_ASSIGN: {
+            analyzeNode(node->indexAssign.index);
+            analyzeNode(node->indexAssign.value);
+            checkParallelRead(node->indexAssign.name);
+            Symbol *sym = lookupSymbol(node->indexAssign.name);
+            if (!sym) {
+                fprintf(stderr, "Semantic error: Variable '%s' not declared.\n",
+                        node->indexAssign.name);
+                exit(1);
+            }
+            if (!isArrayType(sym->type)) {
+                fprintf(stderr, "Semantic error: Variable '%s' is not an array.\n",
+                        node->indexAssign.name);
+                exit(1);
+            }
+            checkArrayIndex(node->indexAssign.index);
+            DataType valueType = inferType(node->indexAssign.value);
+            if (sym->type == TYPE_ARRAY_CLASS) {
+                checkElementAssign(node, findClass(sym->customType), valueType);
+                break;
+            }
+            if (node->indexAssign.field[0]) {
+                fprintf(stderr, "Semantic error: Elements of '%s' have no fields.\n",
+                        node->indexAssign.name);
+                exit(1);
+            }
+            if (!isNumericType(valueType) ||
+                (sym->type == TYPE_ARRAY_INT && valueType == TYPE_FLOAT)) {
+                fprintf(stderr, "Semantic error: Incompatible element assigned to '%s'.\n",
+                        node->indexAssign.name);
+                exit(1);
+            }
+            break;
+        }
+
         case AST_BINARY_OP: {
             // Analizar subnodos
             analyzeNode(node->binaryOp.left);
@@ -335,15 +1481,30 @@ static void analyzeNode(AstNode *node) {
             DataType leftType = inferType(node->binaryOp.left);
             DataType rightType = inferType(node->binaryOp.right);
 
+            // Concatenación: buildStringChains la aplana después con estos tipos
+            if (node->binaryOp.op == '+') {
+                node->binaryOp.leftString = leftType == TYPE_STRING;
+                node->binaryOp.rightString = rightType == TYPE_STRING;
+            }
+            int concat = node->binaryOp.leftString || node->binaryOp.rightString;
+
+            if (isArrayType(leftType) || isArrayType(rightType)) {
+                fprintf(stderr, "Semantic error: Operator '%c' is not defined for arrays.\n",
+                        node->binaryOp.op);
+                exit(1);
+            }
+            else if (vecTypeOf(leftType) != VEC_NONE || vecTypeOf(rightType) != VEC_NONE) {
+                checkVectorBinary(node, leftType, rightType);
+            }
             // Aquí mantenemos el warning si no se determinó tipo
-            if (leftType == TYPE_UNKNOWN || rightType == TYPE_UNKNOWN) {
+            else if (!concat && (leftType == TYPE_UNKNOWN || rightType == TYPE_UNKNOWN)) {
                 fprintf(stderr,
                         "Warning: Unable to determine types in binary operation '%c'.\n",
                         node->binaryOp.op);
             }
             else if (node->binaryOp.op == '+') {
                 // Permitir concatenación con strings
-                if (leftType == TYPE_STRING || rightType == TYPE_STRING) {
+                if (concat) {
                     // Nada, se asume OK
                 }
                 else if (leftType != rightType) {
@@ -355,7 +1516,8 @@ static void analyzeNode(AstNode *node) {
             }
             else if (node->binaryOp.op == '-' ||
                      node->binaryOp.op == '*' ||
-                     node->binaryOp.op == '/') {
+                     node->binaryOp.op == '/' ||
+                     node->binaryOp.op == '%') {
                 // Exigimos que coincidan si no son desconocidos
                 if (leftType != TYPE_UNKNOWN && rightType != TYPE_UNKNOWN &&
                     leftType != rightType) {
@@ -365,19 +1527,88 @@ static void analyzeNode(AstNode *node) {
                     exit(1);
                 }
             }
+            else if (isRelationalOp(node->binaryOp.op)) {
+                // Se permite comparar int con float; un string solo con otro string
+                if ((leftType == TYPE_STRING) != (rightType == TYPE_STRING)) {
+                    fprintf(stderr,
+                            "Semantic error: Incompatible types in comparison '%c'.\n",
+                            node->binaryOp.op);
+                    exit(1);
+                }
+            }
+            break;
+        }
+
+        case AST_SPAWN: {
+            AstNode *call = node->spawnExpr.call;
+            // La tarea llama directamente a una función de nivel superior
+            AstNode *callee = findFunctionDef(call->funcCall.name);
+            if (!callee) {
+                fprintf(stderr,
+                        "Semantic error: 'spawn %s' requires a top-level function.\n",
+                        call->funcCall.name);
+                exit(1);
+            }
+            // El runtime pasa a la tarea un único argumento entero
+            if (callee->funcDef.paramCount > 1) {
+                fprintf(stderr,
+                        "Semantic error: 'spawn %s' requires a function with at most one parameter.\n",
+                        call->funcCall.name);
+                exit(1);
+            }
+            if (call->funcCall.argCount != callee->funcDef.paramCount) {
+                fprintf(stderr,
+                        "Semantic error: Function '%s' expects %d arguments.\n",
+                        call->funcCall.name, callee->funcDef.paramCount);
+                exit(1);
+            }
+            for (int i = 0; i < call->funcCall.argCount; i++) {
+                analyzeNode(call->funcCall.arguments[i]);
+            }
+            break;
+        }
+
+        case AST_AWAIT: {
+            analyzeNode(node->awaitExpr.future);
+            DataType futureType = inferType(node->awaitExpr.future);
+            if (futureType != TYPE_FUTURE && futureType != TYPE_UNKNOWN) {
+                fprintf(stderr, "Semantic error: 'await' expects a future.\n");
+                exit(1);
+            }
             break;
         }
 
         case AST_LAMBDA: {
+            // El runtime paralelo solo privatiza escalares del cuerpo
+            if (parallelDepth > 0) {
+                fprintf(stderr, "Semantic error: Lambdas cannot be created inside a parallel loop.\n");
+                exit(1);
+            }
+            if (lambdaDepth == MAX_LAMBDA_DEPTH) {
+                fprintf(stderr, "Semantic error: Lambdas nested too deeply.\n");
+                exit(1);
+            }
+            node->lambda.id = lambdaCount++;
+            lambdaStack[lambdaDepth++] = node;
             pushScope();
             for (int i = 0; i < node->lambda.paramCount; i++) {
-                addSymbol(node->lambda.parameters[i]->identifier.name, TYPE_INT, "");
+                char customType[256] = "";
+                DataType paramType = TYPE_INT;
+                if (node->lambda.paramTypes)
+                    paramType = mapTypeString(node->lambda.paramTypes[i], customType,
+                                              sizeof(customType));
+                addSymbol(node->lambda.parameters[i]->identifier.name, paramType, customType);
             }
             analyzeNode(node->lambda.body);
             popScope();
+            lambdaDepth--;
             break;
         }
 
+        case AST_IDENTIFIER:
+            recordUse(node->identifier.name);
+            break;
+
         case AST_IF_STMT:
             analyzeNode(node->ifStmt.condition);
             pushScope();
@@ -395,23 +1626,79 @@ static void analyzeNode(AstNode *node) {
         case AST_FOR_STMT:
             analyzeNode(node->forStmt.rangeStart);
             analyzeNode(node->forStmt.rangeEnd);
+            if (node->forStmt.parallel)
+                checkParallelFor(node);
+            AstNode *savedLoop = parallelLoop;
+            if (node->forStmt.parallel)
+                parallelLoop = node;
+            parallelDepth += node->forStmt.parallel;
             pushScope();
             addSymbol(node->forStmt.iterator, TYPE_INT, "");
             for (int i = 0; i < node->forStmt.bodyCount; i++) {
                 analyzeNode(node->forStmt.body[i]);
             }
             popScope();
+            parallelDepth -= node->forStmt.parallel;
+            parallelLoop = savedLoop;
             break;
 
-        case AST_CLASS_DEF:
+        case AST_CLASS_DEF: {
             // Registrar el nombre de la clase
             addSymbol(node->classDef.name, TYPE_CLASS, node->classDef.name);
+            ClassInfo *savedClass = currentClass;
+            currentClass = findClass(node->classDef.name);
             pushScope();
             for (int i = 0; i < node->classDef.memberCount; i++) {
                 analyzeNode(node->classDef.members[i]);
             }
             popScope();
+            currentClass = savedClass;
+            break;
+        }
+
+        case AST_MEMBER_ACCESS: {
+            AstNode *object = node->memberAccess.object;
+            ClassInfo *element = object->type == AST_INDEX ?
+                                 elementClass(object->indexExpr.array) : NULL;
+            if (element && element->soa) {
+                // arr[i].campo sobre un arreglo @soa se reescribe como
+                // arr.campo[i]: la columna del campo indexada
+                analyzeNode(object->indexExpr.array);
+                analyzeNode(object->indexExpr.index);
+                checkArrayIndex(object->indexExpr.index);
+                const ClassField *field = findField(element, node->memberAccess.member);
+                if (!field) {
+                    fprintf(stderr, "Semantic error: Class '%s' has no field '%s'.\n",
+                            element->name, node->memberAccess.member);
+                    exit(1);
+                }
+                AstNode *array = object->indexExpr.array;
+                AstNode *index = object->indexExpr.index;
+                object->type = AST_MEMBER_ACCESS;
+                object->memberAccess.object = array;
+                snprintf(object->memberAccess.member, sizeof(object->memberAccess.member),
+                         "%s", field->name);
+                object->memberAccess.offset = -1;
+                object->memberAccess.column = (int)(field - element->fields);
+                node->type = AST_INDEX;
+                node->indexExpr.array = object;
+                node->indexExpr.index = index;
+                node->indexExpr.checked = 1;
+                break;
+            }
+            analyzeNode(object);
+            ClassInfo *cls = classOf(node->memberAccess.object);
+            if (!cls)
+                break;
+            const ClassField *field = findField(cls, node->memberAccess.member);
+            if (!field) {
+                fprintf(stderr, "Semantic error: Class '%s' has no field '%s'.\n",
+                        cls->name, node->memberAccess.member);
+                exit(1);
+            }
+            node->memberAccess.offset = field->offset;
             break;
+        }
 
         default:
             // Literales, identificadores, etc., sin acción extra
@@ -427,7 +1714,18 @@ static void analyzeNode(AstNode *node) {
  * @param root Puntero a la raíz del AST.
  */
 void analyzeSemantics(AstNode *root) {
+    freeClasses();
+    if (root && root->type == AST_PROGRAM)
+        buildClasses(root);
+    programRoot = root;
+    lambdaDepth = 0;
+    lambdaCount = 0;
+    parallelDepth = 0;
+    parallelLoop = NULL;
+    functionDepth = 0;
     pushScope(); // Ámbito global
     analyzeNode(root);
     popScope();
+    programRoot = NULL;
+    globalTable = NULL;
 }
@@ -9,12 +9,75 @@ typedef enum {
     TYPE_FLOAT,
     TYPE_STRING,
     TYPE_CLASS,    // Para tipos definidos por el usuario (clases)
+    TYPE_FUTURE,   // Resultado pendiente de 'spawn'
+    TYPE_VEC4I,    // Vectores SIMD de 4 u 8 carriles de 32 bits
+    TYPE_VEC4F,
+    TYPE_VEC8I,
+    TYPE_VEC8F,
+    TYPE_ARRAY_INT,   // Arreglos tipados [int] y [float]
+    TYPE_ARRAY_FLOAT,
+    TYPE_ARRAY_CLASS, // Arreglo de objetos [Clase] (por columnas si la clase es @soa)
+    TYPE_FUNCTION,    // Lambda o clausura (tipo 'fn')
     TYPE_UNKNOWN
 } DataType;
 
+/**
+ * @brief Campo de una clase y su posición en el objeto.
+ *
+ * Todos los campos ocupan una palabra de 8 bytes. Los heredados conservan
+ * la posición que tienen en la clase base, así que un objeto derivado se
+ * puede usar como uno de la base.
+ */
+typedef struct {
+    char name[256];
+    char type[64];
+    int offset;             /* Bytes desde el inicio del objeto */
+    AstNode *initializer;   /* Valor por defecto en la clase que lo declara
+                               (NULL si no tiene); es del AST analizado */
+} ClassField;
+
+/**
+ * @brief Método visible en una clase, propio o heredado.
+ */
+typedef struct {
+    char name[256];
+    char owner[256];        /* Clase que define la implementación */
+    char symbol[256];       /* Símbolo de la implementación: <owner>__<name> */
+    int slot;               /* Hueco en la vtable, -1 si nunca se despacha en
+                               tiempo de ejecución */
+    AstNode *def;           /* FUNC_DEF; solo es válido durante el análisis */
+} ClassMethod;
+
+/**
+ * @brief Disposición de una clase calculada por el análisis semántico.
+ *
+ * Solo las jerarquías en las que alguna subclase redefine un método llevan
+ * vtable: el puntero ocupa la primera palabra del objeto y cada método
+ * redefinido tiene un hueco. El resto de objetos son solo sus campos.
+ */
+typedef struct ClassInfo {
+    char name[256];
+    struct ClassInfo *parent;
+    ClassField *fields;     /* Heredados primero, en orden de declaración */
+    int fieldCount;
+    ClassMethod *methods;   /* Con la implementación que usa esta clase */
+    int methodCount;
+    int size;               /* Bytes del objeto (al menos una palabra) */
+    int hasVtable;
+    int vtableSize;         /* Huecos de la vtable de la jerarquía */
+    int soa;                /* @soa: un arreglo de la clase guarda una columna
+                               por campo, en el orden de 'fields' */
+    struct ClassInfo *next;
+} ClassInfo;
+
 /**
  * @brief Realiza el análisis semántico sobre el AST.
  *
+ * Calcula la disposición de las clases y resuelve cada llamada a un método
+ * con el análisis de la jerarquía de clases: si ninguna subclase del tipo
+ * estático del receptor redefine el método, la llamada es directa (y el
+ * generador puede expandirla en línea); si no, pasa por la vtable.
+ *
  * Recorre el árbol de sintaxis abstracta, verifica consistencia de tipos en 
  * operaciones, asignaciones y declaraciones, y gestiona el alcance de las 
  * variables usando una pila de tablas de símbolos.
@@ -23,4 +86,21 @@ typedef enum {
  */
 void analyzeSemantics(AstNode *root);
 
+/**
+ * @brief Clases del último programa analizado.
+ *
+ * Siguen disponibles para el generador de código hasta el siguiente
+ * análisis.
+ *
+ * @return const ClassInfo* Primera clase de la lista (NULL si no hay).
+ */
+const ClassInfo *semanticClasses(void);
+
+/**
+ * @brief Busca una clase del último programa analizado por su nombre.
+ *
+ * @return const ClassInfo* La clase, o NULL si no existe.
+ */
+const ClassInfo *semanticFindClass(const char *name);
+
 #endif /* SEMANTIC_H */
@@ -0,0 +1,503 @@
+/* treeshake.c */
+#include "treeshake.h"
+#include "ast.h"
+#include "memory.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+/* ============================
+   Estadísticas
+   ============================ */
+
+static TreeShakeStats stats;
+
+void treeShakeResetStats(void) {
+    memset(&stats, 0, sizeof(stats));
+}
+
+const TreeShakeStats *treeShakeGetStats(void) {
+    return &stats;
+}
+
+void treeShakeDumpStats(void) {
+    printf("Tree Shaking Stats:\n");
+    printf("  Dead functions    : %zu\n", stats.functions);
+    printf("  Dead classes      : %zu\n", stats.classes);
+    printf("  Dead methods      : %zu\n", stats.methods);
+    printf("  Dead globals      : %zu\n", stats.globals);
+    printf("  Dead imports      : %zu\n", stats.imports);
+}
+
+/* ============================
+   Conjuntos de nombres
+   Listas enlazadas, igual que las tablas de símbolos del resto del compilador.
+   ============================ */
+
+typedef struct Name {
+    char name[256];
+    struct Name *next;
+} Name;
+
+static Name *liveNames = NULL;    /* Funciones, clases, métodos y globales alcanzados */
+static Name *innerWrites = NULL;  /* Globales escritas fuera del nivel superior */
+static Name *locals = NULL;       /* Parámetros y variables de la función en curso */
+static int usesExternal = 0;      /* Hay referencias a símbolos que aportan los imports */
+static int changed = 0;           /* El conjunto vivo creció en la pasada actual */
+static int depth = 0;             /* 0 = sentencias de nivel superior */
+static AstNode *program = NULL;
+
+static int hasName(Name *set, const char *name) {
+    for (Name *n = set; n; n = n->next) {
+        if (strcmp(n->name, name) == 0)
+            return 1;
+    }
+    return 0;
+}
+
+/* Retorna 1 si el nombre no estaba en el conjunto */
+static int addName(Name **set, const char *name) {
+    if (hasName(*set, name))
+        return 0;
+    Name *n = (Name *)memory_alloc(sizeof(Name));
+    strncpy(n->name, name, sizeof(n->name) - 1);
+    n->name[sizeof(n->name) - 1] = '\0';
+    n->next = *set;
+    *set = n;
+    return 1;
+}
+
+/* Libera los nombres añadidos desde 'mark' (el conjunto crece por la cabeza) */
+static void truncateNames(Name **set, Name *mark) {
+    while (*set && *set != mark) {
+        Name *next = (*set)->next;
+        memory_free(*set);
+        *set = next;
+    }
+}
+
+/* Símbolos que provee el runtime: no requieren ningún import */
+static int isBuiltin(const char *name) {
+    static const char *builtins[] = {
+        "print", "to_str", "sqrt", "range", "len", "register_event", NULL
+    };
+    for (int i = 0; builtins[i]; i++) {
+        if (strcmp(builtins[i], name) == 0)
+            return 1;
+    }
+    return 0;
+}
+
+/* ============================
+   Resolución de nombres de nivel superior
+   ============================ */
+
+static const char *definedName(AstNode *st) {
+    switch (st->type) {
+        case AST_FUNC_DEF:   return st->funcDef.name;
+        case AST_CLASS_DEF:  return st->classDef.name;
+        case AST_VAR_ASSIGN: return st->varAssign.name;
+        case AST_VAR_DECL:   return st->varDecl.name;
+        default:             return NULL;
+    }
+}
+
+/* Variable que mantiene viva una asignación: en 'obj.campo = v' es el
+   objeto, porque el valor se lee a través de él */
+static const char *assignedObject(AstNode *st, char *buffer, size_t size) {
+    const char *name = st->varAssign.name;
+    size_t len = strcspn(name, ".");
+    if (!name[len] || len >= size)
+        return name;
+    memcpy(buffer, name, len);
+    buffer[len] = '\0';
+    return buffer;
+}
+
+static int isTopLevelName(const char *name) {
+    for (int i = 0; i < program->program.statementCount; i++) {
+        const char *defined = definedName(program->program.statements[i]);
+        if (defined && strcmp(defined, name) == 0)
+            return 1;
+    }
+    return 0;
+}
+
+static int isMethodName(const char *name) {
+    for (int i = 0; i < program->program.statementCount; i++) {
+        AstNode *st = program->program.statements[i];
+        if (st->type != AST_CLASS_DEF)
+            continue;
+        for (int j = 0; j < st->classDef.memberCount; j++) {
+            AstNode *m = st->classDef.members[j];
+            if (m && m->type == AST_FUNC_DEF && strcmp(m->funcDef.name, name) == 0)
+                return 1;
+        }
+    }
+    return 0;
+}
+
+/* Marca como vivo el destino de una referencia por nombre */
+static void reference(const char *name) {
+    if (hasName(locals, name))
+        return;
+    if (isTopLevelName(name) || isMethodName(name)) {
+        if (addName(&liveNames, name))
+            changed = 1;
+    } else if (!isBuiltin(name)) {
+        usesExternal = 1;
+    }
+}
+
+/* Un tipo declarado solo cuenta si nombra una clase del programa, sola o
+   como elemento de un arreglo ([Clase]) */
+static void referenceType(const char *typeName) {
+    size_t len = strlen(typeName);
+    if (typeName[0] == '[') {
+        typeName++;
+        len = strcspn(typeName, "]");
+    }
+    for (int i = 0; i < program->program.statementCount; i++) {
+        AstNode *st = program->program.statements[i];
+        if (st->type == AST_CLASS_DEF && strlen(st->classDef.name) == len &&
+            strncmp(st->classDef.name, typeName, len) == 0) {
+            if (addName(&liveNames, st->classDef.name))
+                changed = 1;
+            return;
+        }
+    }
+}
+
+/* Un inicializador sin efectos se puede descartar junto con su global */
+static int isPure(AstNode *node) {
+    if (!node)
+        return 1;
+    switch (node->type) {
+        case AST_NUMBER_LITERAL:
+        case AST_STRING_LITERAL:
+        case AST_IDENTIFIER:
+        case AST_LAMBDA:
+            return 1;
+        case AST_BINARY_OP:
+            /* '/' y '%' pueden fallar en tiempo de ejecución */
+            return node->binaryOp.op != '/' && node->binaryOp.op != '%' &&
+                   isPure(node->binaryOp.left) && isPure(node->binaryOp.right);
+        case AST_MEMBER_ACCESS:
+            return isPure(node->memberAccess.object);
+        case AST_ARRAY_LITERAL:
+            for (int i = 0; i < node->arrayLiteral.elementCount; i++) {
+                if (!isPure(node->arrayLiteral.elements[i]))
+                    return 0;
+            }
+            return 1;
+        case AST_STRING_BUILD:
+            for (int i = 0; i < node->stringBuild.pieceCount; i++) {
+                if (!isPure(node->stringBuild.pieces[i]))
+                    return 0;
+            }
+            return 1;
+        default:
+            return 0;
+    }
+}
+
+/* ============================
+   Recorrido de alcanzabilidad
+   ============================ */
+
+static void scanNode(AstNode *node);
+
+static void scanList(AstNode **nodes, int count) {
+    for (int i = 0; i < count; i++)
+        scanNode(nodes[i]);
+}
+
+/* Registra una escritura; fuera del nivel superior la variable es local
+   dentro de la función, pero el backend la sigue reservando como global */
+static void recordWrite(const char *name) {
+    if (depth > 0) {
+        addName(&innerWrites, name);
+        if (!isTopLevelName(name))
+            addName(&locals, name);
+    }
+}
+
+static void scanParameters(AstNode **params, int count) {
+    for (int i = 0; i < count; i++) {
+        if (params[i] && params[i]->type == AST_IDENTIFIER)
+            addName(&locals, params[i]->identifier.name);
+    }
+}
+
+static void scanFunction(AstNode *func) {
+    Name *mark = locals;
+    depth++;
+    scanParameters(func->funcDef.parameters, func->funcDef.paramCount);
+    scanList(func->funcDef.body, func->funcDef.bodyCount);
+    depth--;
+    truncateNames(&locals, mark);
+}
+
+/* Una clase viva conserva sus campos, sus métodos especiales y los métodos
+   invocados en algún punto alcanzable del programa */
+static int isLiveMember(AstNode *member) {
+    if (!member || member->type != AST_FUNC_DEF)
+        return 1;
+    return strncmp(member->funcDef.name, "__", 2) == 0 ||
+           hasName(liveNames, member->funcDef.name);
+}
+
+static void scanClass(AstNode *cls) {
+    /* Los métodos heredados se generan en la clase base */
+    referenceType(cls->classDef.parent);
+    for (int i = 0; i < cls->classDef.memberCount; i++) {
+        AstNode *member = cls->classDef.members[i];
+        if (!member || !isLiveMember(member))
+            continue;
+        if (member->type == AST_FUNC_DEF) {
+            scanFunction(member);
+        } else if (member->type == AST_VAR_DECL) {
+            referenceType(member->varDecl.type);
+            scanNode(member->varDecl.initializer);
+        } else {
+            scanNode(member);
+        }
+    }
+}
+
+static void scanNode(AstNode *node) {
+    if (!node)
+        return;
+    switch (node->type) {
+        case AST_IDENTIFIER:
+            reference(node->identifier.name);
+            break;
+        case AST_FUNC_CALL:
+            reference(node->funcCall.name);
+            scanList(node->funcCall.arguments, node->funcCall.argCount);
+            break;
+        case AST_METHOD_CALL:
+            reference(node->methodCall.method);
+            scanNode(node->methodCall.object);
+            scanList(node->methodCall.arguments, node->methodCall.argCount);
+            break;
+        case AST_MEMBER_ACCESS:
+            scanNode(node->memberAccess.object);
+            break;
+        case AST_BINARY_OP:
+            scanNode(node->binaryOp.left);
+            scanNode(node->binaryOp.right);
+            break;
+        case AST_ARRAY_LITERAL:
+            scanList(node->arrayLiteral.elements, node->arrayLiteral.elementCount);
+            break;
+        case AST_STRING_BUILD:
+            scanList(node->stringBuild.pieces, node->stringBuild.pieceCount);
+            break;
+        case AST_SPAWN:
+            scanNode(node->spawnExpr.call);
+            break;
+        case AST_AWAIT:
+            scanNode(node->awaitExpr.future);
+            break;
+        case AST_INDEX:
+            scanNode(node->indexExpr.array);
+            scanNode(node->indexExpr.index);
+            break;
+        case AST_INDEX_ASSIGN:
+            /* Escribir un elemento lee la variable que contiene el arreglo */
+            reference(node->indexAssign.name);
+            scanNode(node->indexAssign.index);
+            scanNode(node->indexAssign.value);
+            break;
+        case AST_LAMBDA: {
+            Name *mark = locals;
+            depth++;
+            scanParameters(node->lambda.parameters, node->lambda.paramCount);
+            scanNode(node->lambda.body);
+            depth--;
+            truncateNames(&locals, mark);
+            break;
+        }
+        case AST_VAR_ASSIGN:
+            scanNode(node->varAssign.initializer);
+            recordWrite(node->varAssign.name);
+            break;
+        case AST_VAR_DECL:
+            /* El tipo declarado mantiene viva la clase correspondiente */
+            referenceType(node->varDecl.type);
+            scanNode(node->varDecl.initializer);
+            recordWrite(node->varDecl.name);
+            break;
+        case AST_RETURN_STMT:
+            scanNode(node->returnStmt.expr);
+            break;
+        case AST_PRINT_STMT:
+            scanNode(node->printStmt.expr);
+            break;
+        case AST_IF_STMT:
+            scanNode(node->ifStmt.condition);
+            depth++;
+            scanList(node->ifStmt.thenBranch, node->ifStmt.thenCount);
+            scanList(node->ifStmt.elseBranch, node->ifStmt.elseCount);
+            depth--;
+            break;
+        case AST_FOR_STMT:
+            scanNode(node->forStmt.rangeStart);
+            scanNode(node->forStmt.rangeEnd);
+            /* La reducción lee el valor inicial y escribe el combinado */
+            if (node->forStmt.reduceOp != REDUCE_NONE)
+                reference(node->forStmt.reduceVar);
+            depth++;
+            recordWrite(node->forStmt.iterator);
+            if (node->forStmt.reduceOp != REDUCE_NONE)
+                recordWrite(node->forStmt.reduceVar);
+            scanList(node->forStmt.body, node->forStmt.bodyCount);
+            depth--;
+            break;
+        case AST_FUNC_DEF:
+            scanFunction(node);
+            break;
+        case AST_CLASS_DEF:
+            scanClass(node);
+            break;
+        default:
+            /* Literales e imports no referencian a nadie */
+            break;
+    }
+}
+
+/* Una pasada sobre el nivel superior. Las definiciones solo se recorren si
+   ya están vivas; el resto de sentencias son raíces. */
+static void scanProgram(void) {
+    for (int i = 0; i < program->program.statementCount; i++) {
+        AstNode *st = program->program.statements[i];
+        switch (st->type) {
+            case AST_FUNC_DEF:
+                if (hasName(liveNames, st->funcDef.name))
+                    scanFunction(st);
+                break;
+            case AST_CLASS_DEF:
+                if (hasName(liveNames, st->classDef.name))
+                    scanClass(st);
+                break;
+            case AST_VAR_ASSIGN: {
+                char object[256];
+                if (hasName(liveNames, assignedObject(st, object, sizeof(object))) ||
+                    !isPure(st->varAssign.initializer))
+                    scanNode(st);
+                break;
+            }
+            case AST_VAR_DECL:
+                if (hasName(liveNames, st->varDecl.name) || !isPure(st->varDecl.initializer))
+                    scanNode(st);
+                break;
+            case AST_IMPORT:
+                break;
+            default:
+                scanNode(st);
+                break;
+        }
+    }
+}
+
+/* ============================
+   Eliminación
+   ============================ */
+
+static int isLiveGlobal(const char *name) {
+    return hasName(liveNames, name) || hasName(innerWrites, name);
+}
+
+/* Retorna la sentencia que sustituye a 'st' (NULL si se elimina) */
+static AstNode *shakeStatement(AstNode *st) {
+    AstNode **init = NULL;
+    switch (st->type) {
+        case AST_FUNC_DEF:
+            if (hasName(liveNames, st->funcDef.name))
+                return st;
+            stats.functions++;
+            freeAstNode(st);
+            return NULL;
+        case AST_CLASS_DEF: {
+            if (!hasName(liveNames, st->classDef.name)) {
+                stats.classes++;
+                freeAstNode(st);
+                return NULL;
+            }
+            int kept = 0;
+            for (int i = 0; i < st->classDef.memberCount; i++) {
+                AstNode *member = st->classDef.members[i];
+                if (isLiveMember(member)) {
+                    st->classDef.members[kept++] = member;
+                } else {
+                    stats.methods++;
+                    freeAstNode(member);
+                }
+            }
+            st->classDef.memberCount = kept;
+            return st;
+        }
+        case AST_IMPORT:
+            /* Sin interfaces de módulo no se sabe qué símbolo aporta cada
+               import: se conservan todos si queda alguna referencia externa.
+               ui y css son recursos con efectos propios y no se eliminan. */
+            if (usesExternal || strcmp(st->importStmt.moduleType, "ui") == 0 ||
+                strcmp(st->importStmt.moduleType, "css") == 0)
+                return st;
+            stats.imports++;
+            freeAstNode(st);
+            return NULL;
+        case AST_VAR_ASSIGN: {
+            char object[256];
+            if (isLiveGlobal(assignedObject(st, object, sizeof(object))))
+                return st;
+            init = &st->varAssign.initializer;
+            break;
+        }
+        case AST_VAR_DECL:
+            if (isLiveGlobal(st->varDecl.name))
+                return st;
+            init = &st->varDecl.initializer;
+            break;
+        default:
+            return st;
+    }
+    /* Global nunca leída: se descarta el almacenamiento y, si el
+       inicializador tiene efectos, se conserva como sentencia */
+    stats.globals++;
+    AstNode *effect = NULL;
+    if (!isPure(*init)) {
+        effect = *init;
+        *init = NULL;
+    }
+    freeAstNode(st);
+    return effect;
+}
+
+void treeShakeProgram(AstNode *root) {
+    if (!root || root->type != AST_PROGRAM)
+        return;
+    program = root;
+    usesExternal = 0;
+    depth = 0;
+
+    /* Punto fijo: cada definición que se vuelve viva puede alcanzar otras */
+    do {
+        changed = 0;
+        scanProgram();
+    } while (changed);
+
+    int kept = 0;
+    for (int i = 0; i < root->program.statementCount; i++) {
+        AstNode *st = shakeStatement(root->program.statements[i]);
+        if (st)
+            root->program.statements[kept++] = st;
+    }
+    root->program.statementCount = kept;
+
+    truncateNames(&liveNames, NULL);
+    truncateNames(&innerWrites, NULL);
+    truncateNames(&locals, NULL);
+    program = NULL;
+}
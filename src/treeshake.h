@@ -0,0 +1,49 @@
+#ifndef TREESHAKE_H
+#define TREESHAKE_H
+
+#include "ast.h"
+
+/**
+ * @brief Contadores de definiciones eliminadas por el tree shaking.
+ */
+typedef struct {
+    size_t functions;   /* Funciones no alcanzables desde main */
+    size_t classes;     /* Clases nunca instanciadas ni usadas como tipo */
+    size_t methods;     /* Métodos nunca invocados de clases vivas */
+    size_t globals;     /* Variables globales escritas pero nunca leídas */
+    size_t imports;     /* Módulos importados sin uso */
+} TreeShakeStats;
+
+/**
+ * @brief Elimina del programa las definiciones no alcanzables desde main.
+ *
+ * Calcula la alcanzabilidad partiendo de las sentencias de nivel superior
+ * y recorre llamadas, identificadores y tipos declarados. Se eliminan las
+ * funciones, clases y métodos que nunca se alcanzan, las globales que nunca
+ * se leen (su inicializador se conserva como sentencia si tiene efectos) y
+ * los imports sin uso. Los literales string del código eliminado desaparecen
+ * con él, por lo que no llegan a la salida.
+ *
+ * Debe ejecutarse después del análisis semántico para que los errores en
+ * código muerto se sigan reportando.
+ *
+ * @param root Raíz del AST (AST_PROGRAM); se modifica en el sitio.
+ */
+void treeShakeProgram(AstNode *root);
+
+/**
+ * @brief Reinicia los contadores del tree shaking.
+ */
+void treeShakeResetStats(void);
+
+/**
+ * @brief Retorna los contadores del tree shaking acumulados.
+ */
+const TreeShakeStats *treeShakeGetStats(void);
+
+/**
+ * @brief Imprime los contadores del tree shaking acumulados.
+ */
+void treeShakeDumpStats(void);
+
+#endif /* TREESHAKE_H */
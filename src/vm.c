@@ -0,0 +1,538 @@
+/* vm.c */
+#define _POSIX_C_SOURCE 200809L
+#define _DEFAULT_SOURCE
+#include "vm.h"
+#include "bytecode.h"
+#include "runtime.h"
+#include "memory.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+
+#if defined(__x86_64__) && defined(__ELF__)
+#define VM_NATIVE_TIER 1
+#include <dlfcn.h>
+#include <unistd.h>
+#include "arch.h"
+#include "codegen.h"
+#endif
+
+#define VM_REGISTERS (1 << 20)  /* Palabras de la pila de registros */
+#define VM_FRAMES (1 << 17)     /* Llamadas anidadas como mucho */
+
+static VmStats stats;
+
+void vmResetStats(void) {
+    memset(&stats, 0, sizeof(stats));
+}
+
+const VmStats *vmGetStats(void) {
+    return &stats;
+}
+
+void vmDumpStats(void) {
+    printf("Interpreter Stats:\n");
+    printf("  Interpreted calls : %zu\n", stats.calls);
+    printf("  Native calls      : %zu\n", stats.nativeCalls);
+    printf("  Tiered functions  : %zu\n", stats.tieredFunctions);
+    printf("  Tier failures     : %zu\n", stats.tierFailures);
+}
+
+static void runtimeError(const char *message) {
+    fflush(stdout);
+    fprintf(stderr, "Runtime error: %s\n", message);
+    exit(1);
+}
+
+/* ============================
+   Nivel nativo
+   Las funciones candidatas que se llaman a menudo se compilan con el
+   backend x86-64 a un objeto compartido: el ensamblador de siempre, con
+   direcciones relativas a rip, más una entrada por función que toma los
+   argumentos de la pila de registros.
+   ============================ */
+
+#ifdef VM_NATIVE_TIER
+
+/* Añade el prototipo y, recursivamente, las candidatas a las que llama */
+static void collectCallees(BcProgram *program, AstNode *node, AstNode ***defs, int *count);
+
+static void addNativeDef(BcProgram *program, AstNode *def, AstNode ***defs, int *count) {
+    for (int i = 0; i < *count; i++) {
+        if ((*defs)[i] == def)
+            return;
+    }
+    *defs = (AstNode **)memory_realloc(*defs, (size_t)(*count + 1) * sizeof(AstNode *));
+    (*defs)[(*count)++] = def;
+    for (int i = 0; i < def->funcDef.bodyCount; i++)
+        collectCallees(program, def->funcDef.body[i], defs, count);
+}
+
+static void collectCallees(BcProgram *program, AstNode *node, AstNode ***defs, int *count) {
+    if (!node)
+        return;
+    switch (node->type) {
+        case AST_FUNC_CALL:
+            for (int i = 0; i < program->protoCount; i++) {
+                BcProto *proto = program->protos[i];
+                if (proto->tier != BC_TIER_NONE && proto->def && proto->def->type == AST_FUNC_DEF &&
+                    strcmp(proto->name, node->funcCall.name) == 0)
+                    addNativeDef(program, proto->def, defs, count);
+            }
+            for (int i = 0; i < node->funcCall.argCount; i++)
+                collectCallees(program, node->funcCall.arguments[i], defs, count);
+            break;
+        case AST_VAR_ASSIGN:
+            collectCallees(program, node->varAssign.initializer, defs, count);
+            break;
+        case AST_VAR_DECL:
+            collectCallees(program, node->varDecl.initializer, defs, count);
+            break;
+        case AST_RETURN_STMT:
+            collectCallees(program, node->returnStmt.expr, defs, count);
+            break;
+        case AST_BINARY_OP:
+            collectCallees(program, node->binaryOp.left, defs, count);
+            collectCallees(program, node->binaryOp.right, defs, count);
+            break;
+        case AST_IF_STMT:
+            collectCallees(program, node->ifStmt.condition, defs, count);
+            for (int i = 0; i < node->ifStmt.thenCount; i++)
+                collectCallees(program, node->ifStmt.thenBranch[i], defs, count);
+            for (int i = 0; i < node->ifStmt.elseCount; i++)
+                collectCallees(program, node->ifStmt.elseBranch[i], defs, count);
+            break;
+        case AST_FOR_STMT:
+            collectCallees(program, node->forStmt.rangeStart, defs, count);
+            collectCallees(program, node->forStmt.rangeEnd, defs, count);
+            for (int i = 0; i < node->forStmt.bodyCount; i++)
+                collectCallees(program, node->forStmt.body[i], defs, count);
+            break;
+        default:
+            break;
+    }
+}
+
+/* Copia el ensamblador sin los comentarios ';', que GAS toma como
+   separadores de sentencias (el módulo no tiene literales string) */
+static int stripComments(const char *from, const char *to) {
+    FILE *in = fopen(from, "r");
+    FILE *out = in ? fopen(to, "w") : NULL;
+    char line[1024];
+    if (!out) {
+        if (in)
+            fclose(in);
+        return -1;
+    }
+    while (fgets(line, sizeof(line), in)) {
+        char *comment = strchr(line, ';');
+        if (comment) {
+            comment[0] = '\n';
+            comment[1] = '\0';
+        }
+        fputs(line, out);
+    }
+    fclose(in);
+    fclose(out);
+    return 0;
+}
+
+/* Compila el prototipo y sus candidatas a código nativo. Si algo falla se
+   marca como FAILED y se sigue interpretando. */
+static void tierUp(BcProgram *program, BcProto *proto) {
+    char dir[] = "/tmp/lync-XXXXXX";
+    char raw[64], source[64], library[64], command[512];
+    AstNode **defs = NULL;
+    int count = 0;
+    void *handle = NULL;
+    const char *cc = getenv("CC");
+
+    proto->tier = BC_TIER_FAILED;
+    if (!mkdtemp(dir)) {
+        printf("Aviso: no se pudo compilar '%s' a código nativo.\n", proto->name);
+        stats.tierFailures++;
+        return;
+    }
+    snprintf(raw, sizeof(raw), "%s/module.raw.s", dir);
+    snprintf(source, sizeof(source), "%s/module.s", dir);
+    snprintf(library, sizeof(library), "%s/module.so", dir);
+    addNativeDef(program, proto->def, &defs, &count);
+
+    ArchBackend *saved = g_backend;
+    FILE *savedOut = g_backend ? g_backend->out : NULL;
+    setCurrentBackend(ARCH_X86_64, NULL);
+    int generated = generateNativeModule(defs, count, raw) == 0 && stripComments(raw, source) == 0;
+    g_backend->out = savedOut;
+    g_backend = saved;
+
+    if (generated) {
+        snprintf(command, sizeof(command), "%s -shared -Wl,-Bsymbolic -o %s %s >/dev/null 2>&1",
+                 cc && cc[0] ? cc : "cc", library, source);
+        fflush(stdout);
+        if (system(command) == 0)
+            handle = dlopen(library, RTLD_NOW | RTLD_LOCAL);
+    }
+    if (handle) {
+        /* Las candidatas del módulo también pasan al nivel nativo */
+        for (int i = 0; i < program->protoCount; i++) {
+            BcProto *p = program->protos[i];
+            char entry[288];
+            int inModule = 0;
+            for (int j = 0; j < count; j++)
+                inModule |= p->def == defs[j];
+            if (!inModule || p->native || (p != proto && p->tier != BC_TIER_CANDIDATE))
+                continue;
+            snprintf(entry, sizeof(entry), "__lyn_native_%s", p->name);
+            void *symbol = dlsym(handle, entry);
+            if (!symbol)
+                continue;
+            /* Conversión de void* a puntero a función, como indica POSIX */
+            memcpy(&p->native, &symbol, sizeof(symbol));
+            p->tier = BC_TIER_NATIVE;
+            stats.tieredFunctions++;
+        }
+    }
+    if (proto->tier != BC_TIER_NATIVE) {
+        printf("Aviso: no se pudo compilar '%s' a código nativo.\n", proto->name);
+        stats.tierFailures++;
+    }
+    /* El módulo cargado sigue en memoria aunque se borren los archivos */
+    unlink(raw);
+    unlink(source);
+    unlink(library);
+    rmdir(dir);
+    if (defs)
+        memory_free(defs);
+}
+
+#else
+
+static void tierUp(BcProgram *program, BcProto *proto) {
+    (void)program;
+    proto->tier = BC_TIER_FAILED;
+    printf("Aviso: el nivel nativo solo está disponible en hosts x86-64.\n");
+    stats.tierFailures++;
+}
+
+#endif /* VM_NATIVE_TIER */
+
+/* ============================
+   Intérprete
+   ============================ */
+
+/* Llamada en curso: a dónde volver. El resultado se deja en el primer
+   registro del llamado, que es R[A] del que llama. */
+typedef struct {
+    BcProto *proto;
+    const BcInstr *pc;
+    long *base;
+} Frame;
+
+/* Despacho: con goto calculado cada instrucción salta directamente a la
+   siguiente, sin volver a un switch central */
+#if defined(__GNUC__) && !defined(LYN_VM_SWITCH)
+#define VM_THREADED 1
+#define VM_CASE(name) op_##name:
+#define VM_NEXT() do { instr = *pc++; goto *dispatch[BC_OP(instr)]; } while (0)
+#else
+#define VM_CASE(name) case BC_##name:
+#define VM_NEXT() continue
+#endif
+
+/* Aritmética entera con desbordamiento modular, como el código compilado */
+#define WRAP(op, x, y) ((long)((unsigned long)(x) op (unsigned long)(y)))
+
+#define JUMP_IF(cond) \
+    do { \
+        if (cond) \
+            pc += 1 + (int32_t)*pc; \
+        else \
+            pc++; \
+    } while (0)
+
+int vmRun(BcProgram *program, const VmOptions *options) {
+#ifdef VM_THREADED
+    static void *const dispatch[] = {
+#define VM_LABEL(name) &&op_##name,
+        BC_OPCODES(VM_LABEL)
+#undef VM_LABEL
+    };
+#endif
+    long threshold = options ? options->tierThreshold : 0;
+    long *registers = (long *)memory_alloc(VM_REGISTERS * sizeof(long));
+    long *registerEnd = registers + VM_REGISTERS;
+    Frame *frames = (Frame *)memory_alloc(VM_FRAMES * sizeof(Frame));
+    int depth = 0;
+    long *globals = (long *)memory_alloc((size_t)(program->globalCount + 1) * sizeof(long));
+    const long *constants = program->constants;
+    BcProto *proto = program->protos[0];
+    const BcInstr *pc = proto->code;
+    long *base = registers;
+    BcInstr instr;
+
+    memset(globals, 0, (size_t)(program->globalCount + 1) * sizeof(long));
+    memset(registers, 0, (size_t)proto->registerCount * sizeof(long));
+
+#define R(i) base[i]
+
+/* Entra en el prototipo 'callee' con los argumentos ya en R[a..]: las
+   variables locales empiezan a cero */
+#define ENTER(callee, a) \
+    do { \
+        BcProto *enter_ = (callee); \
+        long *calleeBase_ = base + (a); \
+        if (depth == VM_FRAMES || calleeBase_ + enter_->registerCount > registerEnd) \
+            runtimeError("Stack overflow."); \
+        frames[depth].proto = proto; \
+        frames[depth].pc = pc; \
+        frames[depth].base = base; \
+        depth++; \
+        for (int r_ = enter_->paramCount; r_ < enter_->registerCount; r_++) \
+            calleeBase_[r_] = 0; \
+        proto = enter_; \
+        base = calleeBase_; \
+        pc = proto->code; \
+        stats.calls++; \
+    } while (0)
+
+#ifdef VM_THREADED
+    VM_NEXT();
+#else
+    for (;;) {
+        instr = *pc++;
+        switch (BC_OP(instr)) {
+#endif
+
+    VM_CASE(MOVE)
+        R(BC_A(instr)) = R(BC_B(instr));
+        VM_NEXT();
+    VM_CASE(LOADI)
+        R(BC_A(instr)) = BC_SBX(instr);
+        VM_NEXT();
+    VM_CASE(LOADK)
+        R(BC_A(instr)) = constants[BC_BX(instr)];
+        VM_NEXT();
+    VM_CASE(GETG)
+        R(BC_A(instr)) = globals[BC_BX(instr)];
+        VM_NEXT();
+    VM_CASE(SETG)
+        globals[BC_BX(instr)] = R(BC_A(instr));
+        VM_NEXT();
+    VM_CASE(ADD)
+        R(BC_A(instr)) = WRAP(+, R(BC_B(instr)), R(BC_C(instr)));
+        VM_NEXT();
+    VM_CASE(SUB)
+        R(BC_A(instr)) = WRAP(-, R(BC_B(instr)), R(BC_C(instr)));
+        VM_NEXT();
+    VM_CASE(MUL)
+        R(BC_A(instr)) = WRAP(*, R(BC_B(instr)), R(BC_C(instr)));
+        VM_NEXT();
+    VM_CASE(DIV) {
+        long divisor = R(BC_C(instr));
+        if (divisor == 0)
+            runtimeError("Division by zero.");
+        /* LONG_MIN / -1 desborda: el resultado modular es -LONG_MIN */
+        R(BC_A(instr)) = divisor == -1 ? WRAP(-, 0, R(BC_B(instr))) : R(BC_B(instr)) / divisor;
+        VM_NEXT();
+    }
+    VM_CASE(MOD) {
+        long divisor = R(BC_C(instr));
+        if (divisor == 0)
+            runtimeError("Division by zero.");
+        R(BC_A(instr)) = divisor == -1 ? 0 : R(BC_B(instr)) % divisor;
+        VM_NEXT();
+    }
+    VM_CASE(ADDI)
+        R(BC_A(instr)) = WRAP(+, R(BC_B(instr)), (long)BC_SC(instr));
+        VM_NEXT();
+    VM_CASE(LT)
+        R(BC_A(instr)) = R(BC_B(instr)) < R(BC_C(instr));
+        VM_NEXT();
+    VM_CASE(LE)
+        R(BC_A(instr)) = R(BC_B(instr)) <= R(BC_C(instr));
+        VM_NEXT();
+    VM_CASE(GT)
+        R(BC_A(instr)) = R(BC_B(instr)) > R(BC_C(instr));
+        VM_NEXT();
+    VM_CASE(GE)
+        R(BC_A(instr)) = R(BC_B(instr)) >= R(BC_C(instr));
+        VM_NEXT();
+    VM_CASE(EQ)
+        R(BC_A(instr)) = R(BC_B(instr)) == R(BC_C(instr));
+        VM_NEXT();
+    VM_CASE(NE)
+        R(BC_A(instr)) = R(BC_B(instr)) != R(BC_C(instr));
+        VM_NEXT();
+    VM_CASE(JMP)
+        JUMP_IF(1);
+        VM_NEXT();
+    VM_CASE(JZ)
+        JUMP_IF(R(BC_A(instr)) == 0);
+        VM_NEXT();
+    VM_CASE(JLT)
+        JUMP_IF(R(BC_A(instr)) < R(BC_B(instr)));
+        VM_NEXT();
+    VM_CASE(JLE)
+        JUMP_IF(R(BC_A(instr)) <= R(BC_B(instr)));
+        VM_NEXT();
+    VM_CASE(JGT)
+        JUMP_IF(R(BC_A(instr)) > R(BC_B(instr)));
+        VM_NEXT();
+    VM_CASE(JGE)
+        JUMP_IF(R(BC_A(instr)) >= R(BC_B(instr)));
+        VM_NEXT();
+    VM_CASE(JEQ)
+        JUMP_IF(R(BC_A(instr)) == R(BC_B(instr)));
+        VM_NEXT();
+    VM_CASE(JNE)
+        JUMP_IF(R(BC_A(instr)) != R(BC_B(instr)));
+        VM_NEXT();
+    VM_CASE(CALL) {
+        BcProto *callee = program->protos[*pc++];
+        if (callee->native) {
+            stats.nativeCalls++;
+            R(BC_A(instr)) = callee->native(&R(BC_A(instr)));
+            VM_NEXT();
+        }
+        if (callee->tier == BC_TIER_CANDIDATE && threshold > 0 && ++callee->calls >= threshold) {
+            tierUp(program, callee);
+            if (callee->native) {
+                stats.nativeCalls++;
+                R(BC_A(instr)) = callee->native(&R(BC_A(instr)));
+                VM_NEXT();
+            }
+        }
+        ENTER(callee, BC_A(instr));
+        VM_NEXT();
+    }
+    VM_CASE(CALLV) {
+        BcProto **vtable = *(BcProto ***)R(BC_A(instr));
+        BcProto *callee = vtable[*pc++];
+        if (!callee)
+            runtimeError("Call to a method that was removed.");
+        ENTER(callee, BC_A(instr));
+        VM_NEXT();
+    }
+    VM_CASE(CALLC) {
+        /* Los argumentos bajan un registro y las capturas van detrás */
+        long *closure = (long *)R(BC_A(instr));
+        BcProto *callee = (BcProto *)closure[0];
+        int a = BC_A(instr);
+        int argCount = BC_B(instr);
+        memmove(&R(a), &R(a + 1), (size_t)argCount * sizeof(long));
+        ENTER(callee, a);
+        for (int i = 0; i < proto->captureCount; i++)
+            R(argCount + i) = closure[1 + i];
+        VM_NEXT();
+    }
+    VM_CASE(RET) {
+        long result = R(BC_A(instr));
+        if (depth == 0)
+            goto done;
+        base[0] = result;
+        depth--;
+        proto = frames[depth].proto;
+        pc = frames[depth].pc;
+        base = frames[depth].base;
+        VM_NEXT();
+    }
+    VM_CASE(CLOSURE) {
+        /* Registro de clausura: el prototipo y las capturas, como el
+           código compilado guarda la función y las capturas */
+        BcProto *lambda = program->protos[*pc++];
+        int a = BC_A(instr);
+        if (BC_B(instr) == 0) {
+            /* Sin capturas: el registro estático del prototipo */
+            R(a) = (long)(intptr_t)&lambda->record;
+            VM_NEXT();
+        }
+        long *closure = (long *)lyn_object_new((long)(1 + BC_B(instr)) * (long)sizeof(long), lambda);
+        for (int i = 0; i < BC_B(instr); i++)
+            closure[1 + i] = R(a + 1 + i);
+        R(a) = (long)(intptr_t)closure;
+        VM_NEXT();
+    }
+    VM_CASE(NEWOBJ) {
+        BcClass *cls = &program->classes[BC_BX(instr)];
+        R(BC_A(instr)) = (long)(intptr_t)lyn_object_new(cls->size, cls->vtable);
+        VM_NEXT();
+    }
+    VM_CASE(GETF)
+        R(BC_A(instr)) = ((long *)R(BC_B(instr)))[BC_C(instr)];
+        VM_NEXT();
+    VM_CASE(SETF)
+        ((long *)R(BC_A(instr)))[BC_B(instr)] = R(BC_C(instr));
+        VM_NEXT();
+    VM_CASE(NEWARR)
+        R(BC_A(instr)) = (long)(intptr_t)lyn_array_new(R(BC_B(instr)));
+        VM_NEXT();
+    VM_CASE(NEWSOA)
+        R(BC_A(instr)) = (long)(intptr_t)lyn_soa_new(R(BC_B(instr)), BC_C(instr));
+        VM_NEXT();
+    VM_CASE(LEN)
+        R(BC_A(instr)) = ((LynArray *)R(BC_B(instr)))->length;
+        VM_NEXT();
+    VM_CASE(GETI) {
+        LynArray *array = (LynArray *)R(BC_B(instr));
+        long index = R(BC_C(instr));
+        if ((unsigned long)index >= (unsigned long)array->length)
+            lyn_bounds_fail(index, array->length);
+        R(BC_A(instr)) = array->data[index];
+        VM_NEXT();
+    }
+    VM_CASE(GETIU)
+        R(BC_A(instr)) = ((LynArray *)R(BC_B(instr)))->data[R(BC_C(instr))];
+        VM_NEXT();
+    VM_CASE(SETI) {
+        LynArray *array = (LynArray *)R(BC_A(instr));
+        long index = R(BC_B(instr));
+        if ((unsigned long)index >= (unsigned long)array->length)
+            lyn_bounds_fail(index, array->length);
+        array->data[index] = R(BC_C(instr));
+        VM_NEXT();
+    }
+    VM_CASE(SETIU)
+        ((LynArray *)R(BC_A(instr)))->data[R(BC_B(instr))] = R(BC_C(instr));
+        VM_NEXT();
+    VM_CASE(SBNEW)
+        R(BC_A(instr)) = (long)(intptr_t)lyn_sb_new(BC_BX(instr));
+        VM_NEXT();
+    VM_CASE(SBADDS)
+        lyn_sb_append_str((LynStrBuilder *)R(BC_A(instr)), (LynStr)R(BC_B(instr)));
+        VM_NEXT();
+    VM_CASE(SBADDI)
+        lyn_sb_append_int((LynStrBuilder *)R(BC_A(instr)), R(BC_B(instr)));
+        VM_NEXT();
+    VM_CASE(SBEND)
+        R(BC_A(instr)) = (long)lyn_sb_finish((LynStrBuilder *)R(BC_B(instr)));
+        VM_NEXT();
+    VM_CASE(SBPRINT)
+        lyn_sb_print((LynStrBuilder *)R(BC_A(instr)));
+        VM_NEXT();
+    VM_CASE(TOSTR)
+        R(BC_A(instr)) = (long)lyn_str_from_int(R(BC_B(instr)));
+        VM_NEXT();
+    VM_CASE(PRINTI)
+        printf("Result: %ld\n", R(BC_A(instr)));
+        VM_NEXT();
+    VM_CASE(PRINTS)
+        lyn_str_print((LynStr)R(BC_A(instr)));
+        VM_NEXT();
+
+#ifndef VM_THREADED
+            default:
+                runtimeError("Invalid bytecode.");
+        }
+    }
+#endif
+
+done:
+#undef R
+#undef ENTER
+    fflush(stdout);
+    memory_free(globals);
+    memory_free(frames);
+    memory_free(registers);
+    return 0;
+}
@@ -0,0 +1,69 @@
+#ifndef VM_H
+#define VM_H
+
+#include <stddef.h>
+#include "bytecode.h"
+
+/* Llamadas interpretadas tras las que una función candidata se compila a
+   código nativo, si el nivel nativo está activo */
+#ifndef VM_DEFAULT_TIER_THRESHOLD
+#define VM_DEFAULT_TIER_THRESHOLD 1000
+#endif
+
+/**
+ * @brief Opciones del intérprete.
+ */
+typedef struct {
+    long tierThreshold;     /* Llamadas para pasar al nivel nativo (0 = desactivado) */
+} VmOptions;
+
+/**
+ * @brief Contadores de la ejecución.
+ */
+typedef struct {
+    size_t calls;           /* Llamadas interpretadas */
+    size_t nativeCalls;     /* Llamadas a funciones compiladas a código nativo */
+    size_t tieredFunctions; /* Funciones compiladas a código nativo */
+    size_t tierFailures;    /* Compilaciones fallidas (se siguen interpretando) */
+} VmStats;
+
+/**
+ * @brief Ejecuta el programa con el intérprete de bytecode.
+ *
+ * El bucle de despacho salta de una instrucción a la siguiente con goto
+ * calculado (GCC y Clang); en otros compiladores, o con -DLYN_VM_SWITCH,
+ * usa un switch. Los arreglos, objetos y strings son los del runtime, así
+ * que la salida coincide con la del programa compilado.
+ *
+ * Con options->tierThreshold > 0, una función candidata (aritmética entera
+ * sobre sus variables locales) que alcanza ese número de llamadas se
+ * compila con el backend x86-64 a un objeto compartido que se carga en el
+ * proceso; las llamadas siguientes van al código nativo. Solo está
+ * disponible en hosts x86-64 ELF con un compilador de C ($CC o cc) para
+ * ensamblar el módulo; si falla, la función se sigue interpretando.
+ *
+ * Un error de ejecución (división por cero, índice fuera de rango,
+ * desbordamiento de la pila) se informa y termina el programa.
+ *
+ * @param program Programa compilado con bytecodeCompile.
+ * @param options Opciones (NULL = sin nivel nativo).
+ * @return int 0 si el programa terminó.
+ */
+int vmRun(BcProgram *program, const VmOptions *options);
+
+/**
+ * @brief Reinicia los contadores del intérprete.
+ */
+void vmResetStats(void);
+
+/**
+ * @brief Retorna los contadores del intérprete acumulados.
+ */
+const VmStats *vmGetStats(void);
+
+/**
+ * @brief Imprime los contadores del intérprete acumulados.
+ */
+void vmDumpStats(void);
+
+#endif /* VM_H */
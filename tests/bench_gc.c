@@ -0,0 +1,111 @@
+#define _POSIX_C_SOURCE 200112L
+#include <stdio.h>
+#include <stddef.h>
+#include <assert.h>
+#include <time.h>
+#include "memory.h"
+
+/* Benchmark del recolector (compilar con -DUSE_GC).
+   - binary trees: árboles temporales mientras vive un árbol de fondo de
+     distintos tamaños; mide throughput y pausas.
+   - ciclos: anillos de nodos que se vuelven basura; con conteo de
+     referencias nunca se liberarían. */
+
+typedef struct Node {
+    struct Node *left;
+    struct Node *right;
+    long value;
+} Node;
+
+static const size_t nodeOffsets[] = { offsetof(Node, left), offsetof(Node, right) };
+static const GCType nodeType = { "Node", 2, nodeOffsets };
+
+static Node *makeTree(int depth) {
+    void *roots[2] = { NULL, NULL };
+    GCFrame frame;
+    memory_gc_push_frame(&frame, roots, 2);
+    Node *node = memory_alloc_gc_typed(sizeof(Node), &nodeType);
+    roots[0] = node;
+    node->value = depth;
+    if (depth > 0) {
+        roots[1] = makeTree(depth - 1);
+        node->left = roots[1];
+        node->right = makeTree(depth - 1);
+    }
+    memory_gc_pop_frame(&frame);
+    return node;
+}
+
+static long checkTree(Node *node) {
+    if (!node->left)
+        return 1;
+    return 1 + checkTree(node->left) + checkTree(node->right);
+}
+
+static double nowSeconds(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec + (double)ts.tv_nsec / 1e9;
+}
+
+static void benchBinaryTrees(int liveDepth) {
+    void *roots[2] = { NULL, NULL };
+    GCFrame frame;
+    memory_gc_push_frame(&frame, roots, 2);
+
+    GCStats before, after;
+    memory_gc_get_stats(&before);
+    double start = nowSeconds();
+
+    roots[0] = makeTree(liveDepth);
+    for (int i = 0; i < 200; i++) {
+        roots[1] = makeTree(12);
+        assert(checkTree(roots[1]) == (1L << 13) - 1);
+    }
+    assert(checkTree(roots[0]) == (1L << (liveDepth + 1)) - 1);
+
+    double elapsed = nowSeconds() - start;
+    memory_gc_get_stats(&after);
+    size_t allocs = after.objectsAllocated - before.objectsAllocated;
+    size_t collections = after.collections - before.collections;
+    double pauses = after.totalPauseMs - before.totalPauseMs;
+    printf("trees live=2^%-2d  %6.2f Mallocs/s  %4zu GCs  pause avg %.3f ms  max %.3f ms  live %zu KB\n",
+           liveDepth + 1, (double)allocs / elapsed / 1e6, collections,
+           collections ? pauses / (double)collections : 0.0, after.maxPauseMs,
+           after.liveBytes / 1024);
+    memory_gc_pop_frame(&frame);
+}
+
+static void benchCycles(void) {
+    GCStats before, after;
+    memory_gc_collect();
+    memory_gc_get_stats(&before);
+    for (int ring = 0; ring < 20000; ring++) {
+        void *roots[2] = { NULL, NULL };
+        GCFrame frame;
+        memory_gc_push_frame(&frame, roots, 2);
+        roots[0] = memory_alloc_gc_typed(sizeof(Node), &nodeType);
+        roots[1] = roots[0];
+        for (int i = 0; i < 16; i++) {
+            Node *next = memory_alloc_gc_typed(sizeof(Node), &nodeType);
+            ((Node *)roots[1])->left = next;
+            roots[1] = next;
+        }
+        ((Node *)roots[1])->left = roots[0];   /* cierra el ciclo */
+        memory_gc_pop_frame(&frame);
+    }
+    memory_gc_collect();
+    memory_gc_get_stats(&after);
+    size_t freed = after.objectsFreed - before.objectsFreed;
+    printf("cycles: %zu ring nodes freed\n", freed);
+    assert(freed == 20000 * 17);
+}
+
+int main(void) {
+    int depths[] = { 10, 14, 18 };
+    for (int i = 0; i < 3; i++)
+        benchBinaryTrees(depths[i]);
+    benchCycles();
+    memory_gc_dumpStats();
+    return 0;
+}
@@ -0,0 +1,142 @@
+#define _POSIX_C_SOURCE 200112L
+#include <stdio.h>
+#include <stdlib.h>
+#include <assert.h>
+#include <pthread.h>
+#include <time.h>
+#include "memory.h"
+
+/* Throughput de memory_pool_alloc/memory_pool_free con 1, 4, 16 y 64 hilos.
+   Cada hilo asigna una ráfaga de bloques, los escribe y los libera. La
+   segunda tabla repite la prueba con un SlabAllocator y tamaños que
+   recorren todas sus clases: cada hilo mantiene a la vez un magazine por
+   clase. */
+
+#define BLOCK_SIZE   64
+#define BURST        16
+#define ITERATIONS   200000
+
+typedef struct {
+    MemoryPool *pool;
+    size_t failures;
+} WorkerArgs;
+
+static void *worker(void *arg) {
+    WorkerArgs *args = (WorkerArgs *)arg;
+    void *blocks[BURST];
+    for (int it = 0; it < ITERATIONS; it++) {
+        for (int i = 0; i < BURST; i++) {
+            blocks[i] = memory_pool_alloc(args->pool);
+            if (!blocks[i])
+                args->failures++;
+            else
+                *(volatile char *)blocks[i] = (char)i;
+        }
+        for (int i = 0; i < BURST; i++)
+            memory_pool_free(args->pool, blocks[i]);
+    }
+    return NULL;
+}
+
+/* Tamaños de cada ráfaga en la prueba mixta: todas las clases del slab */
+#define MIXED_SIZES 40
+
+typedef struct {
+    SlabAllocator *slab;
+    size_t failures;
+} SlabWorkerArgs;
+
+static void *slabWorker(void *arg) {
+    SlabWorkerArgs *args = (SlabWorkerArgs *)arg;
+    void *blocks[MIXED_SIZES];
+    size_t sizes[MIXED_SIZES];
+    for (int i = 0; i < MIXED_SIZES; i++)
+        sizes[i] = 16 + (size_t)i * (MEMORY_SLAB_MAX_SIZE - 16) / (MIXED_SIZES - 1);
+    for (int it = 0; it < ITERATIONS / 4; it++) {
+        for (int i = 0; i < MIXED_SIZES; i++) {
+            blocks[i] = memory_slab_alloc(args->slab, sizes[i]);
+            if (!blocks[i])
+                args->failures++;
+            else
+                *(volatile char *)blocks[i] = (char)i;
+        }
+        for (int i = 0; i < MIXED_SIZES; i++)
+            memory_slab_free(args->slab, blocks[i], sizes[i]);
+    }
+    return NULL;
+}
+
+static double elapsedSeconds(struct timespec start, struct timespec end) {
+    return (double)(end.tv_sec - start.tv_sec) + (double)(end.tv_nsec - start.tv_nsec) / 1e9;
+}
+
+int main(void) {
+    const int threadCounts[] = { 1, 4, 16, 64 };
+    printf("threads  ops/s (alloc+free)\n");
+    for (size_t t = 0; t < sizeof(threadCounts) / sizeof(threadCounts[0]); t++) {
+        int n = threadCounts[t];
+        /* Suficientes bloques para que ningún hilo agote el pool */
+        MemoryPool *pool = memory_pool_create(BLOCK_SIZE,
+                                              (size_t)n * (MEMORY_POOL_MAGAZINE_SIZE + BURST) * 2, 64);
+        assert(pool != NULL);
+        pthread_t *threads = malloc(sizeof(pthread_t) * n);
+        WorkerArgs *args = calloc(n, sizeof(WorkerArgs));
+
+        struct timespec start, end;
+        clock_gettime(CLOCK_MONOTONIC, &start);
+        for (int i = 0; i < n; i++) {
+            args[i].pool = pool;
+            pthread_create(&threads[i], NULL, worker, &args[i]);
+        }
+        for (int i = 0; i < n; i++)
+            pthread_join(threads[i], NULL);
+        clock_gettime(CLOCK_MONOTONIC, &end);
+
+        size_t failures = 0;
+        for (int i = 0; i < n; i++)
+            failures += args[i].failures;
+        assert(failures == 0);
+
+        /* Al terminar los hilos sus magazines ya se devolvieron al pool */
+        double ops = 2.0 * n * ITERATIONS * BURST;
+        printf("%7d  %.2fM\n", n, ops / elapsedSeconds(start, end) / 1e6);
+        assert(memory_pool_get_total_allocs(pool) == (size_t)n * ITERATIONS * BURST);
+        assert(memory_pool_get_total_frees(pool) == (size_t)n * ITERATIONS * BURST);
+
+        free(threads);
+        free(args);
+        memory_pool_destroy(pool);
+    }
+
+    printf("threads  ops/s (slab, %d tamaños)\n", MIXED_SIZES);
+    for (size_t t = 0; t < sizeof(threadCounts) / sizeof(threadCounts[0]); t++) {
+        int n = threadCounts[t];
+        SlabAllocator *slab = memory_slab_create();
+        assert(slab != NULL);
+        pthread_t *threads = malloc(sizeof(pthread_t) * n);
+        SlabWorkerArgs *args = calloc(n, sizeof(SlabWorkerArgs));
+
+        struct timespec start, end;
+        clock_gettime(CLOCK_MONOTONIC, &start);
+        for (int i = 0; i < n; i++) {
+            args[i].slab = slab;
+            pthread_create(&threads[i], NULL, slabWorker, &args[i]);
+        }
+        for (int i = 0; i < n; i++)
+            pthread_join(threads[i], NULL);
+        clock_gettime(CLOCK_MONOTONIC, &end);
+
+        size_t failures = 0;
+        for (int i = 0; i < n; i++)
+            failures += args[i].failures;
+        assert(failures == 0);
+
+        double ops = 2.0 * n * (ITERATIONS / 4) * MIXED_SIZES;
+        printf("%7d  %.2fM\n", n, ops / elapsedSeconds(start, end) / 1e6);
+
+        free(threads);
+        free(args);
+        memory_slab_destroy(slab);
+    }
+    return 0;
+}
@@ -0,0 +1,96 @@
+#define _POSIX_C_SOURCE 200112L
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <assert.h>
+#include <time.h>
+#include "runtime.h"
+
+/* Benchmark de los strings del runtime.
+   - to_str: lyn_str_from_int (que incluye reservar los resultados que no
+     caben en línea) frente a snprintf en un buffer.
+   - cadena: "Iteración " + i.to_str() + " de " + n.to_str() con el
+     constructor frente a un string intermedio por cada '+'. */
+
+#define ITERATIONS 2000000
+
+static double nowSeconds(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec + (double)ts.tv_nsec / 1e9;
+}
+
+/* Concatenación ingenua: cada '+' crea un string nuevo */
+static char *naiveConcat(const char *a, const char *b) {
+    size_t la = strlen(a), lb = strlen(b);
+    char *s = malloc(la + lb + 1);
+    memcpy(s, a, la);
+    memcpy(s + la, b, lb + 1);
+    return s;
+}
+
+static void benchToStr(void) {
+    size_t total = 0;
+    double start = nowSeconds();
+    for (long i = 0; i < ITERATIONS; i++) {
+        LynStr s = lyn_str_from_int(i * 7919);
+        size_t length = lyn_str_length(s);
+        total += length;
+        if (length > LYN_STR_INLINE_MAX)
+            free((void *)s);
+    }
+    double runtime = nowSeconds() - start;
+
+    size_t check = 0;
+    char buf[32];
+    start = nowSeconds();
+    for (long i = 0; i < ITERATIONS; i++)
+        check += (size_t)snprintf(buf, sizeof(buf), "%ld", i * 7919);
+    double libc = nowSeconds() - start;
+    assert(total == check);
+    printf("to_str: %.1f ns (snprintf %.1f ns)\n",
+           runtime / ITERATIONS * 1e9, libc / ITERATIONS * 1e9);
+}
+
+static void benchChain(void) {
+    size_t total = 0;
+    double start = nowSeconds();
+    for (long i = 0; i < ITERATIONS; i++) {
+        LynStrBuilder *sb = lyn_sb_new(40);
+        lyn_sb_append_str(sb, (LynStr)"Iteración ");
+        lyn_sb_append_int(sb, i);
+        lyn_sb_append_str(sb, (LynStr)" de ");
+        lyn_sb_append_int(sb, ITERATIONS);
+        LynStr s = lyn_sb_finish(sb);
+        size_t length = lyn_str_length(s);
+        total += length;
+        if (length > LYN_STR_INLINE_MAX)
+            free((void *)s);
+    }
+    double builder = nowSeconds() - start;
+
+    size_t check = 0;
+    char num[32];
+    start = nowSeconds();
+    for (long i = 0; i < ITERATIONS; i++) {
+        snprintf(num, sizeof(num), "%ld", i);
+        char *a = naiveConcat("Iteración ", num);
+        char *b = naiveConcat(a, " de ");
+        snprintf(num, sizeof(num), "%d", ITERATIONS);
+        char *c = naiveConcat(b, num);
+        check += strlen(c);
+        free(a);
+        free(b);
+        free(c);
+    }
+    double naive = nowSeconds() - start;
+    assert(total == check);
+    printf("chain: %.1f ns (naive %.1f ns)\n",
+           builder / ITERATIONS * 1e9, naive / ITERATIONS * 1e9);
+}
+
+int main(void) {
+    benchToStr();
+    benchChain();
+    return 0;
+}
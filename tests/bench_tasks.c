@@ -0,0 +1,66 @@
+#define _POSIX_C_SOURCE 200112L
+#include <stdio.h>
+#include <assert.h>
+#include <time.h>
+#include "runtime.h"
+
+/* Benchmark de las tareas ligeras (spawn/await).
+   - ráfagas: lanza lotes de tareas vacías y los espera; mide el coste
+     por tarea de crearla, encolarla y recoger su resultado.
+   - fib: paralelismo recursivo con una tarea por llamada. */
+
+#define BATCH 256
+
+static double nowSeconds(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec + (double)ts.tv_nsec / 1e9;
+}
+
+static long identityTask(long x) {
+    return x;
+}
+
+static long fibTask(long n) {
+    if (n < 2)
+        return n;
+    LynFuture *left = lyn_spawn(fibTask, n - 1);
+    long right = fibTask(n - 2);
+    return lyn_await(left) + right;
+}
+
+static void benchBursts(void) {
+    const long tasks = 4000000;
+    LynFuture *futures[BATCH];
+    long sum = 0;
+    double start = nowSeconds();
+    for (long done = 0; done < tasks; done += BATCH) {
+        for (int i = 0; i < BATCH; i++)
+            futures[i] = lyn_spawn(identityTask, done + i);
+        for (int i = BATCH - 1; i >= 0; i--)
+            sum += lyn_await(futures[i]);
+    }
+    double elapsed = nowSeconds() - start;
+    assert(sum == tasks * (tasks - 1) / 2);
+    printf("bursts: %ld tasks, %.1f ns/task\n", tasks, elapsed / (double)tasks * 1e9);
+}
+
+static void benchFib(void) {
+    double start = nowSeconds();
+    long result = fibTask(27);
+    double elapsed = nowSeconds() - start;
+    assert(result == 196418);
+    /* fib(27) crea fib(28) - 1 tareas */
+    printf("fib(27): %.1f ms, %.1f ns/task\n", elapsed * 1e3, elapsed / 317810.0 * 1e9);
+}
+
+int main(void) {
+    printf("threads: %d\n", lyn_runtime_threads());
+    benchBursts();
+    benchFib();
+    LynRuntimeStats stats;
+    lyn_runtime_get_stats(&stats);
+    printf("spawned=%zu steals=%zu\n", stats.spawned, stats.steals);
+    lyn_runtime_shutdown();
+    return 0;
+}
@@ -0,0 +1,194 @@
+#include <stdio.h>
+#include <assert.h>
+#include <string.h>
+#include "lexer.h"
+#include "parser.h"
+#include "ast.h"
+#include "optimize.h"
+#include "semantic.h"
+#include "bounds.h"
+
+static int checkedIn(AstNode *node);
+
+static int checkedInList(AstNode **nodes, int count) {
+    int checked = 0;
+    for (int i = 0; i < count; i++)
+        checked += checkedIn(nodes[i]);
+    return checked;
+}
+
+/* Accesos que conservan la comprobación de rango dentro de 'node' */
+static int checkedIn(AstNode *node) {
+    if (!node)
+        return 0;
+    switch (node->type) {
+        case AST_INDEX:
+            return node->indexExpr.checked + checkedIn(node->indexExpr.index);
+        case AST_INDEX_ASSIGN:
+            return node->indexAssign.checked + checkedIn(node->indexAssign.index) +
+                   checkedIn(node->indexAssign.value);
+        case AST_BINARY_OP:
+            return checkedIn(node->binaryOp.left) + checkedIn(node->binaryOp.right);
+        case AST_VAR_ASSIGN:
+            return checkedIn(node->varAssign.initializer);
+        case AST_PRINT_STMT:
+            return checkedIn(node->printStmt.expr);
+        case AST_FUNC_CALL:
+            return checkedInList(node->funcCall.arguments, node->funcCall.argCount);
+        case AST_FOR_STMT:
+            return checkedInList(node->forStmt.body, node->forStmt.bodyCount);
+        default:
+            return 0;
+    }
+}
+
+/* Último bucle de nivel superior del programa */
+static AstNode *lastLoop(AstNode *program) {
+    AstNode *loop = NULL;
+    for (int i = 0; i < program->program.statementCount; i++) {
+        if (program->program.statements[i]->type == AST_FOR_STMT)
+            loop = program->program.statements[i];
+    }
+    assert(loop != NULL);
+    return loop;
+}
+
+/* Analiza 'source' y retorna cuántos accesos del último bucle siguen
+   comprobados; 'accesses' recibe cuántos hay en todo el programa */
+static int checkedInLastLoop(const char *source, size_t *accesses) {
+    lexerInit(source);
+    AstNode *ast = parseProgram();
+    assert(ast != NULL);
+    ast = optimizeAST(ast);
+    analyzeSemantics(ast);
+    buildStringChains(ast);
+    boundsResetStats();
+    boundsCheckProgram(ast);
+    int checked = checkedIn(lastLoop(ast));
+    if (accesses)
+        *accesses = boundsGetStats()->accesses;
+    freeAst(ast);
+    return checked;
+}
+
+int main(void) {
+    size_t accesses;
+
+    // Dentro de range(2, len(a) - 3): a[i], a[i + c] con c <= 3 y a[i - c]
+    // con 2 - c >= 0 están en rango, tanto al leer como al escribir.
+    const char *proven =
+        "main;\n"
+        "a: [int] = array(10);\n"
+        "s: int = 0;\n"
+        "for i in range(2, len(a) - 3);\n"
+        "    s = s + a[i] + a[i + 3] + a[3 + i] + a[i - 2];\n"
+        "    a[i + 1] = s;\n"
+        "end;\n"
+        "print(s);\n"
+        "end;\n";
+    assert(checkedInLastLoop(proven, &accesses) == 0);
+    assert(accesses == 5 && boundsGetStats()->eliminated == 5);
+
+    // c > k: a[i + 2] puede ser a[len(a)] en la última vuelta.
+    const char *pastEnd =
+        "main;\n"
+        "a: [int] = array(10);\n"
+        "s: int = 0;\n"
+        "for i in range(0, len(a) - 1);\n"
+        "    s = s + a[i + 1] + a[i + 2];\n"
+        "end;\n"
+        "print(s);\n"
+        "end;\n";
+    assert(checkedInLastLoop(pastEnd, NULL) == 1);
+
+    // lo - c < 0: a[i - 2] es a[-1] en la primera vuelta.
+    const char *beforeStart =
+        "main;\n"
+        "a: [int] = array(10);\n"
+        "s: int = 0;\n"
+        "for i in range(1, len(a));\n"
+        "    s = s + a[i - 1] + a[i - 2];\n"
+        "end;\n"
+        "print(s);\n"
+        "end;\n";
+    assert(checkedInLastLoop(beforeStart, NULL) == 1);
+
+    // El cuerpo reasigna el iterador o el arreglo: no hay hecho que valga.
+    const char *writesIterator =
+        "main;\n"
+        "a: [int] = array(10);\n"
+        "s: int = 0;\n"
+        "for i in range(0, len(a) - 1);\n"
+        "    s = s + a[i];\n"
+        "    i = i + 1;\n"
+        "end;\n"
+        "print(s);\n"
+        "end;\n";
+    assert(checkedInLastLoop(writesIterator, NULL) == 1);
+
+    const char *writesArray =
+        "main;\n"
+        "a: [int] = array(10);\n"
+        "b: [int] = array(2);\n"
+        "s: int = 0;\n"
+        "for i in range(0, len(a));\n"
+        "    s = s + a[i];\n"
+        "    a = b;\n"
+        "end;\n"
+        "print(s);\n"
+        "end;\n";
+    assert(checkedInLastLoop(writesArray, NULL) == 1);
+
+    // Una función que reasigna el arreglo solo importa si puede ejecutarse
+    // durante el bucle: llamada desde el cuerpo o en una tarea lanzada.
+    const char *clobberIdle =
+        "main;\n"
+        "a: [int] = array(10);\n"
+        "func vacia() -> int;\n"
+        "    a = array(1);\n"
+        "    return 0;\n"
+        "end;\n"
+        "s: int = 0;\n"
+        "for i in range(len(a));\n"
+        "    s = s + a[i];\n"
+        "end;\n"
+        "print(s + vacia());\n"
+        "end;\n";
+    assert(checkedInLastLoop(clobberIdle, NULL) == 0);
+
+    const char *clobberCalled =
+        "main;\n"
+        "a: [int] = array(10);\n"
+        "func vacia() -> int;\n"
+        "    a = array(1);\n"
+        "    return 0;\n"
+        "end;\n"
+        "s: int = 0;\n"
+        "for i in range(len(a));\n"
+        "    s = s + a[i] + vacia();\n"
+        "end;\n"
+        "print(s);\n"
+        "end;\n";
+    assert(checkedInLastLoop(clobberCalled, NULL) == 1);
+
+    const char *clobberSpawned =
+        "main;\n"
+        "a: [int] = array(10);\n"
+        "func vacia() -> int;\n"
+        "    a = array(1);\n"
+        "    return 0;\n"
+        "end;\n"
+        "f = spawn vacia();\n"
+        "s: int = 0;\n"
+        "for i in range(len(a));\n"
+        "    s = s + a[i];\n"
+        "end;\n"
+        "r: int = await f;\n"
+        "print(s + r);\n"
+        "end;\n";
+    assert(checkedInLastLoop(clobberSpawned, NULL) == 1);
+
+    boundsDumpStats();
+    printf("Bounds test passed.\n");
+    return 0;
+}
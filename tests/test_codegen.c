@@ -0,0 +1,286 @@
+#define _POSIX_C_SOURCE 200809L
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <assert.h>
+#include <unistd.h>
+#include <sys/wait.h>
+#include "lexer.h"
+#include "parser.h"
+#include "ast.h"
+#include "optimize.h"
+#include "semantic.h"
+#include "escape.h"
+#include "treeshake.h"
+#include "bounds.h"
+#include "codegen.h"
+#include "arch.h"
+
+/* Compila programas con el backend x86-64, los ensambla con cc junto al
+   runtime y compara lo que imprimen. Ejecutar desde la raíz del repositorio;
+   en hosts que no son x86-64 o sin cc las pruebas se omiten. */
+
+static char workDir[] = "/tmp/lyn-codegen-XXXXXX";
+
+/* El programa generado llama a printf sin alinear la pila y termina con
+   exit_group sin vaciar stdout: esta versión realinea y vacía cada línea */
+static const char *printfSource =
+    "#include <stdarg.h>\n"
+    "#include <stdio.h>\n"
+    "__attribute__((force_align_arg_pointer)) int printf(const char *format, ...) {\n"
+    "    va_list args;\n"
+    "    va_start(args, format);\n"
+    "    int written = vprintf(format, args);\n"
+    "    va_end(args);\n"
+    "    fflush(stdout);\n"
+    "    return written;\n"
+    "}\n";
+
+static int setUp(void) {
+#if !defined(__x86_64__)
+    return 0;
+#else
+    if (system("cc --version >/dev/null 2>&1") != 0 || !mkdtemp(workDir))
+        return 0;
+    char path[96];
+    snprintf(path, sizeof(path), "%s/printf.c", workDir);
+    FILE *fp = fopen(path, "w");
+    assert(fp != NULL);
+    fputs(printfSource, fp);
+    fclose(fp);
+    return 1;
+#endif
+}
+
+/* Los comentarios ';' del backend separan instrucciones en GAS */
+static void stripComments(const char *from, const char *to) {
+    FILE *in = fopen(from, "r");
+    FILE *out = fopen(to, "w");
+    char line[1024];
+    assert(in && out);
+    while (fgets(line, sizeof(line), in)) {
+        char *comment = strchr(line, ';');
+        if (comment) {
+            comment[0] = '\n';
+            comment[1] = '\0';
+        }
+        fputs(line, out);
+    }
+    fclose(in);
+    fclose(out);
+}
+
+/* Salida de 'source' compilado y ejecutado, sin el prefijo "Result: " y
+   con un espacio tras cada valor */
+static const char *runNative(const char *source) {
+    static char output[4096];
+    char raw[96], assembly[96], command[512], line[256];
+
+    lexerInit(source);
+    AstNode *ast = parseProgram();
+    assert(ast != NULL);
+    ast = optimizeAST(ast);
+    analyzeSemantics(ast);
+    buildStringChains(ast);
+    escapeAnalyzeProgram(ast);
+    treeShakeProgram(ast);
+    boundsCheckProgram(ast);
+    snprintf(raw, sizeof(raw), "%s/prog.raw.s", workDir);
+    snprintf(assembly, sizeof(assembly), "%s/prog.s", workDir);
+    setCurrentBackend(ARCH_X86_64, NULL);
+    generateCode(ast, raw);
+    freeAst(ast);
+    stripComments(raw, assembly);
+
+    snprintf(command, sizeof(command),
+             "cc -no-pie -o %s/prog %s %s/printf.c src/runtime.c -I./src -pthread "
+             ">/dev/null 2>&1 && %s/prog > %s/out.txt",
+             workDir, assembly, workDir, workDir, workDir);
+    assert(system(command) == 0);
+
+    snprintf(raw, sizeof(raw), "%s/out.txt", workDir);
+    FILE *fp = fopen(raw, "r");
+    assert(fp != NULL);
+    output[0] = '\0';
+    while (fgets(line, sizeof(line), fp)) {
+        line[strcspn(line, "\n")] = '\0';
+        const char *value = strncmp(line, "Result: ", 8) == 0 ? line + 8 : line;
+        strncat(output, value, sizeof(output) - strlen(output) - 2);
+        strcat(output, " ");
+    }
+    fclose(fp);
+    return output;
+}
+
+static void expectOutput(const char *name, const char *source, const char *expected) {
+    const char *got = runNative(source);
+    if (strcmp(got, expected) != 0) {
+        fprintf(stderr, "%s: expected '%s', got '%s'\n", name, expected, got);
+        assert(0);
+    }
+}
+
+/* 1 si el análisis semántico rechaza 'source' (termina con estado 1) */
+static int rejected(const char *source) {
+    fflush(stdout);
+    pid_t pid = fork();
+    assert(pid >= 0);
+    if (pid == 0) {
+        freopen("/dev/null", "w", stdout);
+        freopen("/dev/null", "w", stderr);
+        lexerInit(source);
+        AstNode *ast = parseProgram();
+        analyzeSemantics(ast);
+        _exit(0);
+    }
+    int status;
+    waitpid(pid, &status, 0);
+    return WIFEXITED(status) && WEXITSTATUS(status) == 1;
+}
+
+int main(void) {
+    if (!setUp()) {
+        printf("Codegen test skipped (needs an x86-64 host with cc).\n");
+        return 0;
+    }
+
+    // Vectores de 4 enteros: operaciones elemento a elemento con escalares
+    // difundidos, shuffle y las tres reducciones.
+    expectOutput("vec4i",
+        "main;\n"
+        "a: vec4i = vec4i(1, 2, 3, 4);\n"
+        "b: vec4i = vec4i(10, 20, 30, 40);\n"
+        "n: int = 5;\n"
+        "c = a * b + n;\n"
+        "print(hsum(c));\n"
+        "d = shuffle(c, 3, 2, 1, 0);\n"
+        "print(hmin(d - a));\n"
+        "print(hmax(d));\n"
+        "e = b - a * 3;\n"
+        "print(hsum(e));\n"
+        "print(hmin(shuffle(e, 1, 1, 2, 3)));\n"
+        "print(hmax(a - b));\n"
+        "end;\n",
+        "320 11 165 70 14 -9 ");
+
+    // 8 floats (AVX2 en x86-64): las reducciones truncan a entero.
+    if (__builtin_cpu_supports("avx2")) {
+        expectOutput("vec8f",
+            "main;\n"
+            "n: int = 5;\n"
+            "k: vec8f = vec8f(n);\n"
+            "k = k * vec8f(1, 2, 3, 4, 5, 6, 7, 8) / 2;\n"
+            "print(hsum(k));\n"
+            "print(hmax(k));\n"
+            "print(hmin(shuffle(k, 7, 6, 5, 4, 3, 2, 1, 0)));\n"
+            "h = k - vec8f(0.5) + 1.0;\n"
+            "print(hsum(h));\n"
+            "print(hmin(h));\n"
+            "print(hmax(shuffle(h, 0, 0, 0, 0, 1, 1, 1, 1)));\n"
+            "end;\n",
+            "90 20 2 94 3 5 ");
+    } else {
+        printf("vec8f skipped (no AVX2).\n");
+    }
+
+    // Clases: los valores por defecto se guardan al crear el objeto, los
+    // heredados también y antes de __init__; total() es una llamada
+    // directa y nombre() pasa por la vtable. 'local' y 'q' no escapan y se
+    // reemplazan por escalares.
+    expectOutput("classes",
+        "main;\n"
+        "class Forma;\n"
+        "    lados: int = 4;\n"
+        "    escala: int = 0;\n"
+        "    func __init__(self: Forma, escala: int);\n"
+        "        self.escala = escala;\n"
+        "    end;\n"
+        "    func total(self: Forma) -> int;\n"
+        "        return self.lados * self.escala;\n"
+        "    end;\n"
+        "    func nombre(self: Forma) -> int;\n"
+        "        return 1;\n"
+        "    end;\n"
+        "end;\n"
+        "class Triangulo(Forma);\n"
+        "    extra: int = 10;\n"
+        "    func nombre(self: Triangulo) -> int;\n"
+        "        return 3 + self.extra;\n"
+        "    end;\n"
+        "end;\n"
+        "class Punto;\n"
+        "    x: int = 5;\n"
+        "    y: int = 6;\n"
+        "    func suma(self: Punto) -> int;\n"
+        "        return self.x + self.y;\n"
+        "    end;\n"
+        "end;\n"
+        "func usa(f: Forma) -> int;\n"
+        "    return f.total() + f.nombre();\n"
+        "end;\n"
+        "f: Forma = Forma(3);\n"
+        "t: Forma = Triangulo(2);\n"
+        "print(usa(f));\n"
+        "print(usa(t));\n"
+        "p: Punto = Punto();\n"
+        "print(p.suma());\n"
+        "local: Forma = Forma(5);\n"
+        "print(local.lados + local.escala);\n"
+        "q: Punto = Punto();\n"
+        "print(q.x * q.y);\n"
+        "end;\n",
+        "13 21 11 9 30 ");
+
+    // 'parallel for' dentro de una función: el cuerpo corre en otros hilos
+    // y las variables de la función son locales de cada hilo. Puede leer
+    // globales y las privadas del bucle; no un parámetro ni un local de
+    // fuera, que allí valdrían 0.
+    setenv("LYN_THREADS", "4", 1);
+    expectOutput("parallelInFunction",
+        "main;\n"
+        "a: [int] = array(1000);\n"
+        "func suma(k: int) -> int;\n"
+        "    total: int = 0;\n"
+        "    parallel for i in range(0, 1000) reduce(+: total);\n"
+        "        t: int = i * 2;\n"
+        "        total = total + a[i] + t;\n"
+        "    end;\n"
+        "    return total + k;\n"
+        "end;\n"
+        "for j in range(0, 1000);\n"
+        "    a[j] = 1;\n"
+        "end;\n"
+        "print(suma(5));\n"
+        "end;\n",
+        "1000005 ");
+    assert(rejected(
+        "main;\n"
+        "func f(n: int) -> int;\n"
+        "    total: int = 0;\n"
+        "    parallel for i in range(0, 1000) reduce(+: total);\n"
+        "        total = total + n;\n"
+        "    end;\n"
+        "    return total;\n"
+        "end;\n"
+        "print(f(3));\n"
+        "end;\n"));
+    assert(rejected(
+        "main;\n"
+        "class P;\n"
+        "    v: int = 2;\n"
+        "    func s(self: P) -> int;\n"
+        "        acc: int = 0;\n"
+        "        parallel for i in range(0, 10) reduce(+: acc);\n"
+        "            acc = acc + self.v;\n"
+        "        end;\n"
+        "        return acc;\n"
+        "    end;\n"
+        "end;\n"
+        "end;\n"));
+
+    char command[96];
+    snprintf(command, sizeof(command), "rm -rf %s", workDir);
+    system(command);
+    printf("Codegen test passed.\n");
+    return 0;
+}
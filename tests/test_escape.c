@@ -0,0 +1,57 @@
+#include <stdio.h>
+#include <assert.h>
+#include <string.h>
+#include "lexer.h"
+#include "parser.h"
+#include "ast.h"
+#include "escape.h"
+
+static int hasAssign(AstNode *program, const char *name) {
+    for (int i = 0; i < program->program.statementCount; i++) {
+        AstNode *st = program->program.statements[i];
+        if (st->type == AST_VAR_ASSIGN && strcmp(st->varAssign.name, name) == 0)
+            return 1;
+    }
+    return 0;
+}
+
+int main(void) {
+    // 'p' solo se usa a través de sus campos; 'q' se pasa a una función.
+    const char *source =
+        "main;\n"
+        "class Punto;\n"
+        "    x: int;\n"
+        "    y: int;\n"
+        "    func __init__(self: Punto, x: int, y: int);\n"
+        "        self.x = x;\n"
+        "        self.y = y;\n"
+        "    end;\n"
+        "end;\n"
+        "p: Punto = Punto(3, 4);\n"
+        "print(p.x + p.y);\n"
+        "q: Punto = Punto(1, 2);\n"
+        "print(q);\n"
+        "end;\n";
+
+    lexerInit(source);
+    AstNode *ast = parseProgram();
+    assert(ast != NULL);
+
+    escapeResetStats();
+    escapeAnalyzeProgram(ast);
+    const EscapeStats *stats = escapeGetStats();
+    assert(stats->objects == 2);
+    assert(stats->scalarReplaced == 1);
+    assert(stats->heap == 1);
+    assert(stats->fields == 2);
+
+    // El constructor de 'p' se expande en almacenamientos a sus slots.
+    assert(hasAssign(ast, "p$x"));
+    assert(hasAssign(ast, "p$y"));
+    assert(!hasAssign(ast, "q$x"));
+
+    escapeDumpStats();
+    freeAst(ast);
+    printf("Escape analysis test passed.\n");
+    return 0;
+}
@@ -0,0 +1,85 @@
+#include <stdio.h>
+#include <stddef.h>
+#include <assert.h>
+#include "memory.h"
+
+/* Compilar con -DUSE_GC */
+
+typedef struct Node {
+    struct Node *left;
+    struct Node *right;
+    long value;
+} Node;
+
+static const size_t nodeOffsets[] = { offsetof(Node, left), offsetof(Node, right) };
+static const GCType nodeType = { "Node", 2, nodeOffsets };
+
+static Node *globalNode = NULL;
+
+static Node *newNode(long value) {
+    Node *node = memory_alloc_gc_typed(sizeof(Node), &nodeType);
+    node->value = value;
+    return node;
+}
+
+static size_t collectFreed(void) {
+    GCStats before, after;
+    memory_gc_get_stats(&before);
+    memory_gc_collect();
+    memory_gc_get_stats(&after);
+    return after.objectsFreed - before.objectsFreed;
+}
+
+int main(void) {
+    void *roots[2] = { NULL, NULL };
+    GCFrame frame;
+    memory_gc_push_frame(&frame, roots, 2);
+
+    // Lo alcanzable desde un marco se conserva, también a través de campos;
+    // el recolector no mueve objetos, así que los punteros siguen valiendo.
+    Node *parent = newNode(1);
+    roots[0] = parent;
+    parent->left = newNode(2);
+    parent->right = newNode(3);
+    parent->left->left = newNode(4);
+    newNode(-1);
+    assert(collectFreed() == 1);
+    assert(roots[0] == parent);
+    assert(parent->left->value == 2 && parent->right->value == 3);
+    assert(parent->left->left->value == 4);
+
+    // Un objeto sin descriptor no se recorre: su contenido no son raíces.
+    long *leaf = memory_alloc_gc(sizeof(long) * 4);
+    leaf[0] = 42;
+    roots[1] = leaf;
+    assert(collectFreed() == 0);
+    assert(leaf[0] == 42);
+    roots[1] = NULL;
+    assert(collectFreed() == 1);
+
+    // Un ciclo que no cuelga de ninguna raíz se libera entero (las
+    // variables locales de C no son raíces si no están en un marco).
+    Node *a = newNode(10);
+    Node *b = newNode(11);
+    a->left = b;
+    b->left = a;
+    assert(collectFreed() == 2);
+
+    // Las raíces globales mantienen vivo lo que apuntan hasta que se quitan.
+    globalNode = newNode(20);
+    globalNode->right = newNode(21);
+    memory_gc_add_root((void **)&globalNode);
+    assert(collectFreed() == 0);
+    assert(globalNode->right->value == 21);
+    memory_gc_remove_root((void **)&globalNode);
+    assert(collectFreed() == 2);
+
+    // Al soltar la raíz del marco se libera el árbol completo.
+    roots[0] = NULL;
+    assert(collectFreed() == 4);
+
+    memory_gc_pop_frame(&frame);
+    memory_gc_dumpStats();
+    printf("GC test passed.\n");
+    return 0;
+}
@@ -0,0 +1,146 @@
+#include <stdio.h>
+#include <assert.h>
+#include <stdint.h>
+#include <string.h>
+#include <pthread.h>
+#include "memory.h"
+
+#define STATS_THREADS 4
+#define STATS_ALLOCS 5000
+
+static void *statsWorker(void *arg) {
+    (void)arg;
+    for (int i = 0; i < STATS_ALLOCS; i++)
+        memory_free(memory_alloc(100));
+    return NULL;
+}
+
+/* Libera en otro hilo bloques muestreados por el hilo principal */
+typedef struct {
+    void **blocks;
+    int count;
+} FreeRange;
+
+static void *freeWorker(void *arg) {
+    FreeRange *range = (FreeRange *)arg;
+    for (int i = 0; i < range->count; i++)
+        memory_free(range->blocks[i]);
+    return NULL;
+}
+
+int main(void) {
+    // El pool crece más allá de poolSize en lugar de retornar NULL.
+    MemoryPool *pool = memory_pool_create(48, 4, 16);
+    assert(pool != NULL);
+    enum { N = 10000 };
+    static void *blocks[N];
+    for (int i = 0; i < N; i++) {
+        blocks[i] = memory_pool_alloc(pool);
+        assert(blocks[i] != NULL);
+        assert(((uintptr_t)blocks[i] % 16) == 0);
+        memset(blocks[i], 0xAB, 48);
+    }
+    for (int i = 0; i < N; i++)
+        memory_pool_free(pool, blocks[i]);
+    memory_pool_flush_thread_cache(pool);
+    assert(memory_pool_get_total_allocs(pool) == N);
+    assert(memory_pool_get_total_frees(pool) == N);
+    memory_pool_dumpStats(pool);
+    memory_pool_destroy(pool);
+
+    // Con límite (modo embedded) el pool deja de crecer.
+    pool = memory_pool_create(64, 0, 16);
+    memory_pool_set_max_blocks(pool, 1);
+    size_t count = 0;
+    while (memory_pool_alloc(pool) != NULL)
+        count++;
+    assert(count > 0 && count < N);
+    memory_pool_destroy(pool);
+
+    // Respaldo prefaltado y con hugepages.
+    int flags[] = { MEMORY_POOL_POPULATE, MEMORY_POOL_HUGEPAGES };
+    for (int f = 0; f < 2; f++) {
+        pool = memory_pool_create_ex(32, 1000, 16, flags[f]);
+        assert(pool != NULL);
+        void *p = memory_pool_alloc(pool);
+        assert(p != NULL);
+        memory_pool_free(pool, p);
+        memory_pool_destroy(pool);
+    }
+
+    // Pool NUMA: la reserva se reparte entre los nodos y cada hilo toma
+    // bloques de su nodo (en una máquina de un nodo, todo va al nodo 0).
+    int nodes = memory_numa_node_count();
+    assert(nodes >= 1 && nodes <= MEMORY_NUMA_MAX_NODES);
+    int node = memory_numa_current_node();
+    assert(node >= 0 && node < nodes);
+    pool = memory_pool_create_ex(32, 1000, 16, MEMORY_POOL_NUMA | MEMORY_POOL_POPULATE);
+    assert(pool != NULL);
+    for (int i = 0; i < N; i++) {
+        blocks[i] = memory_pool_alloc(pool);
+        assert(blocks[i] != NULL);
+    }
+    for (int i = 0; i < N; i++)
+        memory_pool_free(pool, blocks[i]);
+    memory_pool_dumpStats(pool);
+    memory_pool_destroy(pool);
+
+    // Slab allocator: cada tamaño cae en una clase que lo contiene.
+    SlabAllocator *sa = memory_slab_create_ex(MEMORY_POOL_NUMA);
+    for (size_t size = 1; size <= 40000; size = size * 5 / 4 + 1) {
+        char *p = memory_slab_alloc(sa, size);
+        assert(p != NULL);
+        assert(((uintptr_t)p % MEMORY_SLAB_ALIGNMENT) == 0);
+        memset(p, 0x5A, size);
+        memory_slab_free(sa, p, size);
+    }
+    memory_slab_dumpStats(sa);
+    memory_slab_destroy(sa);
+
+    // Perfilador: con un intervalo pequeño se muestrean asignaciones y,
+    // liberadas todas, no quedan bytes vivos estimados.
+    assert(memory_profile_start("/tmp/lyn_test_memprof.txt", 64) == 0);
+    for (int i = 0; i < N / 4; i++)
+        blocks[i] = memory_alloc(32 + (size_t)(i % 200));
+    MemoryProfileStats prof;
+    memory_profile_get_stats(&prof);
+    assert(prof.samples > 0 && prof.sites > 0);
+    assert(prof.liveBytes > 0 && prof.liveBytes == prof.peakLiveBytes);
+    // Las bajas que hace otro hilo pasan por el filtro sin perder ninguna,
+    // también mientras el resto de asignaciones hace crecer la tabla.
+    pthread_t freer[STATS_THREADS];
+    FreeRange ranges[STATS_THREADS];
+    for (int t = 0; t < STATS_THREADS; t++) {
+        ranges[t].blocks = blocks + t * (N / 4 / STATS_THREADS);
+        ranges[t].count = N / 4 / STATS_THREADS;
+        pthread_create(&freer[t], NULL, freeWorker, &ranges[t]);
+    }
+    for (int i = N / 4; i < N; i++)
+        blocks[i] = memory_alloc(32 + (size_t)(i % 200));
+    for (int t = 0; t < STATS_THREADS; t++)
+        pthread_join(freer[t], NULL);
+    for (int i = N / 4; i < N; i++)
+        memory_free(blocks[i]);
+    memory_profile_get_stats(&prof);
+    assert(prof.liveBytes == 0);
+    memory_profile_stop();
+    assert(!memory_profile_active());
+
+    // Contadores por hilo: los de hilos ya terminados siguen sumando.
+    MemoryAllocStats before, after;
+    memory_get_alloc_stats(&before);
+    pthread_t threads[STATS_THREADS];
+    for (int i = 0; i < STATS_THREADS; i++)
+        assert(pthread_create(&threads[i], NULL, statsWorker, NULL) == 0);
+    for (int i = 0; i < STATS_THREADS; i++)
+        pthread_join(threads[i], NULL);
+    memory_get_alloc_stats(&after);
+    assert(after.allocs - before.allocs == STATS_THREADS * STATS_ALLOCS);
+    assert(after.frees - before.frees == STATS_THREADS * STATS_ALLOCS);
+    assert(after.bytes - before.bytes == (size_t)STATS_THREADS * STATS_ALLOCS * 100);
+    assert(after.classAllocs[7] - before.classAllocs[7] == STATS_THREADS * STATS_ALLOCS);
+    assert(memory_get_global_alloc_count() >= after.allocs);
+
+    printf("Memory test passed.\n");
+    return 0;
+}
@@ -0,0 +1,148 @@
+#include <stdio.h>
+#include <assert.h>
+#include <string.h>
+#include "lexer.h"
+#include "parser.h"
+#include "ast.h"
+#include "optimize.h"
+#include "semantic.h"
+
+/* Inicializador de la asignación de nivel superior a 'name' */
+static AstNode *initializerOf(AstNode *program, const char *name) {
+    for (int i = 0; i < program->program.statementCount; i++) {
+        AstNode *st = program->program.statements[i];
+        if (st->type == AST_VAR_ASSIGN && strcmp(st->varAssign.name, name) == 0)
+            return st->varAssign.initializer;
+        if (st->type == AST_VAR_DECL && strcmp(st->varDecl.name, name) == 0)
+            return st->varDecl.initializer;
+    }
+    return NULL;
+}
+
+/* Expresión del primer 'return' de la función 'name' (o de un método) */
+static AstNode *returnOf(AstNode **stmts, int count, const char *name) {
+    for (int i = 0; i < count; i++) {
+        AstNode *st = stmts[i];
+        if (st->type == AST_CLASS_DEF) {
+            AstNode *found = returnOf(st->classDef.members, st->classDef.memberCount, name);
+            if (found)
+                return found;
+        }
+        if (st->type != AST_FUNC_DEF || strcmp(st->funcDef.name, name) != 0)
+            continue;
+        for (int j = 0; j < st->funcDef.bodyCount; j++) {
+            if (st->funcDef.body[j]->type == AST_RETURN_STMT)
+                return st->funcDef.body[j]->returnStmt.expr;
+        }
+    }
+    return NULL;
+}
+
+static int isIntZero(AstNode *node) {
+    return node && node->type == AST_NUMBER_LITERAL && !node->numberLiteral.isFloat &&
+           node->numberLiteral.intValue == 0;
+}
+
+static AstNode *optimizeSource(const char *source) {
+    lexerInit(source);
+    AstNode *ast = parseProgram();
+    assert(ast != NULL);
+    return optimizeAST(ast);
+}
+
+int main(void) {
+    // Los aniquiladores y la reasociación solo se aplican a enteros:
+    // 'f * 0' con f float no es el entero 0 (NaN * 0 es NaN).
+    const char *source =
+        "main;\n"
+        "n: int = 3;\n"
+        "f: float = 2.5;\n"
+        "a = n * 0;\n"
+        "b = n - n;\n"
+        "c = f * 0;\n"
+        "d = f - f;\n"
+        "e = (f + 1) + 2;\n"
+        "g = (n + 1) + 2;\n"
+        "print(a + b + c + d + e + g);\n"
+        "end;\n";
+
+    optimizeResetStats();
+    AstNode *ast = optimizeSource(source);
+    assert(isIntZero(initializerOf(ast, "a")));
+    assert(isIntZero(initializerOf(ast, "b")));
+    assert(initializerOf(ast, "c")->type == AST_BINARY_OP);
+    assert(initializerOf(ast, "d")->type == AST_BINARY_OP);
+    AstNode *e = initializerOf(ast, "e");
+    assert(e->type == AST_BINARY_OP && e->binaryOp.left->type == AST_BINARY_OP);
+    AstNode *g = initializerOf(ast, "g");
+    assert(g->type == AST_BINARY_OP && g->binaryOp.left->type == AST_IDENTIFIER &&
+           g->binaryOp.right->numberLiteral.intValue == 3);
+    optimizeDumpStats();
+    freeAst(ast);
+
+    // '+' entre strings se decide tras el análisis semántico, con el tipo
+    // de cada operando: parámetros, retornos de funciones, métodos y
+    // lambdas, y campos de la clase del objeto.
+    const char *strings =
+        "main;\n"
+        "func junta(a: string, b: string) -> string;\n"
+        "    return a + b;\n"
+        "end;\n"
+        "func suma(a: int, b: int) -> int;\n"
+        "    return a + b;\n"
+        "end;\n"
+        "class A;\n"
+        "    s: string;\n"
+        "    v: string;\n"
+        "    func nombre(self: A) -> string;\n"
+        "        return self.s + \"!\";\n"
+        "    end;\n"
+        "end;\n"
+        "class B;\n"
+        "    v: int;\n"
+        "    func nombre(self: B) -> int;\n"
+        "        return self.v;\n"
+        "    end;\n"
+        "end;\n"
+        "f = (t: string) -> string => t + t;\n"
+        "x: A = A();\n"
+        "y: B = B();\n"
+        "h = junta(\"a\", \"b\") + \"c\";\n"
+        "k = x.nombre() + \"?\";\n"
+        "m = f(\"z\") + \"w\";\n"
+        "n = y.v + 1;\n"
+        "p = y.nombre() + 1;\n"
+        "q = x.v + \"?\";\n"
+        "r = 0 + x.s;\n"
+        "print(h + k + m + q + r);\n"
+        "print(n + p);\n"
+        "end;\n";
+    ast = optimizeSource(strings);
+    // Antes del análisis semántico ningún '+' es todavía una cadena y
+    // '0 + x.s' no se simplifica: x.s no se sabe entero
+    AstNode *r = initializerOf(ast, "r");
+    assert(r->type == AST_BINARY_OP && isIntZero(r->binaryOp.left));
+    analyzeSemantics(ast);
+    buildStringChains(ast);
+    AstNode **stmts = ast->program.statements;
+    int count = ast->program.statementCount;
+    assert(returnOf(stmts, count, "junta")->type == AST_STRING_BUILD);
+    assert(returnOf(stmts, count, "suma")->type == AST_BINARY_OP);
+    assert(returnOf(stmts, count, "nombre")->type == AST_STRING_BUILD);
+    AstNode *f = initializerOf(ast, "f");
+    assert(f->type == AST_LAMBDA && f->lambda.body->type == AST_STRING_BUILD);
+    assert(initializerOf(ast, "h")->type == AST_STRING_BUILD);
+    assert(initializerOf(ast, "k")->type == AST_STRING_BUILD);
+    assert(initializerOf(ast, "m")->type == AST_STRING_BUILD);
+    // 'v' y 'nombre' son string en A e int en B: decide la clase del objeto
+    assert(initializerOf(ast, "n")->type == AST_BINARY_OP);
+    assert(initializerOf(ast, "p")->type == AST_BINARY_OP);
+    assert(initializerOf(ast, "q")->type == AST_STRING_BUILD);
+    r = initializerOf(ast, "r");
+    assert(r->type == AST_STRING_BUILD && r->stringBuild.pieceCount == 2 &&
+           r->stringBuild.pieces[0]->type == AST_STRING_LITERAL && !r->stringBuild.intPiece[1]);
+    freeAst(ast);
+
+    printf("Optimizer test passed.\n");
+    return 0;
+}
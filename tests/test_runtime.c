@@ -0,0 +1,144 @@
+#include <stdio.h>
+#include <assert.h>
+#include <limits.h>
+#include <pthread.h>
+#include "runtime.h"
+
+/* Cada iteración marca su casilla: al final todas deben valer 1 */
+#define N 1000000
+static int visited[N];
+
+static long markChunk(long start, long end) {
+    for (long i = start; i < end; i++)
+        visited[i]++;
+    return 0;
+}
+
+static long sumChunk(long start, long end) {
+    long sum = 0;
+    for (long i = start; i < end; i++)
+        sum += i;
+    return sum;
+}
+
+static long minChunk(long start, long end) {
+    long best = LONG_MAX;
+    for (long i = start; i < end; i++) {
+        long v = (i * 7919) % 1000003;
+        if (v < best)
+            best = v;
+    }
+    return best;
+}
+
+static long maxChunk(long start, long end) {
+    long best = LONG_MIN;
+    for (long i = start; i < end; i++) {
+        if (i > best)
+            best = i;
+    }
+    return best;
+}
+
+static long mulChunk(long start, long end) {
+    long product = 1;
+    for (long i = start; i < end; i++)
+        product *= (i % 2) ? -1 : 1;
+    return product;
+}
+
+/* Bucle anidado: cada iteración externa lanza otro bucle paralelo */
+static long innerChunk(long start, long end) {
+    return end - start;
+}
+
+static long outerChunk(long start, long end) {
+    long total = 0;
+    for (long i = start; i < end; i++)
+        total += lyn_parallel_for(0, 1000, 0, innerChunk, LYN_REDUCE_ADD);
+    return total;
+}
+
+/* Tareas: fib recursivo con spawn/await hasta un umbral */
+static long fibTask(long n) {
+    if (n < 2)
+        return n;
+    if (n < 12)
+        return fibTask(n - 1) + fibTask(n - 2);
+    LynFuture *left = lyn_spawn(fibTask, n - 1);
+    long right = fibTask(n - 2);
+    return lyn_await(left) + right;
+}
+
+static long squareTask(long x) {
+    return x * x;
+}
+
+/* Cadena de tareas: cada una espera a la anterior, que queda debajo en la
+   cola. Sin límite de ayuda, el hilo que espera la última las ejecutaría
+   todas anidadas en su pila */
+enum { CHAIN = 4 * LYN_DEQUE_SIZE };
+static LynFuture *chain[CHAIN];
+static pthread_t mainThread;
+static char *mainStackBase;
+static size_t mainStackUsed = 0;
+
+static long chainTask(long i) {
+    char probe;
+    if (pthread_equal(pthread_self(), mainThread)) {
+        size_t used = (size_t)(mainStackBase - &probe);
+        if (used > mainStackUsed)
+            mainStackUsed = used;
+    }
+    return i == 0 ? 0 : lyn_await(chain[i - 1]) + 1;
+}
+
+int main(void) {
+    printf("Runtime threads: %d\n", lyn_runtime_threads());
+
+    // Se repite para que la granularidad se ajuste con las medidas previas.
+    for (int round = 0; round < 3; round++) {
+        lyn_parallel_for(0, N, 0, markChunk, LYN_REDUCE_NONE);
+        for (long i = 0; i < N; i++)
+            assert(visited[i] == round + 1);
+        assert(lyn_parallel_for(0, N, 5, sumChunk, LYN_REDUCE_ADD) == 5 + (long)N * (N - 1) / 2);
+    }
+
+    assert(lyn_parallel_for(0, N, LONG_MAX, minChunk, LYN_REDUCE_MIN) == 0);
+    assert(lyn_parallel_for(0, N, -1, maxChunk, LYN_REDUCE_MAX) == N - 1);
+    assert(lyn_parallel_for(0, 1001, 1, mulChunk, LYN_REDUCE_MUL) == 1);
+    assert(lyn_parallel_for(0, 1002, 1, mulChunk, LYN_REDUCE_MUL) == -1);
+    assert(lyn_parallel_for(10, 10, 42, sumChunk, LYN_REDUCE_ADD) == 42);
+    assert(lyn_parallel_for(0, 200, 0, outerChunk, LYN_REDUCE_ADD) == 200 * 1000);
+
+    assert(lyn_await(lyn_spawn(fibTask, 25)) == 75025);
+    // Más tareas pendientes que huecos en la cola: el resto se ejecuta en el acto.
+    enum { TASKS = 3 * LYN_DEQUE_SIZE };
+    static LynFuture *futures[TASKS];
+    for (long i = 0; i < TASKS; i++)
+        futures[i] = lyn_spawn(squareTask, i);
+    for (long i = TASKS - 1; i >= 0; i--)
+        assert(lyn_await(futures[i]) == i * i);
+
+    char base;
+    mainThread = pthread_self();
+    mainStackBase = &base;
+    for (long i = 0; i < CHAIN; i++)
+        chain[i] = lyn_spawn(chainTask, i);
+    assert(lyn_await(chain[CHAIN - 1]) == CHAIN - 1);
+    printf("await chain: %zu bytes of stack\n", mainStackUsed);
+    assert(mainStackUsed < (size_t)LYN_AWAIT_HELP_DEPTH * 1024);
+
+    LynRuntimeStats stats;
+    lyn_runtime_get_stats(&stats);
+    assert(stats.loops > 0 && stats.chunks >= stats.loops - stats.sequential);
+    assert(stats.spawned >= TASKS);
+    printf("loops=%zu sequential=%zu chunks=%zu steals=%zu spawned=%zu\n",
+           stats.loops, stats.sequential, stats.chunks, stats.steals, stats.spawned);
+
+    lyn_runtime_shutdown();
+    assert(lyn_parallel_for(0, 100, 0, sumChunk, LYN_REDUCE_ADD) == 4950);
+    lyn_runtime_shutdown();
+    printf("Runtime test passed.\n");
+    return 0;
+}
@@ -0,0 +1,242 @@
+#define _POSIX_C_SOURCE 200809L
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <assert.h>
+#include <unistd.h>
+#include <sys/wait.h>
+#include "lexer.h"
+#include "parser.h"
+#include "ast.h"
+#include "optimize.h"
+#include "semantic.h"
+#include "escape.h"
+#include "treeshake.h"
+#include "bounds.h"
+#include "bytecode.h"
+#include "vm.h"
+#include "memory.h"
+
+/* Ejecuta programas con el intérprete de bytecode como 'lync run', cada
+   uno en un proceso hijo: un error de ejecución termina el proceso. */
+
+static char workDir[] = "/tmp/lyn-vm-XXXXXX";
+
+typedef struct {
+    char output[4096];      /* Salida, sin "Result: " y con un espacio tras cada valor */
+    char errors[512];       /* Lo escrito en stderr */
+    int status;             /* Estado de salida del proceso */
+    size_t tiered;          /* Funciones que pasaron al nivel nativo */
+} VmResult;
+
+static void readFile(const char *path, char *out, size_t size, int values) {
+    FILE *fp = fopen(path, "r");
+    char line[256];
+    assert(fp != NULL);
+    out[0] = '\0';
+    while (fgets(line, sizeof(line), fp)) {
+        if (values) {
+            line[strcspn(line, "\n")] = '\0';
+            const char *value = strncmp(line, "Result: ", 8) == 0 ? line + 8 : line;
+            strncat(out, value, size - strlen(out) - 2);
+            strcat(out, " ");
+        } else {
+            strncat(out, line, size - strlen(out) - 1);
+        }
+    }
+    fclose(fp);
+}
+
+static void runVm(const char *source, long tierThreshold, VmResult *result) {
+    char outPath[96], errPath[96], tierPath[96];
+    snprintf(outPath, sizeof(outPath), "%s/out.txt", workDir);
+    snprintf(errPath, sizeof(errPath), "%s/err.txt", workDir);
+    snprintf(tierPath, sizeof(tierPath), "%s/tier.txt", workDir);
+
+    fflush(stdout);
+    pid_t pid = fork();
+    assert(pid >= 0);
+    if (pid == 0) {
+        /* Las fases escriben trazas: solo cuenta la salida del programa */
+        freopen("/dev/null", "w", stdout);
+        freopen(errPath, "w", stderr);
+        memory_set_trace(0);
+        lexerInit(source);
+        AstNode *ast = parseProgram();
+        ast = optimizeAST(ast);
+        analyzeSemantics(ast);
+        buildStringChains(ast);
+        escapeAnalyzeProgram(ast);
+        treeShakeProgram(ast);
+        boundsCheckProgram(ast);
+        BcProgram *program = bytecodeCompile(ast);
+        fflush(stdout);
+        freopen(outPath, "w", stdout);
+        VmOptions options = { tierThreshold };
+        vmResetStats();
+        int status = vmRun(program, &options);
+        fflush(stdout);
+        FILE *fp = fopen(tierPath, "w");
+        fprintf(fp, "%zu\n", vmGetStats()->tieredFunctions);
+        fclose(fp);
+        _exit(status);
+    }
+    int status;
+    waitpid(pid, &status, 0);
+    assert(WIFEXITED(status));
+    result->status = WEXITSTATUS(status);
+    readFile(outPath, result->output, sizeof(result->output), 1);
+    readFile(errPath, result->errors, sizeof(result->errors), 0);
+    result->tiered = 0;
+    FILE *fp = fopen(tierPath, "r");
+    if (fp) {
+        assert(fscanf(fp, "%zu", &result->tiered) == 1);
+        fclose(fp);
+    }
+    remove(tierPath);
+}
+
+static void expectOutput(const char *name, const char *source, const char *expected) {
+    VmResult result;
+    runVm(source, 0, &result);
+    if (result.status != 0 || strcmp(result.output, expected) != 0) {
+        fprintf(stderr, "%s: expected '%s', got '%s' (status %d)\n%s",
+                name, expected, result.output, result.status, result.errors);
+        assert(0);
+    }
+    assert(result.errors[0] == '\0');
+}
+
+int main(void) {
+    assert(mkdtemp(workDir) != NULL);
+    VmResult result;
+
+    // Despacho: aritmética, comparaciones, saltos, globales, arreglos y
+    // strings.
+    expectOutput("dispatch",
+        "main;\n"
+        "a: int = 17;\n"
+        "b: int = 5;\n"
+        "print(a + b * 2 - 3);\n"
+        "print(a / b);\n"
+        "print(a % b);\n"
+        "print(0 - a);\n"
+        "if a > b;\n"
+        "    print(1);\n"
+        "else;\n"
+        "    print(0);\n"
+        "end;\n"
+        "s: int = 0;\n"
+        "for i in range(10);\n"
+        "    if i % 3 == 0;\n"
+        "        s = s + i;\n"
+        "    else;\n"
+        "        s = s - 1;\n"
+        "    end;\n"
+        "end;\n"
+        "print(s);\n"
+        "v: [int] = array(5);\n"
+        "for j in range(5);\n"
+        "    v[j] = j * j;\n"
+        "end;\n"
+        "print(v[4] + len(v));\n"
+        "t: string = \"n=\" + s.to_str();\n"
+        "print(t);\n"
+        "end;\n",
+        "24 3 2 -17 1 12 21 n=12 ");
+
+    // Llamadas: argumentos, recursión doble y recursión profunda.
+    expectOutput("calls",
+        "main;\n"
+        "func fib(n: int) -> int;\n"
+        "    if n < 2;\n"
+        "        return n;\n"
+        "    end;\n"
+        "    return fib(n - 1) + fib(n - 2);\n"
+        "end;\n"
+        "func suma(n: int, acc: int) -> int;\n"
+        "    if n == 0;\n"
+        "        return acc;\n"
+        "    end;\n"
+        "    return suma(n - 1, acc + n);\n"
+        "end;\n"
+        "func mezcla(a: int, b: int, c: int) -> int;\n"
+        "    return a * 100 + b * 10 + c;\n"
+        "end;\n"
+        "print(fib(20));\n"
+        "print(suma(1000, 0));\n"
+        "print(mezcla(1, fib(3), 3));\n"
+        "end;\n",
+        "6765 500500 123 ");
+
+    // Clausuras: capturas por valor, funciones que devuelven lambdas y
+    // lambdas pasadas como argumento.
+    expectOutput("closures",
+        "main;\n"
+        "func hazSumador(n: int) -> fn;\n"
+        "    g = (x: int) -> int => x + n;\n"
+        "    return g;\n"
+        "end;\n"
+        "func aplica(f: fn, x: int) -> int;\n"
+        "    return f(x) + 1;\n"
+        "end;\n"
+        "s3 = hazSumador(3);\n"
+        "s10 = hazSumador(10);\n"
+        "print(s3(4));\n"
+        "print(s10(4));\n"
+        "print(aplica(s3, 100));\n"
+        "doble = (n: int) -> int => n * 2;\n"
+        "print(aplica(doble, 20));\n"
+        "cur = (a: int) -> fn => (b: int) -> int => a * 10 + b;\n"
+        "c4 = cur(4);\n"
+        "print(c4(2));\n"
+        "end;\n",
+        "7 14 104 41 42 ");
+
+    // Un índice fuera de rango termina con estado 1 tras lo ya impreso.
+    runVm(
+        "main;\n"
+        "a: [int] = array(3);\n"
+        "print(1);\n"
+        "print(a[3]);\n"
+        "print(2);\n"
+        "end;\n",
+        0, &result);
+    assert(result.status == 1);
+    assert(strcmp(result.output, "1 ") == 0);
+    assert(strstr(result.errors, "Index 3 out of bounds for array of length 3") != NULL);
+
+    // Nivel nativo: la función pasa a código nativo tras 100 llamadas y el
+    // resultado no cambia.
+    const char *hot =
+        "main;\n"
+        "func cuadrado(n: int) -> int;\n"
+        "    return n * n + 1;\n"
+        "end;\n"
+        "s: int = 0;\n"
+        "for i in range(2000);\n"
+        "    s = s + cuadrado(i);\n"
+        "end;\n"
+        "print(s);\n"
+        "end;\n";
+#if defined(__x86_64__)
+    if (system("cc --version >/dev/null 2>&1") == 0) {
+        runVm(hot, 100, &result);
+        assert(result.status == 0 && result.tiered == 1);
+        assert(strcmp(result.output, "2664669000 ") == 0);
+    } else {
+        printf("Tier-up skipped (needs cc).\n");
+    }
+#else
+    printf("Tier-up skipped (needs an x86-64 host).\n");
+#endif
+    runVm(hot, 0, &result);
+    assert(result.status == 0 && result.tiered == 0);
+    assert(strcmp(result.output, "2664669000 ") == 0);
+
+    char command[96];
+    snprintf(command, sizeof(command), "rm -rf %s", workDir);
+    system(command);
+    printf("VM test passed.\n");
+    return 0;
+}